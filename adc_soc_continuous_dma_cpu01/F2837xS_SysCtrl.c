@@ -49,6 +49,7 @@
 //
 #include "F2837xS_device.h"
 #include "F2837xS_Examples.h"
+#include "boot.h"
 #ifdef __cplusplus
 using std::memcpy;
 #endif
@@ -111,6 +112,7 @@ void InitSysCtrl(void)
     //
     InitFlash_Bank0();
 #endif
+    Boot_Mark(BOOT_RAMFUNCS);
 
     //
     //      *IMPORTANT*
@@ -156,6 +158,7 @@ void InitSysCtrl(void)
     CpuSysRegs.PCLKCR13.bit.ADC_C = 0;
     CpuSysRegs.PCLKCR13.bit.ADC_D = 0;
     EDIS;
+    Boot_Mark(BOOT_TRIM);
 
     //
     // Initialize the PLL control: SYSPLLMULT and SYSCLKDIVSEL.
@@ -173,11 +176,13 @@ void InitSysCtrl(void)
 #else
     InitSysPll(XTAL_OSC,IMULT_20,FMULT_0,PLLCLK_BY_2);
 #endif
+    Boot_Mark(BOOT_PLL);
 
     //
     // Turn on all peripherals
     //
     InitPeripheralClocks();
+    Boot_Mark(BOOT_CLOCKS);
 }
 
 //
@@ -191,6 +196,30 @@ void InitPeripheralClocks(void)
 {
     EALLOW;
 
+#ifdef BOOT_FAST
+    //
+    // Only the peripherals this project uses (see boot.c)
+    //
+    CpuSysRegs.PCLKCR0.bit.DMA = 1;
+    CpuSysRegs.PCLKCR0.bit.CPUTIMER0 = 1;
+    CpuSysRegs.PCLKCR0.bit.CPUTIMER1 = 1;
+    CpuSysRegs.PCLKCR0.bit.CPUTIMER2 = 1;
+    CpuSysRegs.PCLKCR0.bit.TBCLKSYNC = 1;
+
+    CpuSysRegs.PCLKCR2.bit.EPWM2 = 1;
+
+    CpuSysRegs.PCLKCR7.bit.SCI_A = 1;
+    CpuSysRegs.PCLKCR7.bit.SCI_B = 1;
+    CpuSysRegs.PCLKCR7.bit.SCI_C = 1;
+    CpuSysRegs.PCLKCR7.bit.SCI_D = 1;
+
+    CpuSysRegs.PCLKCR8.bit.SPI_A = 1;
+
+    CpuSysRegs.PCLKCR11.bit.McBSP_A = 1;
+
+    CpuSysRegs.PCLKCR13.bit.ADC_A = 1;
+    CpuSysRegs.PCLKCR13.bit.ADC_B = 1;
+#else
     CpuSysRegs.PCLKCR0.bit.CLA1 = 1;
     CpuSysRegs.PCLKCR0.bit.DMA = 1;
     CpuSysRegs.PCLKCR0.bit.CPUTIMER0 = 1;
@@ -267,6 +296,7 @@ void InitPeripheralClocks(void)
     CpuSysRegs.PCLKCR16.bit.DAC_A = 1;
     CpuSysRegs.PCLKCR16.bit.DAC_B = 1;
     CpuSysRegs.PCLKCR16.bit.DAC_C = 1;
+#endif
 
     EDIS;
 }
@@ -0,0 +1,382 @@
+//###########################################################################
+//
+// FILE:   adc_cal.c
+//
+// TITLE:  Board level gain/offset calibration of the ADC channels.
+//
+// AdcSetMode() only loads the factory trims of the converter itself. The
+// table here corrects the analog front end of the board: every sample of a
+// channel is replaced by data * gain + offset before it leaves the board.
+//
+// The table is calibrated with a two-point procedure on the SCI command
+// channel:
+//
+//   CAL LO <ch> <mV>   - apply a low reference voltage to the channel input
+//                        and capture its mean as the low point (in
+//                        differential mode the voltage between the + and
+//                        - inputs, which may be negative)
+//   CAL HI <ch> <mV>   - same for the high point
+//   CAL APPLY <ch>     - compute gain and offset from the two points
+//   CAL CLR <ch>       - return the channel to gain 1, offset 0
+//   CAL SET <ch> <gain> <offset> - load a saved entry (gain in 1e-6,
+//                        offset in 1/1000 code)
+//   CAL                - list the table in the CAL SET format
+//
+// A table only applies to the resolution and signal mode it was taken in.
+// Each mode keeps its own, so a mode change (MODE, ADC BENCH) and back
+// finds the table of the mode as it was left.
+//
+// There is no flash programming in this project, so the tables live in
+// RAM. They are protected by a checksum and survive a warm reset;
+// otherwise the host keeps the CAL listing and restores it with CAL SET.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "adc_cal.h"
+#include "cmd.h"
+
+//
+// Defines
+//
+#define CAL_POINT_NONE  0
+#define CAL_POINT_LO    1
+#define CAL_POINT_HI    2
+
+//
+// Typedefs
+//
+typedef struct
+{
+    float32 measured[2];        // Mean code captured at the LO/HI points
+    float32 ideal[2];           // Code the LO/HI reference should read
+    Uint16  have[2];
+} ADC_CAL_POINTS;
+
+//
+// Globals
+//
+#pragma DATA_SECTION(adcCalTable, "ramgs1");
+#pragma DATA_SECTION(adcCalSaved, "ramgs1");
+ADC_CAL_TABLE adcCalTable;                  // Table of the current mode
+ADC_CAL_TABLE adcCalSaved[ADC_CAL_MODES];   // Tables of the other modes
+ADC_CAL_POINTS adcCalPoints[ADC_CAL_CHANNELS];
+Uint16 calPendingPoint;
+Uint16 calPendingCh;
+
+//
+// AdcCal_Checksum - Sum of the table contents, excluding the checksum
+//
+static Uint16 AdcCal_Checksum(const ADC_CAL_TABLE *table)
+{
+    union
+    {
+        float32 f;
+        Uint32 u;
+    } word;
+    Uint16 sum;
+    Uint16 ch;
+
+    sum = table->magic + table->fullScale + table->signalMode;
+    for(ch = 0; ch < ADC_CAL_CHANNELS; ch++)
+    {
+        word.f = table->entry[ch].gain;
+        sum += (Uint16)word.u + (Uint16)(word.u >> 16);
+        word.f = table->entry[ch].offset;
+        sum += (Uint16)word.u + (Uint16)(word.u >> 16);
+    }
+    return sum ^ 0xFFFF;
+}
+
+//
+// AdcCal_Valid - Nonzero for a table that was initialized and is intact
+//
+static Uint16 AdcCal_Valid(const ADC_CAL_TABLE *table)
+{
+    return (table->magic == ADC_CAL_MAGIC) &&
+           (table->checksum == AdcCal_Checksum(table));
+}
+
+//
+// AdcCal_Mode - adcCalSaved index of a resolution and signal mode
+//
+static Uint16 AdcCal_Mode(Uint16 fullScale, Uint16 signalMode)
+{
+    return ((fullScale > 4095) ? 2 : 0) +
+           ((signalMode == ADC_SIGNALMODE_DIFFERENTIAL) ? 1 : 0);
+}
+
+//
+// AdcCal_Clear - Identity correction for one channel
+//
+static void AdcCal_Clear(Uint16 ch)
+{
+    adcCalTable.entry[ch].gain = 1.0f;
+    adcCalTable.entry[ch].offset = 0.0f;
+    adcCalPoints[ch].have[0] = 0;
+    adcCalPoints[ch].have[1] = 0;
+}
+
+//
+// AdcCal_Init - Select the table of a mode: keep a valid one from before
+//               a warm reset or a mode change, otherwise start from the
+//               identity correction. fullScale is the largest code of the
+//               configured resolution and signalMode the ADC_SIGNALMODE_xxx
+//               of the inputs. The table of the mode left is put aside.
+//
+void AdcCal_Init(Uint16 fullScale, Uint16 signalMode)
+{
+    Uint16 ch;
+    Uint16 mode;
+
+    mode = AdcCal_Mode(fullScale, signalMode);
+    if((AdcCal_Valid(&adcCalTable) != 0) &&
+       ((adcCalTable.fullScale != fullScale) ||
+        (adcCalTable.signalMode != signalMode)))
+    {
+        adcCalSaved[AdcCal_Mode(adcCalTable.fullScale,
+                                adcCalTable.signalMode)] = adcCalTable;
+        adcCalTable.magic = 0;
+    }
+
+    if((AdcCal_Valid(&adcCalTable) == 0) &&
+       (AdcCal_Valid(&adcCalSaved[mode]) != 0) &&
+       (adcCalSaved[mode].fullScale == fullScale) &&
+       (adcCalSaved[mode].signalMode == signalMode))
+    {
+        adcCalTable = adcCalSaved[mode];
+    }
+
+    if(AdcCal_Valid(&adcCalTable) == 0)
+    {
+        adcCalTable.magic = ADC_CAL_MAGIC;
+        adcCalTable.fullScale = fullScale;
+        adcCalTable.signalMode = signalMode;
+        for(ch = 0; ch < ADC_CAL_CHANNELS; ch++)
+        {
+            AdcCal_Clear(ch);
+        }
+        adcCalTable.checksum = AdcCal_Checksum(&adcCalTable);
+    }
+
+    for(ch = 0; ch < ADC_CAL_CHANNELS; ch++)
+    {
+        adcCalPoints[ch].have[0] = 0;
+        adcCalPoints[ch].have[1] = 0;
+    }
+    calPendingPoint = CAL_POINT_NONE;
+}
+
+//
+// AdcCal_Apply - Correct a block of one channel in place. This is a single
+//                multiply-add per sample on the FPU followed by saturation
+//                to the code range.
+//
+void AdcCal_Apply(Uint16 ch, Uint16 *data, Uint16 len)
+{
+    Uint16 i;
+    float32 gain;
+    float32 offset;
+    float32 fullScale;
+    float32 y;
+
+    gain = adcCalTable.entry[ch].gain;
+    offset = adcCalTable.entry[ch].offset;
+    if((gain == 1.0f) && (offset == 0.0f))
+    {
+        return;
+    }
+
+    fullScale = (float32)adcCalTable.fullScale;
+    for(i = 0; i < len; i++)
+    {
+        y = (float32)data[i] * gain + offset;
+        if(y < 0.0f)
+        {
+            y = 0.0f;
+        }
+        if(y > fullScale)
+        {
+            y = fullScale;
+        }
+        data[i] = (Uint16)(y + 0.5f);
+    }
+}
+
+//
+// AdcCal_Pending - Nonzero while a calibration point waits for a capture
+//
+Uint16 AdcCal_Pending(void)
+{
+    return calPendingPoint != CAL_POINT_NONE;
+}
+
+//
+// AdcCal_Capture - Take the pending calibration point from a raw capture
+//
+void AdcCal_Capture(const Uint16 *chA, const Uint16 *chB, Uint16 len)
+{
+    const Uint16 *data;
+    Uint32 sum;
+    Uint16 i;
+    Uint16 p;
+    float32 mean;
+    char reply[40];
+
+    if((calPendingPoint == CAL_POINT_NONE) || (len == 0))
+    {
+        return;
+    }
+
+    data = (calPendingCh == ADC_CAL_CH_A) ? chA : chB;
+    sum = 0;
+    for(i = 0; i < len; i++)
+    {
+        sum += data[i];
+    }
+    mean = (float32)sum / (float32)len;
+
+    p = calPendingPoint - CAL_POINT_LO;
+    adcCalPoints[calPendingCh].measured[p] = mean;
+    adcCalPoints[calPendingCh].have[p] = 1;
+
+    sprintf(reply, "OK CAL %s %u %ld\n",
+            (calPendingPoint == CAL_POINT_LO) ? "LO" : "HI",
+            calPendingCh, (long)(mean * 1000.0f));
+    Cmd_Reply(reply);
+
+    calPendingPoint = CAL_POINT_NONE;
+}
+
+//
+// AdcCal_Solve - Gain and offset through the two captured points
+//
+static Uint16 AdcCal_Solve(Uint16 ch)
+{
+    ADC_CAL_POINTS *pts;
+    float32 span;
+    float32 gain;
+
+    pts = &adcCalPoints[ch];
+    if((pts->have[0] == 0) || (pts->have[1] == 0))
+    {
+        return 0;
+    }
+
+    span = pts->measured[1] - pts->measured[0];
+    if((span < 1.0f) && (span > -1.0f))
+    {
+        return 0;
+    }
+
+    gain = (pts->ideal[1] - pts->ideal[0]) / span;
+    adcCalTable.entry[ch].gain = gain;
+    adcCalTable.entry[ch].offset = pts->ideal[0] - gain * pts->measured[0];
+    return 1;
+}
+
+//
+// AdcCal_ReplyEntry - Report one table entry in the CAL SET format
+//
+static void AdcCal_ReplyEntry(Uint16 ch)
+{
+    char reply[48];
+
+    sprintf(reply, "CAL SET %u %ld %ld\n", ch,
+            (long)(adcCalTable.entry[ch].gain * 1000000.0f),
+            (long)(adcCalTable.entry[ch].offset * 1000.0f));
+    Cmd_Reply(reply);
+}
+
+//
+// AdcCal_Command - Handler of the CAL command
+//
+void AdcCal_Command(int argc, char *argv[])
+{
+    Uint16 ch;
+    Uint16 point;
+    float32 volts;
+
+    if(argc == 1)
+    {
+        for(ch = 0; ch < ADC_CAL_CHANNELS; ch++)
+        {
+            AdcCal_ReplyEntry(ch);
+        }
+        Cmd_Reply("OK\n");
+        return;
+    }
+
+    if(argc < 3)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    ch = (Uint16)atoi(argv[2]);
+    if(ch >= ADC_CAL_CHANNELS)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    if((strcmp(argv[1], "LO") == 0) || (strcmp(argv[1], "HI") == 0))
+    {
+        if((argc != 4) || (calPendingPoint != CAL_POINT_NONE))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        point = (argv[1][0] == 'L') ? CAL_POINT_LO : CAL_POINT_HI;
+
+        //
+        // Differential codes are offset binary over -VREF..+VREF
+        //
+        volts = (float32)atol(argv[3]) / (float32)ADC_CAL_VREF_MV;
+        if(adcCalTable.signalMode == ADC_SIGNALMODE_DIFFERENTIAL)
+        {
+            volts = 0.5f * (volts + 1.0f);
+        }
+        adcCalPoints[ch].ideal[point - CAL_POINT_LO] =
+            volts * (float32)(adcCalTable.fullScale + 1UL);
+        calPendingCh = ch;
+        calPendingPoint = point;
+        return;                 // Answered by AdcCal_Capture()
+    }
+    else if((strcmp(argv[1], "APPLY") == 0) && (argc == 3))
+    {
+        if(AdcCal_Solve(ch) == 0)
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+    }
+    else if((strcmp(argv[1], "CLR") == 0) && (argc == 3))
+    {
+        AdcCal_Clear(ch);
+    }
+    else if((strcmp(argv[1], "SET") == 0) && (argc == 5))
+    {
+        adcCalTable.entry[ch].gain = (float32)atol(argv[3]) / 1000000.0f;
+        adcCalTable.entry[ch].offset = (float32)atol(argv[4]) / 1000.0f;
+    }
+    else
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    adcCalTable.checksum = AdcCal_Checksum(&adcCalTable);
+    AdcCal_ReplyEntry(ch);
+    Cmd_Reply("OK\n");
+}
+
+//
+// End of file
+//
@@ -0,0 +1,65 @@
+//###########################################################################
+//
+// FILE:   adc_cal.h
+//
+// TITLE:  Board level gain/offset calibration of the ADC channels.
+//
+//###########################################################################
+
+#ifndef ADC_CAL_H
+#define ADC_CAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define ADC_CAL_CH_A        0       // ADCA channel of the capture
+#define ADC_CAL_CH_B        1       // ADCB channel of the capture
+#define ADC_CAL_CHANNELS    2
+
+#define ADC_CAL_VREF_MV     3000    // VREFHI - VREFLO of the board
+#define ADC_CAL_MAGIC       0xCA1B  // Marks an initialized table
+#define ADC_CAL_MODES       4       // Tables kept, one per resolution and
+                                    // signal mode
+
+//
+// Typedefs
+//
+// The corrected sample is data * gain + offset, in ADC codes
+//
+typedef struct
+{
+    float32 gain;
+    float32 offset;
+} ADC_CAL_ENTRY;
+
+typedef struct
+{
+    Uint16 magic;
+    Uint16 fullScale;
+    Uint16 signalMode;
+    ADC_CAL_ENTRY entry[ADC_CAL_CHANNELS];
+    Uint16 checksum;
+} ADC_CAL_TABLE;
+
+//
+// Function Prototypes
+//
+void AdcCal_Init(Uint16 fullScale, Uint16 signalMode);
+void AdcCal_Apply(Uint16 ch, Uint16 *data, Uint16 len);
+Uint16 AdcCal_Pending(void);
+void AdcCal_Capture(const Uint16 *chA, const Uint16 *chB, Uint16 len);
+void AdcCal_Command(int argc, char *argv[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_CAL_H
+
+//
+// End of file
+//
@@ -0,0 +1,359 @@
+//###########################################################################
+//
+// FILE:   adc_skew.c
+//
+// TITLE:  ADCA/ADCB inter-channel skew measurement and correction.
+//
+// ADCA and ADCB are both started by EPWM2 SOCA, but each ADC then runs its
+// own SOC chain re-triggered by its own INT1, so the two result streams can
+// slide against each other. With the same reference tone applied to both
+// inputs, the phase difference of the tone between the channels gives the
+// skew of ADCB relative to ADCA. Estimates are taken per segment so that
+// drift over a capture can be fitted as well.
+//
+// The reference must be a sine of SKEW_REF_CYCLES cycles per
+// SKEW_SEGMENT_LEN samples. The segments are Hann windowed, which puts the
+// window zeros on the DC bin so the input offset does not bias the phase.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <math.h>
+#include "adc_skew.h"
+
+//
+// Defines
+//
+#define SKEW_PI     3.14159265f
+
+//
+// Globals
+//
+#pragma DATA_SECTION(skewWinCos, "ramgs4");
+#pragma DATA_SECTION(skewWinSin, "ramgs4");
+#pragma DATA_SECTION(skewEstimate, "ramgs4");
+#pragma DATA_SECTION(skewPosition, "ramgs4");
+float32 skewWinCos[SKEW_SEGMENT_LEN];   // Hann window * cos(w n)
+float32 skewWinSin[SKEW_SEGMENT_LEN];   // Hann window * sin(w n)
+float32 skewEstimate[SKEW_MAX_SEGMENTS];
+Uint32  skewPosition[SKEW_MAX_SEGMENTS];
+Uint16  skewSegments;
+Uint16  skewRejected;
+Uint32  skewSampleCount;
+
+//
+// AdcSkew_Init - Build the windowed reference tables. Call once at startup.
+//
+void AdcSkew_Init(void)
+{
+    Uint16 n;
+    float32 w;
+    float32 phase;
+
+    for(n = 0; n < SKEW_SEGMENT_LEN; n++)
+    {
+        w = 0.5f - 0.5f * cos(2.0f * SKEW_PI * n / SKEW_SEGMENT_LEN);
+        phase = 2.0f * SKEW_PI * SKEW_REF_CYCLES * n / SKEW_SEGMENT_LEN;
+        skewWinCos[n] = w * cos(phase);
+        skewWinSin[n] = w * sin(phase);
+    }
+
+    AdcSkew_Reset();
+}
+
+//
+// AdcSkew_Reset - Discard the estimates of a previous calibration capture
+//
+void AdcSkew_Reset(void)
+{
+    skewSegments = 0;
+    skewRejected = 0;
+    skewSampleCount = 0;
+}
+
+//
+// AdcSkew_ProcessBlock - Estimate the skew of every whole segment in a pair
+//                        of simultaneously captured blocks. Blocks of one
+//                        capture must be passed in order; a trailing partial
+//                        segment is ignored.
+//
+void AdcSkew_ProcessBlock(const Uint16 *chA, const Uint16 *chB, Uint16 len)
+{
+    Uint16 seg;
+    Uint16 n;
+    float32 reA, imA, reB, imB;
+    float32 re, im;
+    float32 magA, magB, minMag;
+
+    //
+    // Squared bin magnitude of a tone at SKEW_MIN_AMPLITUDE. The Hann window
+    // has a coherent gain of 1/2, so the bin holds amplitude * N / 4.
+    //
+    minMag = SKEW_MIN_AMPLITUDE * SKEW_SEGMENT_LEN / 4.0f;
+    minMag = minMag * minMag;
+
+    for(seg = 0; seg + SKEW_SEGMENT_LEN <= len; seg += SKEW_SEGMENT_LEN)
+    {
+        reA = 0.0f;
+        imA = 0.0f;
+        reB = 0.0f;
+        imB = 0.0f;
+
+        for(n = 0; n < SKEW_SEGMENT_LEN; n++)
+        {
+            reA += (float32)chA[seg + n] * skewWinCos[n];
+            imA -= (float32)chA[seg + n] * skewWinSin[n];
+            reB += (float32)chB[seg + n] * skewWinCos[n];
+            imB -= (float32)chB[seg + n] * skewWinSin[n];
+        }
+
+        magA = reA * reA + imA * imA;
+        magB = reB * reB + imB * imB;
+
+        if((magA < minMag) || (magB < minMag) ||
+           (skewSegments >= SKEW_MAX_SEGMENTS))
+        {
+            skewRejected++;
+        }
+        else
+        {
+            //
+            // arg(A * conj(B)) is the phase lead of ADCA over ADCB. A delay
+            // of d samples on the ADCB data (ADCB sampling d samples early)
+            // shows up as a lead of w*d radians.
+            //
+            re = reA * reB + imA * imB;
+            im = imA * reB - reA * imB;
+
+            skewEstimate[skewSegments] = atan2(im, re) *
+                (float32)SKEW_SEGMENT_LEN /
+                (2.0f * SKEW_PI * SKEW_REF_CYCLES);
+            skewPosition[skewSegments] = skewSampleCount + seg +
+                                         (SKEW_SEGMENT_LEN / 2);
+            skewSegments++;
+        }
+    }
+
+    skewSampleCount += len;
+}
+
+//
+// AdcSkew_Finish - Fit skew and drift to the segment estimates of the
+//                  capture. Returns 1 if at least one segment carried the
+//                  reference tone.
+//
+Uint16 AdcSkew_Finish(ADC_SKEW_RESULT *result)
+{
+    Uint16 i;
+    float32 t, d, err;
+    float32 meanT, meanD;
+    float32 sxx, sxy;
+
+    result->segments = skewSegments;
+    result->rejected = skewRejected;
+    result->skew = 0.0f;
+    result->drift = 0.0f;
+    result->skewMin = 0.0f;
+    result->skewMax = 0.0f;
+    result->residual = 0.0f;
+    result->valid = 0;
+
+    if(skewSegments == 0)
+    {
+        return 0;
+    }
+
+    meanT = 0.0f;
+    meanD = 0.0f;
+    result->skewMin = skewEstimate[0];
+    result->skewMax = skewEstimate[0];
+    for(i = 0; i < skewSegments; i++)
+    {
+        meanT += (float32)skewPosition[i];
+        meanD += skewEstimate[i];
+        if(skewEstimate[i] < result->skewMin)
+        {
+            result->skewMin = skewEstimate[i];
+        }
+        if(skewEstimate[i] > result->skewMax)
+        {
+            result->skewMax = skewEstimate[i];
+        }
+    }
+    meanT /= skewSegments;
+    meanD /= skewSegments;
+
+    //
+    // Least squares line through the estimates
+    //
+    sxx = 0.0f;
+    sxy = 0.0f;
+    for(i = 0; i < skewSegments; i++)
+    {
+        t = (float32)skewPosition[i] - meanT;
+        sxx += t * t;
+        sxy += t * (skewEstimate[i] - meanD);
+    }
+
+    if(sxx > 0.0f)
+    {
+        result->drift = sxy / sxx;
+    }
+    result->skew = meanD - result->drift * meanT;
+
+    for(i = 0; i < skewSegments; i++)
+    {
+        d = result->skew + result->drift * (float32)skewPosition[i];
+        err = skewEstimate[i] - d;
+        result->residual += err * err;
+    }
+    result->residual = sqrt(result->residual / skewSegments);
+
+    result->valid = 1;
+    return 1;
+}
+
+//
+// AdcSkew_Fetch - Read a sample with the index clamped to the block
+//
+static float32 AdcSkew_Fetch(const Uint16 *src, int32 idx, Uint16 len)
+{
+    if(idx < 0)
+    {
+        idx = 0;
+    }
+    else if(idx >= (int32)len)
+    {
+        idx = (int32)len - 1;
+    }
+    return (float32)src[idx];
+}
+
+//
+// AdcSkew_Store - Round and saturate a corrected sample to 0..fullScale
+//
+static Uint16 AdcSkew_Store(float32 y, Uint16 fullScale)
+{
+    if(y <= 0.0f)
+    {
+        return 0;
+    }
+    if(y >= (float32)fullScale)
+    {
+        return fullScale;
+    }
+    return (Uint16)(y + 0.5f);
+}
+
+//
+// AdcSkew_Correct - Re-sample an ADCB block onto the ADCA sample instants.
+//                   startIndex is the position of src[0] within the capture
+//                   the result was measured on, so drift is followed across
+//                   consecutive blocks. The output is saturated to
+//                   fullScale, the largest code of the active resolution.
+//                   src and dst must not overlap.
+//
+// The delay is held constant over each SKEW_SEGMENT_LEN chunk, which keeps
+// the inner loop a fixed-coefficient 4-tap (cubic Lagrange) FIR.
+//
+void AdcSkew_Correct(const Uint16 *src, Uint16 *dst, Uint16 len,
+                     const ADC_SKEW_RESULT *result, Uint32 startIndex,
+                     Uint16 fullScale)
+{
+    Uint16 chunk, chunkEnd;
+    int32 n, nLo, nHi;
+    int32 whole;
+    float32 delay, mu;
+    float32 h0, h1, h2, h3;
+    float32 y;
+    const Uint16 *x;
+
+    if((result == 0) || (result->valid == 0))
+    {
+        for(n = 0; n < len; n++)
+        {
+            dst[n] = src[n];
+        }
+        return;
+    }
+
+    for(chunk = 0; chunk < len; chunk = chunkEnd)
+    {
+        chunkEnd = chunk + SKEW_SEGMENT_LEN;
+        if((chunkEnd > len) || (chunkEnd < chunk))
+        {
+            chunkEnd = len;
+        }
+
+        delay = result->skew + result->drift *
+                (float32)(startIndex + chunk + (chunkEnd - chunk) / 2);
+        if(delay > SKEW_MAX_SAMPLES)
+        {
+            delay = SKEW_MAX_SAMPLES;
+        }
+        else if(delay < -SKEW_MAX_SAMPLES)
+        {
+            delay = -SKEW_MAX_SAMPLES;
+        }
+
+        whole = (int32)floor(delay);
+        mu = delay - (float32)whole;
+
+        h0 = -mu * (mu - 1.0f) * (mu - 2.0f) / 6.0f;
+        h1 = (mu + 1.0f) * (mu - 1.0f) * (mu - 2.0f) / 2.0f;
+        h2 = -(mu + 1.0f) * mu * (mu - 2.0f) / 2.0f;
+        h3 = (mu + 1.0f) * mu * (mu - 1.0f) / 6.0f;
+
+        //
+        // Taps are src[n + whole - 1] .. src[n + whole + 2]. Samples whose
+        // taps fall off the block are clamped to the nearest edge sample.
+        //
+        nLo = 1 - whole;
+        if(nLo < chunk)
+        {
+            nLo = chunk;
+        }
+        nHi = (int32)len - 2 - whole;
+        if(nHi > chunkEnd)
+        {
+            nHi = chunkEnd;
+        }
+        if(nHi < nLo)
+        {
+            nHi = nLo;
+        }
+
+        for(n = chunk; n < nLo && n < chunkEnd; n++)
+        {
+            y = h0 * AdcSkew_Fetch(src, n + whole - 1, len) +
+                h1 * AdcSkew_Fetch(src, n + whole, len) +
+                h2 * AdcSkew_Fetch(src, n + whole + 1, len) +
+                h3 * AdcSkew_Fetch(src, n + whole + 2, len);
+            dst[n] = AdcSkew_Store(y, fullScale);
+        }
+
+        x = src + whole - 1;
+        for(n = nLo; n < nHi; n++)
+        {
+            y = h0 * (float32)x[n] + h1 * (float32)x[n + 1] +
+                h2 * (float32)x[n + 2] + h3 * (float32)x[n + 3];
+            dst[n] = AdcSkew_Store(y, fullScale);
+        }
+
+        for(n = nHi; n < chunkEnd; n++)
+        {
+            y = h0 * AdcSkew_Fetch(src, n + whole - 1, len) +
+                h1 * AdcSkew_Fetch(src, n + whole, len) +
+                h2 * AdcSkew_Fetch(src, n + whole + 1, len) +
+                h3 * AdcSkew_Fetch(src, n + whole + 2, len);
+            dst[n] = AdcSkew_Store(y, fullScale);
+        }
+    }
+}
+
+//
+// End of file
+//
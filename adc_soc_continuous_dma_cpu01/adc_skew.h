@@ -0,0 +1,69 @@
+//###########################################################################
+//
+// FILE:   adc_skew.h
+//
+// TITLE:  ADCA/ADCB inter-channel skew measurement and correction.
+//
+//###########################################################################
+
+#ifndef ADC_SKEW_H
+#define ADC_SKEW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define SKEW_SEGMENT_LEN    128     // Samples per phase estimate
+#define SKEW_REF_CYCLES     4       // Reference tone cycles per segment
+#define SKEW_MAX_SEGMENTS   64      // Estimates kept per calibration capture
+#define SKEW_MIN_AMPLITUDE  64.0f   // Reference bin magnitude below which a
+                                    // segment is rejected (in ADC codes)
+#define SKEW_MAX_SAMPLES    2.0f    // Largest skew the correction will apply
+
+//
+// Typedefs
+//
+// skew  - delay of the ADCB data relative to the ADCA data at the start of
+//         the capture, in samples. Positive means the ADCB samples are
+//         delayed copies, i.e. ADCB samples early; AdcSkew_Correct()
+//         advances them by the skew.
+// drift - change of skew per sample over the capture
+// skewMin/skewMax - extremes of the per-segment estimates, i.e. the bound
+//         on the skew seen during the capture
+// residual - RMS deviation of the segments from the skew + drift line
+//
+typedef struct
+{
+    float32 skew;
+    float32 drift;
+    float32 skewMin;
+    float32 skewMax;
+    float32 residual;
+    Uint16  segments;
+    Uint16  rejected;
+    Uint16  valid;
+} ADC_SKEW_RESULT;
+
+//
+// Function Prototypes
+//
+void AdcSkew_Init(void);
+void AdcSkew_Reset(void);
+void AdcSkew_ProcessBlock(const Uint16 *chA, const Uint16 *chB, Uint16 len);
+Uint16 AdcSkew_Finish(ADC_SKEW_RESULT *result);
+void AdcSkew_Correct(const Uint16 *src, Uint16 *dst, Uint16 len,
+                     const ADC_SKEW_RESULT *result, Uint32 startIndex,
+                     Uint16 fullScale);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_SKEW_H
+
+//
+// End of file
+//
@@ -15,6 +15,88 @@
 //! - \b adcData0 \b: a digital representation of the voltage on pin A3\n
 //! - \b adcData1 \b: a digital representation of the voltage on pin B3\n
 //!
+//! The ADCs start in 12-bit single-ended mode on A3/B3. In 16-bit
+//! differential mode (ADC 16 D 2) they convert the A2-A3 and B2-B3 pairs;
+//! the results are offset binary, 32768 at zero volts. All later stages
+//! take the sample width from \b adcBits.
+//!
+//! The first capture is sent on SCI-B as "index,value" lines. After that
+//! the program serves line commands received on SCI-B:
+//!
+//! - \b CAP \b: take and send another capture\n
+//! - \b SKEW \b: take a capture and run the skew calibration on it\n
+//! - \b CAL \b: board gain/offset calibration, see adc_cal.c\n
+//! - \b MODE CSV|RICE|SPI|MCB \b: send captures as text lines or as Rice
+//!   coded binary frames of both channels (see rice.c and tlm.h), or as
+//!   raw frames of both channels on the SPI-A slave link (see spi.c) or
+//!   the McBSP-A link (see mcbsp.c)\n
+//! - \b STAT \b: compression ratio and encoder load, see StatCommand()\n
+//! - \b DEC <ratio>|OFF|BUDGET \b: continuous decimated streaming, see
+//!   DecimCommand()\n
+//! - \b SCI \b: baud rates, telemetry ports, RTS/CTS flow control,
+//!   receive error counts and status frames and loopback of the SCI
+//!   ports, see SciCommand()\n
+//! - \b SPI \b: frames, throughput and CPU cost of the SPI link, see
+//!   SpiCommand()\n
+//! - \b MCB [CLK <div>] \b: the same for the McBSP link and its bit
+//!   rate, see McbspCommand()\n
+//! - \b LINK SCI|SPI|MCB [ms] \b: bandwidth and CPU cost of a data link
+//!   sending raw frames, see LinkCommand()\n
+//! - \b ADC 12|16 S|D <ch> \b: resolution, signal mode and input of both
+//!   ADCs; \b ADC BENCH \b compares the sample rates of the modes, see
+//!   AdcCommand()\n
+//! - \b ARQ [ON <port>|OFF|SEG <n>|RTO <ms>] \b: reliable transport of
+//!   the data output on one port, received by host/arq_peer (see arq.c),
+//!   see ArqCommand()\n
+//! - \b LOG [ON|OFF|CLEAR|BENCH] \b: the binary event log, sent as
+//!   TLM_TYPE_LOG frames and rendered by host/log_render (see log.c), see
+//!   LogCommand()\n
+//! - \b MEM RD|WR|CRC|STREAM|STOP \b: read, write and check target memory
+//!   without a debug probe; reads go out as TLM_TYPE_MEM frames for
+//!   host/mem_tool (see mem.c), see MemCommand()\n
+//! - \b SCHED \b: priorities, weights, shares and worst waits of the
+//!   telemetry streams sharing the frames (see sched.c), see
+//!   SchedCommand()\n
+//! - \b FAULT [RESUME|RESET|HALT|CLEAR|TEST] \b: the crash record and the
+//!   counts of interrupts that had no handler, and what is done about
+//!   them (see fault.c), see FaultCommand()\n
+//! - \b ISR [ON|OFF|CLEAR|BENCH] \b: execution time and entry latency of
+//!   the interrupts (see isrprof.c), see IsrCommand()\n
+//! - \b LOAD [CLEAR] \b: CPU load, split into interrupts, background loop
+//!   and idle (see load.c), see LoadCommand()\n
+//! - \b NEST [ON|OFF] \b: the interrupt priorities and the masks they
+//!   nest with (see nest.c), see NestCommand()\n
+//! - \b WORK [CLEAR] \b: the work the interrupts hand to the background
+//!   loop (see work.c), see WorkCommand()\n
+//! - \b HOT [BENCH] \b: the hot paths copied to RAM and the time of a
+//!   fixed workload of them (see hot.c), see HotCommand()\n
+//! - \b FLASH [BENCH] \b: the measured SYSCLK and the flash wait states,
+//!   prefetch and data cache set for it, and their effect on code run
+//!   from flash (see flash.c), see FlashCommand()\n
+//! - \b BOOT \b: the time each phase of the startup took, up to the first
+//!   sample (see boot.c), see BootCommand()\n
+//! - \b TIMER \b: the microsecond clock and the soft timers (see timer.c),
+//!   see TimerCommand()\n
+//!
+//! The skew calibration (also run when \b skewCalMode is set before a
+//! capture) uses a shared reference tone on A3 and B3 to measure the
+//! sampling skew of ADCB against ADCA (see adc_skew.c). The result is
+//! reported as a "SKEW,<skew>,<drift>,<residual>" line ahead of the data
+//! (skew and residual in 1/1000 sample, drift in 1/1000 sample per 1000
+//! samples; a positive skew means ADCB samples early) and is kept in
+//! \b adcSkew, which re-aligns the ADCB data before it is sent.
+//!
+//! Every capture is corrected with the board calibration table before the
+//! skew correction and before it is sent.
+//!
+//! In the streaming mode (DEC) the ADCs convert without a break. DMA CH1
+//! and CH2 run continuously and alternate between the two halves of
+//! \b adcData0 and \b adcData1; each finished half is decimated by the
+//! CIC + FIR chain of decim.c and the output is sent as Rice frames of
+//! DECIM_OUT_BITS wide samples (raw frames in MODE SPI and MCB). The data is
+//! not calibrated or skew corrected. Captures requested while streaming
+//! wait for DEC OFF.
+//!
 //
 //###########################################################################
 // $TI Release: F2837xS Support Library v3.04.00.00 $
@@ -57,60 +139,336 @@
 //
 #include "F28x_Project.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "adc_skew.h"
+#include "adc_cal.h"
+#include "cmd.h"
+#include "rice.h"
+#include "tlm.h"
+#include "timebase.h"
+#include "decim.h"
+#include "sci.h"
+#include "spi.h"
+#include "mcbsp.h"
+#include "log.h"
+#include "arq.h"
+#include "mem.h"
+#include "sched.h"
+#include "fmt.h"
+#include "fault.h"
+#include "isrprof.h"
+#include "load.h"
+#include "nest.h"
+#include "work.h"
+#include "hot.h"
+#include "flash.h"
+#include "boot.h"
+#include "timer.h"
 
 //
 // Function Prototypes
 //
 __interrupt void adca1_isr(void);
 __interrupt void dmach1_isr(void);
+__interrupt void dmach2_isr(void);
 
 void ConfigureEPWM(void);
-void ConfigureADC(void);
+void ConfigureADC(Uint16 resolution, Uint16 signalMode);
 void SetupADCContinuous(volatile struct ADC_REGS * adcRegs, Uint16 channel);
-void DMAInit(void);
+Uint16 AdcChannelValid(Uint16 signalMode, Uint16 channel);
+Uint16 SetAdcMode(Uint16 resolution, Uint16 signalMode, Uint16 channel);
+void DMAInit(Uint16 stream);
+void SetupSampling(void);
+void AdcPowerWait(void);
+void SettleDone(Uint16 arg);
+void StartConversions(void);
+void StartCapture(void);
+void ProcessCapture(void);
+void CaptureDone(Uint16 arg);
+void BenchStart(void);
+void BenchDone(Uint32 cycles);
+void BenchTimeout(Uint16 arg);
+void BenchReply(void);
+Uint16 SendCaptureStep(void);
+Uint16 SendRiceStep(void);
+Uint16 SendRawStep(void);
+Uint16 SendRawBlock(Uint16 ch, Uint16 bits, const Uint16 *data,
+                    Uint16 count);
+void QueueRiceFrame(Uint16 ch, const Uint16 *data, Uint16 len, Uint16 bits);
+void StartStream(void);
+void StopStream(void);
+void ProcessStreamBlock(Uint16 half);
+void SendStreamStep(void);
+void CaptureCommand(int argc, char *argv[]);
+void SkewCommand(int argc, char *argv[]);
+void ModeCommand(int argc, char *argv[]);
+void StatCommand(int argc, char *argv[]);
+void DecimCommand(int argc, char *argv[]);
+void AdcCommand(int argc, char *argv[]);
+void SpiCommand(int argc, char *argv[]);
+void McbspCommand(int argc, char *argv[]);
+void LinkCommand(int argc, char *argv[]);
+void LogCommand(int argc, char *argv[]);
+void ArqCommand(int argc, char *argv[]);
+void MemCommand(int argc, char *argv[]);
+void SchedCommand(int argc, char *argv[]);
+void FaultCommand(int argc, char *argv[]);
+void IsrCommand(int argc, char *argv[]);
+void LoadCommand(int argc, char *argv[]);
+void NestCommand(int argc, char *argv[]);
+void WorkCommand(int argc, char *argv[]);
+void HotCommand(int argc, char *argv[]);
+void FlashCommand(int argc, char *argv[]);
+void BootCommand(int argc, char *argv[]);
+void TimerCommand(int argc, char *argv[]);
+Uint16 CaptureFrameReady(void);
+void SendCaptureFrame(void);
+Uint16 StreamFrameReady(void);
+void SendStreamFrame(void);
 
 // Prototype statements for functions found within this file.
-interrupt void scibTxFifoIsr(void);
-interrupt void scibRxFifoIsr(void);
-void scib_fifo_init(void);
+Uint16 TxPort(void);
+int TxPut(const char *data, int len);
+void TxWrite(const char *s);
+int RxGet(void);
+void SciCommand(int argc, char *argv[]);
+Uint16 ParsePorts(const char *names);
+void PortNames(Uint16 mask, char *names);
+void MemWriteReply(void);
+Uint16 SciStatusReady(void);
+void SciStatusFrame(void);
+Uint16 ParseRange(char *argv[], Uint32 *addr, Uint32 *words);
 
 //
 // Defines
 //
 #define RESULTS_BUFFER_SIZE 1024    // Buffer for storing conversion results
                                     // (size must be multiple of 16)
-#define BUFFMAX 64
+#define ADC_CHANNEL_DEFAULT 3       // A3/B3, or the A2-A3/B2-B3 pairs
+#define ADC_BENCH_CAPTURES  2       // Modes ADC BENCH compares
+#define ADC_BENCH_TIMEOUT_US 100000UL // Longest wait for its capture
+#define ADC_POWERUP_US      1000    // ADC power-up time
+#define SETTLE_US           3000000UL // Wait before the first capture
+#define OUTPUT_CSV          0       // "index,value" lines of ADCB
+#define OUTPUT_RICE         1       // Rice coded frames of ADCA and ADCB
+#define OUTPUT_SPI          2       // Raw frames of ADCA and ADCB on SPI-A
+#define OUTPUT_MCBSP        3       // Raw frames of ADCA and ADCB on McBSP-A
+#define CAP_BLOCK_SIZE      256     // Samples per Rice frame of a capture,
+                                    // fits TLM_MAX_PAYLOAD
+#define RAW_BLOCK_SIZE      512     // Samples per raw frame, at most
+                                    // SPI_BLOCK_SAMPLES,
+                                    // MCBSP_BLOCK_SAMPLES and
+                                    // TLM_RAW_MAX_SAMPLES
+#define LINK_BENCH_MS       1000    // Default length of a LINK measurement
+#define LINK_BENCH_MAX_MS   20000   // Longest that fits the cycle counter
+#define LOG_BENCH_CALLS     32      // LOG2() calls timed by LOG BENCH, all
+                                    // fit an empty ring
+#define HOT_BENCH_RUNS      4       // HOT BENCH reports the fastest
+#define FLASH_BENCH_RUNS    4       // FLASH BENCH reports the fastest
+#define EPWM_CYCLES         2       // SYSCLK cycles per ePWM count:
+                                    // EPWMCLK is SYSCLK / 2, TBCTL
+                                    // prescalers 1
+#define STREAM_BLOCK_SIZE   (RESULTS_BUFFER_SIZE / 2)   // DMA ping-pong half
+#define STREAM_OUT_LEN      128     // Decimated samples per frame and channel
+#define STREAM_NONE         0xFFFF  // No half filled yet
+#define CMD_PORT            SCI_PORT_B  // Command channel at startup
+#define SCI_STATUS_MS_MAX   10000   // Longest status frame period, well
+                                    // inside the cycle counter wrap
 
 //
 // Globals
 //
 #pragma DATA_SECTION(adcData0, "ramgs0");
 #pragma DATA_SECTION(adcData1, "ramgs0");
+#pragma DATA_SECTION(adcData1Aligned, "ramgs1");
 Uint16 adcData0[RESULTS_BUFFER_SIZE];
 Uint16 adcData1[RESULTS_BUFFER_SIZE];
-volatile Uint16 done;
+Uint16 adcData1Aligned[RESULTS_BUFFER_SIZE];
+volatile Uint16 skewCalMode = 0;
+Uint16 adcResolution;
+Uint16 adcSignalMode;
+Uint16 adcChannel;
+Uint16 adcBits;                     // Width of a sample, 12 or 16
+Uint16 adcFullScale;                // Largest code
+ADC_SKEW_RESULT adcSkew;
+const Uint16 benchMode[ADC_BENCH_CAPTURES][3] =
+{
+    {ADC_RESOLUTION_12BIT, ADC_SIGNALMODE_SINGLE, ADC_CHANNEL_DEFAULT},
+    {ADC_RESOLUTION_16BIT, ADC_SIGNALMODE_DIFFERENTIAL,
+     ADC_CHANNEL_DEFAULT & ~1U},
+};
+Uint16 benchRunning;                // ADC BENCH has not replied yet
+Uint16 benchStep;                   // Its capture running, or
+                                    // ADC_BENCH_CAPTURES once all are in
+Uint32 benchCycles[ADC_BENCH_CAPTURES]; // SYSCLK cycles per sample x100,
+                                    // 0 if the capture timed out
+Uint16 benchResolution;             // Mode to restore afterwards
+Uint16 benchSignalMode;
+Uint16 benchChannel;
 volatile Uint16 cnt = 0;
-char buff[32];
+char buff[128];
+Uint16 capturing;
+Uint16 captureRequest;
+Uint16 sending;
+Uint16 outputMode = OUTPUT_CSV;
+Uint16 riceChannel;
+volatile Uint32 captureStartTime;
+volatile Uint32 captureEndTime;
 
+//
+// Encoder statistics since the last STAT command
+//
+struct
+{
+    Uint32 samples;
+    Uint32 rawBits;
+    Uint32 bytes;
+    Uint32 cycles;
+} riceStats;
+
+//
+// Streaming state. The DMA halves are 0 and 1; the decimated output is
+// collected in one slot of decimOut while the other slot is being sent.
+//
+Uint16 streaming;
+Uint16 streamNext[2];               // Half each DMA channel fills next
+volatile Uint16 streamFill;         // Half the DMA is filling
+volatile Uint32 streamBlocks;
+volatile Uint16 streamOverruns;
+Uint16 streamDropped;
+Uint32 streamStartTime;
+Uint32 decimCycles;
+DECIM_STATE decimState[2];
+#pragma DATA_SECTION(decimOut, "ramgs4");
+Uint16 decimOut[2][2][STREAM_OUT_LEN];  // [slot][channel][sample]
+Uint16 decimOutCount;
+Uint16 decimFillSlot;
+Uint16 decimSendSlot;
+Uint16 decimPending;
+Uint32 spiStatTime;                 // Start of the SPI statistics
+Uint32 mcbspStatTime;               // Start of the McBSP statistics
+
+const CMD_ENTRY cmdTable[] =
+{
+    {"CAP",  CaptureCommand},
+    {"SKEW", SkewCommand},
+    {"CAL",  AdcCal_Command},
+    {"MODE", ModeCommand},
+    {"STAT", StatCommand},
+    {"DEC",  DecimCommand},
+    {"ADC",  AdcCommand},
+    {"SCI",  SciCommand},
+    {"SPI",  SpiCommand},
+    {"MCB",  McbspCommand},
+    {"LINK", LinkCommand},
+    {"LOG",  LogCommand},
+    {"ARQ",  ArqCommand},
+    {"MEM",  MemCommand},
+    {"SCHED", SchedCommand},
+    {"FAULT", FaultCommand},
+    {"ISR",  IsrCommand},
+    {"LOAD", LoadCommand},
+    {"NEST", NestCommand},
+    {"WORK", WorkCommand},
+    {"HOT",  HotCommand},
+    {"FLASH", FlashCommand},
+    {"BOOT", BootCommand},
+    {"TIMER", TimerCommand},
+};
+
+//
+// Telemetry streams, see sched.c. Status frames are small and rare and
+// logs must not back up; the bulk data shares the rest.
+//
+const SCHED_STREAM schedTable[] =
+{
+    {"STATUS", 0, 1, SciStatusReady,    SciStatusFrame},
+    {"LOG",    1, 1, Log_Ready,         Log_Poll},
+    {"CAP",    2, 4, CaptureFrameReady, SendCaptureFrame},
+    {"DEC",    2, 4, StreamFrameReady,  SendStreamFrame},
+    {"MEM",    2, 2, Mem_Ready,         Mem_Poll},
+};
 
-char Txbuff[BUFFMAX];
-int Tx_r_idx;
-int Tx_w_idx;
-char Rxbuff[BUFFMAX];
-int Rx_r_idx;
-int Rx_w_idx;
+//
+// The PIE vector map, written once by Fault_Init(); every vector not in it
+// goes to the fault-recording default handler. The modules only enable
+// their interrupts. The CTS handlers are in place whether flow control is
+// on or not: their XINTs stay off without it.
+//
+const FAULT_VECTOR pieVectors[] =
+{
+    {FAULT_PIE(1, 1),  &adca1_isr},
+    {FAULT_PIE(1, 4),  &sciaCtsIsr},    // XINT1..4
+    {FAULT_PIE(1, 5),  &scibCtsIsr},
+    {FAULT_PIE(1, 7),  &timerIsr},      // CPU Timer 0
+    {FAULT_PIE(12, 1), &scicCtsIsr},
+    {FAULT_PIE(12, 2), &scidCtsIsr},
+    {FAULT_PIE(7, 1),  &dmach1_isr},
+    {FAULT_PIE(7, 2),  &dmach2_isr},
+    {FAULT_PIE(7, 3),  &mcbspDmaIsr},
+    {FAULT_PIE(7, 5),  &spiDmaIsr},
+    {FAULT_PIE(9, 1),  &sciaRxIsr},
+    {FAULT_PIE(9, 2),  &sciaTxIsr},
+    {FAULT_PIE(9, 3),  &scibRxIsr},
+    {FAULT_PIE(9, 4),  &scibTxIsr},
+    {FAULT_PIE(8, 5),  &scicRxIsr},
+    {FAULT_PIE(8, 6),  &scicTxIsr},
+    {FAULT_PIE(8, 7),  &scidRxIsr},
+    {FAULT_PIE(8, 8),  &scidTxIsr},
+    {FAULT_CPU(14),    &loadTickIsr},   // Timer 2
+};
+
+//
+// Interrupt priorities, see nest.c. The acquisition comes first: a DMA
+// half must be re-armed before the next one fills, whatever the links
+// are doing. The CTS edges only turn an interrupt back on and share
+// group 1 with the ADC, so they rank with it; adca1_isr turns its own
+// PIEIER bit off and does not nest. CPU Timer 0 is wired to group 1 too
+// and ranks with them for the same reason: a lower vector there would
+// keep the whole group from preempting anything. timerIsr only queues
+// the handlers that are due and re-arms. The SCI receivers outrank the
+// transmitters, whose refills can wait for the FIFO margin.
+//
+const NEST_VECTOR nestTable[] =
+{
+    {NEST_PIE(1, 1),  0},           // ADCA1
+    {NEST_PIE(1, 4),  0},           // XINT1, XINT2: CTS of SCI-A and B
+    {NEST_PIE(1, 5),  0},
+    {NEST_PIE(12, 1), 0},           // XINT3, XINT4: CTS of SCI-C and D
+    {NEST_PIE(12, 2), 0},
+    {NEST_PIE(7, 1),  0},           // DMA CH1, CH2: ADC data
+    {NEST_PIE(7, 2),  0},
+    {NEST_PIE(7, 3),  1},           // DMA CH3: McBSP link
+    {NEST_PIE(7, 5),  1},           // DMA CH5: SPI link
+    {NEST_PIE(9, 1),  2},           // SCI-A, SCI-B RX
+    {NEST_PIE(9, 3),  2},
+    {NEST_PIE(8, 5),  2},           // SCI-C, SCI-D RX
+    {NEST_PIE(8, 7),  2},
+    {NEST_PIE(9, 2),  3},           // SCI-A, SCI-B TX
+    {NEST_PIE(9, 4),  3},
+    {NEST_PIE(8, 6),  3},           // SCI-C, SCI-D TX
+    {NEST_PIE(8, 8),  3},
+    {NEST_PIE(1, 7),  0},           // Timer 0: soft timers, see timer.c
+    {NEST_CPU(14),    4},           // Timer 2: load.c wake-up tick
+};
+
+
+Uint16 cmdPort = CMD_PORT;
+Uint16 loopPorts;                   // Ports echoing for the loopback rig
+Uint16 sciStatusOn;                 // Status frames due (SCI STATUS)
+Uint32 sciStatusPeriod;             // Cycles between them, 0 for one only
+Uint32 sciStatusTime;               // Last one framed
 
 void main(void)
 {
-    Uint16 resultsIndex;
-    Uint16 i;
-
-    Tx_r_idx = 0;
-    Tx_w_idx = 0;
-    Rx_r_idx = 0;
-    Rx_w_idx = 0;
+    Uint16 port;
+    Uint16 busy;
 
+//
+// Time the boot phases, see boot.c
+//
+    Boot_Start();
 
 //
 // Step 1. Initialize System Control:
@@ -118,6 +476,13 @@ void main(void)
 // This example function is found in the F2837xS_SysCtrl.c file.
 //
     InitSysCtrl();
+    Timebase_Init();
+    Boot_Sync();
+    Flash_Init();
+    Boot_Mark(BOOT_FLASH);
+    Hot_Init();
+    Timer_Init();
+    Boot_Mark(BOOT_HOT);
 
 //
 // Step 2. Initialize GPIO:
@@ -125,14 +490,16 @@ void main(void)
 // illustrates how to set the GPIO to it's default state.
 //
     InitGpio();
+    Boot_Mark(BOOT_GPIO);
+
+#ifdef BOOT_FAST
+//
+// The ADCs power up while the rest is set up
+//
+    SetupSampling();
+    Boot_Mark(BOOT_ADC);
+#endif
 
-    // For this example, only init the pins for the SCI-B port.
-    EALLOW;
-    GpioCtrlRegs.GPCMUX2.bit.GPIO86 = 1;
-    GpioCtrlRegs.GPCMUX2.bit.GPIO87 = 1;
-    GpioCtrlRegs.GPCGMUX2.bit.GPIO86 = 1;
-    GpioCtrlRegs.GPCGMUX2.bit.GPIO87 = 1;
-    EDIS;
 //
 // Step 3. Clear all interrupts and initialize PIE vector table:
 // Disable CPU interrupts
@@ -154,32 +521,38 @@ void main(void)
     IFR = 0x0000;
 
 //
-// Initialize the PIE vector table with pointers to the shell Interrupt
-// Service Routines (ISR).
-// This will populate the entire table, even if the interrupt
-// is not used in this example.  This is useful for debug purposes.
-// The shell ISR routines are found in F2837xS_DefaultIsr.c.
-// This function is found in F2837xS_PieVect.c.
+// Write the PIE vector table from pieVectors, the fault-recording default
+// handler (fault.c) everywhere else. An interrupt without a handler of its
+// own is counted and recorded, then resumed with its PIE channel turned
+// off.
 //
-    InitPieVectTable();
+    Fault_Init(FAULT_RESUME, pieVectors,
+               sizeof(pieVectors) / sizeof(pieVectors[0]));
+    Boot_Mark(BOOT_VECTORS);
 
 //
-// Set up ISRs used by this example
-//
-// ISR for ADCA INT1 - occurs after first conversion
-// ISR for DMA ch1 - occurs when DMA transfer is complete
+// All four SCI ports with their pins and interrupts. Commands and, until
+// SCI DATA says otherwise, the telemetry use SCI-B.
 //
-    EALLOW;
-    PieVectTable.ADCA1_INT = &adca1_isr;
-    PieVectTable.DMA_CH1_INT = &dmach1_isr;
-    PieVectTable.SCIB_RX_INT = &scibRxFifoIsr;
-    PieVectTable.SCIB_TX_INT = &scibTxFifoIsr;
-    EDIS;
-
-    scib_fifo_init();  // Init SCI-B
-
-    // Step 5. User specific code, enable interrupts:
-    DELAY_US(3000000); // 3SEC wait
+    for(port = 0; port < SCI_PORTS; port++)
+    {
+        Sci_Init(port, SCI_BAUD_DEFAULT);
+    }
+    Cmd_Init(cmdTable, sizeof(cmdTable) / sizeof(cmdTable[0]), RxGet, TxWrite);
+    Tlm_Init(1U << CMD_PORT);
+    Sched_Init(schedTable, sizeof(schedTable) / sizeof(schedTable[0]));
+    Spi_Init();
+    Mcbsp_Init();
+    Log_Init();
+    Arq_Init();
+    Mem_Init();
+    Work_Init();
+    IsrProf_Init();
+    Load_Init();
+    Nest_Init(nestTable, sizeof(nestTable) / sizeof(nestTable[0]));
+    AdcSkew_Init();
+    memset(&adcSkew, 0, sizeof(adcSkew));   // No skew result yet
+    Boot_Mark(BOOT_DRIVERS);
 
 //
 // Enable specific CPU interrupts: INT1 for ADCs and INT7 for DMA
@@ -191,17 +564,146 @@ void main(void)
 // Enable specific PIE interrupts
 //
 // ADCA INT1 - Group 1, interrupt 1
+// CPU Timer 0 - Group 1, interrupt 7
 // DMA interrupt - Group 7, interrupt 1
 //
     PieCtrlRegs.PIEIER1.bit.INTx1 = 1;
+    PieCtrlRegs.PIEIER1.bit.INTx7 = 1;
     PieCtrlRegs.PIEIER7.bit.INTx1 = 1;
 
     // Enable interrupts required for this example
     PieCtrlRegs.PIECTRL.bit.ENPIE = 1;   // Enable the PIE block
-    PieCtrlRegs.PIEIER9.bit.INTx3=1;     // PIE Group 9, INT3 SCIB_RX
-    PieCtrlRegs.PIEIER9.bit.INTx4=0;     // PIE Group 9, INT4 SCIB_TX
-    IER |= 0x100; // Enable CPU INT
+
+#ifndef BOOT_FAST
+    SetupSampling();
+    Boot_Mark(BOOT_ADC);
+#endif
+
+//
+// Initialize the DMA. The reset of the whole controller is done once here,
+// later reconfigurations of CH1/CH2 leave the SPI and McBSP channels
+// running.
+//
+    DMAInitialize();
+    DMAInit(0);
+    spiStatTime = Timebase_Now();
+    mcbspStatTime = spiStatTime;
+
+//
+// Enable global Interrupts and higher priority real-time debug events:
+//
+    EINT;  // Enable Global interrupt INTM
+    ERTM;  // Enable Global realtime interrupt DBGM
+
+#ifndef BOOT_FAST
+//
+// Initialize results buffer
+//
+    memset(adcData0, 0, sizeof(adcData0));
+    memset(adcData1, 0, sizeof(adcData1));
+#endif
+    Boot_Mark(BOOT_DMA);
+
+//
+// Take the first capture and send it, once the ADCs are powered up and,
+// but with BOOT_FAST, a settling time has passed (SettleDone()). Commands
+// are served meanwhile. Each command that needs data starts a new capture
+// once the previous one is sent.
+//
+    capturing = 0;
+    sending = 0;
+#ifdef BOOT_FAST
+    captureRequest = 1;
+#else
+    captureRequest = 0;
+    Timer_Start(TIMER_SETTLE, SETTLE_US, 0, SettleDone, 0);
+#endif
+
+    for(;;)
+    {
+        //
+        // busy is set by whatever leaves work for the next pass that no
+        // interrupt will announce; without it the loop sleeps (load.c)
+        //
+        busy = 0;
+
+        //
+        // Replies must not land inside a binary frame on the command port;
+        // frames on the other ports do not hold them up. The data of a MEM
+        // WR is taken at once, its reply waits like the others.
+        //
+        if(Mem_Writing() != 0)
+        {
+            Mem_Receive(RxGet);
+            busy = 1;
+        }
+        else if(Tlm_BusyOn(cmdPort) == 0)
+        {
+            MemWriteReply();
+            BenchReply();
+            busy = Cmd_Poll();
+        }
+
+        //
+        // Finished captures and stream blocks, see CaptureDone() and
+        // ProcessStreamBlock()
+        //
+        busy |= Work_Dispatch();
+
+        if(streaming != 0)
+        {
+            SendStreamStep();
+        }
+
+        if((capturing == 0) && (sending == 0) && (streaming == 0) &&
+           (Timer_Running(TIMER_ADC_POWER) == 0) &&
+           ((captureRequest != 0) || AdcCal_Pending()))
+        {
+            captureRequest = 0;
+            StartCapture();
+            capturing = 1;
+        }
+
+        if(sending != 0)
+        {
+            sending = SendCaptureStep();
+        }
+
+        //
+        // Frames wait while the capture goes out as text
+        //
+        if((sending == 0) || (outputMode != OUTPUT_CSV))
+        {
+            busy |= Sched_Poll();
+        }
+
+        Arq_Poll();
+        busy |= Arq_RxReady();
+
+        for(port = 0; port < SCI_PORTS; port++)
+        {
+            if(loopPorts & (1U << port))
+            {
+                Sci_Echo(port);
+            }
+        }
+
+        Load_Poll();
+        if(busy == 0)
+        {
+            Load_Idle();
+        }
+    }
+}
 
+//
+// SetupSampling - Set up ePWM 2 to trigger the conversions and both ADCs
+//                 for continuous conversions on channels A3 and B3, and
+//                 power them up. The first capture waits for the power-up
+//                 time in the background loop.
+//
+void SetupSampling(void)
+{
 //
 // Stop the ePWM clock
 //
@@ -215,257 +717,2226 @@ void main(void)
     ConfigureEPWM();
 
 //
-// Start the ePWM clock
+// Start the ePWM clock
+//
+    EALLOW;
+    CpuSysRegs.PCLKCR0.bit.TBCLKSYNC = 1;
+    EDIS;
+
+//
+// Configure the ADC, power it up and set it up for continuous conversions
+// on channels A3 and B3
+//
+    SetAdcMode(ADC_RESOLUTION_12BIT, ADC_SIGNALMODE_SINGLE,
+               ADC_CHANNEL_DEFAULT);
+}
+
+//
+// AdcPowerWait - Wait for what is left of the ADC power-up time since
+//                ConfigureADC(), nothing once it is over. The background
+//                loop does not start a capture before then; the commands
+//                that convert at once wait here.
+//
+void AdcPowerWait(void)
+{
+    while(Timer_Running(TIMER_ADC_POWER) != 0)
+    {
+    }
+}
+
+//
+// SettleDone - Timer handler: the wait before the first capture is over
+//
+void SettleDone(Uint16 arg)
+{
+    Boot_Mark(BOOT_SETTLE);
+    captureRequest = 1;
+}
+
+//
+// StartConversions - Start the configured DMA channels and restart
+//                    continuous conversions at the next ePWM event
+//
+void StartConversions(void)
+{
+    AdcPowerWait();
+
+    //
+    // Clearing all pending interrupt flags
+    //
+    EALLOW;
+
+    DmaRegs.CH1.CONTROL.bit.PERINTCLR = 1;
+    DmaRegs.CH2.CONTROL.bit.PERINTCLR = 1;
+    AdcaRegs.ADCINTFLGCLR.all = 0x3;
+    AdcbRegs.ADCINTFLGCLR.all = 0x3;
+    EPwm2Regs.ETCNTINITCTL.bit.SOCAINITFRC = 1;
+    EPwm2Regs.ETCLR.bit.SOCA = 1;
+
+    //
+    // Enable continuous operation by setting the last SOC to re-trigger the
+    // first
+    //
+    AdcaRegs.ADCINTSOCSEL1.bit.SOC0 = 2;
+    AdcbRegs.ADCINTSOCSEL1.bit.SOC0 = 2;
+
+    EDIS;
+
+    //
+    // Start DMA. The channels reload their addresses from the shadow
+    // registers, so every capture starts at the beginning of the buffers.
+    //
+    StartDMACH1();
+    StartDMACH2();
+
+    //
+    // Finally, enable the SOCA trigger from ePWM. This will kick off
+    // conversions at the next ePWM event.
+    //
+    PieCtrlRegs.PIEIER1.bit.INTx1 = 1;
+    EPwm2Regs.ETSEL.bit.SOCAEN = 1;
+}
+
+//
+// StartCapture - Arm the DMA and restart continuous conversions for one
+//                capture of RESULTS_BUFFER_SIZE samples per channel.
+//                dmach1_isr queues CaptureDone() when the buffers are full.
+//
+void StartCapture(void)
+{
+    Work_Flush(WORK_DMA_CH1);
+    StartConversions();
+}
+
+//
+// CaptureDone - Work queued by dmach1_isr at the end of a capture: time it
+//               for ADC BENCH, hand it to the board calibration or correct
+//               it for sending
+//
+void CaptureDone(Uint16 arg)
+{
+    if(capturing == 0)
+    {
+        return;
+    }
+    capturing = 0;
+    if(benchRunning != 0)
+    {
+        Timer_Stop(TIMER_BENCH);
+        BenchDone((captureEndTime - captureStartTime) * 100UL /
+                  (RESULTS_BUFFER_SIZE - 1));
+    }
+    else if(AdcCal_Pending())
+    {
+        AdcCal_Capture(adcData0, adcData1, RESULTS_BUFFER_SIZE);
+    }
+    else
+    {
+        ProcessCapture();
+        sending = 1;
+    }
+}
+
+//
+// BenchStart - Switch to the mode of capture benchStep of ADC BENCH and
+//              start it, with TIMER_BENCH as its deadline
+//
+void BenchStart(void)
+{
+    SetAdcMode(benchMode[benchStep][0], benchMode[benchStep][1],
+               benchMode[benchStep][2]);
+    StartCapture();
+    capturing = 1;
+    Timer_Start(TIMER_BENCH, ADC_BENCH_TIMEOUT_US, 0, BenchTimeout, 0);
+}
+
+//
+// BenchDone - Keep the result of the ADC BENCH capture that ended and
+//             start the next one; after the last, restore the mode and
+//             leave the report to BenchReply()
+//
+void BenchDone(Uint32 cycles)
+{
+    benchCycles[benchStep] = cycles;
+    if(++benchStep < ADC_BENCH_CAPTURES)
+    {
+        BenchStart();
+        return;
+    }
+    SetAdcMode(benchResolution, benchSignalMode, benchChannel);
+}
+
+//
+// BenchTimeout - Timer handler: the ADC BENCH capture did not end in
+//                ADC_BENCH_TIMEOUT_US. A late CaptureDone() is dropped by
+//                the next StartCapture() or, after the last, finds
+//                capturing clear.
+//
+void BenchTimeout(Uint16 arg)
+{
+    if((benchRunning == 0) || (capturing == 0))
+    {
+        return;
+    }
+    capturing = 0;
+    BenchDone(0);
+}
+
+//
+// BenchReply - Report the ADC BENCH results, once all are in
+//
+void BenchReply(void)
+{
+    Uint16 i;
+    Uint32 cycles;
+
+    if((benchRunning == 0) || (benchStep < ADC_BENCH_CAPTURES))
+    {
+        return;
+    }
+    for(i = 0; i < ADC_BENCH_CAPTURES; i++)
+    {
+        cycles = benchCycles[i];
+        sprintf(buff, "BENCH %u %c %lu %lu\n",
+                (benchMode[i][0] == ADC_RESOLUTION_16BIT) ? 16 : 12,
+                (benchMode[i][1] == ADC_SIGNALMODE_DIFFERENTIAL) ? 'D' : 'S',
+                (cycles != 0) ?
+                    (unsigned long)((float32)TIMEBASE_HZ * 100.0f /
+                                    (float32)cycles) : 0UL,
+                (unsigned long)cycles);
+        Cmd_Reply(buff);
+    }
+    benchRunning = 0;
+    Cmd_Reply("OK\n");
+}
+
+//
+// ProcessCapture - Apply the board calibration and the skew correction to
+//                  a finished capture and queue the skew report if a skew
+//                  calibration was requested
+//
+void ProcessCapture(void)
+{
+    AdcCal_Apply(ADC_CAL_CH_A, adcData0, RESULTS_BUFFER_SIZE);
+    AdcCal_Apply(ADC_CAL_CH_B, adcData1, RESULTS_BUFFER_SIZE);
+
+    //
+    // Measure the ADCA/ADCB skew on this capture if requested, then bring
+    // ADCB onto the ADCA sample instants with the stored result
+    //
+    if(skewCalMode != 0)
+    {
+        skewCalMode = 0;
+        AdcSkew_Reset();
+        AdcSkew_ProcessBlock(adcData0, adcData1, RESULTS_BUFFER_SIZE);
+        AdcSkew_Finish(&adcSkew);
+
+        sprintf(buff, "SKEW,%ld,%ld,%ld\n",
+                (long)(adcSkew.skew * 1000.0f),
+                (long)(adcSkew.drift * 1000000.0f),
+                (long)(adcSkew.residual * 1000.0f));
+        TxWrite(buff);
+        LOG3(LOG_SKEW_RESULT, "skew %f, drift %e, residual %f",
+             LOG_FLOAT(adcSkew.skew), LOG_FLOAT(adcSkew.drift),
+             LOG_FLOAT(adcSkew.residual));
+    }
+    AdcSkew_Correct(adcData1, adcData1Aligned, RESULTS_BUFFER_SIZE,
+                    &adcSkew, 0, adcFullScale);
+
+    cnt = 0;
+    riceChannel = 0;
+}
+
+//
+// SendCaptureStep - Queue as many "index,value" lines of the processed
+//                   capture as the TX ring takes, once a frame in flight on
+//                   the text port is out of the way. Returns 0 once every
+//                   line has been queued.
+//
+Uint16 SendCaptureStep(void)
+{
+    Uint16 port;
+    Uint16 room;
+    Uint16 len;
+    Uint16 lines;
+    char *span;
+
+    if(outputMode == OUTPUT_RICE)
+    {
+        return SendRiceStep();
+    }
+    if((outputMode == OUTPUT_SPI) || (outputMode == OUTPUT_MCBSP))
+    {
+        return SendRawStep();
+    }
+
+    port = TxPort();
+    if(Tlm_BusyOn(port) != 0)
+    {
+        Tlm_SendStep();
+        return 1;
+    }
+    span = buff;
+
+    //
+    // The lines are formatted straight into the ring. Where it wraps, or
+    // on an ARQ port, they go through buff.
+    //
+    while(cnt < RESULTS_BUFFER_SIZE)
+    {
+        room = (port == Arq_Port()) ? 0 : Sci_TxSpan(port, &span);
+        len = Fmt_CsvLines(span, room, cnt, &adcData1Aligned[cnt],
+                           RESULTS_BUFFER_SIZE - cnt, &lines);
+        if(lines != 0)
+        {
+            Sci_TxCommit(port, len);
+        }
+        else
+        {
+            room = (port == Arq_Port()) ? Arq_Space() : Sci_TxSpace(port);
+            len = Fmt_CsvLines(buff, (room < sizeof(buff)) ? room :
+                               sizeof(buff), cnt, &adcData1Aligned[cnt],
+                               RESULTS_BUFFER_SIZE - cnt, &lines);
+            if((lines == 0) || (TxPut(buff, len) == 0))
+            {
+                break;
+            }
+        }
+        cnt += lines;
+    }
+
+    return cnt < RESULTS_BUFFER_SIZE;
+}
+
+//
+// SendRiceStep - Returns 0 once the CAP stream has framed both channels;
+//                the frames are coded as the scheduler asks for them
+//
+Uint16 SendRiceStep(void)
+{
+    return riceChannel < 2;
+}
+
+//
+// CaptureFrameReady - Nonzero while a Rice coded capture has a block left
+//                     to frame
+//
+Uint16 CaptureFrameReady(void)
+{
+    return (sending != 0) && (outputMode == OUTPUT_RICE) &&
+           (riceChannel < 2);
+}
+
+//
+// SendCaptureFrame - Rice code the next CAP_BLOCK_SIZE samples of ADCA, or
+//                    then of the re-aligned ADCB, into a frame and queue
+//                    it. The CAP stream of the scheduler.
+//
+void SendCaptureFrame(void)
+{
+    const Uint16 *data;
+
+    data = (riceChannel == 0) ? adcData0 : adcData1Aligned;
+    QueueRiceFrame(riceChannel, &data[cnt], CAP_BLOCK_SIZE, adcBits);
+    cnt += CAP_BLOCK_SIZE;
+    if(cnt >= RESULTS_BUFFER_SIZE)
+    {
+        cnt = 0;
+        riceChannel++;
+    }
+}
+
+//
+// SendRawStep - Hand ADCA and then the re-aligned ADCB to the SPI or McBSP
+//               link in blocks of RAW_BLOCK_SIZE, one whenever the link has
+//               taken the previous one. Returns 0 once every block has been
+//               handed over.
+//
+Uint16 SendRawStep(void)
+{
+    const Uint16 *data;
+
+    if(riceChannel >= 2)
+    {
+        return 0;
+    }
+
+    data = (riceChannel == 0) ? adcData0 : adcData1Aligned;
+    if(SendRawBlock(riceChannel, adcBits, &data[cnt], RAW_BLOCK_SIZE) != 0)
+    {
+        cnt += RAW_BLOCK_SIZE;
+        if(cnt >= RESULTS_BUFFER_SIZE)
+        {
+            cnt = 0;
+            riceChannel++;
+        }
+    }
+    return 1;
+}
+
+//
+// SendRawBlock - Start a raw frame on the DMA fed link of the output mode.
+//                Returns 0 while the link is still busy.
+//
+Uint16 SendRawBlock(Uint16 ch, Uint16 bits, const Uint16 *data,
+                    Uint16 count)
+{
+    if(outputMode == OUTPUT_MCBSP)
+    {
+        return Mcbsp_SendBlock(ch, bits, data, count);
+    }
+    return Spi_SendBlock(ch, bits, data, count);
+}
+
+//
+// QueueRiceFrame - Rice code one block of a channel into a telemetry frame
+//                  and queue it. Only valid while Tlm_Busy() is 0.
+//
+void QueueRiceFrame(Uint16 ch, const Uint16 *data, Uint16 len, Uint16 bits)
+{
+    Uint16 *payload;
+    Uint16 codeLen;
+    Uint32 start;
+
+    payload = Tlm_Begin(TLM_TYPE_RICE);
+    payload[0] = ch;
+    payload[1] = bits;
+    payload[2] = len & 0xFF;
+    payload[3] = len >> 8;
+
+    start = Timebase_Now();
+    codeLen = Rice_Encode(data, len, bits, &payload[TLM_RICE_HEADER_LEN]);
+    riceStats.cycles += Timebase_Now() - start;
+    riceStats.samples += len;
+    riceStats.rawBits += (Uint32)len * bits;
+    riceStats.bytes += codeLen;
+
+    Tlm_Commit(TLM_RICE_HEADER_LEN + codeLen);
+}
+
+//
+// StartStream - Switch the DMA to continuous ping-pong transfers and start
+//               converting without a break. The decimator must have been
+//               configured.
+//
+void StartStream(void)
+{
+    Decim_Reset(&decimState[0]);
+    Decim_Reset(&decimState[1]);
+    decimOutCount = 0;
+    decimFillSlot = 0;
+    decimPending = 0;
+    decimCycles = 0;
+
+    streamNext[0] = 0;
+    streamNext[1] = 0;
+    streamFill = STREAM_NONE;
+    Work_Flush(WORK_DMA_CH2);
+    streamBlocks = 0;
+    streamOverruns = 0;
+    streamDropped = 0;
+    streaming = 1;
+    LOG2(LOG_STREAM_START, "stream start, ratio %u, %u bits",
+         Decim_Ratio(), adcBits);
+
+    DMAInit(1);
+    PieCtrlRegs.PIEIER7.bit.INTx2 = 1;
+    streamStartTime = Timebase_Now();
+    StartConversions();
+}
+
+//
+// StopStream - Stop the conversions and return the DMA to single captures
+//
+void StopStream(void)
+{
+    EALLOW;
+    AdcaRegs.ADCINTSOCSEL1.bit.SOC0 = 0;
+    AdcbRegs.ADCINTSOCSEL1.bit.SOC0 = 0;
+    EDIS;
+
+    //
+    // Let the SOCs already triggered finish before the DMA is reset
+    //
+    DELAY_US(10);
+
+    PieCtrlRegs.PIEIER7.bit.INTx2 = 0;
+    streaming = 0;
+    DMAInit(0);
+    LOG3(LOG_STREAM_STOP, "stream stop after %lu blocks, %u overruns, "
+         "%u dropped", streamBlocks, streamOverruns, streamDropped);
+}
+
+//
+// ProcessStreamBlock - Work queued by dmach2_isr: decimate the finished
+//                      DMA half of both channels. A half with a newer one
+//                      queued behind it is being refilled and is skipped
+//                      (an overrun). Each full output slot is handed to
+//                      SendStreamStep(); if that is still sending the other
+//                      slot, the new one is dropped and refilled.
+//
+void ProcessStreamBlock(Uint16 half)
+{
+    Uint16 offset;
+    Uint16 n;
+    Uint32 start;
+
+    if((streaming == 0) || (Work_Pending(WORK_DMA_CH2) > 1))
+    {
+        return;
+    }
+
+    start = Timebase_Now();
+    offset = half * STREAM_BLOCK_SIZE;
+
+    //
+    // STREAM_BLOCK_SIZE is a multiple of every ratio, so both channels
+    // produce the same whole number of outputs per block and the slot
+    // fills exactly
+    //
+    n = Decim_Process(&decimState[0], &adcData0[offset], STREAM_BLOCK_SIZE,
+                      &decimOut[decimFillSlot][0][decimOutCount]);
+    Decim_Process(&decimState[1], &adcData1[offset], STREAM_BLOCK_SIZE,
+                  &decimOut[decimFillSlot][1][decimOutCount]);
+    decimOutCount += n;
+
+    decimCycles += Timebase_Now() - start;
+
+    if(decimOutCount >= STREAM_OUT_LEN)
+    {
+        decimOutCount = 0;
+        if(decimPending == 0)
+        {
+            decimSendSlot = decimFillSlot;
+            decimFillSlot ^= 1;
+            riceChannel = 0;
+            decimPending = 1;
+        }
+        else
+        {
+            streamDropped++;
+            LOG1(LOG_STREAM_DROP, "stream slot dropped at block %lu",
+                 streamBlocks);
+        }
+    }
+}
+
+//
+// SendStreamStep - Hand a full output slot to the SPI or McBSP link, one
+//                  channel at a time. On the SCI ports the DEC stream of
+//                  the scheduler frames it.
+//
+void SendStreamStep(void)
+{
+    if((decimPending != 0) &&
+       ((outputMode == OUTPUT_SPI) || (outputMode == OUTPUT_MCBSP)))
+    {
+        if(riceChannel >= 2)
+        {
+            decimPending = 0;
+        }
+        else if(SendRawBlock(riceChannel, DECIM_OUT_BITS,
+                             decimOut[decimSendSlot][riceChannel],
+                             STREAM_OUT_LEN) != 0)
+        {
+            riceChannel++;
+        }
+    }
+}
+
+//
+// StreamFrameReady - Nonzero while a full output slot has a channel left
+//                    to frame for the SCI ports
+//
+Uint16 StreamFrameReady(void)
+{
+    return (streaming != 0) && (decimPending != 0) &&
+           (outputMode != OUTPUT_SPI) && (outputMode != OUTPUT_MCBSP);
+}
+
+//
+// SendStreamFrame - Rice code the next channel of the output slot into a
+//                   frame and queue it; the slot is free once both are.
+//                   The DEC stream of the scheduler.
+//
+void SendStreamFrame(void)
+{
+    QueueRiceFrame(riceChannel, decimOut[decimSendSlot][riceChannel],
+                   STREAM_OUT_LEN, DECIM_OUT_BITS);
+    if(++riceChannel >= 2)
+    {
+        decimPending = 0;
+    }
+}
+
+//
+// CaptureCommand - CAP: take and send a new capture
+//
+void CaptureCommand(int argc, char *argv[])
+{
+    captureRequest = 1;
+    Cmd_Reply("OK\n");
+}
+
+//
+// SkewCommand - SKEW: take a capture and measure the ADCA/ADCB skew on it
+//
+void SkewCommand(int argc, char *argv[])
+{
+    skewCalMode = 1;
+    captureRequest = 1;
+    Cmd_Reply("OK\n");
+}
+
+//
+// ModeCommand - MODE CSV|RICE|SPI|MCB: select the format and link captures
+//               are sent in
+//
+void ModeCommand(int argc, char *argv[])
+{
+    if((argc == 2) && (strcmp(argv[1], "CSV") == 0))
+    {
+        outputMode = OUTPUT_CSV;
+    }
+    else if((argc == 2) && (strcmp(argv[1], "RICE") == 0))
+    {
+        outputMode = OUTPUT_RICE;
+    }
+    else if((argc == 2) && (strcmp(argv[1], "SPI") == 0))
+    {
+        outputMode = OUTPUT_SPI;
+    }
+    else if((argc == 2) && (strcmp(argv[1], "MCB") == 0))
+    {
+        outputMode = OUTPUT_MCBSP;
+    }
+    else
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+    Cmd_Reply("OK\n");
+}
+
+//
+// StatCommand - STAT: report "STAT <ratio> <encode> <period> <load>" for
+//               the Rice frames sent since the last STAT:
+//               ratio  - raw size / coded size, x100
+//               encode - encoder cycles per sample, x100
+//               period - SYSCLK cycles per sample of the last capture, x100
+//               load   - % of the sample period spent coding both channels;
+//                        below 100 the encoder keeps up with the ADCs
+//
+void StatCommand(int argc, char *argv[])
+{
+    float32 ratio = 0.0f;
+    float32 encode = 0.0f;
+    float32 period;
+    float32 load = 0.0f;
+
+    period = (float32)(captureEndTime - captureStartTime) /
+             (float32)(RESULTS_BUFFER_SIZE - 1);
+    if(riceStats.bytes != 0)
+    {
+        ratio = (float32)riceStats.rawBits / (8.0f * (float32)riceStats.bytes);
+        encode = (float32)riceStats.cycles / (float32)riceStats.samples;
+    }
+    if(period > 0.0f)
+    {
+        load = 2.0f * encode * 100.0f / period;
+    }
+
+    sprintf(buff, "STAT %ld %ld %ld %ld\n", (long)(ratio * 100.0f),
+            (long)(encode * 100.0f), (long)(period * 100.0f), (long)load);
+    Cmd_Reply(buff);
+
+    riceStats.samples = 0;
+    riceStats.rawBits = 0;
+    riceStats.bytes = 0;
+    riceStats.cycles = 0;
+}
+
+//
+// DecimCommand - DEC <ratio>: stream both channels decimated by ratio
+//                (DECIM_RATIO_MIN..DECIM_RATIO_MAX, a power of two)
+//                DEC OFF: stop streaming
+//                DEC: "DEC <ratio> <blocks> <overruns> <dropped> <load>"
+//                  blocks   - DMA halves decimated
+//                  overruns - halves overwritten before they were decimated
+//                  dropped  - output frames lost to a busy link
+//                  load     - % of the time spent decimating
+//                DEC BUDGET: throughput budget, one line per ratio
+//                  "BUDGET <ratio> <cycles> <load>" measured on the last
+//                  capture: cycles per input sample and channel x100, and
+//                  the % of the sample period both channels take. Above
+//                  100 the ratio can not be streamed.
+//
+void DecimCommand(int argc, char *argv[])
+{
+    Uint16 ratio;
+    Uint16 n;
+    Uint32 start;
+    Uint32 cycles;
+    float32 period;
+    float32 load;
+
+    if(argc == 1)
+    {
+        load = 0.0f;
+        if(streaming != 0)
+        {
+            load = (float32)decimCycles * 100.0f /
+                   (float32)(Timebase_Now() - streamStartTime);
+        }
+        sprintf(buff, "DEC %u %lu %u %u %ld\n",
+                (streaming != 0) ? Decim_Ratio() : 0,
+                (unsigned long)streamBlocks, streamOverruns, streamDropped,
+                (long)load);
+        Cmd_Reply(buff);
+        return;
+    }
+
+    if((argc == 2) && (strcmp(argv[1], "OFF") == 0))
+    {
+        if(streaming != 0)
+        {
+            StopStream();
+        }
+        Cmd_Reply("OK\n");
+        return;
+    }
+
+    if((streaming != 0) || (capturing != 0) || (sending != 0) ||
+       (argc != 2))
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    if(strcmp(argv[1], "BUDGET") == 0)
+    {
+        period = (float32)(captureEndTime - captureStartTime) /
+                 (float32)(RESULTS_BUFFER_SIZE - 1);
+        for(ratio = DECIM_RATIO_MIN; ratio <= DECIM_RATIO_MAX; ratio <<= 1)
+        {
+            if(Decim_Configure(ratio, adcBits) == 0)
+            {
+                continue;           // CIC would overflow at this width
+            }
+            Decim_Reset(&decimState[0]);
+            start = Timebase_Now();
+            for(n = 0; n < RESULTS_BUFFER_SIZE; n += STREAM_BLOCK_SIZE)
+            {
+                Decim_Process(&decimState[0], &adcData0[n], STREAM_BLOCK_SIZE,
+                              decimOut[0][0]);
+            }
+            cycles = Timebase_Now() - start;
+
+            load = 0.0f;
+            if(period > 0.0f)
+            {
+                load = 2.0f * (float32)cycles * 100.0f /
+                       ((float32)RESULTS_BUFFER_SIZE * period);
+            }
+            sprintf(buff, "BUDGET %u %lu %ld\n", ratio,
+                    (unsigned long)(cycles * 100UL / RESULTS_BUFFER_SIZE),
+                    (long)load);
+            Cmd_Reply(buff);
+        }
+        Cmd_Reply("OK\n");
+        return;
+    }
+
+    ratio = (Uint16)atoi(argv[1]);
+    if(Decim_Configure(ratio, adcBits) == 0)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+    Cmd_Reply("OK\n");
+    StartStream();
+}
+
+//
+// AdcCommand - ADC: report "ADC <bits> <S|D> <ch>"
+//              ADC <12|16> <S|D> <ch>: set the resolution, signal mode and
+//                input of both ADCs. 16-bit needs differential inputs; in
+//                differential mode ch is the even (+) input of the pair.
+//                Each mode has its own calibration table, kept across
+//                mode changes.
+//              ADC BENCH: capture in 12-bit single-ended and in 16-bit
+//                differential mode and report "BENCH <bits> <S|D> <sps>
+//                <cycles>", the sample rate of each ADC and the SYSCLK
+//                cycles per sample x100. The captures run from the
+//                background loop (BenchStart()); the lines and the OK come
+//                once both are in, and the previous mode is restored.
+//
+void AdcCommand(int argc, char *argv[])
+{
+    Uint16 resolution;
+    Uint16 signalMode;
+    Uint16 channel;
+
+    if(argc == 1)
+    {
+        sprintf(buff, "ADC %u %c %u\n", adcBits,
+                (adcSignalMode == ADC_SIGNALMODE_DIFFERENTIAL) ? 'D' : 'S',
+                adcChannel);
+        Cmd_Reply(buff);
+        return;
+    }
+
+    if((streaming != 0) || (capturing != 0) || (sending != 0) ||
+       (benchRunning != 0) || AdcCal_Pending())
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    if((argc == 2) && (strcmp(argv[1], "BENCH") == 0))
+    {
+        benchResolution = adcResolution;
+        benchSignalMode = adcSignalMode;
+        benchChannel = adcChannel;
+        benchRunning = 1;
+        benchStep = 0;
+        BenchStart();
+        return;
+    }
+
+    if(argc != 4)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    resolution = (strcmp(argv[1], "16") == 0) ? ADC_RESOLUTION_16BIT :
+                                                 ADC_RESOLUTION_12BIT;
+    signalMode = (strcmp(argv[2], "D") == 0) ? ADC_SIGNALMODE_DIFFERENTIAL :
+                                                ADC_SIGNALMODE_SINGLE;
+    channel = (Uint16)atoi(argv[3]);
+    if(((strcmp(argv[1], "12") != 0) && (strcmp(argv[1], "16") != 0)) ||
+       ((strcmp(argv[2], "S") != 0) && (strcmp(argv[2], "D") != 0)) ||
+       (SetAdcMode(resolution, signalMode, channel) == 0))
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+    Cmd_Reply("OK\n");
+}
+
+//
+// SciCommand - SCI: one "SCI <port> <baud> <sent> <received>" line per
+//                port, then "SCI CMD <port> DATA <ports> LOOP <ports>"
+//              SCI BAUD <port> <baud>: change a port's baud rate once it
+//                has sent what it holds; on the command port the reply
+//                comes at the new rate
+//              SCI DATA <ports>: ports the telemetry frames are striped
+//                over, e.g. SCI DATA CD
+//              SCI LOOP <ports>|OFF: echo everything the ports receive,
+//                for the host loopback rig (not the command port)
+//              SCI FLOW: one "FLOW <port> <rts> <cts> <stops> <stalls>"
+//                line per port with flow control: its GPIOs and how
+//                often RTS paused the host and CTS the port
+//              SCI FLOW <port> <rts> <cts>|OFF: RTS/CTS flow control on
+//                the given GPIOs, "-" for none
+//              SCI RXERR: one "RXERR <port> <overrun> <framing> <parity>
+//                <break> <fifo> <ring> <resets>" line per port, the
+//                receive error counts of Sci_Errors()
+//              SCI STATUS [<ms>|OFF]: the same counts as a
+//                TLM_TYPE_SCI_STATUS frame on the data ports, once or
+//                every ms milliseconds
+//
+void SciCommand(int argc, char *argv[])
+{
+    Uint16 port;
+    Uint16 mask;
+    Uint16 rts;
+    Uint16 cts;
+    Uint32 baud;
+    Uint32 stops;
+    Uint32 stalls;
+    Uint32 ms;
+    SCI_ERRORS err;
+    char data[SCI_PORTS + 1];
+    char loop[SCI_PORTS + 1];
+
+    if(argc == 1)
+    {
+        for(port = 0; port < SCI_PORTS; port++)
+        {
+            sprintf(buff, "SCI %c %lu %lu %lu\n", 'A' + port,
+                    (unsigned long)Sci_Baud(port),
+                    (unsigned long)Sci_TxCount(port),
+                    (unsigned long)Sci_RxCount(port));
+            Cmd_Reply(buff);
+        }
+        PortNames(Tlm_Ports(), data);
+        PortNames(loopPorts, loop);
+        sprintf(buff, "SCI CMD %c DATA %s LOOP %s\n", 'A' + cmdPort,
+                data, loop);
+        Cmd_Reply(buff);
+        return;
+    }
+
+    if((argc == 4) && (strcmp(argv[1], "BAUD") == 0))
+    {
+        port = argv[2][0] - 'A';
+        baud = (Uint32)atol(argv[3]);
+        if((argv[2][1] != '\0') || (Sci_IsOpen(port) == 0))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        while(Sci_TxIdle(port) == 0)
+        {
+        }
+        Cmd_Reply((Sci_SetBaud(port, baud) != 0) ? "OK\n" : "ERR\n");
+        return;
+    }
+
+    if((argc == 3) && (strcmp(argv[1], "DATA") == 0))
+    {
+        mask = ParsePorts(argv[2]);
+        if((mask == 0) || (mask == 0xFFFF))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        Tlm_SetPorts(mask);
+        Cmd_Reply("OK\n");
+        return;
+    }
+
+    if((argc == 2) && (strcmp(argv[1], "FLOW") == 0))
+    {
+        for(port = 0; port < SCI_PORTS; port++)
+        {
+            if(Sci_IsOpen(port) == 0)
+            {
+                continue;
+            }
+            Sci_Flow(port, &rts, &cts, &stops, &stalls);
+            if((rts == SCI_NO_PIN) && (cts == SCI_NO_PIN))
+            {
+                continue;
+            }
+            sprintf(buff, "FLOW %c %d %d %lu %lu\n", 'A' + port,
+                    (rts == SCI_NO_PIN) ? -1 : (int)rts,
+                    (cts == SCI_NO_PIN) ? -1 : (int)cts,
+                    (unsigned long)stops, (unsigned long)stalls);
+            Cmd_Reply(buff);
+        }
+        Cmd_Reply("OK\n");
+        return;
+    }
+
+    if(((argc == 4) || (argc == 5)) && (strcmp(argv[1], "FLOW") == 0))
+    {
+        port = argv[2][0] - 'A';
+        if((argc == 4) && (strcmp(argv[3], "OFF") == 0))
+        {
+            rts = SCI_NO_PIN;
+            cts = SCI_NO_PIN;
+        }
+        else if(argc == 5)
+        {
+            rts = (strcmp(argv[3], "-") == 0) ? SCI_NO_PIN :
+                  (Uint16)atoi(argv[3]);
+            cts = (strcmp(argv[4], "-") == 0) ? SCI_NO_PIN :
+                  (Uint16)atoi(argv[4]);
+        }
+        else
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        if((argv[2][1] != '\0') || (Sci_SetFlow(port, rts, cts) == 0))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        Cmd_Reply("OK\n");
+        return;
+    }
+
+    if((argc == 2) && (strcmp(argv[1], "RXERR") == 0))
+    {
+        for(port = 0; port < SCI_PORTS; port++)
+        {
+            if(Sci_IsOpen(port) == 0)
+            {
+                continue;
+            }
+            Sci_Errors(port, &err);
+            sprintf(buff, "RXERR %c %lu %lu %lu %lu %lu %lu %lu\n",
+                    'A' + port, (unsigned long)err.overrun,
+                    (unsigned long)err.framing, (unsigned long)err.parity,
+                    (unsigned long)err.brk, (unsigned long)err.fifoOverflow,
+                    (unsigned long)err.ringDropped,
+                    (unsigned long)err.resets);
+            Cmd_Reply(buff);
+        }
+        Cmd_Reply("OK\n");
+        return;
+    }
+
+    if(((argc == 2) || (argc == 3)) && (strcmp(argv[1], "STATUS") == 0))
+    {
+        if((argc == 3) && (strcmp(argv[2], "OFF") == 0))
+        {
+            sciStatusOn = 0;
+        }
+        else
+        {
+            ms = (argc == 3) ? (Uint32)atol(argv[2]) : 0;
+            if(ms > SCI_STATUS_MS_MAX)
+            {
+                Cmd_Reply("ERR\n");
+                return;
+            }
+            sciStatusPeriod = ms * (TIMEBASE_HZ / 1000);
+            sciStatusTime = Timebase_Now() - sciStatusPeriod;
+            sciStatusOn = 1;
+        }
+        Cmd_Reply("OK\n");
+        return;
+    }
+
+    if((argc == 3) && (strcmp(argv[1], "LOOP") == 0))
+    {
+        mask = (strcmp(argv[2], "OFF") == 0) ? 0 : ParsePorts(argv[2]);
+        if((mask == 0xFFFF) || (mask & (1U << cmdPort)))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        loopPorts = mask;
+        Cmd_Reply("OK\n");
+        return;
+    }
+
+    Cmd_Reply("ERR\n");
+}
+
+//
+// SpiCommand - SPI: report "SPI <frames> <bytes> <rate> <cycles>" for the
+//              SPI link since the last SPI command and restart the counts:
+//              frames - frames the DMA has moved
+//              bytes  - bytes of the frames started, padding included
+//              rate   - bytes per second over the interval; the SCI path
+//                       moves at most 11520 at 115200 baud
+//              cycles - CPU cycles per frame spent packing and in the DMA
+//                       interrupt
+//
+void SpiCommand(int argc, char *argv[])
+{
+    Uint32 now;
+    Uint32 frames;
+    float32 seconds;
+
+    now = Timebase_Now();
+    seconds = (float32)(now - spiStatTime) / (float32)TIMEBASE_HZ;
+    frames = Spi_Frames();
+
+    sprintf(buff, "SPI %lu %lu %lu %lu\n", (unsigned long)frames,
+            (unsigned long)Spi_Bytes(),
+            (unsigned long)((float32)Spi_Bytes() / seconds),
+            (unsigned long)((frames != 0) ? Spi_Cycles() / frames : 0));
+    Cmd_Reply(buff);
+
+    Spi_ClearStats();
+    spiStatTime = now;
+}
+
+//
+// McbspCommand - MCB: report "MCB <bitrate> <frames> <bytes> <rate>
+//                <cycles>" for the McBSP link since the last MCB command,
+//                the fields as for SPI, and restart the counts
+//                MCB CLK <div>: set the bit clock to LSPCLK / (div + 1),
+//                div MCBSP_CLKGDV_MIN..255; waits for the frame in flight
+//
+void McbspCommand(int argc, char *argv[])
+{
+    Uint32 now;
+    Uint32 frames;
+    float32 seconds;
+
+    if((argc == 3) && (strcmp(argv[1], "CLK") == 0))
+    {
+        while(Mcbsp_Busy() != 0)
+        {
+        }
+        Cmd_Reply((Mcbsp_SetClock((Uint16)atoi(argv[2])) != 0) ?
+                  "OK\n" : "ERR\n");
+        return;
+    }
+    if(argc != 1)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    now = Timebase_Now();
+    seconds = (float32)(now - mcbspStatTime) / (float32)TIMEBASE_HZ;
+    frames = Mcbsp_Frames();
+
+    sprintf(buff, "MCB %lu %lu %lu %lu %lu\n",
+            (unsigned long)Mcbsp_BitRate(), (unsigned long)frames,
+            (unsigned long)Mcbsp_Bytes(),
+            (unsigned long)((float32)Mcbsp_Bytes() / seconds),
+            (unsigned long)((frames != 0) ? Mcbsp_Cycles() / frames : 0));
+    Cmd_Reply(buff);
+
+    Mcbsp_ClearStats();
+    mcbspStatTime = now;
+}
+
+//
+// LinkCommand - LINK SCI|SPI|MCB [ms]: send raw frames of RAW_BLOCK_SIZE
+//               samples of the last ADCA capture on one link for ms
+//               milliseconds (LINK_BENCH_MS, at most LINK_BENCH_MAX_MS)
+//               and report "LINK <link> <rate> <cost> <load>":
+//               rate - bytes per second the link moved
+//               cost - CPU cycles per byte x100: framing, copying and the
+//                      link interrupts (SCI TX FIFO refills, DMA ends)
+//               load - % of the CPU the link takes at that rate
+//               SCI sends on the data ports (SCI DATA), SPI needs the
+//               master to be clocking.
+//
+void LinkCommand(int argc, char *argv[])
+{
+    Uint16 link;
+    Uint16 port;
+    Uint16 pending;
+    Uint32 duration;
+    Uint32 start;
+    Uint32 t;
+    Uint32 cycles;
+    Uint32 bytes;
+    Uint32 elapsed;
+
+    link = 0xFFFF;
+    if(argc >= 2)
+    {
+        link = (strcmp(argv[1], "SCI") == 0) ? OUTPUT_RICE :
+               (strcmp(argv[1], "SPI") == 0) ? OUTPUT_SPI :
+               (strcmp(argv[1], "MCB") == 0) ? OUTPUT_MCBSP : 0xFFFF;
+    }
+    duration = (argc == 3) ? (Uint32)atol(argv[2]) : LINK_BENCH_MS;
+    if((link == 0xFFFF) || (argc > 3) || (duration == 0) ||
+       (duration > LINK_BENCH_MAX_MS) ||
+       (streaming != 0) || (capturing != 0) || (sending != 0) ||
+       (Tlm_Idle() == 0))
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+    duration *= TIMEBASE_HZ / 1000;
+
+    //
+    // Baselines; the DMA links count from zero
+    //
+    cycles = 0;
+    bytes = 0;
+    for(port = 0; port < SCI_PORTS; port++)
+    {
+        bytes -= Sci_TxCount(port);
+        cycles -= Sci_TxCycles(port);
+    }
+    Spi_ClearStats();
+    Mcbsp_ClearStats();
+
+    start = Timebase_Now();
+    while((Timebase_Now() - start) < duration)
+    {
+        if(link == OUTPUT_RICE)
+        {
+            //
+            // Only calls that framed or queued something are counted,
+            // not the polls of a full ring
+            //
+            t = Timebase_Now();
+            pending = Tlm_Pending();
+            if(Tlm_Busy() == 0)
+            {
+                Tlm_CommitRaw(0, adcBits, adcData0, RAW_BLOCK_SIZE);
+            }
+            Tlm_SendStep();
+            if(Tlm_Pending() != pending)
+            {
+                cycles += Timebase_Now() - t;
+            }
+        }
+        else if(link == OUTPUT_SPI)
+        {
+            Spi_SendBlock(0, adcBits, adcData0, RAW_BLOCK_SIZE);
+        }
+        else
+        {
+            Mcbsp_SendBlock(0, adcBits, adcData0, RAW_BLOCK_SIZE);
+        }
+    }
+    elapsed = Timebase_Now() - start;
+
+    if(link == OUTPUT_RICE)
+    {
+        for(port = 0; port < SCI_PORTS; port++)
+        {
+            bytes += Sci_TxCount(port);
+            cycles += Sci_TxCycles(port);
+        }
+
+        //
+        // Let the last frames out before the reply
+        //
+        while(Tlm_Idle() == 0)
+        {
+            Tlm_SendStep();
+        }
+    }
+    else if(link == OUTPUT_SPI)
+    {
+        bytes = Spi_Frames() * 2UL * SPI_FRAME_WORDS(RAW_BLOCK_SIZE);
+        cycles = Spi_Cycles();
+    }
+    else
+    {
+        bytes = Mcbsp_Frames() * 2UL * TLM_RAW_WORDS(RAW_BLOCK_SIZE);
+        cycles = Mcbsp_Cycles();
+    }
+
+    sprintf(buff, "LINK %s %lu %lu %lu\n", argv[1],
+            (unsigned long)((float32)bytes * (float32)TIMEBASE_HZ /
+                            (float32)elapsed),
+            (unsigned long)((bytes != 0) ?
+                            (float32)cycles * 100.0f / (float32)bytes : 0),
+            (unsigned long)((float32)cycles * 100.0f / (float32)elapsed));
+    Cmd_Reply(buff);
+}
+
+//
+// LogCommand - LOG: report "LOG <ON|OFF> <records> <lost>", the records
+//              stored and lost to a full ring since the last LOG CLEAR
+//              LOG ON|OFF: start or stop logging and sending the records
+//              LOG CLEAR: discard the unsent records, restart the counts
+//              LOG BENCH: time LOG_BENCH_CALLS LOG2() calls with logging
+//                on and off and report "LOG BENCH <on> <off>" in cycles
+//                per call. The unsent records are discarded first.
+//
+void LogCommand(int argc, char *argv[])
+{
+    Uint16 i;
+    Uint16 wasEnabled;
+    Uint32 start;
+    Uint32 on;
+    Uint32 off;
+
+    if(argc == 1)
+    {
+        sprintf(buff, "LOG %s %lu %lu\n", Log_Enabled() ? "ON" : "OFF",
+                (unsigned long)Log_Records(), (unsigned long)Log_Lost());
+        Cmd_Reply(buff);
+        return;
+    }
+    if(argc != 2)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    if(strcmp(argv[1], "ON") == 0)
+    {
+        Log_Enable(1);
+    }
+    else if(strcmp(argv[1], "OFF") == 0)
+    {
+        Log_Enable(0);
+    }
+    else if(strcmp(argv[1], "CLEAR") == 0)
+    {
+        Log_Clear();
+    }
+    else if(strcmp(argv[1], "BENCH") == 0)
+    {
+        wasEnabled = Log_Enabled();
+        Log_Clear();
+
+        Log_Enable(1);
+        start = Timebase_Now();
+        for(i = 0; i < LOG_BENCH_CALLS; i++)
+        {
+            LOG2(LOG_BENCH, "log bench call %u of %u", i, LOG_BENCH_CALLS);
+        }
+        on = Timebase_Now() - start;
+
+        Log_Enable(0);
+        start = Timebase_Now();
+        for(i = 0; i < LOG_BENCH_CALLS; i++)
+        {
+            LOG2(LOG_BENCH, "log bench call %u of %u", i, LOG_BENCH_CALLS);
+        }
+        off = Timebase_Now() - start;
+
+        Log_Enable(wasEnabled);
+        sprintf(buff, "LOG BENCH %lu %lu\n",
+                (unsigned long)(on / LOG_BENCH_CALLS),
+                (unsigned long)(off / LOG_BENCH_CALLS));
+        Cmd_Reply(buff);
+        return;
+    }
+    else
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+    Cmd_Reply("OK\n");
+}
+
+//
+// ArqCommand - ARQ: report "ARQ <port|-> <seg> <rto> <held> <bytes>
+//              <segments> <retransmits> <timeouts> <acks> <bad>" and
+//              restart the counts: segment size and timeout, segments
+//              held, data bytes taken, segments sent new and again (of
+//              them after a timeout), ACKs applied and rejected
+//              ARQ ON <port>: carry the data output of the port (it
+//                becomes the only data port) over ARQ to host/arq_peer
+//              ARQ OFF: back to plain SCI; unacknowledged data is lost
+//              ARQ SEG <n>: data bytes per segment, while off
+//              ARQ RTO <ms>: retransmission timeout, 1..ARQ_RTO_MS_MAX
+//
+void ArqCommand(int argc, char *argv[])
+{
+    Uint16 port;
+    ARQ_STATS stats;
+    char name[SCI_PORTS + 1];
+
+    if(argc == 1)
+    {
+        Arq_GetStats(&stats);
+        port = Arq_Port();
+        PortNames((port == ARQ_NO_PORT) ? 0 : (1U << port), name);
+        sprintf(buff, "ARQ %s %u %u %u %lu %lu %lu %lu %lu %lu\n", name,
+                Arq_Segment(), Arq_Timeout(), Arq_InFlight(),
+                (unsigned long)stats.bytes, (unsigned long)stats.segments,
+                (unsigned long)stats.retransmits,
+                (unsigned long)stats.timeouts, (unsigned long)stats.acks,
+                (unsigned long)stats.badAcks);
+        Cmd_Reply(buff);
+        Arq_ClearStats();
+        return;
+    }
+
+    //
+    // The session must not start or end inside a frame or a CSV line
+    //
+    if((argc == 3) && (strcmp(argv[1], "ON") == 0))
+    {
+        port = argv[2][0] - 'A';
+        if((argv[2][1] != '\0') || (sending != 0) || (Tlm_Idle() == 0) ||
+           (Arq_Port() != ARQ_NO_PORT) || (Arq_Open(port) == 0))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        Tlm_SetPorts(1U << port);
+    }
+    else if((argc == 2) && (strcmp(argv[1], "OFF") == 0))
+    {
+        if((sending != 0) || (Tlm_Idle() == 0))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        Arq_Close();
+    }
+    else if((argc == 3) && (strcmp(argv[1], "SEG") == 0))
+    {
+        if(Arq_SetSegment((Uint16)atoi(argv[2])) == 0)
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+    }
+    else if((argc == 3) && (strcmp(argv[1], "RTO") == 0))
+    {
+        if(Arq_SetTimeout((Uint16)atoi(argv[2])) == 0)
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+    }
+    else
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+    Cmd_Reply("OK\n");
+}
+
+//
+// MemCommand - MEM: report "MEM <ON|OFF> <passes>", whether a read or
+//              stream is running and its passes over the range
+//              MEM RD <addr> <words>: send the range once as TLM_TYPE_MEM
+//                frames on the data ports
+//              MEM STREAM <addr> <words> [ms]: send it again every ms
+//                milliseconds, back to back without ms
+//              MEM STOP: end the read or stream
+//              MEM CRC <addr> <words>: report "MEM CRC <crc>", the frame
+//                CRC-16 over the range
+//              MEM WR <addr> <words>: after the OK, the next 2 * words
+//                bytes on the command port are the data, high byte first,
+//                then two of CRC-16 over them. Up to MEM_WRITE_MAX words
+//                of RAM; "MEM WR OK|CRC|TIMEOUT" when they are in. The
+//                line must end in a single newline character.
+//              Addresses are hexadecimal, word counts decimal.
+//
+void MemCommand(int argc, char *argv[])
+{
+    Uint32 addr;
+    Uint32 words;
+    Uint32 ms;
+
+    if(argc == 1)
+    {
+        sprintf(buff, "MEM %s %lu\n", Mem_Active() ? "ON" : "OFF",
+                (unsigned long)Mem_Passes());
+        Cmd_Reply(buff);
+        return;
+    }
+
+    if((argc == 2) && (strcmp(argv[1], "STOP") == 0))
+    {
+        Mem_Stop();
+    }
+    else if((argc == 4) && (strcmp(argv[1], "CRC") == 0))
+    {
+        if((ParseRange(argv, &addr, &words) == 0) ||
+           (Mem_Valid(addr, words, MEM_READ) == 0))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        sprintf(buff, "MEM CRC %04X\n", Mem_Crc(addr, words));
+        Cmd_Reply(buff);
+        return;
+    }
+    else if((argc == 4) && (strcmp(argv[1], "RD") == 0))
+    {
+        if((ParseRange(argv, &addr, &words) == 0) ||
+           (Mem_Read(addr, words) == 0))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+    }
+    else if(((argc == 4) || (argc == 5)) && (strcmp(argv[1], "STREAM") == 0))
+    {
+        ms = (argc == 5) ? (Uint32)atol(argv[4]) : 0;
+        if((ParseRange(argv, &addr, &words) == 0) ||
+           (ms > MEM_PERIOD_MS_MAX) ||
+           (Mem_Stream(addr, words, (Uint16)ms) == 0))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+    }
+    else if((argc == 4) && (strcmp(argv[1], "WR") == 0))
+    {
+        if((ParseRange(argv, &addr, &words) == 0) ||
+           (words > MEM_WRITE_MAX) ||
+           (Mem_BeginWrite(addr, (Uint16)words) == 0))
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+    }
+    else
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+    Cmd_Reply("OK\n");
+}
+
+//
+// SchedCommand - SCHED: one "SCHED <name> <priority> <weight> <frames>
+//                <bytes> <share> <wait>" line per telemetry stream since
+//                the last SCHED CLEAR:
+//                share - its frame bytes in 1/1000 of all of them; under
+//                        saturation the streams of one priority share in
+//                        the ratio of their weights
+//                wait  - worst time in us from having a frame to framing
+//                        it
+//              SCHED <name> <priority> <weight>: change a stream, priority
+//                0 (first) to SCHED_PRIORITY_MAX, weight 1 to
+//                SCHED_WEIGHT_MAX
+//              SCHED CLEAR: start the statistics again
+//
+void SchedCommand(int argc, char *argv[])
+{
+    Uint16 stream;
+    Uint16 priority;
+    Uint16 weight;
+    Uint32 total;
+    SCHED_STATS stats;
+
+    if(argc == 1)
+    {
+        total = 0;
+        for(stream = 0; stream < Sched_Count(); stream++)
+        {
+            Sched_Stats(stream, &stats);
+            total += stats.bytes;
+        }
+        for(stream = 0; stream < Sched_Count(); stream++)
+        {
+            Sched_Get(stream, &priority, &weight);
+            Sched_Stats(stream, &stats);
+            sprintf(buff, "SCHED %s %u %u %lu %lu %lu %lu\n",
+                    Sched_Name(stream), priority, weight,
+                    (unsigned long)stats.frames, (unsigned long)stats.bytes,
+                    (unsigned long)((total != 0) ?
+                        (Uint32)((float32)stats.bytes * 1000.0f /
+                                 (float32)total) : 0),
+                    (unsigned long)(stats.maxWait / (TIMEBASE_HZ / 1000000)));
+            Cmd_Reply(buff);
+        }
+        return;
+    }
+
+    if((argc == 2) && (strcmp(argv[1], "CLEAR") == 0))
+    {
+        Sched_ClearStats();
+        Cmd_Reply("OK\n");
+        return;
+    }
+
+    stream = (argc == 4) ? Sched_Find(argv[1]) : SCHED_NONE;
+    if((stream == SCHED_NONE) ||
+       (Sched_Set(stream, (Uint16)atoi(argv[2]), (Uint16)atoi(argv[3])) == 0))
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+    Cmd_Reply("OK\n");
+}
+
+//
+// FaultCommand - FAULT: "FAULT <policy> <faults> <wdreset>", then the crash
+//                record as "FAULT LAST <vector> <group>.<channel> <pc>
+//                <ier> <ifr> <time>" (pc, ier and ifr in hex, time in
+//                ms of the timebase) and one "SPUR <vector> <count>" line
+//                per vector that fired without a handler since the start
+//              FAULT RESUME|RESET|HALT: what to do about the next one
+//              FAULT CLEAR: forget the record and the counts
+//              FAULT TEST: raise an interrupt without a handler
+//
+void FaultCommand(int argc, char *argv[])
+{
+    static const char * const policyName[FAULT_POLICIES] =
+        {"RESUME", "RESET", "HALT"};
+    Uint16 policy;
+    Uint16 vector;
+    FAULT_RECORD record;
+
+    if(argc == 1)
+    {
+        Fault_Record(&record);
+        sprintf(buff, "FAULT %s %u %u\n", policyName[Fault_Policy()],
+                record.count, Fault_WatchdogReset());
+        Cmd_Reply(buff);
+        if(record.count != 0)
+        {
+            sprintf(buff, "FAULT LAST %u %u.%u %08lX %04X %04X %lu\n",
+                    record.vector, record.group, record.channel,
+                    (unsigned long)record.pc, record.ier, record.ifr,
+                    (unsigned long)(record.time / (TIMEBASE_HZ / 1000)));
+            Cmd_Reply(buff);
+        }
+        for(vector = 0; vector < FAULT_VECTORS; vector++)
+        {
+            if(Fault_Count(vector) != 0)
+            {
+                sprintf(buff, "SPUR %u %u\n", vector, Fault_Count(vector));
+                Cmd_Reply(buff);
+            }
+        }
+        return;
+    }
+    if(argc != 2)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    if(strcmp(argv[1], "CLEAR") == 0)
+    {
+        Fault_Clear();
+    }
+    else if(strcmp(argv[1], "TEST") == 0)
+    {
+        Fault_Test();
+    }
+    else
+    {
+        for(policy = 0; policy < FAULT_POLICIES; policy++)
+        {
+            if(strcmp(argv[1], policyName[policy]) == 0)
+            {
+                break;
+            }
+        }
+        if(policy == FAULT_POLICIES)
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        Fault_SetPolicy(policy);
+    }
+    Cmd_Reply("OK\n");
+}
+
+//
+// IsrCommand - ISR: "ISR ON|OFF <bias>", then one "ISR <name> <vector>
+//              <count> <exec min> <mean> <max> <latency min> <mean> <max>
+//              <jitter>" line per profiled interrupt that ran, in cycles,
+//              since the last ISR CLEAR. The latency is "- - -" for
+//              interrupts that cannot tell the age of their event. The
+//              execution times include the bias, what an empty handler
+//              would show, and leave out nested interrupts. The jitter,
+//              the spread of the time between entries, bounds how much
+//              the latency of a periodic interrupt varies; "-" before its
+//              second run.
+//            ISR ON|OFF: start or stop profiling
+//            ISR CLEAR: start the statistics again
+//            ISR BENCH: "ISR BENCH <on> <off> <bias>", the cycles the
+//              profiling adds to each interrupt with it on and off
+//
+void IsrCommand(int argc, char *argv[])
+{
+    Uint16 id;
+    Uint16 len;
+    Uint32 on;
+    Uint32 off;
+    ISRPROF_STATS stats;
+
+    if(argc == 1)
+    {
+        sprintf(buff, "ISR %s %lu\n", IsrProf_Enabled() ? "ON" : "OFF",
+                (unsigned long)IsrProf_Bias());
+        Cmd_Reply(buff);
+        for(id = 0; id < ISRPROF_COUNT; id++)
+        {
+            IsrProf_Stats(id, &stats);
+            if(stats.count == 0)
+            {
+                continue;
+            }
+            len = sprintf(buff, "ISR %s %u %lu %lu %lu %lu",
+                          IsrProf_Name(id), IsrProf_Vector(id),
+                          (unsigned long)stats.count,
+                          (unsigned long)stats.execMin,
+                          (unsigned long)(stats.execSum / stats.count),
+                          (unsigned long)stats.execMax);
+            if(stats.latCount != 0)
+            {
+                len += sprintf(buff + len, " %lu %lu %lu",
+                               (unsigned long)stats.latMin,
+                               (unsigned long)(stats.latSum / stats.latCount),
+                               (unsigned long)stats.latMax);
+            }
+            else
+            {
+                strcpy(buff + len, " - - -");
+                len += 6;
+            }
+            if(stats.count > 1)
+            {
+                sprintf(buff + len, " %lu\n",
+                        (unsigned long)(stats.periodMax - stats.periodMin));
+            }
+            else
+            {
+                strcpy(buff + len, " -\n");
+            }
+            Cmd_Reply(buff);
+        }
+        return;
+    }
+    if(argc != 2)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    if(strcmp(argv[1], "ON") == 0)
+    {
+        IsrProf_Enable(1);
+    }
+    else if(strcmp(argv[1], "OFF") == 0)
+    {
+        IsrProf_Enable(0);
+    }
+    else if(strcmp(argv[1], "CLEAR") == 0)
+    {
+        IsrProf_Clear();
+    }
+    else if(strcmp(argv[1], "BENCH") == 0)
+    {
+        IsrProf_Bench(&on, &off);
+        sprintf(buff, "ISR BENCH %lu %lu %lu\n", (unsigned long)on,
+                (unsigned long)off, (unsigned long)IsrProf_Bias());
+        Cmd_Reply(buff);
+        return;
+    }
+    else
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+    Cmd_Reply("OK\n");
+}
+
+//
+// LoadCommand - LOAD: "LOAD <load> <rolling> <peak> <isr> <background>
+//               <idle>" in 1/1000 of the CPU: the load (interrupts and
+//               background loop) of the last LOAD_WINDOW_MS window, over
+//               the last LOAD_WINDOWS windows and the highest of a window
+//               since the last LOAD CLEAR, then the three shares of the
+//               last window
+//             LOAD CLEAR: start again
 //
-    EALLOW;
-    CpuSysRegs.PCLKCR0.bit.TBCLKSYNC = 1;
-    EDIS;
+void LoadCommand(int argc, char *argv[])
+{
+    LOAD_STATS stats;
 
-//
-// Configure the ADC and power it up
-//
-    ConfigureADC();
+    if((argc == 2) && (strcmp(argv[1], "CLEAR") == 0))
+    {
+        Load_Clear();
+        Cmd_Reply("OK\n");
+        return;
+    }
+    if(argc != 1)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
 
-//
-// Setup the ADC for continuous conversions on channels A3 and B3
-//
-    SetupADCContinuous(&AdcaRegs, 3);
-    SetupADCContinuous(&AdcbRegs, 3);
+    Load_Stats(&stats);
+    sprintf(buff, "LOAD %u %u %u %u %u %u\n", 1000 - stats.idle,
+            stats.rolling, stats.peak, stats.isr, stats.background,
+            stats.idle);
+    Cmd_Reply(buff);
+}
 
 //
-// Initialize the DMA
+// WorkCommand - WORK: one "WORK <producer> <posts> <drops> <runs> <peak>
+//               <run max>" line per producer of work.c: items queued and
+//               lost to a full ring, items run, the most waiting at once
+//               and the longest handler in cycles, since the last WORK
+//               CLEAR
+//             WORK CLEAR: start again
 //
-    DMAInit();
+void WorkCommand(int argc, char *argv[])
+{
+    static const char * const names[WORK_PRODUCERS] =
+        {"DMA_CH1", "DMA_CH2", "TIMER"};
+    WORK_STATS stats;
+    Uint16 p;
 
-//
-// Enable global Interrupts and higher priority real-time debug events:
-//
-    EINT;  // Enable Global interrupt INTM
-    ERTM;  // Enable Global realtime interrupt DBGM
+    if((argc == 2) && (strcmp(argv[1], "CLEAR") == 0))
+    {
+        Work_Clear();
+        Cmd_Reply("OK\n");
+        return;
+    }
+    if(argc != 1)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
 
-//
-// Initialize results buffer
-//
-    for(resultsIndex = 0; resultsIndex < RESULTS_BUFFER_SIZE; resultsIndex++)
+    for(p = 0; p < WORK_PRODUCERS; p++)
     {
-        adcData0[resultsIndex] = 0;
-        adcData1[resultsIndex] = 0;
+        Work_Stats(p, &stats);
+        sprintf(buff, "WORK %s %lu %lu %lu %u %lu\n", names[p],
+                (unsigned long)stats.posts, (unsigned long)stats.drops,
+                (unsigned long)stats.runs, stats.peak,
+                (unsigned long)stats.runMax);
+        Cmd_Reply(buff);
     }
+}
 
 //
-// Clearing all pending interrupt flags
+// HotCommand - HOT: "HOT <load> <run> <words> <copy>": the flash and RAM
+//              addresses of the hot paths in hex, their size and the
+//              cycles Hot_Init() took to copy them; all 0 when nothing is
+//              copied (RAM build, HOT_IN_FLASH)
+//            HOT BENCH: "HOT BENCH <cycles> <per sample>", the fastest of
+//              HOT_BENCH_RUNS runs of the Hot_Bench() workload on the last
+//              capture. The same command on the CPU1_FLASH and CPU1_RAM
+//              builds compares the two. Not while capturing, streaming or
+//              sending, as it uses adcData1Aligned for scratch.
 //
-    EALLOW;
+void HotCommand(int argc, char *argv[])
+{
+    HOT_INFO info;
+    Uint32 cycles;
+    Uint32 best;
+    Uint16 i;
 
-    DmaRegs.CH1.CONTROL.bit.PERINTCLR = 1;
-    DmaRegs.CH2.CONTROL.bit.PERINTCLR = 1;
-    AdcaRegs.ADCINTFLGCLR.all = 0x3;
-    AdcbRegs.ADCINTFLGCLR.all = 0x3;
-    EPwm2Regs.ETCNTINITCTL.bit.SOCAINITFRC = 1;
-    EPwm2Regs.ETCLR.bit.SOCA = 1;
+    if(argc == 1)
+    {
+        Hot_Info(&info);
+        sprintf(buff, "HOT %05lX %05lX %lu %lu\n",
+                (unsigned long)info.loadStart, (unsigned long)info.runStart,
+                (unsigned long)info.words, (unsigned long)info.copyCycles);
+        Cmd_Reply(buff);
+        return;
+    }
 
-//
-// Enable continuous operation by setting the last SOC to re-trigger the first
-//
-    AdcaRegs.ADCINTSOCSEL1.bit.SOC0 = 2;
-    AdcbRegs.ADCINTSOCSEL1.bit.SOC0 = 2;
+    if((argc != 2) || (strcmp(argv[1], "BENCH") != 0) ||
+       (streaming != 0) || (capturing != 0) || (sending != 0))
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
 
-    EDIS;
+    best = 0xFFFFFFFFUL;
+    for(i = 0; i < HOT_BENCH_RUNS; i++)
+    {
+        cycles = Hot_Bench(adcData0, adcBits, adcData1Aligned);
+        if(cycles < best)
+        {
+            best = cycles;
+        }
+    }
+    sprintf(buff, "HOT BENCH %lu %lu\n", (unsigned long)best,
+            (unsigned long)(best / ((Uint32)HOT_BENCH_ROUNDS *
+                                    HOT_BENCH_SAMPLES)));
+    Cmd_Reply(buff);
+}
 
 //
-// Start DMA
-//
-    done = 0;
-    StartDMACH1();
-    StartDMACH2();
+// FlashCommand - FLASH: "FLASH <measured> <pll> <sysclk> <rwait> <flags>":
+//                SYSCLK in Hz as measured, as the PLL registers give it and
+//                as the flash is set up for, then the wait states and the
+//                FLASH_PREFETCH and FLASH_CACHE flags in use
+//              FLASH BENCH: one "FLASH BENCH <rwait> <flags> <cycles>" line
+//                per setting, from the wait states in use to those of the
+//                fastest clock and the reset value, each with the prefetch
+//                and the cache off, the prefetch on and both on: the
+//                fastest of FLASH_BENCH_RUNS runs of Flash_Bench() over the
+//                hot path image kept in flash. The setting in use is put
+//                back after. FLASH build only, not while capturing,
+//                streaming or sending.
+//
+void FlashCommand(int argc, char *argv[])
+{
+    static const Uint16 flagSets[] =
+        {0, FLASH_PREFETCH, FLASH_PREFETCH | FLASH_CACHE};
+    FLASH_INFO info;
+    HOT_INFO hot;
+    Uint32 cycles;
+    Uint32 best;
+    Uint16 words;
+    Uint16 rwait;
+    Uint16 f;
+    Uint16 i;
 
-//
-// Finally, enable the SOCA trigger from ePWM. This will kick off
-// conversions at the next ePWM event.
-//
-    EPwm2Regs.ETSEL.bit.SOCAEN = 1;
+    Flash_Info(&info);
+    if(argc == 1)
+    {
+        sprintf(buff, "FLASH %lu %lu %lu %u %u\n",
+                (unsigned long)info.measuredHz, (unsigned long)info.pllHz,
+                (unsigned long)info.sysclkHz, info.rwait, info.flags);
+        Cmd_Reply(buff);
+        return;
+    }
 
-//
-// Loop until the ISR signals the transfer is complete
-//
-    while(done == 0)
+    Hot_Info(&hot);
+    if((argc != 2) || (strcmp(argv[1], "BENCH") != 0) ||
+       (hot.words == 0) ||
+       (streaming != 0) || (capturing != 0) || (sending != 0))
     {
-        __asm(" NOP");
+        Cmd_Reply("ERR\n");
+        return;
     }
+    words = (hot.words < FLASH_BENCH_WORDS) ? (Uint16)hot.words :
+                                              FLASH_BENCH_WORDS;
 
-    cnt = 0;
-    unsigned char flag = 0;
-    while(1)
+    rwait = info.rwait;
+    for(;;)
     {
-        if( PieCtrlRegs.PIEIER9.bit.INTx4 == 0 )
+        for(f = 0; f < sizeof(flagSets) / sizeof(flagSets[0]); f++)
         {
-            flag = 0;
-            while(1)
+            Flash_Apply(rwait, flagSets[f]);
+            best = 0xFFFFFFFFUL;
+            for(i = 0; i < FLASH_BENCH_RUNS; i++)
             {
-                if(cnt >= RESULTS_BUFFER_SIZE)
-                {
-                    break;
-                }
-                //Txbuff[Tx_w_idx++] = adcData1[cnt++] & 0x0FF;
-                sprintf(buff, "%04d,%04d\n", cnt, adcData1[cnt]);
-                flag = 0;
-                int len = strlen(buff);
-                int a = Tx_w_idx + len;
-                if(a >= BUFFMAX)
-                {
-                    a = a - BUFFMAX;
-                    if(a >= Tx_r_idx)
-                    {
-                        flag = 1;
-                    }
-                }
-                else
-                {
-                    if(Tx_w_idx < Tx_r_idx)
-                    {
-                        if(a >= Tx_r_idx)
-                        {
-                            flag = 1;
-                        }
-                    }
-                }
-                if(flag == 0)
-                {
-                    cnt++;
-                    for(i=0;i<len;i++)
-                    {
-                        Txbuff[Tx_w_idx++] = buff[i];
-
-                        if(Tx_w_idx >= BUFFMAX)
-                        {
-                            Tx_w_idx = 0;
-                        }
-                    }
-                }
-                else
+                cycles = Flash_Bench((const Uint16 *)hot.loadStart, words);
+                if(cycles < best)
                 {
-                    break;
+                    best = cycles;
                 }
             }
+            sprintf(buff, "FLASH BENCH %u %u %lu\n", rwait, flagSets[f],
+                    (unsigned long)best);
+            Cmd_Reply(buff);
+        }
 
-            if(Tx_w_idx != Tx_r_idx)
-            {
-                Uint16 fifo_st = 16 - ScibRegs.SCIFFTX.bit.TXFFST;
-                for(i = 0; i<fifo_st; i++)
-                {
-                    ScibRegs.SCITXBUF.all = Txbuff[Tx_r_idx++];
-                    if(Tx_r_idx >= BUFFMAX)
-                    {
-                        Tx_r_idx = 0;
-                    }
-                    if(Tx_w_idx == Tx_r_idx)
-                    {
-                        break;
-                    }
-                }
-                PieCtrlRegs.PIEIER9.bit.INTx4=1;     // PIE Group 9, INT4 SCIB_TX
-            }
-            else
-            {
-                break;
-            }
+        if(rwait == FLASH_RWAIT_RESET)
+        {
+            break;
+        }
+        rwait = (rwait < Flash_WaitStates(FLASH_HZ_MAX)) ? rwait + 1 :
+                                                           FLASH_RWAIT_RESET;
+    }
+
+    Flash_Apply(info.rwait, info.flags);
+}
+
+//
+// BootCommand - BOOT: "BOOT FAST|NORMAL <us>", the build and the time the
+//               boot took up to the first sample, then one "BOOT <phase>
+//               <cycles> <us>" line per phase in the order they ended (see
+//               boot.h). A phase in which SYSCLK changed has "-" for its
+//               time and is left out of the total.
+//
+void BootCommand(int argc, char *argv[])
+{
+    BOOT_PHASE phase;
+    Uint32 total;
+    Uint16 i;
+
+    if(argc != 1)
+    {
+        Cmd_Reply("ERR\n");
+        return;
+    }
+
+    total = 0;
+    for(i = 0; Boot_Phase(i, &phase) != 0; i++)
+    {
+        if(phase.us != BOOT_US_MIXED)
+        {
+            total += phase.us;
+        }
+    }
+#ifdef BOOT_FAST
+    sprintf(buff, "BOOT FAST %lu\n", (unsigned long)total);
+#else
+    sprintf(buff, "BOOT NORMAL %lu\n", (unsigned long)total);
+#endif
+    Cmd_Reply(buff);
+
+    for(i = 0; Boot_Phase(i, &phase) != 0; i++)
+    {
+        if(phase.us == BOOT_US_MIXED)
+        {
+            sprintf(buff, "BOOT %s %lu -\n", phase.name,
+                    (unsigned long)phase.cycles);
+        }
+        else
+        {
+            sprintf(buff, "BOOT %s %lu %lu\n", phase.name,
+                    (unsigned long)phase.cycles, (unsigned long)phase.us);
         }
+        Cmd_Reply(buff);
+    }
+}
+
+//
+// TimerCommand - TIMER: "TIMER <us>", the microsecond clock, then one
+//                "TIMER <timer> ON|OFF <left> <period> <fires>" line per
+//                soft timer (see timer.h): the microseconds to its next
+//                expiry and between expiries, 0 for a one-shot, and how
+//                often it expired
+//
+void TimerCommand(int argc, char *argv[])
+{
+    static const char * const names[TIMER_COUNT] =
+        {"ADC_POWER", "SETTLE", "BENCH"};
+    TIMER_STATE state;
+    Uint16 id;
+
+    if(argc != 1)
+    {
+        Cmd_Reply("ERR\n");
+        return;
     }
 
-    while( PieCtrlRegs.PIEIER9.bit.INTx4 != 0 )
+    sprintf(buff, "TIMER %llu\n", (unsigned long long)Timebase_Us());
+    Cmd_Reply(buff);
+
+    for(id = 0; id < TIMER_COUNT; id++)
     {
-        __asm(" NOP");
+        Timer_State(id, &state);
+        sprintf(buff, "TIMER %s %s %lu %lu %lu\n", names[id],
+                (state.active != 0) ? "ON" : "OFF",
+                (unsigned long)state.remainingUs,
+                (unsigned long)state.periodUs, (unsigned long)state.fires);
+        Cmd_Reply(buff);
     }
-    ESTOP0;
 }
 
-interrupt void scibTxFifoIsr(void)
+//
+// NestCommand - NEST: "NEST ON|OFF", then one "NEST <vector> <group>.<channel>
+//               <priority> <ier> <pieier>" line per entry of nestTable
+//               that nests, with the IER and own group PIEIER masks of its
+//               body in hex
+//             NEST ON|OFF: nest the interrupts by priority, or run each to
+//               its end as without the table, to compare the latencies
+//               and the jitter (ISR)
+//
+void NestCommand(int argc, char *argv[])
 {
     Uint16 i;
-    if(Tx_w_idx != Tx_r_idx)
+    Uint16 v;
+    Uint16 ier;
+    Uint16 pieier;
+
+    if(argc == 1)
     {
-        Uint16 fifo_st = 16 - ScibRegs.SCIFFTX.bit.TXFFST;
-        for(i = 0; i<fifo_st; i++)
+        sprintf(buff, "NEST %s\n", Nest_Enabled() ? "ON" : "OFF");
+        Cmd_Reply(buff);
+        for(i = 0; i < sizeof(nestTable) / sizeof(nestTable[0]); i++)
         {
-            ScibRegs.SCITXBUF.all = Txbuff[Tx_r_idx++];
-            if(Tx_r_idx >= BUFFMAX)
-            {
-                Tx_r_idx = 0;
-            }
-            if(Tx_w_idx == Tx_r_idx)
+            v = nestTable[i].vector;
+            if(Nest_Masks(v, &ier, &pieier) == 0)
             {
-                break;
+                continue;
             }
+            sprintf(buff, "NEST %u %u.%u %u %04X %04X\n", v,
+                    (v < 32) ? v : ((v < 128) ? (v - 32) / 8 + 1 :
+                                                (v - 128) / 8 + 1),
+                    (v < 32) ? 0 : ((v < 128) ? (v - 32) % 8 + 1 :
+                                                (v - 128) % 8 + 9),
+                    nestTable[i].priority, ier, pieier);
+            Cmd_Reply(buff);
         }
+        return;
+    }
+
+    if((argc == 2) && (strcmp(argv[1], "ON") == 0))
+    {
+        Nest_Enable(1);
+    }
+    else if((argc == 2) && (strcmp(argv[1], "OFF") == 0))
+    {
+        Nest_Enable(0);
     }
     else
     {
-        PieCtrlRegs.PIEIER9.bit.INTx4=0;     // PIE Group 9, INT4 SCIB_TX
+        Cmd_Reply("ERR\n");
+        return;
+    }
+    Cmd_Reply("OK\n");
+}
+
+//
+// MemWriteReply - Report how the last MEM WR ended, once
+//
+void MemWriteReply(void)
+{
+    switch(Mem_WriteResult())
+    {
+        case MEM_WR_OK:      Cmd_Reply("MEM WR OK\n"); break;
+        case MEM_WR_CRC:     Cmd_Reply("MEM WR CRC\n"); break;
+        case MEM_WR_TIMEOUT: Cmd_Reply("MEM WR TIMEOUT\n"); break;
+        default:             break;
     }
+}
 
-    ScibRegs.SCIFFTX.bit.TXFFINTCLR=1;  // Clear SCI Interrupt flag
-    PieCtrlRegs.PIEACK.all|=0x100;      // Issue PIE ACK
+//
+// SciStatusReady - Nonzero when a status frame is due
+//
+Uint16 SciStatusReady(void)
+{
+    return (sciStatusOn != 0) &&
+           ((sciStatusPeriod == 0) ||
+            ((Timebase_Now() - sciStatusTime) >= sciStatusPeriod));
 }
 
-interrupt void scibRxFifoIsr(void)
+//
+// SciStatusFrame - Frame the receive error counts of the open ports as a
+//                  TLM_TYPE_SCI_STATUS frame and queue it. The STATUS
+//                  stream of the scheduler.
+//
+void SciStatusFrame(void)
 {
+    Uint16 *payload;
+    Uint16 *q;
+    Uint16 port;
     Uint16 i;
-    Uint16 fifo_st = ScibRegs.SCIFFRX.bit.RXFFST;
+    Uint16 n;
+    Uint32 count[TLM_SCI_STATUS_COUNTS];
+    SCI_ERRORS err;
 
-    for(i=0;i<fifo_st;i++)
+    sciStatusTime = Timebase_Now();
+    sciStatusOn = (sciStatusPeriod != 0);
+
+    payload = Tlm_Begin(TLM_TYPE_SCI_STATUS);
+    q = payload + 1;
+    n = 0;
+    for(port = 0; port < SCI_PORTS; port++)
     {
-        Rxbuff[Rx_w_idx++]=ScibRegs.SCIRXBUF.all;  // Read data
-        if(Rx_w_idx >= BUFFMAX)
+        if(Sci_IsOpen(port) == 0)
         {
-            Rx_w_idx = 0;
+            continue;
         }
-        if(Rx_w_idx == Rx_r_idx)
+        Sci_Errors(port, &err);
+        count[0] = err.overrun;
+        count[1] = err.framing;
+        count[2] = err.parity;
+        count[3] = err.brk;
+        count[4] = err.fifoOverflow;
+        count[5] = err.ringDropped;
+        count[6] = err.resets;
+        count[7] = Sci_RxCount(port);
+        *q++ = port;
+        for(i = 0; i < TLM_SCI_STATUS_COUNTS; i++)
         {
-            Rx_w_idx--;
-            if(Rx_w_idx < 0)
-            {
-                Rx_w_idx = BUFFMAX;
-            }
-            break;
+            *q++ = count[i] & 0xFF;
+            *q++ = (count[i] >> 8) & 0xFF;
+            *q++ = (count[i] >> 16) & 0xFF;
+            *q++ = count[i] >> 24;
+        }
+        n++;
+    }
+    payload[0] = n;
+    Tlm_Commit(1 + n * TLM_SCI_STATUS_PORT_LEN);
+}
+
+//
+// ParseRange - Address (hexadecimal) and word count (decimal) of
+//              argv[2] and argv[3]. Returns 0 if either is malformed.
+//
+Uint16 ParseRange(char *argv[], Uint32 *addr, Uint32 *words)
+{
+    char *end;
+
+    *addr = (Uint32)strtoul(argv[2], &end, 16);
+    if((end == argv[2]) || (*end != '\0'))
+    {
+        return 0;
+    }
+    *words = (Uint32)strtoul(argv[3], &end, 10);
+    return (end != argv[3]) && (*end == '\0');
+}
+
+//
+// ParsePorts - Port mask from port letters such as "BCD". Returns 0xFFFF if
+//              a letter is not an open port.
+//
+Uint16 ParsePorts(const char *names)
+{
+    Uint16 mask;
+    Uint16 port;
+
+    mask = 0;
+    for(; *names != '\0'; names++)
+    {
+        port = *names - 'A';
+        if(Sci_IsOpen(port) == 0)
+        {
+            return 0xFFFF;
+        }
+        mask |= 1U << port;
+    }
+    return mask;
+}
+
+//
+// PortNames - Port letters of a mask, "-" for none
+//
+void PortNames(Uint16 mask, char *names)
+{
+    Uint16 port;
+
+    for(port = 0; port < SCI_PORTS; port++)
+    {
+        if(mask & (1U << port))
+        {
+            *names++ = 'A' + port;
         }
     }
+    if(mask == 0)
+    {
+        *names++ = '-';
+    }
+    *names = '\0';
+}
 
-    ScibRegs.SCIFFRX.bit.RXFFOVRCLR=1;   // Clear Overflow flag
-    ScibRegs.SCIFFRX.bit.RXFFINTCLR=1;   // Clear Interrupt flag
+//
+// TxPort - The first data port, where the capture text goes
+//
+Uint16 TxPort(void)
+{
+    Uint16 port;
 
-    PieCtrlRegs.PIEACK.all|=0x100;       // Issue PIE ack
+    for(port = 0; port < SCI_PORTS - 1; port++)
+    {
+        if(Tlm_Ports() & (1U << port))
+        {
+            break;
+        }
+    }
+    return port;
 }
 
-void scib_fifo_init()
+//
+// TxPut - Queue len characters of capture data on the first data port.
+//         Returns 0 and queues nothing if its ring does not have room for
+//         all of them.
+//
+int TxPut(const char *data, int len)
 {
-   ScibRegs.SCICCR.all =0x0007;   // 1 stop bit,  No loopback
-                                  // No parity,8 char bits,
-                                  // async mode, idle-line protocol
-   ScibRegs.SCICTL1.all =0x0003;  // enable TX, RX, internal SCICLK,
-                                  // Disable RX ERR, SLEEP, TXWAKE
-   ScibRegs.SCICTL2.bit.TXINTENA =1;
-   ScibRegs.SCICTL2.bit.RXBKINTENA =1;
+    Uint16 port;
 
-   // SCIC at115200 baud
-   ScibRegs.SCIHBAUD.all = 0x0000;
-   ScibRegs.SCILBAUD.all = 53;
-   ScibRegs.SCIFFTX.all=0xC020; // EMPTY INT
-   ScibRegs.SCIFFRX.all=0x0021; //@one char INT
-   ScibRegs.SCIFFCT.all=0x00;
+    port = TxPort();
+    if(port == Arq_Port())
+    {
+        return Arq_Put(data, len);
+    }
+    return Sci_Put(port, data, len);
+}
 
-   ScibRegs.SCICTL1.all =0x0023;     // Relinquish SCI from Reset
-   ScibRegs.SCIFFTX.bit.TXFIFORESET=1;
-   ScibRegs.SCIFFRX.bit.RXFIFORESET=1;
+//
+// TxWrite - Queue a string on the command port, waiting for room
+//
+void TxWrite(const char *s)
+{
+    Sci_Write(cmdPort, s);
+}
 
+//
+// RxGet - Take one received character from the command port. Returns -1
+//         if there is none.
+//
+int RxGet(void)
+{
+    if(cmdPort == Arq_Port())
+    {
+        return Arq_GetChar();
+    }
+    return Sci_GetChar(cmdPort);
 }
 
 //
 // adca1_isr - This is called after the very first conversion and will disable
 //             the ePWM SOC to avoid re-triggering problems.
 //
-#pragma CODE_SECTION(adca1_isr, ".TI.ramfunc");
+HOT_FUNC(adca1_isr)
 __interrupt void adca1_isr(void)
 {
+    ISRPROF_ENTER();
+    Uint16 socCount = EPwm2Regs.TBCTR;  // ePWM2 counts since the SOC
+
+    captureStartTime = Timebase_Now();
+    BOOT_MARK_LAST(BOOT_FIRST_SAMPLE);
+
     //
     // Remove ePWM trigger
     //
@@ -480,6 +2951,11 @@ __interrupt void adca1_isr(void)
     // Acknowledge
     //
     PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+
+    //
+    // The latency is counted from the SOC and includes the conversion
+    //
+    ISRPROF_EXIT_AGE(ISRPROF_ADCA1, (Uint32)socCount * EPWM_CYCLES);
 }
 
 //
@@ -487,9 +2963,31 @@ __interrupt void adca1_isr(void)
 //              are stopped by removing the trigger of the first SOC from
 //              the last.
 //
-#pragma CODE_SECTION(dmach1_isr, ".TI.ramfunc");
+HOT_FUNC(dmach1_isr)
 __interrupt void dmach1_isr(void)
 {
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    if(streaming != 0)
+    {
+        //
+        // CH1 has started on a half; point its shadow at the other one
+        //
+        streamNext[0] ^= 1;
+        EALLOW;
+        DmaRegs.CH1.DST_BEG_ADDR_SHADOW =
+            (Uint32)&adcData0[streamNext[0] * STREAM_BLOCK_SIZE];
+        DmaRegs.CH1.DST_ADDR_SHADOW =
+            (Uint32)&adcData0[streamNext[0] * STREAM_BLOCK_SIZE];
+        EDIS;
+
+        PieCtrlRegs.PIEACK.all = PIEACK_GROUP7;
+        NEST_EXIT();
+        ISRPROF_EXIT(ISRPROF_DMA_CH1);
+        return;
+    }
+
     //
     // Stop the ADC by removing the trigger for SOC0
     //
@@ -498,12 +2996,56 @@ __interrupt void dmach1_isr(void)
     AdcbRegs.ADCINTSOCSEL1.bit.SOC0 = 0;
     EDIS;
 
-    done = 1;
+    captureEndTime = Timebase_Now();
+    Work_Post(WORK_DMA_CH1, CaptureDone, 0);
+    LOG1(LOG_CAPTURE_DONE, "capture done in %lu cycles",
+         captureEndTime - captureStartTime);
 
     //
     // Acknowledge
     //
     PieCtrlRegs.PIEACK.all = PIEACK_GROUP7;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_DMA_CH1);
+}
+
+//
+// dmach2_isr - Only used while streaming. CH2 is serviced after CH1 on the
+//              same trigger, so when it starts a new half both channels
+//              have finished the previous one, which is queued for
+//              ProcessStreamBlock(). An overrun is a half finished while
+//              the one before is still queued or being decimated.
+//
+HOT_FUNC(dmach2_isr)
+__interrupt void dmach2_isr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    if(streamFill != STREAM_NONE)
+    {
+        if(Work_Pending(WORK_DMA_CH2) != 0)
+        {
+            streamOverruns++;
+            LOG1(LOG_STREAM_OVERRUN, "stream overrun at block %lu",
+                 streamBlocks);
+        }
+        Work_Post(WORK_DMA_CH2, ProcessStreamBlock, streamFill);
+        streamBlocks++;
+    }
+    streamFill = streamNext[1];
+
+    streamNext[1] ^= 1;
+    EALLOW;
+    DmaRegs.CH2.DST_BEG_ADDR_SHADOW =
+        (Uint32)&adcData1[streamNext[1] * STREAM_BLOCK_SIZE];
+    DmaRegs.CH2.DST_ADDR_SHADOW =
+        (Uint32)&adcData1[streamNext[1] * STREAM_BLOCK_SIZE];
+    EDIS;
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP7;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_DMA_CH2);
 }
 
 
@@ -545,11 +3087,53 @@ void ConfigureEPWM(void)
     EPwm2Regs.ETCNTINITCTL.bit.SOCAINITEN = 1;
 }
 
+//
+// SetAdcMode - Configure both ADCs for continuous conversions at the given
+//              resolution and signal mode on one input (pair) and update
+//              the sample width the processing uses. Returns 0 and changes
+//              nothing if the combination is not supported.
+//
+Uint16 SetAdcMode(Uint16 resolution, Uint16 signalMode, Uint16 channel)
+{
+    if(((resolution == ADC_RESOLUTION_16BIT) &&
+        (signalMode != ADC_SIGNALMODE_DIFFERENTIAL)) ||
+       (AdcChannelValid(signalMode, channel) == 0))
+    {
+        return 0;
+    }
+
+    ConfigureADC(resolution, signalMode);
+    SetupADCContinuous(&AdcaRegs, channel);
+    SetupADCContinuous(&AdcbRegs, channel);
+
+    adcResolution = resolution;
+    adcSignalMode = signalMode;
+    adcChannel = channel;
+    adcBits = (resolution == ADC_RESOLUTION_16BIT) ? 16 : 12;
+    adcFullScale = (1U << adcBits) - 1;
+    AdcCal_Init(adcFullScale, signalMode);
+    return 1;
+}
+
+//
+// AdcChannelValid - Check an input of ADCA and ADCB. Single-ended inputs
+//                   are ADCIN0-5 and the shared ADCIN14/15; differential
+//                   pairs are selected by their even (+) input.
+//
+Uint16 AdcChannelValid(Uint16 signalMode, Uint16 channel)
+{
+    if(signalMode == ADC_SIGNALMODE_DIFFERENTIAL)
+    {
+        return ((channel & 1) == 0) && ((channel <= 4) || (channel == 14));
+    }
+    return (channel <= 5) || (channel == 14) || (channel == 15);
+}
+
 //
 // ConfigureADC - Write ADC configurations and power up the ADC for both
 //                ADC A and ADC B
 //
-void ConfigureADC(void)
+void ConfigureADC(Uint16 resolution, Uint16 signalMode)
 {
     EALLOW;
 
@@ -562,8 +3146,8 @@ void ConfigureADC(void)
     //
     // Set mode
     //
-    AdcSetMode(ADC_ADCA, ADC_RESOLUTION_12BIT, ADC_SIGNALMODE_SINGLE);
-    AdcSetMode(ADC_ADCB, ADC_RESOLUTION_12BIT, ADC_SIGNALMODE_SINGLE);
+    AdcSetMode(ADC_ADCA, resolution, signalMode);
+    AdcSetMode(ADC_ADCB, resolution, signalMode);
 
     //
     // Set pulse positions to late
@@ -572,15 +3156,12 @@ void ConfigureADC(void)
     AdcbRegs.ADCCTL1.bit.INTPULSEPOS = 1;
 
     //
-    // Power up the ADC
+    // Power up the ADC. The conversions wait 1ms from here for the ADCs to
+    // power up (TIMER_ADC_POWER); the setup goes on meanwhile.
     //
     AdcaRegs.ADCCTL1.bit.ADCPWDNZ = 1;
     AdcbRegs.ADCCTL1.bit.ADCPWDNZ = 1;
-
-    //
-    // Delay for 1ms to allow ADCs time to power up
-    //
-    DELAY_US(1000);
+    Timer_Start(TIMER_ADC_POWER, ADC_POWERUP_US, 0, 0, 0);
 
     EDIS;
 }
@@ -593,9 +3174,10 @@ void SetupADCContinuous(volatile struct ADC_REGS * adcRegs, Uint16 channel)
     Uint16 acqps;
 
     //
-    // Determine minimum acquisition window (in SYSCLKS) based on resolution
+    // Determine minimum acquisition window (in SYSCLKS) based on the
+    // resolution of the ADC being set up
     //
-    if(ADC_RESOLUTION_12BIT == AdcaRegs.ADCCTL2.bit.RESOLUTION)
+    if(ADC_RESOLUTION_12BIT == adcRegs->ADCCTL2.bit.RESOLUTION)
     {
         acqps = 14; // 75ns
     }
@@ -637,6 +3219,7 @@ void SetupADCContinuous(volatile struct ADC_REGS * adcRegs, Uint16 channel)
     adcRegs->ADCSOC5CTL.bit.ACQPS  = acqps;
     adcRegs->ADCSOC6CTL.bit.ACQPS  = acqps;
     adcRegs->ADCSOC7CTL.bit.ACQPS  = acqps;
+    adcRegs->ADCSOC8CTL.bit.ACQPS  = acqps;
     adcRegs->ADCSOC9CTL.bit.ACQPS  = acqps;
     adcRegs->ADCSOC10CTL.bit.ACQPS = acqps;
     adcRegs->ADCSOC11CTL.bit.ACQPS = acqps;
@@ -685,14 +3268,44 @@ void SetupADCContinuous(volatile struct ADC_REGS * adcRegs, Uint16 channel)
 
 //
 // DMAInit - Initialize DMA ch 1 to transfer ADCA results and DMA ch 2 to
-//           transfer ADCB results
-//
-void DMAInit(void)
+//           transfer ADCB results. For a capture (stream = 0) the channels
+//           fill the results buffers once and CH1 interrupts at the end.
+//           For streaming they run continuously over one half of the
+//           buffers at a time and both interrupt at the start of each
+//           half, which is when the next half can be set in the shadow
+//           address registers.
+//
+void DMAInit(Uint16 stream)
 {
+    Uint16 bursts;
+    Uint16 cont;
+    Uint16 chintMode;
+    Uint16 ch2Int;
+
+    if(stream != 0)
+    {
+        bursts = STREAM_BLOCK_SIZE >> 4;
+        cont = CONT_ENABLE;
+        chintMode = CHINT_BEGIN;
+        ch2Int = CHINT_ENABLE;
+    }
+    else
+    {
+        bursts = RESULTS_BUFFER_SIZE >> 4;
+        cont = CONT_DISABLE;
+        chintMode = CHINT_END;
+        ch2Int = CHINT_DISABLE;
+    }
+
     //
-    // Initialize DMA
+    // Stop both channels; the rest of the DMA (the SPI link) keeps running
     //
-    DMAInitialize();
+    EALLOW;
+    DmaRegs.CH1.CONTROL.bit.HALT = 1;
+    DmaRegs.CH2.CONTROL.bit.HALT = 1;
+    DmaRegs.CH1.CONTROL.bit.SOFTRESET = 1;
+    DmaRegs.CH2.CONTROL.bit.SOFTRESET = 1;
+    EDIS;
 
     //
     // DMA set up for first ADC
@@ -706,17 +3319,17 @@ void DMAInit(void)
     // Enable the DMA channel 1 interrupt
     //
     DMACH1BurstConfig(15, 2, 2);
-    DMACH1TransferConfig((RESULTS_BUFFER_SIZE >> 4) - 1, -14, 2);
+    DMACH1TransferConfig(bursts - 1, -14, 2);
     DMACH1ModeConfig(
                         DMA_ADCAINT2,
                         PERINT_ENABLE,
                         ONESHOT_DISABLE,
-                        CONT_DISABLE,
+                        cont,
                         SYNC_DISABLE,
                         SYNC_SRC,
                         OVRFLOW_DISABLE,
                         THIRTYTWO_BIT,
-                        CHINT_END,
+                        chintMode,
                         CHINT_ENABLE
                     );
 
@@ -730,18 +3343,18 @@ void DMAInit(void)
     // transferred 32 bits at a time hence the address steps below.
     //
     DMACH2BurstConfig(15, 2, 2);
-    DMACH2TransferConfig((RESULTS_BUFFER_SIZE >> 4) - 1, -14, 2);
+    DMACH2TransferConfig(bursts - 1, -14, 2);
     DMACH2ModeConfig(
                         DMA_ADCAINT2,
                         PERINT_ENABLE,
                         ONESHOT_DISABLE,
-                        CONT_DISABLE,
+                        cont,
                         SYNC_DISABLE,
                         SYNC_SRC,
                         OVRFLOW_DISABLE,
                         THIRTYTWO_BIT,
-                        CHINT_END,
-                        CHINT_DISABLE
+                        chintMode,
+                        ch2Int
                     );
 }
 
@@ -0,0 +1,65 @@
+/*
+//###########################################################################
+//
+// FILE:   adc_soc_continuous_dma_cpu01.cmd
+//
+// TITLE:  Project sections, linked together with the C2000Ware
+//         2837xS_Generic_RAM_lnk.cmd or 2837xS_Generic_FLASH_lnk.cmd.
+//
+// The generic command files place only ramgs0 and ramgs1; the project's
+// own data in the other GS RAM blocks is placed here. The MEMORY ranges
+// are those of the generic files. .ebss stays in the 2K words of RAMLS5
+// the generic files give it, so the large tables are moved out of it into
+// ramgs4 and ramgs5 (DATA_SECTION in their modules).
+//
+// The RAM build has .econst, strings included, and the code in RAM as
+// well, more of both than RAMLS5 and the LS and D blocks hold. Their
+// input sections are taken into GS blocks here: an input section goes to
+// the first specification that names it, and this file is linked ahead of
+// the generic one, whose .text and .econst are then left empty.
+//
+// hotfuncs holds the functions annotated HOT_FUNC() (hot.h). The CPU1_FLASH
+// configuration links with --define=_FLASH: there the section is loaded
+// to flash and runs from one of the RAM blocks the generic file leaves
+// free, copied by Hot_Init(). In the RAM build it is linked straight into
+// the same blocks, the code being in RAM already. A section with its own
+// run address is not split, so in the FLASH build all of hotfuncs must fit
+// one 2K-word block: host/ram_report lists what landed where and fails
+// when it comes within 128 words of that.
+//
+//###########################################################################
+*/
+
+SECTIONS
+{
+   ramgs2           : > RAMGS2,    PAGE = 1     /* ARQ segments (arq.c) */
+   faultRecord      : > RAMGS3,    PAGE = 1, type = NOINIT
+                                                /* Crash record kept over
+                                                   resets (fault.c) */
+   ramgs4           : > RAMGS4,    PAGE = 1     /* Tables kept out of
+                                                   .ebss */
+   ramgs5           : > RAMGS5,    PAGE = 1     /* ARQ segment state
+                                                   (arq.c) */
+#ifdef _FLASH
+   hotfuncs         : LOAD = FLASHD | FLASHE,
+                      RUN = RAMLS1 | RAMLS2 | RAMLS3 | RAMD0,
+                      LOAD_START(_HotfuncsLoadStart),
+                      LOAD_SIZE(_HotfuncsLoadSize),
+                      RUN_START(_HotfuncsRunStart),
+                      PAGE = 0, ALIGN(4)        /* Hot paths (hot.c) */
+#else
+   hotfuncs         : >> RAMD0 | RAMLS0 | RAMLS1 | RAMLS2 | RAMLS3 | RAMLS4,
+                      PAGE = 0
+   ramconst         : { *(.econst) } >> RAMGS6 | RAMD1,
+                      PAGE = 1                  /* .econst */
+   ramtext          : { *(.text) } >> RAMGS7 | RAMGS8 | RAMGS9 | RAMGS10 |
+                                      RAMGS11,
+                      PAGE = 1                  /* .text */
+#endif
+}
+
+/*
+//===========================================================================
+// End of file.
+//===========================================================================
+*/
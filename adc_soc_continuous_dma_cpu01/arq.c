@@ -0,0 +1,660 @@
+//###########################################################################
+//
+// FILE:   arq.c
+//
+// TITLE:  Reliable byte stream over one SCI port (selective repeat ARQ).
+//
+// A byte lost on a serial line either breaks a telemetry frame (caught by
+// its CRC, the frame is gone) or, in the CSV output, silently shifts every
+// following value. With ARQ ON <port> everything sent on that port's data
+// path (Tlm frames and the CSV lines) goes through this module instead of
+// straight into the SCI ring, and the host peer (host/arq_peer) hands the
+// bytes on complete and in order.
+//
+//   Arq_Put()  - cuts the byte stream into numbered segments of
+//                Arq_Segment() bytes, kept in arqBuf until acknowledged
+//   Arq_Poll() - background loop: reads the ACKs, sends lost segments
+//                again and new ones as the SCI ring takes them
+//
+// The peer acknowledges every segment it receives with the next segment
+// it needs and a map of the 128 after it. A segment is sent again as soon
+// as a segment sent after it is acknowledged without it (the line does
+// not reorder, so it was lost), or after Arq_Timeout() ms without an
+// acknowledgement, which only happens when the last segments of a burst
+// or all ACKs for a while are lost. Lost segments are recovered in about
+// one round trip while the other segments of the window keep the line
+// busy, so losses cost only the bytes sent again. When the window is full
+// anyway, the line time is used to send the unacknowledged segment sent
+// longest ago once more.
+//
+// The window must cover the line's bandwidth-delay product plus the
+// recovery of the losses: a segment lost twice holds the window start for
+// two more round trips while the line goes on with the segments after it.
+// At 921600 baud, with about 3 ms in the SCI ring and some 20 ms of USB
+// adapter and host latency, some 2 KB are unacknowledged at any time, and
+// at 1% byte loss half of the 64 byte segments are lost on their way, some
+// of them several times. The held segments are kept two bytes per word in
+// arqBuf, ARQ_BUF_LEN words filling GS RAM block 2 (section ramgs2, see
+// the project linker command file), as many as fit at the set segment
+// size up to ARQ_WINDOW_MAX: 8 KB, about four round trips at 921600 baud,
+// at the default 64 bytes. A segment is framed into arqTx when it is sent.
+//
+// Bytes received on the port that are not ACK frames (commands when the
+// ARQ port is also the command port) are kept for Arq_GetChar().
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "sci.h"
+#include "tlm.h"
+#include "arq.h"
+#include "timebase.h"
+
+//
+// Defines
+//
+#define ARQ_DATA        (TLM_HEADER_LEN + 1)    // First data word of a frame
+#define ARQ_IDLE_LEVEL  16      // Close a partial segment once the SCI ring
+                                // holds less than this
+#define ARQ_RX_LEN      32      // Non-ACK bytes kept (power of two)
+#define ARQ_ACKED       0x0001
+#define ARQ_RETX        0x0002
+
+//
+// Function Prototypes
+//
+static Uint16 Arq_Slot(Uint16 n);
+static void Arq_CloseSegment(void);
+static Uint16 Arq_Transmit(Uint16 n);
+static void Arq_Receive(void);
+static void Arq_Ack(void);
+
+//
+// Globals
+//
+#pragma DATA_SECTION(arqBuf, "ramgs2");
+#pragma DATA_SECTION(arqLen, "ramgs5");
+#pragma DATA_SECTION(arqFlags, "ramgs5");
+#pragma DATA_SECTION(arqTxOrder, "ramgs5");
+#pragma DATA_SECTION(arqTxTime, "ramgs5");
+#pragma DATA_SECTION(arqTx, "ramgs5");
+Uint16 arqBuf[ARQ_BUF_LEN];         // arqWindow slots of arqStride words,
+                                    // two data bytes per word
+Uint16 arqLen[ARQ_WINDOW_MAX];      // Frame bytes of each held segment
+Uint16 arqFlags[ARQ_WINDOW_MAX];
+Uint32 arqTxOrder[ARQ_WINDOW_MAX];  // arqTxCount at the last transmission
+Uint32 arqTxTime[ARQ_WINDOW_MAX];
+Uint16 arqPort;
+Uint16 arqSegLen;
+Uint16 arqStride;                   // Words per slot
+Uint16 arqWindow;                   // Slots, segments held at most
+Uint16 arqBaseSlot;                 // Slot of arqBase
+Uint16 arqRtoMs;
+Uint32 arqRto;                      // Cycles
+Uint16 arqBase;                     // Oldest unacknowledged segment
+Uint16 arqSendNext;                 // First segment never sent
+Uint16 arqNext;                     // Segment being filled
+Uint16 arqFill;                     // Bytes in it
+Uint32 arqTxCount;
+Uint32 arqAckedOrder;               // Latest transmission acknowledged
+Uint16 arqTx[ARQ_SLOT_LEN];         // Frame being queued, a byte per word
+Uint16 arqAck[ARQ_ACK_FRAME_LEN];
+Uint16 arqAckLen;
+Uint16 arqRx[ARQ_RX_LEN];
+Uint16 arqRxHead;
+Uint16 arqRxTail;
+ARQ_STATS arqStats;
+
+//
+// Arq_Init - Start closed, with the default segment size and timeout
+//
+void Arq_Init(void)
+{
+    arqPort = ARQ_NO_PORT;
+    Arq_SetSegment(ARQ_SEG_DEFAULT);
+    Arq_SetTimeout(ARQ_RTO_MS_DEFAULT);
+    Arq_ClearStats();
+}
+
+//
+// Arq_Open - Start a new session on an open port, numbering from 0. The
+//            peer follows by the base of the first segment it gets.
+//            Returns 0 if the port is not open.
+//
+Uint16 Arq_Open(Uint16 port)
+{
+    Uint16 i;
+
+    if((port >= SCI_PORTS) || (Sci_IsOpen(port) == 0))
+    {
+        return 0;
+    }
+
+    for(i = 0; i < ARQ_WINDOW_MAX; i++)
+    {
+        arqFlags[i] = 0;
+    }
+    arqBase = 0;
+    arqBaseSlot = 0;
+    arqSendNext = 0;
+    arqNext = 0;
+    arqFill = 0;
+    arqTxCount = 0;
+    arqAckedOrder = 0;
+    arqAckLen = 0;
+    arqRxHead = 0;
+    arqRxTail = 0;
+    arqPort = port;
+    return 1;
+}
+
+//
+// Arq_Close - Return the port to plain SCI output. Segments not yet
+//             acknowledged are dropped.
+//
+void Arq_Close(void)
+{
+    arqPort = ARQ_NO_PORT;
+}
+
+//
+// Arq_Port - The port carrying the ARQ session, ARQ_NO_PORT if closed
+//
+Uint16 Arq_Port(void)
+{
+    return arqPort;
+}
+
+//
+// Arq_SetSegment - Data bytes per segment, ARQ_SEG_MIN..ARQ_SEG_MAX, and
+//                  the window, as many of them as arqBuf holds. Short
+//                  segments lose less to a lost byte, long ones less to the
+//                  framing. Returns 0 and changes nothing while open.
+//
+Uint16 Arq_SetSegment(Uint16 len)
+{
+    if((arqPort != ARQ_NO_PORT) || (len < ARQ_SEG_MIN) || (len > ARQ_SEG_MAX))
+    {
+        return 0;
+    }
+    arqSegLen = len;
+    arqStride = (len + 1) / 2;
+    arqWindow = ARQ_BUF_LEN / arqStride;
+    if(arqWindow > ARQ_WINDOW_MAX)
+    {
+        arqWindow = ARQ_WINDOW_MAX;
+    }
+    return 1;
+}
+
+//
+// Arq_Segment - Data bytes per segment
+//
+Uint16 Arq_Segment(void)
+{
+    return arqSegLen;
+}
+
+//
+// Arq_Window - Segments held for retransmission at the segment size
+//
+Uint16 Arq_Window(void)
+{
+    return arqWindow;
+}
+
+//
+// Arq_SetTimeout - Retransmission timeout in ms, at least the round trip
+//                  through the SCI ring and the host. Returns 0 and changes
+//                  nothing if ms is outside 1..ARQ_RTO_MS_MAX.
+//
+Uint16 Arq_SetTimeout(Uint16 ms)
+{
+    if((ms == 0) || (ms > ARQ_RTO_MS_MAX))
+    {
+        return 0;
+    }
+    arqRtoMs = ms;
+    arqRto = (Uint32)ms * (TIMEBASE_HZ / 1000);
+    return 1;
+}
+
+//
+// Arq_Timeout - Retransmission timeout in ms
+//
+Uint16 Arq_Timeout(void)
+{
+    return arqRtoMs;
+}
+
+//
+// Arq_Space - Bytes Arq_Put() takes now
+//
+Uint16 Arq_Space(void)
+{
+    Uint16 used;
+
+    if(arqPort == ARQ_NO_PORT)
+    {
+        return 0;
+    }
+    used = arqNext - arqBase;
+    if(used >= arqWindow)
+    {
+        return 0;
+    }
+    return (arqWindow - used) * arqSegLen - arqFill;
+}
+
+//
+// Arq_InFlight - Segments held, sent or not, that are not acknowledged yet
+//
+Uint16 Arq_InFlight(void)
+{
+    return arqNext - arqBase + (arqFill != 0);
+}
+
+//
+// Arq_Put - Append len characters (their low 8 bits) to the stream.
+//           Returns 0 and takes nothing if there is no room for all of
+//           them, like Sci_Put().
+//
+int Arq_Put(const char *data, int len)
+{
+    Uint16 *slot;
+    Uint16 n;
+    Uint16 i;
+
+    if(len > (int)Arq_Space())
+    {
+        return 0;
+    }
+
+    while(len > 0)
+    {
+        slot = &arqBuf[Arq_Slot(arqNext) * arqStride];
+        n = arqSegLen - arqFill;
+        if(n > len)
+        {
+            n = len;
+        }
+        for(i = arqFill; i < arqFill + n; i++)
+        {
+            if((i & 1) == 0)
+            {
+                slot[i >> 1] = ((Uint16)*data++ & 0xFF) << 8;
+            }
+            else
+            {
+                slot[i >> 1] |= (Uint16)*data++ & 0xFF;
+            }
+        }
+        arqFill += n;
+        len -= n;
+        arqStats.bytes += n;
+
+        if(arqFill == arqSegLen)
+        {
+            Arq_CloseSegment();
+        }
+    }
+    return 1;
+}
+
+//
+// Arq_Poll - Take in the ACKs, then fill the SCI ring: segments lost or
+//            timed out first, oldest first, then new ones. A partly
+//            filled segment is closed and sent when the line is about to
+//            go idle.
+//
+void Arq_Poll(void)
+{
+    Uint16 n;
+    Uint16 s;
+    Uint16 oldest;
+    Uint32 now;
+
+    if(arqPort == ARQ_NO_PORT)
+    {
+        return;
+    }
+
+    Arq_Receive();
+
+    now = Timebase_Now();
+    s = arqBaseSlot;
+    for(n = arqBase; n != arqSendNext; n++)
+    {
+        if((arqFlags[s] == 0) && ((now - arqTxTime[s]) > arqRto))
+        {
+            arqFlags[s] = ARQ_RETX;
+            arqStats.timeouts++;
+        }
+        if(++s == arqWindow)
+        {
+            s = 0;
+        }
+    }
+
+    s = arqBaseSlot;
+    for(n = arqBase; n != arqSendNext; n++)
+    {
+        if(arqFlags[s] & ARQ_RETX)
+        {
+            if(Arq_Transmit(n) == 0)
+            {
+                return;
+            }
+            arqStats.retransmits++;
+        }
+        if(++s == arqWindow)
+        {
+            s = 0;
+        }
+    }
+
+    if((arqFill != 0) && (arqSendNext == arqNext) &&
+       (Sci_TxSpace(arqPort) > SCI_TX_LEN - ARQ_IDLE_LEVEL))
+    {
+        Arq_CloseSegment();
+    }
+
+    while(arqSendNext != arqNext)
+    {
+        if(Arq_Transmit(arqSendNext) == 0)
+        {
+            return;
+        }
+        arqSendNext++;
+        arqStats.segments++;
+    }
+
+    //
+    // With the window full the line would go idle until an ACK opens it.
+    // Use that time to send the unacknowledged segment sent longest ago
+    // once more: the window start is most often held by a segment lost
+    // again, and this sends it again before its loss is seen.
+    //
+    if(((Uint16)(arqSendNext - arqBase) == arqWindow) &&
+       (Sci_TxSpace(arqPort) > SCI_TX_LEN - ARQ_IDLE_LEVEL))
+    {
+        oldest = arqSendNext;
+        s = arqBaseSlot;
+        for(n = arqBase; n != arqSendNext; n++)
+        {
+            if(((arqFlags[s] & ARQ_ACKED) == 0) &&
+               ((oldest == arqSendNext) ||
+                (arqTxOrder[s] < arqTxOrder[Arq_Slot(oldest)])))
+            {
+                oldest = n;
+            }
+            if(++s == arqWindow)
+            {
+                s = 0;
+            }
+        }
+        if((oldest != arqSendNext) && (Arq_Transmit(oldest) != 0))
+        {
+            arqStats.retransmits++;
+        }
+    }
+}
+
+//
+// Arq_GetChar - Take one byte received on the port outside the ACK frames.
+//               Returns -1 if there is none.
+//
+int Arq_GetChar(void)
+{
+    int c;
+
+    if(arqRxTail == arqRxHead)
+    {
+        return -1;
+    }
+    c = arqRx[arqRxTail];
+    arqRxTail = (arqRxTail + 1) & (ARQ_RX_LEN - 1);
+    return c;
+}
+
+//
+// Arq_RxReady - Nonzero while Arq_GetChar() has a byte
+//
+Uint16 Arq_RxReady(void)
+{
+    return arqRxTail != arqRxHead;
+}
+
+//
+// Arq_GetStats - Counters since the last Arq_ClearStats()
+//
+void Arq_GetStats(ARQ_STATS *stats)
+{
+    *stats = arqStats;
+}
+
+//
+// Arq_ClearStats - Restart the counters
+//
+void Arq_ClearStats(void)
+{
+    arqStats.bytes = 0;
+    arqStats.segments = 0;
+    arqStats.retransmits = 0;
+    arqStats.timeouts = 0;
+    arqStats.acks = 0;
+    arqStats.badAcks = 0;
+}
+
+//
+// Arq_Slot - Slot of held segment n. The slots are used in turn, so it
+//            follows from the slot of the window start.
+//
+static Uint16 Arq_Slot(Uint16 n)
+{
+    Uint16 s;
+
+    s = arqBaseSlot + (Uint16)(n - arqBase);
+    return (s >= arqWindow) ? s - arqWindow : s;
+}
+
+//
+// Arq_CloseSegment - Finish the segment being filled; it is sent by the
+//                    next Arq_Poll()
+//
+static void Arq_CloseSegment(void)
+{
+    Uint16 s;
+
+    s = Arq_Slot(arqNext);
+    arqLen[s] = arqFill + ARQ_OVERHEAD;
+    arqFlags[s] = 0;
+    arqFill = 0;
+    arqNext++;
+}
+
+//
+// Arq_Transmit - Frame segment n with the current base in arqTx and queue
+//                it whole. Returns 0 if the SCI ring has no room for it.
+//
+static Uint16 Arq_Transmit(Uint16 n)
+{
+    const Uint16 *slot;
+    Uint16 s;
+    Uint16 len;
+    Uint16 crc;
+    Uint16 i;
+
+    s = Arq_Slot(n);
+    if(Sci_TxSpace(arqPort) < arqLen[s])
+    {
+        return 0;
+    }
+
+    slot = &arqBuf[s * arqStride];
+    len = arqLen[s] - ARQ_OVERHEAD + 1;     // base and data
+    arqTx[0] = TLM_SYNC0;
+    arqTx[1] = TLM_SYNC1;
+    arqTx[2] = TLM_TYPE_ARQ;
+    arqTx[3] = n & 0xFF;
+    arqTx[4] = len;
+    arqTx[5] = 0;
+    arqTx[6] = arqBase & 0xFF;
+    //
+    // The data, high byte first; the CRC overwrites the pad of an odd last
+    // byte
+    //
+    for(i = 0; i < len - 1; i += 2)
+    {
+        arqTx[ARQ_DATA + i] = slot[i >> 1] >> 8;
+        arqTx[ARQ_DATA + i + 1] = slot[i >> 1] & 0xFF;
+    }
+    crc = Tlm_Crc16(0xFFFF, &arqTx[2], len + TLM_HEADER_LEN - 2);
+    arqTx[TLM_HEADER_LEN + len] = crc >> 8;
+    arqTx[TLM_HEADER_LEN + len + 1] = crc & 0xFF;
+
+    Sci_Put(arqPort, (const char *)arqTx, arqLen[s]);
+    arqTxTime[s] = Timebase_Now();
+    arqTxOrder[s] = ++arqTxCount;
+    arqFlags[s] &= ~ARQ_RETX;
+    return 1;
+}
+
+//
+// Arq_Receive - Collect ACK frames from the port's RX ring and keep the
+//               other bytes for Arq_GetChar(). A broken ACK is dropped
+//               with its bytes; a later one repeats what it said.
+//
+static void Arq_Receive(void)
+{
+    int c;
+
+    while((c = Sci_GetChar(arqPort)) >= 0)
+    {
+        if((arqAckLen == 0) && (c != TLM_SYNC0))
+        {
+            arqRx[arqRxHead] = c;           // Dropped when full
+            if(((arqRxHead + 1) & (ARQ_RX_LEN - 1)) != arqRxTail)
+            {
+                arqRxHead = (arqRxHead + 1) & (ARQ_RX_LEN - 1);
+            }
+            continue;
+        }
+        if((arqAckLen == 1) && (c != TLM_SYNC1))
+        {
+            arqAckLen = (c == TLM_SYNC0);
+            continue;
+        }
+
+        arqAck[arqAckLen++] = c;
+        if((arqAckLen == TLM_HEADER_LEN) &&
+           ((arqAck[4] == 0) || (arqAck[4] > ARQ_ACK_LEN) || (arqAck[5] != 0)))
+        {
+            arqAckLen = 0;
+            arqStats.badAcks++;
+        }
+        else if((arqAckLen > TLM_HEADER_LEN) &&
+                (arqAckLen == TLM_HEADER_LEN + arqAck[4] + TLM_CRC_LEN))
+        {
+            arqAckLen = 0;
+            Arq_Ack();
+        }
+    }
+}
+
+//
+// Arq_Ack - Apply a complete ACK frame: mark what it acknowledges, queue
+//           the segments it shows lost and slide the window
+//
+static void Arq_Ack(void)
+{
+    Uint16 outstanding;
+    Uint16 offset;
+    Uint16 n;
+    Uint16 s;
+    Uint16 i;
+    Uint16 k;
+    Uint16 mapLen;
+
+    if((arqAck[2] != TLM_TYPE_ARQ_ACK) ||
+       (Tlm_Crc16(0xFFFF, &arqAck[2],
+                  TLM_HEADER_LEN - 2 + arqAck[4] + TLM_CRC_LEN) != 0))
+    {
+        arqStats.badAcks++;
+        return;
+    }
+
+    //
+    // An ACK older than the window start, or past what was sent, is stale
+    //
+    outstanding = arqSendNext - arqBase;
+    offset = (arqAck[6] - arqBase) & 0xFF;
+    if(offset > outstanding)
+    {
+        arqStats.badAcks++;
+        return;
+    }
+    arqStats.acks++;
+
+    //
+    // Bit k of the map is segment next + 1 + k; the map ends with its last
+    // byte that is not zero
+    //
+    mapLen = arqAck[4] - 1;
+    s = arqBaseSlot;
+    for(i = 0; i < outstanding; i++)
+    {
+        k = i - offset - 1;
+        if((i < offset) ||
+           ((i > offset) && ((k >> 3) < mapLen) &&
+            ((arqAck[7 + (k >> 3)] >> (k & 7)) & 1)))
+        {
+            if((arqFlags[s] & ARQ_ACKED) == 0)
+            {
+                arqFlags[s] = ARQ_ACKED;
+                if(arqTxOrder[s] > arqAckedOrder)
+                {
+                    arqAckedOrder = arqTxOrder[s];
+                }
+            }
+        }
+        if(++s == arqWindow)
+        {
+            s = 0;
+        }
+    }
+
+    //
+    // Anything sent before an acknowledged segment and still missing was
+    // lost on the way
+    //
+    s = arqBaseSlot;
+    for(n = arqBase; n != arqSendNext; n++)
+    {
+        if((arqFlags[s] == 0) && (arqTxOrder[s] < arqAckedOrder))
+        {
+            arqFlags[s] = ARQ_RETX;
+        }
+        if(++s == arqWindow)
+        {
+            s = 0;
+        }
+    }
+
+    while((arqBase != arqSendNext) && (arqFlags[arqBaseSlot] & ARQ_ACKED))
+    {
+        arqFlags[arqBaseSlot] = 0;
+        arqBase++;
+        if(++arqBaseSlot == arqWindow)
+        {
+            arqBaseSlot = 0;
+        }
+    }
+}
+
+//
+// End of file
+//
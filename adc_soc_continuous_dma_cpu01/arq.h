@@ -0,0 +1,93 @@
+//###########################################################################
+//
+// FILE:   arq.h
+//
+// TITLE:  Reliable byte stream over one SCI port (selective repeat ARQ).
+//
+//###########################################################################
+
+#ifndef ARQ_H
+#define ARQ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+// Segments are telemetry frames (tlm.h), one byte per word:
+//
+//   TLM_TYPE_ARQ      target to host: seq = segment number, payload =
+//                     base, data[n]; base is the oldest segment not yet
+//                     acknowledged
+//   TLM_TYPE_ARQ_ACK  host to target: payload = next, map0..mapN; every
+//                     segment before next has arrived, and bit i of the
+//                     map of up to 128 bits (map0 holds bits 0..7) says
+//                     segment next + 1 + i has arrived. The map ends with
+//                     its last byte that is not zero, so the ACK of a
+//                     line without losses is a single byte of payload.
+//
+// Segment numbers are 8 bits. The segments held for retransmission share
+// the ARQ_BUF_LEN words of arqBuf, so the window is as many segments of
+// the set size as fit there, at most ARQ_WINDOW_MAX: half the numbers, the
+// most selective repeat allows against the peer's receive window of the
+// same size.
+//
+#define ARQ_BUF_LEN         4096    // Words for held segments, all of RAMGS2
+#define ARQ_WINDOW_MAX      128     // Segments in flight
+#define ARQ_SLOT_LEN        128     // Words of the longest held segment
+#define ARQ_OVERHEAD        (TLM_HEADER_LEN + 1 + TLM_CRC_LEN)
+#define ARQ_SEG_MAX         (ARQ_SLOT_LEN - ARQ_OVERHEAD)
+#define ARQ_SEG_MIN         8
+#define ARQ_SEG_DEFAULT     64      // Data bytes per segment
+#define ARQ_RTO_MS_DEFAULT  100     // Retransmission timeout
+#define ARQ_RTO_MS_MAX      10000   // Well inside the cycle counter wrap
+#define ARQ_ACK_LEN         (1 + ARQ_WINDOW_MAX / 8)    // Longest payload
+                                    // of TLM_TYPE_ARQ_ACK
+#define ARQ_ACK_FRAME_LEN   (TLM_HEADER_LEN + ARQ_ACK_LEN + TLM_CRC_LEN)
+#define ARQ_NO_PORT         SCI_PORTS
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint32 bytes;                   // Data bytes accepted by Arq_Put()
+    Uint32 segments;                // New segments sent
+    Uint32 retransmits;             // Segments sent again
+    Uint32 timeouts;                // ... of them after ARQ_RTO
+    Uint32 acks;
+    Uint32 badAcks;                 // CRC errors and stale ACKs
+} ARQ_STATS;
+
+//
+// Function Prototypes
+//
+void Arq_Init(void);
+Uint16 Arq_Open(Uint16 port);
+void Arq_Close(void);
+Uint16 Arq_Port(void);
+Uint16 Arq_SetSegment(Uint16 len);
+Uint16 Arq_Segment(void);
+Uint16 Arq_Window(void);
+Uint16 Arq_SetTimeout(Uint16 ms);
+Uint16 Arq_Timeout(void);
+int Arq_Put(const char *data, int len);
+Uint16 Arq_Space(void);
+Uint16 Arq_InFlight(void);
+void Arq_Poll(void);
+int Arq_GetChar(void);
+Uint16 Arq_RxReady(void);
+void Arq_GetStats(ARQ_STATS *stats);
+void Arq_ClearStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARQ_H
+
+//
+// End of file
+//
@@ -0,0 +1,174 @@
+//###########################################################################
+//
+// FILE:   boot.c
+//
+// TITLE:  Boot profiler: the time each step of the startup takes.
+//
+// main() and InitSysCtrl() mark the end of every boot phase with
+// Boot_Mark(), and adca1_isr the first conversion of the first capture,
+// the end of the boot. BOOT lists the phases in the order they ended.
+//
+// The timebase (Timer 1) is taken by InitSysPll() and only set up after
+// InitSysCtrl(), so the phases up to then are counted on CPU Timer 0,
+// started by Boot_Start() on entry to main(). Boot_Sync() carries the
+// count over to the timebase and leaves Timer 0 free. The time before
+// main(), the boot ROM and the C start-up, is not counted.
+//
+// Both count SYSCLK cycles, and SYSCLK changes during the boot. Every mark
+// also takes the clock the PLL registers give, and a phase is converted to
+// microseconds at the clock it ran at. The PLL phase switches the clock
+// half way and has no time in microseconds, only its cycles.
+//
+// Building with BOOT_FAST takes out of the boot what it can do without:
+//
+//   - the 3 second wait before the first capture (BOOT_SETTLE), a soft
+//     timer (timer.c) during which commands are already served
+//   - the clocks of the peripherals the project does not use
+//     (InitPeripheralClocks())
+//   - the zeroing of the capture buffers, which the first capture fills
+//
+// and sets the ADCs up right after the GPIO, so that their power-up runs
+// alongside the PIE, driver and DMA setup. Either way the setup does not
+// wait for the ADCs; the first capture does, for what is left of the
+// power-up time (TIMER_ADC_POWER). The .TI.ramfunc and hot path copies, the
+// five PLL locks TI recommends and the vector table fill are kept; BOOT
+// shows what they cost.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "boot.h"
+#include "flash.h"
+#include "timebase.h"
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint16 phase;
+    Uint32 time;                    // Cycles since Boot_Start()
+    Uint32 hz;                      // SYSCLK at the mark
+} BOOT_ENTRY;
+
+//
+// Globals
+//
+BOOT_ENTRY bootLog[BOOT_PHASES];
+Uint16 bootCount;
+Uint32 bootStartHz;                 // SYSCLK at Boot_Start()
+Uint32 bootOffset;                  // Timer 0 count less the timebase
+Uint16 bootSynced;
+volatile Uint16 bootOpen;
+
+static const char * const bootNames[BOOT_PHASES] =
+{
+    "RAMFUNCS", "TRIM", "PLL", "CLOCKS", "FLASH", "HOT", "GPIO",
+    "VECTORS", "DRIVERS", "SETTLE", "ADC", "DMA", "FIRST_SAMPLE"
+};
+
+//
+// Boot_Now - Cycles since Boot_Start()
+//
+static Uint32 Boot_Now(void)
+{
+    if(bootSynced != 0)
+    {
+        return Timebase_Now() + bootOffset;
+    }
+    return ~CpuTimer0Regs.TIM.all;
+}
+
+//
+// Boot_Start - Start counting the boot on CPU Timer 0. Call first thing in
+//              main().
+//
+void Boot_Start(void)
+{
+    EALLOW;
+    CpuSysRegs.PCLKCR0.bit.CPUTIMER0 = 1;
+    EDIS;
+
+    CpuTimer0Regs.TCR.bit.TSS = 1;          // Stop the timer
+    CpuTimer0Regs.PRD.all = 0xFFFFFFFF;
+    CpuTimer0Regs.TPR.all = 0;              // Prescale by 1
+    CpuTimer0Regs.TPRH.all = 0;
+    CpuTimer0Regs.TCR.bit.TIE = 0;
+    CpuTimer0Regs.TCR.bit.FREE = 1;
+    CpuTimer0Regs.TCR.bit.TRB = 1;          // Reload the counter
+    CpuTimer0Regs.TCR.bit.TSS = 0;          // Start the timer
+
+    bootCount = 0;
+    bootSynced = 0;
+    bootStartHz = Flash_PllHz();
+    bootOpen = 1;
+}
+
+//
+// Boot_Sync - Go on counting on the timebase and stop Timer 0. Call right
+//             after Timebase_Init().
+//
+void Boot_Sync(void)
+{
+    bootOffset = ~CpuTimer0Regs.TIM.all - Timebase_Now();
+    bootSynced = 1;
+    CpuTimer0Regs.TCR.bit.TSS = 1;
+}
+
+//
+// Boot_Mark - Mark the end of phase. Does nothing after BOOT_FIRST_SAMPLE.
+//
+void Boot_Mark(Uint16 phase)
+{
+    BOOT_ENTRY *e;
+
+    if((bootOpen == 0) || (bootCount >= BOOT_PHASES))
+    {
+        return;
+    }
+
+    e = &bootLog[bootCount];
+    e->phase = phase;
+    e->time = Boot_Now();
+    e->hz = Flash_PllHz();
+    bootCount++;
+
+    if(phase == BOOT_FIRST_SAMPLE)
+    {
+        bootOpen = 0;
+    }
+}
+
+//
+// Boot_Phase - The i-th phase to end, its cycles and, if the clock did not
+//              change in it, its time. Returns 0 past the last one marked.
+//
+Uint16 Boot_Phase(Uint16 i, BOOT_PHASE *phase)
+{
+    Uint32 time;
+    Uint32 hz;
+
+    if(i >= bootCount)
+    {
+        return 0;
+    }
+
+    time = (i == 0) ? 0 : bootLog[i - 1].time;
+    hz = (i == 0) ? bootStartHz : bootLog[i - 1].hz;
+
+    phase->name = bootNames[bootLog[i].phase];
+    phase->cycles = bootLog[i].time - time;
+    phase->us = BOOT_US_MIXED;
+    if((hz == bootLog[i].hz) && (hz != 0))
+    {
+        phase->us = (Uint32)((Uint64)phase->cycles * 1000000 / hz);
+    }
+    return 1;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,76 @@
+//###########################################################################
+//
+// FILE:   boot.h
+//
+// TITLE:  Boot profiler: the time each step of the startup takes.
+//
+//###########################################################################
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+// Boot phases, each marked where it ends. Building with BOOT_FAST skips
+// BOOT_SETTLE and what else the startup can do without (see boot.c).
+//
+#define BOOT_RAMFUNCS       0       // .TI.ramfunc copy and flash setup
+#define BOOT_TRIM           1       // Unbonded pull-ups and ADC trims
+#define BOOT_PLL            2       // PLL lock and check
+#define BOOT_CLOCKS         3       // Peripheral clocks
+#define BOOT_FLASH          4       // Timebase and flash wait states
+#define BOOT_HOT            5       // Hot paths copied to RAM
+#define BOOT_GPIO           6
+#define BOOT_VECTORS        7       // PIE and vector table
+#define BOOT_DRIVERS        8       // SCI, SPI, McBSP and services
+#define BOOT_SETTLE         9       // Wait before the first capture
+#define BOOT_ADC            10      // ePWM and ADC set up, ADCs powering
+#define BOOT_DMA            11      // DMA and interrupts on
+#define BOOT_FIRST_SAMPLE   12      // First conversion of the first capture
+#define BOOT_PHASES         13
+
+#define BOOT_US_MIXED       0xFFFFFFFFUL    // The clock changed in the phase
+
+//
+// BOOT_MARK_LAST - Boot_Mark() from an interrupt that runs on after the
+//                  boot, at no more than a test once the boot is over
+//
+#define BOOT_MARK_LAST(phase)   if(bootOpen != 0) { Boot_Mark(phase); }
+
+//
+// Typedefs
+//
+typedef struct
+{
+    const char *name;
+    Uint32 cycles;                  // SYSCLK cycles
+    Uint32 us;                      // BOOT_US_MIXED if not known
+} BOOT_PHASE;
+
+//
+// Globals
+//
+extern volatile Uint16 bootOpen;    // Set until BOOT_FIRST_SAMPLE
+
+//
+// Function Prototypes
+//
+void Boot_Start(void);
+void Boot_Sync(void);
+void Boot_Mark(Uint16 phase);
+Uint16 Boot_Phase(Uint16 i, BOOT_PHASE *phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_H
+
+//
+// End of file
+//
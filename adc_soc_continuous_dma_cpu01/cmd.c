@@ -0,0 +1,145 @@
+//###########################################################################
+//
+// FILE:   cmd.c
+//
+// TITLE:  Line based command interpreter for the SCI command channel.
+//
+// Characters are pulled from the receive ring by Cmd_Poll() until a CR or
+// LF ends the line. The line is split on spaces and the first word is
+// looked up in the command table handed to Cmd_Init(). Unknown commands
+// and over-long lines are answered with "ERR".
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <string.h>
+#include "cmd.h"
+
+//
+// Globals
+//
+const CMD_ENTRY *cmdTable;
+Uint16 cmdCount;
+int (*cmdGetChar)(void);
+void (*cmdPutString)(const char *s);
+char cmdLine[CMD_LINE_MAX];
+Uint16 cmdLen;
+Uint16 cmdOverflow;
+
+//
+// Cmd_Init - Set the command table and the character I/O of the channel
+//
+void Cmd_Init(const CMD_ENTRY *table, Uint16 count,
+              int (*getChar)(void), void (*putString)(const char *s))
+{
+    cmdTable = table;
+    cmdCount = count;
+    cmdGetChar = getChar;
+    cmdPutString = putString;
+    cmdLen = 0;
+    cmdOverflow = 0;
+}
+
+//
+// Cmd_Reply - Send a response line on the command channel
+//
+void Cmd_Reply(const char *s)
+{
+    cmdPutString(s);
+}
+
+//
+// Cmd_Execute - Split a complete line into words and run its handler
+//
+static void Cmd_Execute(char *line)
+{
+    int argc;
+    char *argv[CMD_MAX_ARGS];
+    Uint16 i;
+
+    argc = 0;
+    while(*line != '\0')
+    {
+        while(*line == ' ')
+        {
+            *line++ = '\0';
+        }
+        if(*line == '\0')
+        {
+            break;
+        }
+        if(argc >= CMD_MAX_ARGS)
+        {
+            Cmd_Reply("ERR\n");
+            return;
+        }
+        argv[argc++] = line;
+        while((*line != ' ') && (*line != '\0'))
+        {
+            line++;
+        }
+    }
+
+    if(argc == 0)
+    {
+        return;
+    }
+
+    for(i = 0; i < cmdCount; i++)
+    {
+        if(strcmp(argv[0], cmdTable[i].name) == 0)
+        {
+            cmdTable[i].handler(argc, argv);
+            return;
+        }
+    }
+
+    Cmd_Reply("ERR\n");
+}
+
+//
+// Cmd_Poll - Consume received characters and run any completed command.
+//            Call from the background loop. Returns after a command, so
+//            that one taking over the port's input (MEM WR) gets the
+//            characters after its line. Returns nonzero if it ran one;
+//            more may be waiting.
+//
+Uint16 Cmd_Poll(void)
+{
+    int c;
+
+    while((c = cmdGetChar()) >= 0)
+    {
+        if((c == '\r') || (c == '\n'))
+        {
+            if(cmdOverflow != 0)
+            {
+                Cmd_Reply("ERR\n");
+            }
+            else
+            {
+                cmdLine[cmdLen] = '\0';
+                Cmd_Execute(cmdLine);
+            }
+            cmdLen = 0;
+            cmdOverflow = 0;
+            return 1;
+        }
+        else if(cmdLen < (CMD_LINE_MAX - 1))
+        {
+            cmdLine[cmdLen++] = (char)c;
+        }
+        else
+        {
+            cmdOverflow = 1;
+        }
+    }
+    return 0;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,49 @@
+//###########################################################################
+//
+// FILE:   cmd.h
+//
+// TITLE:  Line based command interpreter for the SCI command channel.
+//
+//###########################################################################
+
+#ifndef CMD_H
+#define CMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define CMD_LINE_MAX    48      // Longest accepted command line
+#define CMD_MAX_ARGS    8       // Words per command line, including the name
+
+//
+// Typedefs
+//
+typedef void (*CMD_HANDLER)(int argc, char *argv[]);
+
+typedef struct
+{
+    const char *name;
+    CMD_HANDLER handler;
+} CMD_ENTRY;
+
+//
+// Function Prototypes
+//
+void Cmd_Init(const CMD_ENTRY *table, Uint16 count,
+              int (*getChar)(void), void (*putString)(const char *s));
+Uint16 Cmd_Poll(void);
+void Cmd_Reply(const char *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CMD_H
+
+//
+// End of file
+//
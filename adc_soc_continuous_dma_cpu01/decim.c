@@ -0,0 +1,257 @@
+//###########################################################################
+//
+// FILE:   decim.c
+//
+// TITLE:  CIC + compensating FIR decimator for oversampled acquisition.
+//
+// The ADCs are run at their maximum rate and the data is brought down to
+// the output rate in two stages:
+//
+//   CIC  - DECIM_CIC_ORDER integrators at the input rate and as many combs
+//          at 1/R of it. Only additions, in wrapping 32-bit arithmetic,
+//          which is exact as long as the output fits in 32 bits:
+//          inBits + DECIM_CIC_ORDER * log2(R) <= 32.
+//   FIR  - DECIM_FIR_TAPS symmetric taps in floating point, decimating by
+//          DECIM_FIR_RATIO. The taps are designed at run time for the
+//          selected R: a Blackman windowed low pass with its cutoff at the
+//          output Nyquist frequency, whose pass band is shaped by the
+//          inverse of the CIC droop.
+//
+// The decimation ratio is R * DECIM_FIR_RATIO, a power of two from
+// DECIM_RATIO_MIN to DECIM_RATIO_MAX. The output is alias free (Blackman
+// stop band) up to about 0.3 of the output rate. Samples are scaled to
+// DECIM_OUT_BITS wide codes, so averaging gains resolution below the input
+// LSB.
+//
+// Throughput budget per input sample and channel, in SYSCLK cycles:
+//
+//   cycles = Ci + (Cc + Cf / DECIM_FIR_RATIO) / R
+//
+// with Ci the three integrator additions, Cc the combs and the float
+// conversion and Cf the (DECIM_FIR_TAPS + 1) / 2 multiply-adds of the
+// folded FIR. Ci dominates from R = 8 up. The DEC BUDGET command measures
+// the figure for every ratio on the target and relates it to the measured
+// ADC sample period.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <math.h>
+#include "decim.h"
+#include "hot.h"
+
+//
+// Defines
+//
+#define DECIM_PI            3.14159265f
+#define DECIM_HALF          ((DECIM_FIR_TAPS + 1) / 2)  // Unique taps
+#define DECIM_CUTOFF        (0.5f / DECIM_FIR_RATIO)    // Of the CIC rate
+#define DECIM_DESIGN_STEPS  64      // Integration steps of the tap design
+
+//
+// Globals
+//
+float32 decimCoef[DECIM_HALF];      // Center tap last
+Uint16 decimCicRatio;
+
+//
+// Decim_CicDroop - Magnitude response of the CIC at f, in cycles per CIC
+//                  output sample
+//
+static float32 Decim_CicDroop(float32 f, Uint16 r)
+{
+    float32 d;
+
+    if(f <= 0.0f)
+    {
+        return 1.0f;
+    }
+    d = sin(DECIM_PI * f) / ((float32)r * sin(DECIM_PI * f / (float32)r));
+    return d * d * d;
+}
+
+//
+// Decim_Configure - Set the total decimation ratio for inputs of inBits
+//                   width and design the FIR taps. Returns 0 if the ratio
+//                   is not supported. Takes a few ms on the target; reset
+//                   the channel states afterwards.
+//
+Uint16 Decim_Configure(Uint16 ratio, Uint16 inBits)
+{
+    Uint16 r;
+    Uint16 log2r;
+    Uint16 i, j;
+    int16 m;
+    float32 f, acc, win, sum, gain;
+
+    r = ratio / DECIM_FIR_RATIO;
+    if((r < DECIM_CIC_MIN) || (r > DECIM_CIC_MAX) ||
+       ((r & (r - 1)) != 0) || (ratio != r * DECIM_FIR_RATIO))
+    {
+        return 0;
+    }
+
+    log2r = 0;
+    while((1U << log2r) < r)
+    {
+        log2r++;
+    }
+    if(inBits + DECIM_CIC_ORDER * log2r > 32)
+    {
+        return 0;
+    }
+
+    //
+    // Tap m from the center is 2 * integral of H(f) cos(2 pi f m) over the
+    // pass band, with H the inverse CIC droop, then windowed
+    //
+    sum = 0.0f;
+    for(i = 0; i < DECIM_HALF; i++)
+    {
+        m = DECIM_HALF - 1 - i;
+        acc = 0.0f;
+        for(j = 0; j < DECIM_DESIGN_STEPS; j++)
+        {
+            f = ((float32)j + 0.5f) * DECIM_CUTOFF / DECIM_DESIGN_STEPS;
+            acc += cos(2.0f * DECIM_PI * f * m) / Decim_CicDroop(f, r);
+        }
+        win = 0.42f + 0.5f * cos(2.0f * DECIM_PI * m / (DECIM_FIR_TAPS - 1)) +
+              0.08f * cos(4.0f * DECIM_PI * m / (DECIM_FIR_TAPS - 1));
+        decimCoef[i] = win * acc;
+        sum += (m == 0) ? decimCoef[i] : 2.0f * decimCoef[i];
+    }
+
+    //
+    // Unity gain at DC, with the CIC gain R^N removed and the input scaled
+    // up to the output width
+    //
+    gain = (float32)(1UL << (DECIM_OUT_BITS - inBits)) /
+           ((float32)r * (float32)r * (float32)r * sum);
+    for(i = 0; i < DECIM_HALF; i++)
+    {
+        decimCoef[i] *= gain;
+    }
+
+    decimCicRatio = r;
+    return 1;
+}
+
+//
+// Decim_Ratio - Total decimation ratio set by Decim_Configure()
+//
+Uint16 Decim_Ratio(void)
+{
+    return decimCicRatio * DECIM_FIR_RATIO;
+}
+
+//
+// Decim_Reset - Clear the filter history of one channel
+//
+void Decim_Reset(DECIM_STATE *s)
+{
+    Uint16 i;
+
+    for(i = 0; i < DECIM_CIC_ORDER; i++)
+    {
+        s->integ[i] = 0;
+        s->comb[i] = 0;
+    }
+    for(i = 0; i < 2 * DECIM_FIR_TAPS; i++)
+    {
+        s->line[i] = 0.0f;
+    }
+    s->pos = 0;
+    s->phase = 0;
+}
+
+//
+// Decim_Process - Decimate len input samples of one channel, len a multiple
+//                 of the CIC ratio. Writes len / Decim_Ratio() outputs
+//                 (give or take one, depending on the stage phase) and
+//                 returns their number.
+//
+HOT_FUNC(Decim_Process)
+Uint16 Decim_Process(DECIM_STATE *s, const Uint16 *in, Uint16 len,
+                     Uint16 *out)
+{
+    Uint32 i1, i2, i3;
+    Uint32 c0, c1, c2;
+    Uint16 n, k, r, count;
+    const float32 *w;
+    float32 y;
+
+    r = decimCicRatio;
+    i1 = s->integ[0];
+    i2 = s->integ[1];
+    i3 = s->integ[2];
+    count = 0;
+
+    for(n = 0; n < len; n += r)
+    {
+        //
+        // Integrators at the input rate
+        //
+        for(k = 0; k < r; k++)
+        {
+            i1 += in[n + k];
+            i2 += i1;
+            i3 += i2;
+        }
+
+        //
+        // Combs at the CIC output rate
+        //
+        c0 = i3 - s->comb[0];
+        s->comb[0] = i3;
+        c1 = c0 - s->comb[1];
+        s->comb[1] = c0;
+        c2 = c1 - s->comb[2];
+        s->comb[2] = c1;
+
+        //
+        // History stored twice so the newest DECIM_FIR_TAPS values are
+        // always contiguous from pos
+        //
+        s->pos = (s->pos == 0) ? (DECIM_FIR_TAPS - 1) : (s->pos - 1);
+        s->line[s->pos] = (float32)c2;
+        s->line[s->pos + DECIM_FIR_TAPS] = (float32)c2;
+
+        if(++s->phase < DECIM_FIR_RATIO)
+        {
+            continue;
+        }
+        s->phase = 0;
+
+        //
+        // Symmetric FIR, folded
+        //
+        w = &s->line[s->pos];
+        y = decimCoef[DECIM_HALF - 1] * w[DECIM_HALF - 1];
+        for(k = 0; k < DECIM_HALF - 1; k++)
+        {
+            y += decimCoef[k] * (w[k] + w[DECIM_FIR_TAPS - 1 - k]);
+        }
+
+        if(y < 0.0f)
+        {
+            y = 0.0f;
+        }
+        if(y > 65535.0f)
+        {
+            y = 65535.0f;
+        }
+        out[count++] = (Uint16)(y + 0.5f);
+    }
+
+    s->integ[0] = i1;
+    s->integ[1] = i2;
+    s->integ[2] = i3;
+    return count;
+}
+
+//
+// End of file
+//
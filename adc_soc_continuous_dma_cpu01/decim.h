@@ -0,0 +1,60 @@
+//###########################################################################
+//
+// FILE:   decim.h
+//
+// TITLE:  CIC + compensating FIR decimator for oversampled acquisition.
+//
+//###########################################################################
+
+#ifndef DECIM_H
+#define DECIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define DECIM_CIC_ORDER     3       // Integrator/comb pairs
+#define DECIM_CIC_MIN       4       // Smallest CIC ratio
+#define DECIM_CIC_MAX       64      // Largest CIC ratio, 18 bits of growth
+#define DECIM_FIR_TAPS      31      // Compensating FIR length (odd)
+#define DECIM_FIR_RATIO     2       // Decimation of the FIR stage
+#define DECIM_RATIO_MIN     (DECIM_CIC_MIN * DECIM_FIR_RATIO)
+#define DECIM_RATIO_MAX     (DECIM_CIC_MAX * DECIM_FIR_RATIO)
+#define DECIM_OUT_BITS      16      // Output width, inputs are scaled up
+
+//
+// Typedefs
+//
+// State of one channel. Channels share the ratio and the FIR coefficients
+// set by Decim_Configure().
+//
+typedef struct
+{
+    Uint32  integ[DECIM_CIC_ORDER];
+    Uint32  comb[DECIM_CIC_ORDER];
+    float32 line[2 * DECIM_FIR_TAPS];   // FIR history, stored twice
+    Uint16  pos;
+    Uint16  phase;
+} DECIM_STATE;
+
+//
+// Function Prototypes
+//
+Uint16 Decim_Configure(Uint16 ratio, Uint16 inBits);
+Uint16 Decim_Ratio(void);
+void Decim_Reset(DECIM_STATE *s);
+Uint16 Decim_Process(DECIM_STATE *s, const Uint16 *in, Uint16 len,
+                     Uint16 *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DECIM_H
+
+//
+// End of file
+//
@@ -0,0 +1,299 @@
+//###########################################################################
+//
+// FILE:   fault.c
+//
+// TITLE:  Default interrupt handler with a crash record kept over resets.
+//
+// Replaces the default ISRs of F2837xS_DefaultISR.c, which each stop at
+// ESTOP0 and hang a board running without an emulator, and the copy of
+// PieVectTableInit that InitPieVectTable() makes only for the handlers to
+// be patched in one by one afterwards. Fault_Init() writes the PIE vector
+// table once from a map of (vector, handler) pairs declared at build time:
+// one entry, Fault_Isr (fault_isr.asm), everywhere, then the handlers of
+// the map. The modules do not touch the table. An interrupt that finds no
+// handler of its own ends up in Fault_Handler(), which
+//
+//   - tells the vector from PIECTRL.PIEVECT, the address the PIE fetched
+//     it from, and from it the PIE group and channel
+//   - counts it per vector and writes the crash record: vector, return
+//     address, IER, IFR and time
+//   - resumes, with the PIE channel turned off so a flag nobody clears
+//     cannot raise it again, resets through the watchdog or halts, as the
+//     policy says. The CPU vectors (timers 1 and 2, NMI, illegal
+//     operation and the like) cannot be turned off from here and reset
+//     instead of resuming; only the user traps resume.
+//
+// The crash record is in the faultRecord section (see the project .cmd),
+// which the startup code does not initialize; a sum over it tells a record
+// that survived a reset from what the RAM held at power up.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <stddef.h>
+#include <string.h>
+#include "fault.h"
+#include "timebase.h"
+
+//
+// Defines
+//
+#define FAULT_RECORD_WORDS  offsetof(FAULT_RECORD, check)   // Words summed
+#define FAULT_PIE_BASE      0x0D00  // Address of the PIE vector table
+#define FAULT_CPU_VECTORS   32      // IDs below the PIE groups
+#define FAULT_HIGH_VECTORS  128     // Channels 9..16 of the groups
+
+//
+// Function Prototypes
+//
+__interrupt void Fault_Isr(void);
+__interrupt void Fault_Handler(void);
+static Uint16 Fault_Sum(const FAULT_RECORD *record);
+static void Fault_Reset(void);
+
+//
+// Globals
+//
+#pragma DATA_SECTION(faultRecord, "faultRecord");
+#pragma DATA_SECTION(faultCount, "ramgs4");
+FAULT_RECORD faultRecord;
+Uint16 faultCount[FAULT_VECTORS];   // Per vector, saturating
+Uint16 faultPolicy;
+Uint16 faultWdReset;                // The last reset was the watchdog's
+Uint32 faultEntryPc;                // Stored by Fault_Isr
+Uint16 faultEntryIer;
+
+//
+// Fault_Init - Point every PIE vector at the default handler but those of
+//              the map, enable the PIE and set the policy. Replaces
+//              InitPieVectTable(); call it after InitPieCtrl(). Returns 0,
+//              with the entries of the map from the bad one on left to
+//              the default handler, if the map names a vector out of range
+//              or of the boot ROM.
+//
+Uint16 Fault_Init(Uint16 policy, const FAULT_VECTOR *map, Uint16 count)
+{
+    PINT *vector;
+    Uint16 i;
+    Uint16 ok;
+
+    faultWdReset = CpuSysRegs.RESC.bit.WDRSn;
+    faultPolicy = policy;
+    memset(faultCount, 0, sizeof(faultCount));
+    if((faultRecord.magic != FAULT_MAGIC) ||
+       (faultRecord.check != Fault_Sum(&faultRecord)))
+    {
+        memset(&faultRecord, 0, sizeof(faultRecord));
+    }
+
+    vector = (PINT *)&PieVectTable;
+    ok = 1;
+    EALLOW;
+    for(i = FAULT_FIRST_VECTOR; i < FAULT_VECTORS; i++)
+    {
+        vector[i] = &Fault_Isr;
+    }
+    for(i = 0; i < count; i++)
+    {
+        if((map[i].vector < FAULT_FIRST_VECTOR) ||
+           (map[i].vector >= FAULT_VECTORS))
+        {
+            ok = 0;
+            break;
+        }
+        vector[map[i].vector] = map[i].handler;
+    }
+    EDIS;
+
+    PieCtrlRegs.PIECTRL.bit.ENPIE = 1;
+    return ok;
+}
+
+//
+// Fault_SetPolicy - FAULT_RESUME, FAULT_RESET or FAULT_HALT
+//
+void Fault_SetPolicy(Uint16 policy)
+{
+    faultPolicy = policy;
+}
+
+//
+// Fault_Policy - The policy in force
+//
+Uint16 Fault_Policy(void)
+{
+    return faultPolicy;
+}
+
+//
+// Fault_Record - Copy the crash record. Returns 0 if there is none.
+//
+Uint16 Fault_Record(FAULT_RECORD *record)
+{
+    *record = faultRecord;
+    return faultRecord.count != 0;
+}
+
+//
+// Fault_WatchdogReset - Nonzero if the last reset came from the watchdog,
+//                       as FAULT_RESET does it
+//
+Uint16 Fault_WatchdogReset(void)
+{
+    return faultWdReset;
+}
+
+//
+// Fault_Count - Faults of a vector since Fault_Init() or Fault_Clear()
+//
+Uint16 Fault_Count(Uint16 vector)
+{
+    return (vector < FAULT_VECTORS) ? faultCount[vector] : 0;
+}
+
+//
+// Fault_Clear - Forget the crash record and the counts
+//
+void Fault_Clear(void)
+{
+    Uint16 intState;
+
+    intState = __disable_interrupts();
+    memset(faultCount, 0, sizeof(faultCount));
+    memset(&faultRecord, 0, sizeof(faultRecord));
+    __restore_interrupts(intState);
+}
+
+//
+// Fault_Test - Raise the user trap 1, which has no handler, to see the
+//              record being written; it is resumed under every policy but
+//              FAULT_HALT
+//
+void Fault_Test(void)
+{
+    asm(" TRAP #20");
+}
+
+//
+// Fault_Handler - Entered from Fault_Isr for a vector without a handler
+//
+__interrupt void Fault_Handler(void)
+{
+    volatile Uint16 *pieIer;
+    Uint16 vector;
+    Uint16 group;
+    Uint16 channel;
+    Uint16 policy;
+
+    //
+    // PIEVECT holds address bits 1 to 15 of the fetched vector
+    //
+    vector = ((PieCtrlRegs.PIECTRL.all & 0xFFFE) - FAULT_PIE_BASE) >> 1;
+    if(vector < FAULT_CPU_VECTORS)
+    {
+        group = 0;
+        channel = vector;
+    }
+    else if(vector < FAULT_HIGH_VECTORS)
+    {
+        group = (vector - FAULT_CPU_VECTORS) / 8 + 1;
+        channel = (vector - FAULT_CPU_VECTORS) % 8 + 1;
+    }
+    else
+    {
+        group = (vector - FAULT_HIGH_VECTORS) / 8 + 1;
+        channel = (vector - FAULT_HIGH_VECTORS) % 8 + 9;
+    }
+
+    policy = faultPolicy;
+    if((vector < FAULT_ID_USER1) && (policy == FAULT_RESUME))
+    {
+        policy = FAULT_RESET;
+    }
+
+    if((vector < FAULT_VECTORS) && (faultCount[vector] != 0xFFFF))
+    {
+        faultCount[vector]++;
+    }
+    faultRecord.magic = FAULT_MAGIC;
+    faultRecord.count++;
+    faultRecord.vector = vector;
+    faultRecord.group = group;
+    faultRecord.channel = channel;
+    faultRecord.ier = faultEntryIer;
+    faultRecord.ifr = IFR;
+    faultRecord.policy = policy;
+    faultRecord.pc = faultEntryPc;
+    faultRecord.time = Timebase_Now();
+    faultRecord.check = Fault_Sum(&faultRecord);
+
+    if(policy == FAULT_HALT)
+    {
+        asm(" ESTOP0");
+        for(;;)
+        {
+        }
+    }
+    if(policy == FAULT_RESET)
+    {
+        Fault_Reset();
+    }
+
+    //
+    // Resume: turn the PIE channel off the way the TRM asks for with the
+    // interrupts held off, drop what it may have raised and acknowledge
+    // the group
+    //
+    if(group != 0)
+    {
+        pieIer = &PieCtrlRegs.PIEIER1.all + 2 * (group - 1);
+        EALLOW;
+        *pieIer &= ~(1U << (channel - 1));
+        EDIS;
+        asm(" RPT #5 || NOP");
+        IFR &= ~(1U << (group - 1));
+        PieCtrlRegs.PIEACK.all = 1U << (group - 1);
+    }
+}
+
+//
+// Fault_Sum - Sum of the record words before its check word
+//
+static Uint16 Fault_Sum(const FAULT_RECORD *record)
+{
+    const Uint16 *p;
+    Uint16 sum;
+    Uint16 i;
+
+    p = (const Uint16 *)record;
+    sum = FAULT_MAGIC;
+    for(i = 0; i < FAULT_RECORD_WORDS; i++)
+    {
+        sum += p[i];
+    }
+    return sum;
+}
+
+//
+// Fault_Reset - Reset through the watchdog: enable it in reset mode, then
+//               write a wrong check value, which resets at once; the
+//               counter running out would do it a few ms later
+//
+static void Fault_Reset(void)
+{
+    EALLOW;
+    WdRegs.SCSR.all = 0;            // WDENINT = 0: the watchdog resets
+    WdRegs.WDCR.all = 0x0028;       // WDCHK = 101, enabled, WDCLK / 1
+    WdRegs.WDCR.all = 0x0000;       // WDCHK wrong
+    EDIS;
+    for(;;)
+    {
+    }
+}
+
+//
+// End of file
+//
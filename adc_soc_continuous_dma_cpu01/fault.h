@@ -0,0 +1,93 @@
+//###########################################################################
+//
+// FILE:   fault.h
+//
+// TITLE:  Default interrupt handler with a crash record kept over resets.
+//
+//###########################################################################
+
+#ifndef FAULT_H
+#define FAULT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define FAULT_VECTORS       224     // PIE vector table entries
+#define FAULT_FIRST_VECTOR  3       // Entries before it belong to the boot
+                                    // ROM
+#define FAULT_ID_USER1      20      // TRAP #20, used by Fault_Test(); the
+                                    // CPU vectors before it cannot be
+                                    // resumed
+#define FAULT_MAGIC         0xFA17  // Marks a valid crash record
+
+#define FAULT_RESUME        0       // Policies: count, turn the vector off
+                                    // and go on
+#define FAULT_RESET         1       // Reset through the watchdog
+#define FAULT_HALT          2       // ESTOP0 and wait for the debugger
+#define FAULT_POLICIES      3
+
+//
+// PIE vector IDs: channel 1..16 of group 1..12, or a CPU interrupt such as
+// INT13 and INT14
+//
+#define FAULT_PIE(group, channel)                               \
+    (((channel) <= 8) ? 32 + 8 * ((group) - 1) + (channel) - 1 : \
+                        128 + 8 * ((group) - 1) + (channel) - 9)
+#define FAULT_CPU(n)        (n)
+
+//
+// Typedefs
+//
+// The crash record is in its own section, not initialized at startup, so
+// it survives the watchdog reset of FAULT_RESET
+//
+typedef struct
+{
+    Uint16 magic;                   // FAULT_MAGIC once written
+    Uint16 count;                   // Faults since it was cleared
+    Uint16 vector;                  // Of the last fault: PIE vector ID
+    Uint16 group;                   // PIE group 1..12, 0 for CPU vectors
+    Uint16 channel;                 // Channel 1..16 in it, or the CPU
+                                    // vector number
+    Uint16 ier;                     // IER before the interrupt
+    Uint16 ifr;
+    Uint16 policy;                  // Taken for it
+    Uint32 pc;                      // Return address of the interrupt
+    Uint32 time;                    // Timebase_Now()
+    Uint16 check;                   // Sum of the words before it
+} FAULT_RECORD;
+
+//
+// An entry of the vector map given to Fault_Init()
+//
+typedef struct
+{
+    Uint16 vector;                  // FAULT_PIE() or FAULT_CPU()
+    PINT handler;
+} FAULT_VECTOR;
+
+//
+// Function Prototypes
+//
+Uint16 Fault_Init(Uint16 policy, const FAULT_VECTOR *map, Uint16 count);
+void Fault_SetPolicy(Uint16 policy);
+Uint16 Fault_Policy(void);
+Uint16 Fault_Record(FAULT_RECORD *record);
+Uint16 Fault_WatchdogReset(void);
+Uint16 Fault_Count(Uint16 vector);
+void Fault_Clear(void);
+void Fault_Test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAULT_H
+
+//
+// End of file
+//
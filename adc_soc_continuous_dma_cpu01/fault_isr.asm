@@ -0,0 +1,37 @@
+;//###########################################################################
+;//
+;// FILE:   fault_isr.asm
+;//
+;// TITLE:  Entry of the default interrupt handler (fault.c).
+;//
+;// Every PIE vector without a handler of its own points here. The return
+;// address and IER the CPU saved on entry are stored for Fault_Handler(),
+;// which is then entered as if it were the vector itself: only ACC and
+;// DP are used, and the CPU restores both on IRET.
+;//
+;// Stack on entry, as saved by the CPU:
+;//
+;//   *-SP[2]   PC, the return address (32 bits)
+;//   *-SP[3]   DBGSTAT
+;//   *-SP[4]   IER
+;//
+;//###########################################################################
+
+        .def    _Fault_Isr
+        .ref    _Fault_Handler
+        .ref    _faultEntryPc
+        .ref    _faultEntryIer
+
+        .text
+_Fault_Isr:
+        MOVL    ACC, *-SP[2]
+        MOVW    DP, #_faultEntryPc
+        MOVL    @_faultEntryPc, ACC
+        MOV     AL, *-SP[4]
+        MOVW    DP, #_faultEntryIer
+        MOV     @_faultEntryIer, AL
+        LB      _Fault_Handler
+
+;//
+;// End of file
+;//
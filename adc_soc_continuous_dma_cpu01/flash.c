@@ -0,0 +1,281 @@
+//###########################################################################
+//
+// FILE:   flash.c
+//
+// TITLE:  Flash wait states, prefetch and data cache from the measured
+//         SYSCLK.
+//
+// InitSysCtrl() sets up the flash for the fastest clock of the device,
+// whatever clock InitSysPll() then gives. Flash_Init() measures SYSCLK
+// once the PLL runs, on the cycle counter against CPU Timer 2 clocked
+// from INTOSC2, and sets the fewest wait states that clock allows:
+//
+//   SYSCLK      RWAIT
+//   <= 50 MHz     0
+//   <= 100 MHz    1
+//   <= 150 MHz    2
+//   <= 200 MHz    3
+//
+// INTOSC2 is only good to a few percent. A measurement that agrees with
+// the clock the PLL registers give, to FLASH_MEASURE_TOL_PCT, selects the
+// wait states of that exact clock; one that does not is taken at the top
+// of its tolerance instead. Without a measurement the flash keeps the
+// reset value, the slowest.
+//
+// The data cache is always on. So is the prefetch, but for no wait states,
+// where it has no flash latency to hide.
+//
+// FLASH BENCH times a checksum run from flash over the hot path image kept
+// in flash (see hot.c) at each safe setting, with the prefetch and the
+// cache off and on.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "flash.h"
+#include "timebase.h"
+
+//
+// Defines
+//
+#define FLASH_REF_COUNT         10000   // INTOSC2 periods measured, 1 ms
+#define FLASH_MEASURE_TIMEOUT   (TIMEBASE_HZ / 100) // Cycles to give up
+#define FLASH_MEASURE_TOL_PCT   5       // Agreement with the PLL setting
+#define FLASH_TMR2_SYSCLK       0       // TMR2CLKSRCSEL sources
+#define FLASH_TMR2_INTOSC2      2
+#define FLASH_OSC_XTAL          1       // OSCCLKSRCSEL of the crystal
+
+//
+// Globals
+//
+FLASH_INFO flashInfo;
+volatile Uint32 flashBenchSum;      // Keeps the checksum from being dropped
+
+//
+// Flash_Measure - SYSCLK in Hz, measured over FLASH_REF_COUNT periods of
+//                 INTOSC2, or 0 if Timer 2 did not count. Borrows Timer 2
+//                 and leaves it as found, stopped.
+//
+static Uint32 Flash_Measure(void)
+{
+    Uint16 src;
+    Uint16 prescale;
+    Uint16 tcr;
+    Uint32 prd;
+    Uint32 start;
+    Uint32 cycles;
+
+    CpuTimer2Regs.TCR.bit.TSS = 1;
+    tcr = CpuTimer2Regs.TCR.all;
+    prd = CpuTimer2Regs.PRD.all;
+
+    EALLOW;
+    src = CpuSysRegs.TMR2CLKCTL.bit.TMR2CLKSRCSEL;
+    prescale = CpuSysRegs.TMR2CLKCTL.bit.TMR2CLKPRESCALE;
+    CpuSysRegs.TMR2CLKCTL.bit.TMR2CLKSRCSEL = FLASH_TMR2_INTOSC2;
+    CpuSysRegs.TMR2CLKCTL.bit.TMR2CLKPRESCALE = 0;
+    EDIS;
+
+    CpuTimer2Regs.TCR.bit.TIE = 0;
+    CpuTimer2Regs.PRD.all = FLASH_REF_COUNT;
+    CpuTimer2Regs.TPR.all = 0;
+    CpuTimer2Regs.TPRH.all = 0;
+    CpuTimer2Regs.TCR.bit.TRB = 1;          // Reload the counter
+    CpuTimer2Regs.TCR.bit.TIF = 1;          // Clear a stale flag
+
+    CpuTimer2Regs.TCR.bit.TSS = 0;
+    start = Timebase_Now();
+    do
+    {
+        cycles = Timebase_Now() - start;
+    } while((CpuTimer2Regs.TCR.bit.TIF == 0) &&
+            (cycles < FLASH_MEASURE_TIMEOUT));
+    CpuTimer2Regs.TCR.bit.TSS = 1;
+
+    if(CpuTimer2Regs.TCR.bit.TIF == 0)
+    {
+        cycles = 0;
+    }
+
+    EALLOW;
+    CpuSysRegs.TMR2CLKCTL.bit.TMR2CLKSRCSEL = src;
+    CpuSysRegs.TMR2CLKCTL.bit.TMR2CLKPRESCALE = prescale;
+    EDIS;
+    CpuTimer2Regs.PRD.all = prd;
+    CpuTimer2Regs.TCR.all = tcr;
+    CpuTimer2Regs.TCR.bit.TIF = 1;
+
+    return cycles * (FLASH_INTOSC_HZ / FLASH_REF_COUNT);
+}
+
+//
+// Flash_PllHz - SYSCLK the clock source, PLL and divider registers give
+//               at the time of the call
+//
+Uint32 Flash_PllHz(void)
+{
+    Uint32 hz;
+    Uint16 div;
+
+    hz = (ClkCfgRegs.CLKSRCCTL1.bit.OSCCLKSRCSEL == FLASH_OSC_XTAL) ?
+         FLASH_XTAL_HZ : FLASH_INTOSC_HZ;
+    if(ClkCfgRegs.SYSPLLCTL1.bit.PLLCLKEN == 1)
+    {
+        hz = hz / 4 * (Uint32)(4 * ClkCfgRegs.SYSPLLMULT.bit.IMULT +
+                               ClkCfgRegs.SYSPLLMULT.bit.FMULT);
+    }
+    div = ClkCfgRegs.SYSCLKDIVSEL.bit.PLLSYSCLKDIV;
+    return (div == 0) ? hz : hz / (2 * div);
+}
+
+//
+// Flash_Init - Measure SYSCLK and set the flash for it. Call after
+//              Timebase_Init() and before Load_Init(), which takes Timer 2
+//              over, with the interrupts off.
+//
+void Flash_Init(void)
+{
+    Uint32 measured;
+    Uint32 pll;
+    Uint32 diff;
+    Uint32 sysclk;
+    Uint16 rwait;
+
+    measured = Flash_Measure();
+    pll = Flash_PllHz();
+    diff = (measured > pll) ? measured - pll : pll - measured;
+
+    if(measured == 0)
+    {
+        sysclk = 0;
+    }
+    else if(diff <= pll / 100 * FLASH_MEASURE_TOL_PCT)
+    {
+        sysclk = pll;
+    }
+    else
+    {
+        sysclk = measured + measured / 100 * FLASH_MEASURE_TOL_PCT;
+    }
+
+    rwait = Flash_WaitStates(sysclk);
+    Flash_Apply(rwait, (rwait == 0) ? FLASH_CACHE :
+                                      FLASH_PREFETCH | FLASH_CACHE);
+
+    flashInfo.measuredHz = measured;
+    flashInfo.pllHz = pll;
+    flashInfo.sysclkHz = sysclk;
+}
+
+//
+// Flash_Info - The clock measured and the flash setting in use
+//
+void Flash_Info(FLASH_INFO *info)
+{
+    *info = flashInfo;
+}
+
+//
+// Flash_WaitStates - Fewest wait states for a SYSCLK of sysclkHz, the reset
+//                    value for one that is unknown (0) or off the table
+//
+Uint16 Flash_WaitStates(Uint32 sysclkHz)
+{
+    if((sysclkHz == 0) || (sysclkHz > FLASH_HZ_MAX))
+    {
+        return FLASH_RWAIT_RESET;
+    }
+    return (Uint16)((sysclkHz - 1) / FLASH_HZ_PER_WAIT);
+}
+
+//
+// Flash_Apply - Set the wait states and turn the prefetch and the data
+//               cache on or off. Runs from RAM, as the flash must not be
+//               read while its timing changes. Setting fewer wait states
+//               than Flash_WaitStates() gives for the clock is not safe.
+//
+#pragma CODE_SECTION(Flash_Apply, ".TI.ramfunc");
+void Flash_Apply(Uint16 rwait, Uint16 flags)
+{
+    Uint16 intState;
+
+    intState = __disable_interrupts();
+    EALLOW;
+
+    //
+    // Prefetch and cache off before the wait states change
+    //
+    Flash0CtrlRegs.FRD_INTF_CTRL.bit.DATA_CACHE_EN = 0;
+    Flash0CtrlRegs.FRD_INTF_CTRL.bit.PREFETCH_EN = 0;
+
+    Flash0CtrlRegs.FRDCNTL.bit.RWAIT = rwait;
+
+    Flash0CtrlRegs.FRD_INTF_CTRL.bit.DATA_CACHE_EN =
+        ((flags & FLASH_CACHE) != 0) ? 1 : 0;
+    Flash0CtrlRegs.FRD_INTF_CTRL.bit.PREFETCH_EN =
+        ((flags & FLASH_PREFETCH) != 0) ? 1 : 0;
+
+    EDIS;
+
+    //
+    // Let the last write take effect before any flash access
+    //
+    __asm(" RPT #7 || NOP");
+    __restore_interrupts(intState);
+
+    flashInfo.rwait = rwait;
+    flashInfo.flags = flags;
+}
+
+//
+// Flash_Bench - Cycles of FLASH_BENCH_ROUNDS checksums of words words of
+//               data, the code running from flash in the FLASH build and
+//               the data meant to be in flash too. Take the lowest of a
+//               few runs.
+//
+Uint32 Flash_Bench(const Uint16 *data, Uint16 words)
+{
+    Uint32 start;
+    Uint32 a;
+    Uint32 b;
+    Uint16 round;
+    Uint16 i;
+
+    start = Timebase_Now();
+    a = 0;
+    b = 0;
+    for(round = 0; round < FLASH_BENCH_ROUNDS; round++)
+    {
+        //
+        // Unrolled past one 128-bit flash line of code
+        //
+        for(i = 0; i + 8 <= words; i += 8)
+        {
+            a += data[i];
+            b += a;
+            a += data[i + 1];
+            b += a;
+            a += data[i + 2];
+            b += a;
+            a += data[i + 3];
+            b += a;
+            a += data[i + 4];
+            b += a;
+            a += data[i + 5];
+            b += a;
+            a += data[i + 6];
+            b += a;
+            a += data[i + 7];
+            b += a;
+        }
+    }
+    flashBenchSum = a ^ b;
+    return Timebase_Now() - start;
+}
+
+//
+// End of file
+//
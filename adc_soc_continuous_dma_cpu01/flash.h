@@ -0,0 +1,68 @@
+//###########################################################################
+//
+// FILE:   flash.h
+//
+// TITLE:  Flash wait states, prefetch and data cache from the measured
+//         SYSCLK.
+//
+//###########################################################################
+
+#ifndef FLASH_H
+#define FLASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#ifdef _LAUNCHXL_F28377S
+#define FLASH_XTAL_HZ       10000000UL  // Crystal of the LaunchPad
+#else
+#define FLASH_XTAL_HZ       20000000UL  // Crystal of the controlCARD
+#endif
+#define FLASH_INTOSC_HZ     10000000UL  // INTOSC1 and INTOSC2
+
+#define FLASH_HZ_PER_WAIT   50000000UL  // SYSCLK one more wait state covers
+#define FLASH_HZ_MAX        200000000UL // Fastest SYSCLK in the table
+#define FLASH_RWAIT_RESET   15          // RWAIT out of reset, the slowest
+
+#define FLASH_PREFETCH      0x0001      // Flags of Flash_Apply()
+#define FLASH_CACHE         0x0002
+
+#define FLASH_BENCH_WORDS   2048        // Most words FLASH BENCH reads
+#define FLASH_BENCH_ROUNDS  4
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint32 measuredHz;              // SYSCLK against INTOSC2, 0 if it did
+                                    // not run
+    Uint32 pllHz;                   // SYSCLK the PLL registers give
+    Uint32 sysclkHz;                // The one the wait states are for
+    Uint16 rwait;                   // Wait states set
+    Uint16 flags;                   // FLASH_PREFETCH, FLASH_CACHE set
+} FLASH_INFO;
+
+//
+// Function Prototypes
+//
+void Flash_Init(void);
+void Flash_Info(FLASH_INFO *info);
+Uint32 Flash_PllHz(void);
+Uint16 Flash_WaitStates(Uint32 sysclkHz);
+void Flash_Apply(Uint16 rwait, Uint16 flags);
+Uint32 Flash_Bench(const Uint16 *data, Uint16 words);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLASH_H
+
+//
+// End of file
+//
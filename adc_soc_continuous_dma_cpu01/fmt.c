@@ -0,0 +1,190 @@
+//###########################################################################
+//
+// FILE:   fmt.c
+//
+// TITLE:  Fast fixed-width decimal, hex and CSV text of 16-bit samples.
+//
+// Replaces sprintf() in the text output modes, where it took most of the
+// time of the whole drain loop. The output is byte for byte that of
+//
+//   Fmt_Dec()      "%0<width>u"
+//   Fmt_Hex()      "%04X"
+//   Fmt_CsvLines() "%04d,%04u\n" per sample, the CSV capture format
+//
+// A value is split into a digit (0..6) and two pairs of digits, each pair
+// taken whole from fmtPairs; the division by 100 is a multiply and shift,
+// exact for the remainders below 10000 it is used on. No runtime library
+// call is made.
+//
+// host/fmt_bench checks the output against the C library for every value
+// and times both.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#ifdef FMT_HOST_BENCH
+#include <stdint.h>
+typedef uint16_t Uint16;
+typedef uint32_t Uint32;
+#define HOT_FUNC(f)
+#else
+#include "F28x_Project.h"
+#include "hot.h"
+#endif
+#include "fmt.h"
+
+//
+// Globals
+//
+const char fmtPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+const char fmtHexDigits[17] = "0123456789ABCDEF";
+
+//
+// Fmt_Four - Write value, below 10000, as four digits
+//
+HOT_FUNC(Fmt_Four)
+static void Fmt_Four(char *out, Uint16 value)
+{
+    const char *pair;
+    Uint16 hundreds;
+
+    hundreds = (Uint16)(((Uint32)value * 5243) >> 19);     // value / 100
+    pair = &fmtPairs[2 * hundreds];
+    out[0] = pair[0];
+    out[1] = pair[1];
+    pair = &fmtPairs[2 * (value - 100 * hundreds)];
+    out[2] = pair[0];
+    out[3] = pair[1];
+}
+
+//
+// Fmt_Dec - Write value in decimal, zero padded to width digits (at most
+//           FMT_DEC_MAX, fewer if the value needs more). Returns the
+//           number of characters written.
+//
+HOT_FUNC(Fmt_Dec)
+Uint16 Fmt_Dec(char *out, Uint16 value, Uint16 width)
+{
+    Uint16 top;
+    Uint16 digits;
+    Uint16 n;
+    char tmp[FMT_DEC_MAX];
+
+    top = 0;
+    while(value >= 10000)
+    {
+        value -= 10000;
+        top++;
+    }
+    tmp[0] = '0' + top;
+    Fmt_Four(&tmp[1], value);
+
+    //
+    // Significant digits, but at least width
+    //
+    digits = FMT_DEC_MAX;
+    while((digits > 1) && (tmp[FMT_DEC_MAX - digits] == '0'))
+    {
+        digits--;
+    }
+    if(width > FMT_DEC_MAX)
+    {
+        width = FMT_DEC_MAX;
+    }
+    if(digits < width)
+    {
+        digits = width;
+    }
+
+    for(n = 0; n < digits; n++)
+    {
+        out[n] = tmp[FMT_DEC_MAX - digits + n];
+    }
+    return digits;
+}
+
+//
+// Fmt_Hex - Write value as four upper case hex digits. Returns 4.
+//
+Uint16 Fmt_Hex(char *out, Uint16 value)
+{
+    out[0] = fmtHexDigits[(value >> 12) & 0xF];
+    out[1] = fmtHexDigits[(value >> 8) & 0xF];
+    out[2] = fmtHexDigits[(value >> 4) & 0xF];
+    out[3] = fmtHexDigits[value & 0xF];
+    return 4;
+}
+
+//
+// Fmt_CsvLines - Write "index,value" lines of the CSV capture format for
+//                up to count samples of data, the first numbered index,
+//                as many whole lines as fit in room characters. Returns
+//                the characters written and sets *lines to the lines.
+//
+HOT_FUNC(Fmt_CsvLines)
+Uint16 Fmt_CsvLines(char *out, Uint16 room, Uint16 index,
+                    const Uint16 *data, Uint16 count, Uint16 *lines)
+{
+    char *p;
+    char *end;
+    Uint16 i;
+    Uint16 v;
+    Uint16 len;
+
+    p = out;
+    end = out + room;
+    for(i = 0; i < count; i++, index++)
+    {
+        len = ((index >= 10000) ? 5 : 4) + ((data[i] >= 10000) ? 5 : 4) + 2;
+        if(end - p < len)
+        {
+            break;
+        }
+
+        //
+        // The index, four digits below 10000 as in the capture
+        //
+        if(index >= 10000)
+        {
+            p += Fmt_Dec(p, index, 4);
+        }
+        else
+        {
+            Fmt_Four(p, index);
+            p += 4;
+        }
+        *p++ = ',';
+
+        v = data[i];
+        if(v >= 10000)
+        {
+            p += Fmt_Dec(p, v, 4);
+        }
+        else
+        {
+            Fmt_Four(p, v);
+            p += 4;
+        }
+        *p++ = '\n';
+    }
+
+    *lines = i;
+    return p - out;
+}
+
+//
+// End of file
+//
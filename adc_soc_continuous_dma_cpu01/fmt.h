@@ -0,0 +1,38 @@
+//###########################################################################
+//
+// FILE:   fmt.h
+//
+// TITLE:  Fast fixed-width decimal, hex and CSV text of 16-bit samples.
+//
+//###########################################################################
+
+#ifndef FMT_H
+#define FMT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define FMT_DEC_MAX         5       // Digits of the largest Uint16
+#define FMT_CSV_LINE_MAX    (FMT_DEC_MAX + 1 + FMT_DEC_MAX + 1)
+
+//
+// Function Prototypes
+//
+Uint16 Fmt_Dec(char *out, Uint16 value, Uint16 width);
+Uint16 Fmt_Hex(char *out, Uint16 value);
+Uint16 Fmt_CsvLines(char *out, Uint16 room, Uint16 index,
+                    const Uint16 *data, Uint16 count, Uint16 *lines);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FMT_H
+
+//
+// End of file
+//
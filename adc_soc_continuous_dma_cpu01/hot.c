@@ -0,0 +1,113 @@
+//###########################################################################
+//
+// FILE:   hot.c
+//
+// TITLE:  Hot paths run from zero wait state RAM.
+//
+// The interrupts, the ring buffers they share with the background loop and
+// the kernels the data goes through are annotated HOT_FUNC() (see hot.h).
+// The project .cmd collects them in the hotfuncs section: in the FLASH
+// build loaded to flash and run from RAMLS1..3 or RAMD0, which the generic
+// command file leaves free, in the RAM build linked straight into them.
+// Hot_Init() copies the section before any of it runs. .TI.ramfunc,
+// copied by InitSysCtrl(), keeps the flash setup and the delay loop.
+//
+// HOT reports where the section runs and how large the copy is;
+// host/ram_report lists the functions in it from the link information of
+// a build. HOT BENCH times a fixed workload of the hot kernels, to compare
+// the CPU1_FLASH build with the CPU1_RAM one, or with itself built with
+// HOT_IN_FLASH.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <string.h>
+#include "hot.h"
+#include "fmt.h"
+#include "rice.h"
+#include "timebase.h"
+#include "tlm.h"
+
+//
+// Defines
+//
+#if defined(_FLASH) && !defined(HOT_IN_FLASH)
+#define HOT_COPIED                  // hotfuncs is loaded to flash
+#endif
+
+//
+// Globals
+//
+#ifdef HOT_COPIED
+extern Uint16 HotfuncsLoadStart;    // Created by the linker, see the
+extern Uint16 HotfuncsLoadSize;     // project .cmd
+extern Uint16 HotfuncsRunStart;
+#endif
+
+Uint32 hotCopyCycles;
+
+//
+// Hot_Init - Copy the hot paths to RAM in the FLASH build. Call before any
+//            interrupt is enabled and before any hot function runs.
+//
+void Hot_Init(void)
+{
+#ifdef HOT_COPIED
+    Uint32 start;
+
+    start = Timebase_Now();
+    memcpy(&HotfuncsRunStart, &HotfuncsLoadStart,
+           (size_t)&HotfuncsLoadSize);
+    hotCopyCycles = Timebase_Now() - start;
+#else
+    hotCopyCycles = 0;
+#endif
+}
+
+//
+// Hot_Info - Where the hot paths are kept and run, and the copy
+//
+void Hot_Info(HOT_INFO *info)
+{
+#ifdef HOT_COPIED
+    info->loadStart = (Uint32)&HotfuncsLoadStart;
+    info->runStart = (Uint32)&HotfuncsRunStart;
+    info->words = (Uint32)&HotfuncsLoadSize;
+#else
+    info->loadStart = 0;
+    info->runStart = 0;
+    info->words = 0;
+#endif
+    info->copyCycles = hotCopyCycles;
+}
+
+//
+// Hot_Bench - Cycles of HOT_BENCH_ROUNDS of the workload: Rice coding,
+//             CRC and CSV text of HOT_BENCH_SAMPLES samples of data of
+//             the given width, with HOT_BENCH_SCRATCH words of scratch.
+//             Run with the interrupts on, as the kernels are; take the
+//             lowest of a few runs.
+//
+Uint32 Hot_Bench(const Uint16 *data, Uint16 bits, Uint16 *scratch)
+{
+    Uint32 start;
+    Uint16 lines;
+    Uint16 i;
+
+    start = Timebase_Now();
+    for(i = 0; i < HOT_BENCH_ROUNDS; i++)
+    {
+        Rice_Encode(data, HOT_BENCH_SAMPLES, bits, scratch);
+        Tlm_Crc16(0xFFFF, data, HOT_BENCH_SAMPLES);
+        Fmt_CsvLines((char *)scratch, HOT_BENCH_SCRATCH, 0, data,
+                     HOT_BENCH_SAMPLES, &lines);
+    }
+    return Timebase_Now() - start;
+}
+
+//
+// End of file
+//
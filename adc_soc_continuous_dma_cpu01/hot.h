@@ -0,0 +1,69 @@
+//###########################################################################
+//
+// FILE:   hot.h
+//
+// TITLE:  Hot paths run from zero wait state RAM.
+//
+//###########################################################################
+
+#ifndef HOT_H
+#define HOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+// A hot function is annotated next to its definition,
+//
+//   HOT_FUNC(Sci_RxService)
+//   static void Sci_RxService(SCI_PORT *p)
+//
+// without a semicolon. It goes into the hotfuncs section, which the
+// project .cmd runs from RAMLS/RAMD; in the FLASH build it is loaded to
+// flash and Hot_Init() copies it at boot, into one 2K-word block: check
+// the size with host/ram_report after adding one. Code that runs before
+// Hot_Init() or sets up the flash stays in .TI.ramfunc. Building with
+// HOT_IN_FLASH leaves the hot paths in .text, to compare (HOT BENCH).
+//
+#define HOT_PRAGMA(x)       _Pragma(#x)
+#ifdef HOT_IN_FLASH
+#define HOT_FUNC(f)
+#else
+#define HOT_FUNC(f)         HOT_PRAGMA(CODE_SECTION(f, "hotfuncs"))
+#endif
+
+#define HOT_BENCH_SAMPLES   256     // Samples of the HOT BENCH workload
+#define HOT_BENCH_ROUNDS    8
+#define HOT_BENCH_SCRATCH   1024    // Words of scratch it needs
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint32 loadStart;               // Where hotfuncs is kept, 0 if it is
+                                    // not copied
+    Uint32 runStart;                // Where it runs
+    Uint32 words;                   // Its size
+    Uint32 copyCycles;              // Time Hot_Init() took to copy it
+} HOT_INFO;
+
+//
+// Function Prototypes
+//
+void Hot_Init(void);
+void Hot_Info(HOT_INFO *info);
+Uint32 Hot_Bench(const Uint16 *data, Uint16 bits, Uint16 *scratch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOT_H
+
+//
+// End of file
+//
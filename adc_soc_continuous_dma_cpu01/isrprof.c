@@ -0,0 +1,308 @@
+//###########################################################################
+//
+// FILE:   isrprof.c
+//
+// TITLE:  Per-vector interrupt execution time and entry latency profiler.
+//
+// The profiled interrupts read Timebase_Now() on entry and pass it to
+// IsrProf_Exit() at the end (see isrprof.h), which keeps the minimum,
+// maximum and mean time spent in each of them and, where the interrupt
+// knows the age of its event, the same of its entry latency: the time its
+// event waited behind disabled interrupts and other handlers, plus the
+// CPU's fixed entry cost.
+//
+// Profiling is off until IsrProf_Enable(). While it is off the pair costs
+// one timer read and a call that only adds the time to the total of all
+// of them, IsrProf_Cycles(), the interrupt share of the CPU load (see
+// load.c); while it is on, a few tens of cycles more. IsrProf_Bench()
+// measures both on the target, the way LOG BENCH does for the log, and
+// IsrProf_Bias() is the part of the cost that ends up in every execution
+// time reported: what an empty handler would show.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <string.h>
+#include "isrprof.h"
+#include "timebase.h"
+#include "hot.h"
+
+//
+// Defines
+//
+#define ISRPROF_BENCH_CALLS 32      // Empty pairs timed by IsrProf_Bench()
+
+//
+// Typedefs
+//
+typedef struct
+{
+    const char *name;
+    Uint16 vector;                  // PIE vector ID, see fault.c
+} ISRPROF_VECTOR;
+
+//
+// Function Prototypes
+//
+static void IsrProf_Pair(Uint16 id);
+
+//
+// Globals
+//
+const ISRPROF_VECTOR isrProfVectors[ISRPROF_COUNT] =
+{
+    {"ADCA1",   32},                // Group 1 channel 1
+    {"DMA_CH1", 80},                // Group 7 channels 1, 2, 3 and 5
+    {"DMA_CH2", 81},
+    {"DMA_CH3", 82},
+    {"DMA_CH5", 84},
+    {"SCIA_RX", 96},                // Group 9 channels 1 to 4
+    {"SCIA_TX", 97},
+    {"SCIB_RX", 98},
+    {"SCIB_TX", 99},
+    {"SCIC_RX", 92},                // Group 8 channels 5 to 8
+    {"SCIC_TX", 93},
+    {"SCID_RX", 94},
+    {"SCID_TX", 95},
+    {"TIMER2",  14},                // INT14
+    {"TIMER0",  38},                // Group 1 channel 7
+};
+
+#pragma DATA_SECTION(isrProfStats, "ramgs4");
+ISRPROF_STATS isrProfStats[ISRPROF_COUNT];
+volatile Uint16 isrProfOn;
+volatile Uint32 isrProfCycles;      // In all profiled interrupts, on or off
+Uint32 isrProfBias;
+ISRPROF_STATS isrProfScratch;       // Taken by the bias measurement
+
+//
+// IsrProf_Init - Start with empty statistics and profiling off, and
+//                measure the fixed cost included in the execution times
+//
+void IsrProf_Init(void)
+{
+    Uint16 i;
+
+    isrProfOn = 0;
+    IsrProf_Clear();
+
+    //
+    // The shortest time an empty pair records, in the scratch entry
+    //
+    isrProfBias = 0;
+    isrProfOn = 1;
+    for(i = 0; i < ISRPROF_BENCH_CALLS; i++)
+    {
+        IsrProf_Pair(ISRPROF_COUNT);
+    }
+    isrProfOn = 0;
+    isrProfBias = isrProfScratch.execMin;
+    isrProfCycles = 0;
+}
+
+//
+// IsrProf_Enable - Turn profiling on or off. The statistics are kept.
+//
+void IsrProf_Enable(Uint16 on)
+{
+    isrProfOn = (on != 0);
+}
+
+//
+// IsrProf_Enabled - Nonzero while profiling is on
+//
+Uint16 IsrProf_Enabled(void)
+{
+    return isrProfOn;
+}
+
+//
+// IsrProf_Exit - Count one run of interrupt id, entered at start with
+//                isrProfCycles at base, whose event happened age cycles
+//                before (or ISRPROF_NO_AGE). ISRPROF_COUNT stands for the
+//                scratch entry.
+//
+HOT_FUNC(IsrProf_Exit)
+void IsrProf_Exit(Uint16 id, Uint32 start, Uint32 base, Uint32 age)
+{
+    ISRPROF_STATS *s;
+    Uint32 exec;
+    Uint32 period;
+
+    //
+    // What nested interrupts added to the total meanwhile is theirs
+    //
+    exec = (Timebase_Now() - start) - (isrProfCycles - base);
+    isrProfCycles += exec;
+    if(isrProfOn == 0)
+    {
+        return;
+    }
+
+    s = (id < ISRPROF_COUNT) ? &isrProfStats[id] : &isrProfScratch;
+    if(s->count == 0)
+    {
+        s->execMin = exec;
+        s->execMax = exec;
+    }
+    else
+    {
+        if(exec < s->execMin)
+        {
+            s->execMin = exec;
+        }
+        else if(exec > s->execMax)
+        {
+            s->execMax = exec;
+        }
+
+        period = start - s->lastStart;
+        if((s->count == 1) || (period < s->periodMin))
+        {
+            s->periodMin = period;
+        }
+        if((s->count == 1) || (period > s->periodMax))
+        {
+            s->periodMax = period;
+        }
+    }
+    s->lastStart = start;
+    s->execSum += exec;
+    s->count++;
+
+    if(age == ISRPROF_NO_AGE)
+    {
+        return;
+    }
+    if(s->latCount == 0)
+    {
+        s->latMin = age;
+        s->latMax = age;
+    }
+    else if(age < s->latMin)
+    {
+        s->latMin = age;
+    }
+    else if(age > s->latMax)
+    {
+        s->latMax = age;
+    }
+    s->latSum += age;
+    s->latCount++;
+}
+
+//
+// IsrProf_Name - Name of interrupt id
+//
+const char *IsrProf_Name(Uint16 id)
+{
+    return isrProfVectors[id].name;
+}
+
+//
+// IsrProf_Vector - PIE vector ID of interrupt id
+//
+Uint16 IsrProf_Vector(Uint16 id)
+{
+    return isrProfVectors[id].vector;
+}
+
+//
+// IsrProf_Stats - Copy the statistics of interrupt id, consistent with
+//                 each other
+//
+void IsrProf_Stats(Uint16 id, ISRPROF_STATS *stats)
+{
+    Uint16 intState;
+
+    intState = __disable_interrupts();
+    *stats = isrProfStats[id];
+    __restore_interrupts(intState);
+}
+
+//
+// IsrProf_Clear - Start the statistics again
+//
+void IsrProf_Clear(void)
+{
+    Uint16 intState;
+
+    intState = __disable_interrupts();
+    memset(isrProfStats, 0, sizeof(isrProfStats));
+    memset(&isrProfScratch, 0, sizeof(isrProfScratch));
+    __restore_interrupts(intState);
+}
+
+//
+// IsrProf_Bias - Cycles an empty handler would show as its execution time
+//
+Uint32 IsrProf_Bias(void)
+{
+    return isrProfBias;
+}
+
+//
+// IsrProf_Cycles - Cycles spent in the profiled interrupts since startup,
+//                  counted whether profiling is on or not; differences of
+//                  two readings are valid across the wrap
+//
+Uint32 IsrProf_Cycles(void)
+{
+    return isrProfCycles;
+}
+
+//
+// IsrProf_Bench - Cost in cycles of one ISRPROF_ENTER()/ISRPROF_EXIT()
+//                 pair with profiling on and off, timed over
+//                 ISRPROF_BENCH_CALLS empty pairs with the interrupts held
+//                 off. The statistics are kept.
+//
+void IsrProf_Bench(Uint32 *on, Uint32 *off)
+{
+    Uint16 intState;
+    Uint16 wasOn;
+    Uint16 i;
+    Uint32 start;
+    Uint32 cycles;
+
+    intState = __disable_interrupts();
+    wasOn = isrProfOn;
+    cycles = isrProfCycles;         // The pairs are no interrupt time
+
+    isrProfOn = 1;
+    start = Timebase_Now();
+    for(i = 0; i < ISRPROF_BENCH_CALLS; i++)
+    {
+        IsrProf_Pair(ISRPROF_COUNT);
+    }
+    *on = (Timebase_Now() - start) / ISRPROF_BENCH_CALLS;
+
+    isrProfOn = 0;
+    start = Timebase_Now();
+    for(i = 0; i < ISRPROF_BENCH_CALLS; i++)
+    {
+        IsrProf_Pair(ISRPROF_COUNT);
+    }
+    *off = (Timebase_Now() - start) / ISRPROF_BENCH_CALLS;
+
+    isrProfOn = wasOn;
+    isrProfCycles = cycles;
+    __restore_interrupts(intState);
+}
+
+//
+// IsrProf_Pair - An empty profiled handler body
+//
+HOT_FUNC(IsrProf_Pair)
+static void IsrProf_Pair(Uint16 id)
+{
+    ISRPROF_ENTER();
+    ISRPROF_EXIT(id);
+}
+
+//
+// End of file
+//
@@ -0,0 +1,119 @@
+//###########################################################################
+//
+// FILE:   isrprof.h
+//
+// TITLE:  Per-vector interrupt execution time and entry latency profiler.
+//
+//###########################################################################
+
+#ifndef ISRPROF_H
+#define ISRPROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "timebase.h"
+
+//
+// Defines
+//
+// A profiled interrupt takes the time first and hands it in last:
+//
+//   __interrupt void scibTxIsr(void)
+//   {
+//       ISRPROF_ENTER();
+//       ...
+//       ISRPROF_EXIT(ISRPROF_SCIB_TX);
+//   }
+//
+// An interrupt that can tell how long ago its event happened, from the
+// counter of the peripheral that raised it, gives that age in cycles with
+// ISRPROF_EXIT_AGE() and so has its entry latency profiled as well.
+// ISRPROF_ENTER() is a declaration and must come first in the body;
+// ISRPROF_EXIT() must run with the interrupts held off, after NEST_EXIT()
+// in a nesting interrupt (see nest.h).
+//
+#define ISRPROF_ENTER()             Uint32 isrProfStart = Timebase_Now(), \
+                                           isrProfBase = isrProfCycles
+#define ISRPROF_EXIT(id)            IsrProf_Exit(id, isrProfStart, \
+                                                 isrProfBase, ISRPROF_NO_AGE)
+#define ISRPROF_EXIT_AGE(id, age)   IsrProf_Exit(id, isrProfStart, \
+                                                 isrProfBase, age)
+
+#define ISRPROF_NO_AGE      0xFFFFFFFFUL
+
+//
+// Profiled interrupts
+//
+#define ISRPROF_ADCA1       0       // Start of a capture
+#define ISRPROF_DMA_CH1     1       // Capture end, stream half of ADCA
+#define ISRPROF_DMA_CH2     2       // Stream half of ADCB
+#define ISRPROF_DMA_CH3     3       // McBSP frame sent
+#define ISRPROF_DMA_CH5     4       // SPI frame sent
+#define ISRPROF_SCIA_RX     5       // SCI FIFO interrupts, RX and TX of
+#define ISRPROF_SCIA_TX     6       // each port in turn
+#define ISRPROF_SCIB_RX     7
+#define ISRPROF_SCIB_TX     8
+#define ISRPROF_SCIC_RX     9
+#define ISRPROF_SCIC_TX     10
+#define ISRPROF_SCID_RX     11
+#define ISRPROF_SCID_TX     12
+#define ISRPROF_TIMER2      13      // Idle wake-up tick (load.c)
+#define ISRPROF_TIMER0      14      // Soft timers (timer.c)
+#define ISRPROF_COUNT       15
+
+//
+// Typedefs
+//
+// Times in cycles. exec runs from ISRPROF_ENTER() to ISRPROF_EXIT(), less
+// the interrupts nested in it, so it misses the CPU's own context save and
+// restore and includes the fixed cost of the pair (IsrProf_Bias()). lat
+// is kept only for ISRPROF_EXIT_AGE(). period is the time from one entry
+// to the next: for a periodic interrupt its spread, max less min, bounds
+// how much the entry latency varies.
+//
+typedef struct
+{
+    Uint32 count;
+    Uint32 execMin;
+    Uint32 execMax;
+    Uint64 execSum;
+    Uint32 latCount;
+    Uint32 latMin;
+    Uint32 latMax;
+    Uint64 latSum;
+    Uint32 periodMin;               // Valid from the second run
+    Uint32 periodMax;
+    Uint32 lastStart;
+} ISRPROF_STATS;
+
+//
+// Globals
+//
+extern volatile Uint32 isrProfCycles;
+
+//
+// Function Prototypes
+//
+void IsrProf_Init(void);
+void IsrProf_Enable(Uint16 on);
+Uint16 IsrProf_Enabled(void);
+void IsrProf_Exit(Uint16 id, Uint32 start, Uint32 base, Uint32 age);
+const char *IsrProf_Name(Uint16 id);
+Uint16 IsrProf_Vector(Uint16 id);
+void IsrProf_Stats(Uint16 id, ISRPROF_STATS *stats);
+void IsrProf_Clear(void);
+Uint32 IsrProf_Bias(void);
+Uint32 IsrProf_Cycles(void);
+void IsrProf_Bench(Uint32 *on, Uint32 *off);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ISRPROF_H
+
+//
+// End of file
+//
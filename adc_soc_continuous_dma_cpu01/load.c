@@ -0,0 +1,201 @@
+//###########################################################################
+//
+// FILE:   load.c
+//
+// TITLE:  CPU load: cycles in interrupts, in the background loop and idle.
+//
+// The background loop calls Load_Idle() when a pass has found nothing to
+// do that no interrupt would announce. It sleeps in IDLE() until the next
+// interrupt instead of spinning, and the time asleep is the idle share.
+// Every source of background work wakes it: the DMA, SCI and link
+// interrupts directly, and whatever only waits for time (status frames,
+// ARQ and MEM timeouts) by the LOAD_TICK_HZ tick of CPU Timer 2, which is
+// also the most an interrupt that slips in just before IDLE() can delay
+// the loop.
+//
+// The cycles are split over three buckets:
+//
+//   isr        - the profiled interrupts, IsrProf_Cycles() (isrprof.c)
+//   idle       - time in IDLE(), less the interrupts that ran in it
+//   background - the rest
+//
+// Interrupts that are not profiled (the CTS edges, faults) and the CPU's
+// own context save and restore count towards where they happened, the
+// background or idle; they are a few tens of cycles each.
+//
+// Load_Poll() closes a window every LOAD_WINDOW_MS and keeps the load,
+// interrupts and background, of the last LOAD_WINDOWS of them.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <string.h>
+#include "load.h"
+#include "isrprof.h"
+#include "nest.h"
+#include "timebase.h"
+#include "hot.h"
+
+//
+// Defines
+//
+#define LOAD_WINDOW_CYCLES  (TIMEBASE_HZ / 1000 * LOAD_WINDOW_MS)
+
+//
+// Function Prototypes
+//
+static Uint16 Load_Share(Uint32 cycles, Uint32 total);
+
+//
+// Globals
+//
+Uint32 loadStart;                   // Window start, Timebase_Now()
+Uint32 loadIsrStart;                // IsrProf_Cycles() at it
+Uint32 loadIdle;                    // Idle cycles in it
+Uint16 loadHistory[LOAD_WINDOWS];   // Load of the last windows
+LOAD_STATS loadStats;
+
+//
+// Load_Init - Start the wake-up tick on CPU Timer 2, INT14, which has no
+//             PIE group to share, and the first window
+//
+void Load_Init(void)
+{
+    CpuTimer2Regs.TCR.bit.TSS = 1;          // Stop the timer
+    CpuTimer2Regs.PRD.all = TIMEBASE_HZ / LOAD_TICK_HZ - 1;
+    CpuTimer2Regs.TPR.all = 0;              // Prescale by 1
+    CpuTimer2Regs.TPRH.all = 0;
+    CpuTimer2Regs.TCR.bit.FREE = 1;
+    CpuTimer2Regs.TCR.bit.TRB = 1;          // Reload the counter
+    CpuTimer2Regs.TCR.bit.TIF = 1;          // Clear a stale flag
+    CpuTimer2Regs.TCR.bit.TIE = 1;
+    CpuTimer2Regs.TCR.bit.TSS = 0;          // Start the timer
+
+    IER |= M_INT14;
+
+    Load_Clear();
+}
+
+//
+// Load_Idle - Sleep until the next interrupt and count the time as idle.
+//             Call from the background loop only.
+//
+void Load_Idle(void)
+{
+    Uint32 start;
+    Uint32 isr;
+
+    start = Timebase_Now();
+    isr = IsrProf_Cycles();
+    IDLE();
+    loadIdle += (Timebase_Now() - start) - (IsrProf_Cycles() - isr);
+}
+
+//
+// Load_Poll - Close the window once it is LOAD_WINDOW_MS long. Call from
+//             the background loop on every pass.
+//
+void Load_Poll(void)
+{
+    Uint32 now;
+    Uint32 total;
+    Uint32 isrNow;
+    Uint32 isr;
+    Uint32 idle;
+    Uint32 sum;
+    Uint16 load;
+    Uint16 n;
+    Uint16 i;
+
+    now = Timebase_Now();
+    total = now - loadStart;
+    if(total < LOAD_WINDOW_CYCLES)
+    {
+        return;
+    }
+
+    isrNow = IsrProf_Cycles();
+    isr = isrNow - loadIsrStart;
+    idle = loadIdle;
+    if(isr > total)
+    {
+        isr = total;
+    }
+    if(idle > total - isr)
+    {
+        idle = total - isr;
+    }
+
+    loadStats.isr = Load_Share(isr, total);
+    loadStats.idle = Load_Share(idle, total);
+    loadStats.background = 1000 - loadStats.isr - loadStats.idle;
+    load = 1000 - loadStats.idle;
+    if(load > loadStats.peak)
+    {
+        loadStats.peak = load;
+    }
+
+    loadHistory[loadStats.windows % LOAD_WINDOWS] = load;
+    loadStats.windows++;
+    n = (loadStats.windows < LOAD_WINDOWS) ? (Uint16)loadStats.windows :
+                                             LOAD_WINDOWS;
+    sum = 0;
+    for(i = 0; i < n; i++)
+    {
+        sum += loadHistory[i];
+    }
+    loadStats.rolling = (Uint16)(sum / n);
+
+    loadStart = now;
+    loadIsrStart = isrNow;
+    loadIdle = 0;
+}
+
+//
+// Load_Stats - Copy the shares of the last window and the rolling load
+//
+void Load_Stats(LOAD_STATS *stats)
+{
+    *stats = loadStats;
+}
+
+//
+// Load_Clear - Forget the windows and start a new one
+//
+void Load_Clear(void)
+{
+    memset(&loadStats, 0, sizeof(loadStats));
+    memset(loadHistory, 0, sizeof(loadHistory));
+    loadStart = Timebase_Now();
+    loadIsrStart = IsrProf_Cycles();
+    loadIdle = 0;
+}
+
+//
+// Load_Share - cycles in 1/1000 of total
+//
+static Uint16 Load_Share(Uint32 cycles, Uint32 total)
+{
+    return (Uint16)((float32)cycles * 1000.0f / (float32)total);
+}
+
+//
+// loadTickIsr - Only wakes the background loop from IDLE()
+//
+HOT_FUNC(loadTickIsr)
+__interrupt void loadTickIsr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    CpuTimer2Regs.TCR.bit.TIF = 1;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_TIMER2);
+}
+
+//
+// End of file
+//
@@ -0,0 +1,58 @@
+//###########################################################################
+//
+// FILE:   load.h
+//
+// TITLE:  CPU load: cycles in interrupts, in the background loop and idle.
+//
+//###########################################################################
+
+#ifndef LOAD_H
+#define LOAD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define LOAD_TICK_HZ        1000    // Wake-up tick of the idle loop
+#define LOAD_WINDOW_MS      100     // Load measured over each window
+#define LOAD_WINDOWS        10      // Windows in the rolling load
+
+//
+// Typedefs
+//
+// All in 1/1000 of the CPU
+//
+typedef struct
+{
+    Uint16 isr;                     // Last window: in the interrupts
+    Uint16 background;              // ... in the background loop
+    Uint16 idle;                    // ... in IDLE()
+    Uint16 rolling;                 // Load, interrupts and background,
+                                    // over the last LOAD_WINDOWS windows
+    Uint16 peak;                    // Highest load of a window since
+                                    // Load_Clear()
+    Uint32 windows;                 // Windows since Load_Clear()
+} LOAD_STATS;
+
+//
+// Function Prototypes
+//
+void Load_Init(void);
+void Load_Idle(void);
+void Load_Poll(void);
+void Load_Stats(LOAD_STATS *stats);
+void Load_Clear(void);
+__interrupt void loadTickIsr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOAD_H
+
+//
+// End of file
+//
@@ -0,0 +1,278 @@
+//###########################################################################
+//
+// FILE:   log.c
+//
+// TITLE:  Deferred-format (tokenized) event log.
+//
+// Formatting a message with sprintf() costs thousands of cycles and the
+// string takes flash; neither is acceptable in an interrupt. A LOGn() call
+// instead stores a small binary record, the message ID, the cycle count
+// and the raw arguments, into logRing with interrupts briefly disabled.
+// That is a few tens of cycles, so logging can stay on in the ISRs.
+//
+//   Log_Write() - any context: append one record, or count it as lost
+//                 if the ring is full
+//   Log_Poll()  - background loop: move whole records into TLM_TYPE_LOG
+//                 frames on the telemetry ports
+//
+// The formatting is done on the host: host/log_render looks each ID up in
+// log_strings.txt, the table host/log_strings extracts from the LOGn()
+// calls of the sources, and prints the arguments with its format.
+//
+// Records that find the ring full are counted and reported, once the ring
+// has been drained, as a record of the built in message LOG_ID_LOST,
+// "%lu records lost", with the time of the last one lost.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "log.h"
+#include "tlm.h"
+#include "timebase.h"
+#include "hot.h"
+
+//
+// Defines
+//
+#define LOG_MASK        (LOG_LEN - 1)
+
+//
+// Globals
+//
+#pragma DATA_SECTION(logRing, "ramgs4");
+Uint16 logRing[LOG_LEN];
+volatile Uint16 logHead;            // Written by Log_Write()
+volatile Uint16 logTail;            // Written by Log_Poll()
+volatile Uint16 logEnabled;
+volatile Uint32 logRecords;
+volatile Uint32 logLost;
+volatile Uint32 logLostTime;        // Time of the last lost record
+Uint32 logLostSent;                 // Lost records already reported
+
+//
+// Log_Init - Start with an empty ring and logging off
+//
+void Log_Init(void)
+{
+    logEnabled = 0;
+    Log_Clear();
+}
+
+//
+// Log_Enable - Turn logging on or off. While it is off LOGn() calls return
+//              at once and nothing is sent.
+//
+void Log_Enable(Uint16 on)
+{
+    logEnabled = (on != 0);
+}
+
+//
+// Log_Enabled - Nonzero while logging is on
+//
+Uint16 Log_Enabled(void)
+{
+    return logEnabled;
+}
+
+//
+// Log_Write - Append a record of nargs (at most 3) arguments. Called
+//             through the LOGn() macros from any context; interrupts are
+//             held off only while the record is stored.
+//
+HOT_FUNC(Log_Write)
+void Log_Write(Uint16 id, Uint16 nargs, Uint32 a, Uint32 b, Uint32 c)
+{
+    Uint16 intState;
+    Uint16 head;
+    Uint32 now;
+
+    if(logEnabled == 0)
+    {
+        return;
+    }
+
+    intState = __disable_interrupts();
+
+    now = Timebase_Now();
+    head = logHead;
+    if((Uint16)(head - logTail) > LOG_LEN - LOG_RECORD_WORDS(nargs))
+    {
+        logLost++;
+        logLostTime = now;
+        __restore_interrupts(intState);
+        return;
+    }
+
+    logRing[head++ & LOG_MASK] = id;
+    logRing[head++ & LOG_MASK] = nargs;
+    logRing[head++ & LOG_MASK] = (Uint16)now;
+    logRing[head++ & LOG_MASK] = (Uint16)(now >> 16);
+    if(nargs > 0)
+    {
+        logRing[head++ & LOG_MASK] = (Uint16)a;
+        logRing[head++ & LOG_MASK] = (Uint16)(a >> 16);
+        if(nargs > 1)
+        {
+            logRing[head++ & LOG_MASK] = (Uint16)b;
+            logRing[head++ & LOG_MASK] = (Uint16)(b >> 16);
+            if(nargs > 2)
+            {
+                logRing[head++ & LOG_MASK] = (Uint16)c;
+                logRing[head++ & LOG_MASK] = (Uint16)(c >> 16);
+            }
+        }
+    }
+    logHead = head;
+    logRecords++;
+
+    __restore_interrupts(intState);
+}
+
+//
+// Log_FloatBits - The bits of a float as a LOGn() argument
+//
+Uint32 Log_FloatBits(float32 x)
+{
+    union
+    {
+        float32 f;
+        Uint32 u;
+    } bits;
+
+    bits.f = x;
+    return bits.u;
+}
+
+//
+// Log_PutWord - Store one word of a record as high, low byte
+//
+static Uint16 *Log_PutWord(Uint16 *out, Uint16 w)
+{
+    out[0] = w >> 8;
+    out[1] = w & 0xFF;
+    return out + 2;
+}
+
+//
+// Log_Ready - Nonzero while records or a loss wait to be framed
+//
+Uint16 Log_Ready(void)
+{
+    return (logEnabled != 0) &&
+           ((logHead != logTail) || (logLost != logLostSent));
+}
+
+//
+// Log_Poll - Keep the frames in flight moving and, once a telemetry port
+//            is free, frame as many whole records as fit in
+//            LOG_FRAME_BYTES. The LOG stream of the frame scheduler
+//            (sched.c).
+//
+void Log_Poll(void)
+{
+    Uint16 *payload;
+    Uint16 *out;
+    Uint16 tail;
+    Uint16 head;
+    Uint16 words;
+    Uint16 room;
+    Uint16 i;
+    Uint32 lost;
+    Uint32 time;
+
+    if(Tlm_Busy() != 0)
+    {
+        Tlm_SendStep();
+        return;
+    }
+
+    lost = logLost - logLostSent;
+    if((logEnabled == 0) || ((logHead == logTail) && (lost == 0)))
+    {
+        return;
+    }
+
+    payload = Tlm_Begin(TLM_TYPE_LOG);
+    out = payload;
+    room = LOG_FRAME_BYTES / 2 - LOG_RECORD_WORDS(1);
+
+    //
+    // Records are complete once logHead covers them, so only whole ones
+    // are ever seen here
+    //
+    tail = logTail;
+    head = logHead;
+    while(tail != head)
+    {
+        words = LOG_RECORD_WORDS(logRing[(tail + 1) & LOG_MASK]);
+        if(words > room)
+        {
+            break;
+        }
+        for(i = 0; i < words; i++)
+        {
+            out = Log_PutWord(out, logRing[tail++ & LOG_MASK]);
+        }
+        room -= words;
+    }
+    logTail = tail;
+
+    //
+    // The losses came after what was in the ring, so their record goes
+    // last; room for it was kept
+    //
+    if((tail == head) && (lost != 0))
+    {
+        lost = logLost - logLostSent;
+        time = logLostTime;
+        out = Log_PutWord(out, LOG_ID_LOST);
+        out = Log_PutWord(out, 1);
+        out = Log_PutWord(out, (Uint16)time);
+        out = Log_PutWord(out, (Uint16)(time >> 16));
+        out = Log_PutWord(out, (Uint16)lost);
+        out = Log_PutWord(out, (Uint16)(lost >> 16));
+        logLostSent += lost;
+    }
+
+    Tlm_Commit(out - payload);
+    Tlm_SendStep();
+}
+
+//
+// Log_Clear - Discard the records not yet sent and restart the counters
+//
+void Log_Clear(void)
+{
+    Uint16 intState;
+
+    intState = __disable_interrupts();
+    logTail = logHead;
+    logRecords = 0;
+    logLost = 0;
+    logLostSent = 0;
+    __restore_interrupts(intState);
+}
+
+//
+// Log_Records - Records stored since the last Log_Clear()
+//
+Uint32 Log_Records(void)
+{
+    return logRecords;
+}
+
+//
+// Log_Lost - Records lost to a full ring since the last Log_Clear()
+//
+Uint32 Log_Lost(void)
+{
+    return logLost;
+}
+
+//
+// End of file
+//
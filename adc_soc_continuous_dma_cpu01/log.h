@@ -0,0 +1,75 @@
+//###########################################################################
+//
+// FILE:   log.h
+//
+// TITLE:  Deferred-format (tokenized) event log.
+//
+//###########################################################################
+
+#ifndef LOG_H
+#define LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "log_ids.h"
+
+//
+// Defines
+//
+// A call site names its message and gives the format in place:
+//
+//   LOG2(LOG_STREAM_START, "stream ratio %u, %u bits", ratio, bits);
+//
+// Only the ID and the arguments reach the target; the format string is
+// never referenced and stays out of the image. host/log_strings.c
+// collects the formats into log_strings.txt and numbers the IDs in
+// log_ids.h; rerun it after adding or changing a call. Every argument is
+// passed as 32 bits, so %d, %u, %x, %c and their l forms all work; floats
+// are passed with LOG_FLOAT() and printed with %f, %e or %g.
+//
+#define LOG0(id, fmt)               Log_Write(id, 0, 0, 0, 0)
+#define LOG1(id, fmt, a)            Log_Write(id, 1, (Uint32)(a), 0, 0)
+#define LOG2(id, fmt, a, b)         Log_Write(id, 2, (Uint32)(a), \
+                                              (Uint32)(b), 0)
+#define LOG3(id, fmt, a, b, c)      Log_Write(id, 3, (Uint32)(a), \
+                                              (Uint32)(b), (Uint32)(c))
+#define LOG_FLOAT(x)                Log_FloatBits(x)
+
+#define LOG_LEN             512     // Ring of records (power of two)
+#define LOG_FRAME_BYTES     240     // Largest TLM_TYPE_LOG payload
+#define LOG_ID_LOST         0       // Built in "records lost" message
+
+//
+// Record layout in the ring and, high byte first, in the frames:
+//
+//   id nargs timeLo timeHi (argLo argHi) * nargs
+//
+// time is Timebase_Now() at the call.
+//
+#define LOG_RECORD_WORDS(n) (4 + 2 * (n))
+
+//
+// Function Prototypes
+//
+void Log_Init(void);
+void Log_Enable(Uint16 on);
+Uint16 Log_Enabled(void);
+void Log_Write(Uint16 id, Uint16 nargs, Uint32 a, Uint32 b, Uint32 c);
+Uint32 Log_FloatBits(float32 x);
+Uint16 Log_Ready(void);
+void Log_Poll(void);
+void Log_Clear(void);
+Uint32 Log_Records(void);
+Uint32 Log_Lost(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOG_H
+
+//
+// End of file
+//
@@ -0,0 +1,28 @@
+//###########################################################################
+//
+// FILE:   log_ids.h
+//
+// TITLE:  Log message IDs, generated by host/log_strings from the
+//         LOGn() calls. Do not edit; the formats are in log_strings.txt.
+//
+//###########################################################################
+
+#ifndef LOG_IDS_H
+#define LOG_IDS_H
+
+//
+// Defines
+//
+#define LOG_BENCH                       1
+#define LOG_CAPTURE_DONE                2
+#define LOG_SKEW_RESULT                 3
+#define LOG_STREAM_DROP                 4
+#define LOG_STREAM_OVERRUN              5
+#define LOG_STREAM_START                6
+#define LOG_STREAM_STOP                 7
+
+#endif // LOG_IDS_H
+
+//
+// End of file
+//
@@ -0,0 +1,254 @@
+//###########################################################################
+//
+// FILE:   mcbsp.c
+//
+// TITLE:  McBSP-A streaming of ADC blocks by DMA.
+//
+// A second bulk data link next to SPI-A (spi.c). Unlike the SPI slave it
+// needs no master: McBSP-A transmits on its own clock, CLKX and FSX from
+// the sample rate generator, so every frame goes out as soon as it is
+// armed and the link runs at the full bit rate.
+//
+//   Mcbsp_SendBlock() - packs one block into mcbspBlock as a TLM_TYPE_RAW
+//                       frame and arms DMA CH3
+//   CH3 interrupt     - the last word is in DXR: the buffer is free for
+//                       the next block
+//
+// CH3 is triggered by the transmit event (XRDY, DXR empty) and moves one
+// word per event. The words are 16 bits, MSB first, each marked by a
+// one-bit FSX pulse one CLKX ahead of it (XDATDLY 1). FSX is generated on
+// every DXR to XSR copy, so between frames there are neither clocks on
+// FSX nor pulses and a capture device sees only frame data. The byte
+// stream is the same as on the SPI link and is read by host/rice_decode.
+//
+// Pins (100-pin package):
+//
+//   MDXA GPIO20  MDRA GPIO21  MCLKXA GPIO22  MFSXA GPIO23  (mux 2)
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "tlm.h"
+#include "mcbsp.h"
+#include "timebase.h"
+#include "isrprof.h"
+#include "nest.h"
+#include "hot.h"
+
+//
+// Globals
+//
+#pragma DATA_SECTION(mcbspBlock, "ramgs1");
+Uint16 mcbspBlock[TLM_RAW_WORDS(MCBSP_BLOCK_SAMPLES)];
+volatile Uint16 mcbspBusy;
+Uint16 mcbspSeq;
+Uint16 mcbspClkgdv;
+volatile Uint32 mcbspFrames;
+Uint32 mcbspBytes;
+volatile Uint32 mcbspCycles;    // CPU cycles packing and in the interrupt
+
+//
+// Mcbsp_Init - Set up the pins and McBSP-A as a master transmitter at
+//              MCBSP_CLKGDV_DEFAULT, and the CH3 interrupt. The DMA must
+//              have been reset by DMAInitialize() before the first
+//              Mcbsp_SendBlock().
+//
+void Mcbsp_Init(void)
+{
+    GPIO_SetupPinMux(20, GPIO_MUX_CPU1, 2);
+    GPIO_SetupPinOptions(20, GPIO_OUTPUT, GPIO_PUSHPULL);
+    GPIO_SetupPinMux(21, GPIO_MUX_CPU1, 2);
+    GPIO_SetupPinOptions(21, GPIO_INPUT, GPIO_ASYNC);
+    GPIO_SetupPinMux(22, GPIO_MUX_CPU1, 2);
+    GPIO_SetupPinOptions(22, GPIO_OUTPUT, GPIO_PUSHPULL);
+    GPIO_SetupPinMux(23, GPIO_MUX_CPU1, 2);
+    GPIO_SetupPinOptions(23, GPIO_OUTPUT, GPIO_PUSHPULL);
+
+    McbspaRegs.SPCR2.all = 0x0000;  // Reset transmitter, SRG and FS logic
+    McbspaRegs.SPCR1.all = 0x0000;  // Reset receiver, no loopback
+    McbspaRegs.MFFINT.all = 0x0000; // No McBSP interrupts
+    McbspaRegs.RCR2.all = 0x0000;
+    McbspaRegs.RCR1.all = 0x0000;
+
+    McbspaRegs.XCR2.all = 0x0001;   // Single phase, XDATDLY 1
+    McbspaRegs.XCR1.all = 0x0040;   // One 16-bit word per frame
+
+    McbspaRegs.SRGR2.all = 0x2000;  // CLKSRG = LSPCLK, FSX on DXR copy
+    McbspaRegs.PCR.all = 0x0A00;    // CLKX and FSX driven by the SRG
+    McbspaRegs.SPCR2.bit.FREE = 1;
+
+    mcbspClkgdv = 0;
+    mcbspBusy = 0;
+    Mcbsp_SetClock(MCBSP_CLKGDV_DEFAULT);
+
+    PieCtrlRegs.PIEIER7.bit.INTx3 = 1;
+
+    IER |= M_INT7;
+
+    mcbspSeq = 0;
+    Mcbsp_ClearStats();
+}
+
+//
+// Mcbsp_SetClock - Set CLKX to LSPCLK / (clkgdv + 1) and restart the
+//                  transmitter. Returns the bit rate, or 0 and changes
+//                  nothing while a frame is being sent or if clkgdv is
+//                  outside MCBSP_CLKGDV_MIN..255.
+//
+Uint32 Mcbsp_SetClock(Uint16 clkgdv)
+{
+    if((mcbspBusy != 0) || (clkgdv < MCBSP_CLKGDV_MIN) || (clkgdv > 255))
+    {
+        return 0;
+    }
+
+    McbspaRegs.SPCR2.bit.XRST = 0;
+    McbspaRegs.SPCR2.bit.FRST = 0;
+    McbspaRegs.SPCR2.bit.GRST = 0;
+    McbspaRegs.SRGR1.all = clkgdv;  // FWID 0: one CLKX wide FSX
+    DELAY_US(1);
+
+    McbspaRegs.SPCR2.bit.GRST = 1;
+    DELAY_US(1);                    // Two SRG clocks before XRST
+    McbspaRegs.SPCR2.bit.XRST = 1;
+    McbspaRegs.SPCR2.bit.FRST = 1;
+
+    mcbspClkgdv = clkgdv;
+    return Mcbsp_BitRate();
+}
+
+//
+// Mcbsp_BitRate - Current CLKX rate in bit/s
+//
+Uint32 Mcbsp_BitRate(void)
+{
+    return MCBSP_LSPCLK_HZ / (mcbspClkgdv + 1);
+}
+
+//
+// Mcbsp_Busy - Nonzero while the DMA is still moving the last block
+//
+Uint16 Mcbsp_Busy(void)
+{
+    return mcbspBusy;
+}
+
+//
+// Mcbsp_SendBlock - Pack count (at most MCBSP_BLOCK_SAMPLES) samples of a
+//                   channel into a TLM_TYPE_RAW frame and start the DMA on
+//                   it. Returns 0 and sends nothing while the previous
+//                   block is still being moved.
+//
+Uint16 Mcbsp_SendBlock(Uint16 ch, Uint16 bits, const Uint16 *data,
+                       Uint16 count)
+{
+    Uint16 words;
+    Uint32 start;
+
+    if(mcbspBusy != 0)
+    {
+        return 0;
+    }
+
+    start = Timebase_Now();
+    words = Tlm_PackRaw(mcbspBlock, mcbspSeq, ch, bits, data, count);
+    mcbspSeq = (mcbspSeq + 1) & 0xFF;
+    mcbspBytes += 2UL * words;
+    mcbspBusy = 1;
+
+    DMACH3AddrConfig(&McbspaRegs.DXR1.all, mcbspBlock);
+    DMACH3BurstConfig(0, 0, 0);
+    DMACH3TransferConfig(words - 1, 1, 0);
+    DMACH3ModeConfig(
+                        DMA_MXEVTA,
+                        PERINT_ENABLE,
+                        ONESHOT_DISABLE,
+                        CONT_DISABLE,
+                        SYNC_DISABLE,
+                        SYNC_SRC,
+                        OVRFLOW_DISABLE,
+                        SIXTEEN_BIT,
+                        CHINT_END,
+                        CHINT_ENABLE
+                    );
+    StartDMACH3();
+
+    //
+    // The transmit event is XRDY rising. With DXR already empty (an idle
+    // link) it does not come again, so the first word is forced. A word
+    // already moved by an event since the channel was armed is left alone.
+    //
+    EALLOW;
+    if((McbspaRegs.SPCR2.bit.XRDY != 0) &&
+       (DmaRegs.CH3.CONTROL.bit.PERINTFLG == 0) &&
+       (DmaRegs.CH3.CONTROL.bit.TRANSFERSTS == 0))
+    {
+        DmaRegs.CH3.CONTROL.bit.PERINTFRC = 1;
+    }
+    EDIS;
+
+    mcbspCycles += Timebase_Now() - start;
+    return 1;
+}
+
+//
+// Mcbsp_Frames - Frames sent since the last Mcbsp_ClearStats()
+//
+Uint32 Mcbsp_Frames(void)
+{
+    return mcbspFrames;
+}
+
+//
+// Mcbsp_Bytes - Bytes of the frames started since the last
+//               Mcbsp_ClearStats()
+//
+Uint32 Mcbsp_Bytes(void)
+{
+    return mcbspBytes;
+}
+
+//
+// Mcbsp_Cycles - CPU cycles spent packing blocks and in the CH3 interrupt
+//
+Uint32 Mcbsp_Cycles(void)
+{
+    return mcbspCycles;
+}
+
+//
+// Mcbsp_ClearStats - Restart the counters
+//
+void Mcbsp_ClearStats(void)
+{
+    mcbspFrames = 0;
+    mcbspBytes = 0;
+    mcbspCycles = 0;
+}
+
+//
+// mcbspDmaIsr - CH3 has written the last word of the frame to DXR
+//
+HOT_FUNC(mcbspDmaIsr)
+__interrupt void mcbspDmaIsr(void)
+{
+    Uint32 start;
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    start = Timebase_Now();
+    mcbspFrames++;
+    mcbspBusy = 0;
+    mcbspCycles += Timebase_Now() - start;
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP7;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_DMA_CH3);
+}
+
+//
+// End of file
+//
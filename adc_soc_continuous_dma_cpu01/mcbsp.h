@@ -0,0 +1,50 @@
+//###########################################################################
+//
+// FILE:   mcbsp.h
+//
+// TITLE:  McBSP-A streaming of ADC blocks by DMA.
+//
+//###########################################################################
+
+#ifndef MCBSP_H
+#define MCBSP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+// Blocks are sent as telemetry frames (tlm.h) of type TLM_TYPE_RAW with
+// the bytes packed two per 16-bit McBSP word, high byte first.
+//
+#define MCBSP_BLOCK_SAMPLES 512     // Largest block of one Mcbsp_SendBlock()
+#define MCBSP_LSPCLK_HZ     50000000UL  // Sample rate generator input
+#define MCBSP_CLKGDV_MIN    1       // CLKX = LSPCLK / (CLKGDV + 1)
+#define MCBSP_CLKGDV_DEFAULT 4      // 10 Mbit/s
+
+//
+// Function Prototypes
+//
+void Mcbsp_Init(void);
+Uint32 Mcbsp_SetClock(Uint16 clkgdv);
+Uint32 Mcbsp_BitRate(void);
+Uint16 Mcbsp_Busy(void);
+Uint16 Mcbsp_SendBlock(Uint16 ch, Uint16 bits, const Uint16 *data,
+                       Uint16 count);
+Uint32 Mcbsp_Frames(void);
+Uint32 Mcbsp_Bytes(void);
+Uint32 Mcbsp_Cycles(void);
+void Mcbsp_ClearStats(void);
+__interrupt void mcbspDmaIsr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MCBSP_H
+
+//
+// End of file
+//
@@ -0,0 +1,380 @@
+//###########################################################################
+//
+// FILE:   mem.c
+//
+// TITLE:  Target memory read, write, CRC and streaming over the SCI links.
+//
+// Field access to captured buffers, calibration tables and logs without a
+// JTAG probe, driven by the MEM commands of the command channel:
+//
+//   Mem_Read()   - send a range once as TLM_TYPE_MEM frames of up to
+//                  MEM_FRAME_WORDS words on the data ports
+//   Mem_Stream() - send it again and again, a pass every period
+//   Mem_Crc()    - the frame CRC over a range, to check a read or a write
+//   Mem_BeginWrite(), Mem_Receive() - take the binary data of a MEM WR
+//                  from the command port and store it
+//
+// The frames are sent by Tlm_CommitRef(): the words go from their place
+// in memory straight into the TX FIFO, so the background loop only frames
+// the block and a read runs at the full rate of the link. A word that
+// changes while it is sent (a DMA buffer in use) goes out as it is read,
+// and the frame CRC is over what was sent.
+//
+// Only the ranges of memRegions can be read, RAM only can be written.
+// Registers are read as they are, 16 bits at a time. The receive data
+// registers that a read empties (McBSP DRR2/DRR1, SPIRXBUF, SCIRXBUF,
+// I2CDRR) are left out of the regions, so a range over one of them is
+// refused rather than taking a character from a live link; SPIRXEMU and
+// SCIRXEMU show the same data without the side effect.
+//
+// A write is staged in memWriteBuf and stored only once its CRC matched,
+// so a broken transfer leaves the target memory as it was.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "mem.h"
+#include "tlm.h"
+#include "timebase.h"
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint32 start;
+    Uint32 end;                     // Last word
+    Uint16 access;
+} MEM_REGION;
+
+//
+// Globals
+//
+const MEM_REGION memRegions[] =
+{
+    {0x000000, 0x0007FF, MEM_READ | MEM_WRITE},     // M0, M1
+    {0x000B00, 0x000EFF, MEM_READ},     // ADC results, CPU timers, PIE
+    {0x001000, 0x0017FF, MEM_READ},     // DMA, CLA
+    {0x004000, 0x005FFF, MEM_READ},     // ePWM .. eQEP registers
+    {0x006002, 0x00603F, MEM_READ},     // McBSP-A, but DRR2, DRR1
+    {0x006042, 0x006106, MEM_READ},     // McBSP-B, but DRR2, DRR1 .. SPI-A
+    {0x006108, 0x006116, MEM_READ},     // SPI-A, but SPIRXBUF .. SPI-B
+    {0x006118, 0x006126, MEM_READ},     // SPI-B, but SPIRXBUF .. SPI-C
+    {0x006128, 0x007206, MEM_READ},     // SPI-C, but SPIRXBUF .. SCI-A
+    {0x007208, 0x007216, MEM_READ},     // SCI-A, but SCIRXBUF .. SCI-B
+    {0x007218, 0x007226, MEM_READ},     // SCI-B, but SCIRXBUF .. SCI-C
+    {0x007228, 0x007236, MEM_READ},     // SCI-C, but SCIRXBUF .. SCI-D
+    {0x007238, 0x007305, MEM_READ},     // SCI-D, but SCIRXBUF .. I2C-A
+    {0x007307, 0x007345, MEM_READ},     // I2C-A, but I2CDRR .. I2C-B
+    {0x007347, 0x007FFF, MEM_READ},     // I2C-B, but I2CDRR .. GPIO
+    {0x008000, 0x00BFFF, MEM_READ | MEM_WRITE},     // LS0..LS5, D0, D1
+    {0x00C000, 0x01BFFF, MEM_READ | MEM_WRITE},     // GS0..GS15
+    {0x05D000, 0x05DFFF, MEM_READ},     // System and clock control
+    {0x080000, 0x0BFFFF, MEM_READ},     // Flash
+};
+
+Uint32 memStart;                    // Range of the read or stream
+Uint32 memWords;
+Uint32 memAddr;                     // Next word to frame
+Uint32 memLeft;                     // Words of the pass still to frame
+Uint16 memStreaming;
+Uint32 memPeriod;                   // Cycles between stream passes
+Uint32 memPassStart;
+Uint32 memPasses;
+
+#pragma DATA_SECTION(memWriteBuf, "ramgs4");
+Uint16 memWriteBuf[MEM_WRITE_MAX];
+Uint32 memWriteAddr;
+Uint16 memWriteWords;
+Uint16 memWriteBytes;               // Bytes received, data and CRC
+Uint16 memWriteCrc;                 // CRC as received
+Uint16 memWriting;
+Uint16 memWriteResult;
+Uint32 memWriteTime;                // Last byte received
+
+//
+// Mem_Init - Nothing to send or receive
+//
+void Mem_Init(void)
+{
+    memLeft = 0;
+    memStreaming = 0;
+    memPasses = 0;
+    memWriting = 0;
+    memWriteResult = MEM_WR_NONE;
+}
+
+//
+// Mem_Valid - Nonzero if words from addr on lie in one region that allows
+//             the access, MEM_READ or MEM_WRITE
+//
+Uint16 Mem_Valid(Uint32 addr, Uint32 words, Uint16 access)
+{
+    Uint16 i;
+
+    if(words == 0)
+    {
+        return 0;
+    }
+    for(i = 0; i < sizeof(memRegions) / sizeof(memRegions[0]); i++)
+    {
+        if((addr >= memRegions[i].start) && (addr <= memRegions[i].end) &&
+           (words - 1 <= memRegions[i].end - addr))
+        {
+            return (memRegions[i].access & access) == access;
+        }
+    }
+    return 0;
+}
+
+//
+// Mem_Crc - CRC-16/CCITT of words from addr on, two bytes each, high byte
+//           first; the same as host/mem_tool computes over a read
+//
+Uint16 Mem_Crc(Uint32 addr, Uint32 words)
+{
+    const Uint16 *p;
+    Uint16 crc;
+    Uint16 n;
+
+    p = (const Uint16 *)addr;
+    crc = 0xFFFF;
+    while(words > 0)
+    {
+        n = (words > 0x8000UL) ? 0x8000 : (Uint16)words;
+        crc = Tlm_Crc16Packed(crc, p, n);
+        p += n;
+        words -= n;
+    }
+    return crc;
+}
+
+//
+// Mem_Read - Send words from addr on once, ending a read or stream still
+//            running. Returns 0 if the range cannot be read.
+//
+Uint16 Mem_Read(Uint32 addr, Uint32 words)
+{
+    if(Mem_Valid(addr, words, MEM_READ) == 0)
+    {
+        return 0;
+    }
+    memStart = addr;
+    memWords = words;
+    memAddr = addr;
+    memLeft = words;
+    memStreaming = 0;
+    memPasses = 1;
+    return 1;
+}
+
+//
+// Mem_Stream - Send words from addr on again and again, a pass starting
+//              every ms milliseconds, or as soon as the last one is sent
+//              if ms is 0. Returns 0 if the range cannot be read or ms is
+//              above MEM_PERIOD_MS_MAX.
+//
+Uint16 Mem_Stream(Uint32 addr, Uint32 words, Uint16 ms)
+{
+    if((ms > MEM_PERIOD_MS_MAX) || (Mem_Read(addr, words) == 0))
+    {
+        return 0;
+    }
+    memStreaming = 1;
+    memPeriod = (Uint32)ms * (TIMEBASE_HZ / 1000);
+    memPassStart = Timebase_Now();
+    return 1;
+}
+
+//
+// Mem_Stop - End the read or stream. The frame being sent is finished.
+//
+void Mem_Stop(void)
+{
+    memLeft = 0;
+    memStreaming = 0;
+}
+
+//
+// Mem_Active - Nonzero while a read or stream has frames to send
+//
+Uint16 Mem_Active(void)
+{
+    return (memLeft != 0) || (memStreaming != 0);
+}
+
+//
+// Mem_Passes - Passes over the range started by the read or stream
+//
+Uint32 Mem_Passes(void)
+{
+    return memPasses;
+}
+
+//
+// Mem_Ready - Nonzero while a read has a frame to send or a stream pass is
+//             due
+//
+Uint16 Mem_Ready(void)
+{
+    return (memLeft != 0) ||
+           ((memStreaming != 0) &&
+            ((Timebase_Now() - memPassStart) >= memPeriod));
+}
+
+//
+// Mem_Poll - Keep the frames in flight moving and, once a telemetry port
+//            is free, frame the next MEM_FRAME_WORDS words. The MEM stream
+//            of the frame scheduler (sched.c).
+//
+void Mem_Poll(void)
+{
+    Uint16 *payload;
+    Uint16 n;
+
+    if(Mem_Active() == 0)
+    {
+        return;
+    }
+    if(Tlm_Busy() != 0)
+    {
+        Tlm_SendStep();
+        return;
+    }
+
+    if(memLeft == 0)
+    {
+        if((Timebase_Now() - memPassStart) < memPeriod)
+        {
+            return;
+        }
+        memPassStart = Timebase_Now();
+        memAddr = memStart;
+        memLeft = memWords;
+        memPasses++;
+    }
+
+    n = (memLeft > MEM_FRAME_WORDS) ? MEM_FRAME_WORDS : (Uint16)memLeft;
+    payload = Tlm_Begin(TLM_TYPE_MEM);
+    payload[0] = memAddr & 0xFF;
+    payload[1] = (memAddr >> 8) & 0xFF;
+    payload[2] = (memAddr >> 16) & 0xFF;
+    payload[3] = memAddr >> 24;
+    Tlm_CommitRef(TLM_MEM_HEADER_LEN, (const Uint16 *)memAddr, n);
+    memAddr += n;
+    memLeft -= n;
+
+    Tlm_SendStep();
+}
+
+//
+// Mem_BeginWrite - Take the next 2 * words + 2 bytes received as the data
+//                  of a write to addr, high byte first, and its CRC-16
+//                  (see Mem_Crc()), high byte first. Returns 0 if the range
+//                  cannot be written or is longer than MEM_WRITE_MAX.
+//
+Uint16 Mem_BeginWrite(Uint32 addr, Uint16 words)
+{
+    if((words > MEM_WRITE_MAX) || (Mem_Valid(addr, words, MEM_WRITE) == 0))
+    {
+        return 0;
+    }
+    memWriteAddr = addr;
+    memWriteWords = words;
+    memWriteBytes = 0;
+    memWriteCrc = 0;
+    memWriteResult = MEM_WR_NONE;
+    memWriteTime = Timebase_Now();
+    memWriting = 1;
+    return 1;
+}
+
+//
+// Mem_Writing - Nonzero while the data of a write is being received; the
+//               command port carries no commands meanwhile
+//
+Uint16 Mem_Writing(void)
+{
+    return memWriting;
+}
+
+//
+// Mem_Receive - Take the received bytes of a write. Once the data and the
+//               CRC are in, store the data if the CRC matches and end the
+//               write; it also ends after MEM_WRITE_TIMEOUT_MS without a
+//               byte.
+//
+void Mem_Receive(int (*getChar)(void))
+{
+    Uint16 *dst;
+    Uint16 i;
+    Uint16 dataBytes;
+    int c;
+
+    dataBytes = 2 * memWriteWords;
+    while((memWriting != 0) && ((c = getChar()) >= 0))
+    {
+        memWriteTime = Timebase_Now();
+        if(memWriteBytes < dataBytes)
+        {
+            i = memWriteBytes >> 1;
+            if((memWriteBytes & 1) == 0)
+            {
+                memWriteBuf[i] = (Uint16)c << 8;
+            }
+            else
+            {
+                memWriteBuf[i] |= (Uint16)c & 0xFF;
+            }
+        }
+        else
+        {
+            memWriteCrc = (memWriteCrc << 8) | ((Uint16)c & 0xFF);
+        }
+
+        if(++memWriteBytes == dataBytes + TLM_CRC_LEN)
+        {
+            memWriting = 0;
+            if(Tlm_Crc16Packed(0xFFFF, memWriteBuf, memWriteWords) !=
+               memWriteCrc)
+            {
+                memWriteResult = MEM_WR_CRC;
+                return;
+            }
+            dst = (Uint16 *)memWriteAddr;
+            for(i = 0; i < memWriteWords; i++)
+            {
+                dst[i] = memWriteBuf[i];
+            }
+            memWriteResult = MEM_WR_OK;
+            return;
+        }
+    }
+
+    if((memWriting != 0) && ((Timebase_Now() - memWriteTime) >
+                             MEM_WRITE_TIMEOUT_MS * (TIMEBASE_HZ / 1000)))
+    {
+        memWriting = 0;
+        memWriteResult = MEM_WR_TIMEOUT;
+    }
+}
+
+//
+// Mem_WriteResult - How the last write ended, once; MEM_WR_NONE while it
+//                   runs and after the result has been taken
+//
+Uint16 Mem_WriteResult(void)
+{
+    Uint16 result;
+
+    result = (memWriting != 0) ? MEM_WR_NONE : memWriteResult;
+    memWriteResult = MEM_WR_NONE;
+    return result;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,65 @@
+//###########################################################################
+//
+// FILE:   mem.h
+//
+// TITLE:  Target memory read, write, CRC and streaming over the SCI links.
+//
+//###########################################################################
+
+#ifndef MEM_H
+#define MEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+// Reads are sent as TLM_TYPE_MEM frames (tlm.h) on the data ports:
+//
+//   payload = addr0..addr3 (address of the first word, low byte first),
+//             words as high, low byte pairs
+//
+#define MEM_FRAME_WORDS     256     // Words per frame, about as long as
+                                    // the others (TLM_MAX_PAYLOAD)
+#define MEM_WRITE_MAX       256     // Words per MEM WR
+#define MEM_WRITE_TIMEOUT_MS 1000   // Longest gap in the data of a MEM WR
+#define MEM_PERIOD_MS_MAX   10000   // Longest stream period, well inside
+                                    // the cycle counter wrap
+
+#define MEM_READ            0x0001  // Access kinds of Mem_Valid()
+#define MEM_WRITE           0x0002
+
+#define MEM_WR_NONE         0       // Results of Mem_WriteResult()
+#define MEM_WR_OK           1
+#define MEM_WR_CRC          2       // The data did not match its CRC
+#define MEM_WR_TIMEOUT      3
+
+//
+// Function Prototypes
+//
+void Mem_Init(void);
+Uint16 Mem_Valid(Uint32 addr, Uint32 words, Uint16 access);
+Uint16 Mem_Crc(Uint32 addr, Uint32 words);
+Uint16 Mem_Read(Uint32 addr, Uint32 words);
+Uint16 Mem_Stream(Uint32 addr, Uint32 words, Uint16 ms);
+void Mem_Stop(void);
+Uint16 Mem_Active(void);
+Uint32 Mem_Passes(void);
+Uint16 Mem_Ready(void);
+void Mem_Poll(void);
+Uint16 Mem_BeginWrite(Uint32 addr, Uint16 words);
+Uint16 Mem_Writing(void);
+void Mem_Receive(int (*getChar)(void));
+Uint16 Mem_WriteResult(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEM_H
+
+//
+// End of file
+//
@@ -0,0 +1,291 @@
+//###########################################################################
+//
+// FILE:   nest.c
+//
+// TITLE:  Interrupt nesting by priority across and within the PIE groups.
+//
+// The CPU takes an interrupt with all others held off, and the PIE only
+// ranks the channels of one group against each other. Nest_Init() turns
+// a table of priorities per vector into the masks of the usual software
+// prioritization: an interrupt that some other one outranks runs its
+// body with
+//
+//   IER     - the groups all of whose vectors in the table outrank it,
+//             and its own if some channel of it does
+//   PIEIER  - of its own group, only the channels that outrank it
+//
+// Nest_Enter() finds the running vector from PIECTRL.PIEVECT, applies the
+// masks, acknowledges its group and enables the interrupts; Nest_Exit()
+// disables them and puts the PIEIER back. IER is restored by the CPU on
+// return.
+//
+// A group whose vectors are not all of higher priority does not preempt:
+// changing the PIEIER of a group other than the running one could let a
+// flag already sent to the CPU fetch the wrong vector. Priorities meant to
+// preempt across groups are best kept uniform within a group. Vectors not
+// in the table never preempt a nesting interrupt.
+//
+// Nest_Enable(0) goes back to no nesting at all, to compare the latencies
+// (see isrprof.c): ISR ON, NEST OFF, ISR CLEAR, a minute of SCI load, ISR,
+// then the same with NEST ON. host/nest_sim runs this file on a model of
+// the PIE and the CPU, with estimated ISR costs or those of such a report.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "nest.h"
+#include "hot.h"
+
+//
+// Defines
+//
+#define NEST_PIE_BASE       0x0D00  // Address of the PIE vector table
+#define NEST_CPU_VECTORS    32      // IDs below the PIE groups
+#define NEST_HIGH_VECTORS   128     // Channels 9..16 of the groups
+#define NEST_GROUPS         14      // PIE groups 1..12, INT13, INT14
+#define NEST_NONE           0xFFFF  // nestSlot[] of a vector not nesting
+#define NEST_NOT_NESTED     0xFFFFFFFFUL
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint16 group;                   // 1..12, 13 or 14 for INT13, INT14
+    Uint16 channel;                 // 1..16, 0 for INT13 and INT14
+    Uint16 priority;
+    Uint16 ierOwn;                  // IER bit of the group
+    Uint16 ier;                     // IER mask of the body
+    Uint16 pieier;                  // PIEIER mask of the own group
+} NEST_SLOT;
+
+//
+// Function Prototypes
+//
+static Uint16 Nest_Decode(Uint16 vector, Uint16 *group, Uint16 *channel);
+
+//
+// Globals
+//
+#pragma DATA_SECTION(nestSlot, "ramgs4");
+Uint16 nestSlot[NEST_VECTORS];      // Vector ID to nestSlots[] index
+NEST_SLOT nestSlots[NEST_MAX];
+Uint16 nestCount;
+Uint16 nestOn;
+
+//
+// Nest_Init - Take the priority table and compute the masks of every
+//             vector in it. Nesting is on afterwards. Returns 0, and
+//             leaves nesting off, if the table is too long or names a
+//             vector that cannot nest.
+//
+Uint16 Nest_Init(const NEST_VECTOR *table, Uint16 count)
+{
+    NEST_SLOT *s;
+    NEST_SLOT *t;
+    Uint16 all[NEST_GROUPS];        // Per group: all of it outranks s
+    Uint16 i;
+    Uint16 j;
+    Uint16 g;
+
+    nestOn = 0;
+    nestCount = 0;
+    for(i = 0; i < NEST_VECTORS; i++)
+    {
+        nestSlot[i] = NEST_NONE;
+    }
+    if(count > NEST_MAX)
+    {
+        return 0;
+    }
+
+    for(i = 0; i < count; i++)
+    {
+        s = &nestSlots[i];
+        if((table[i].priority > NEST_PRIORITY_MAX) ||
+           (Nest_Decode(table[i].vector, &s->group, &s->channel) == 0))
+        {
+            return 0;
+        }
+        s->priority = table[i].priority;
+        s->ierOwn = 1U << (s->group - 1);
+    }
+
+    for(i = 0; i < count; i++)
+    {
+        s = &nestSlots[i];
+        for(g = 0; g < NEST_GROUPS; g++)
+        {
+            all[g] = 1;
+        }
+        s->pieier = 0;
+        for(j = 0; j < count; j++)
+        {
+            t = &nestSlots[j];
+            if(t->priority >= s->priority)
+            {
+                all[t->group - 1] = 0;
+            }
+            else if((t->group == s->group) && (t->channel != 0))
+            {
+                s->pieier |= 1U << (t->channel - 1);
+            }
+        }
+
+        //
+        // Only groups that have vectors in the table take part
+        //
+        s->ier = 0;
+        for(j = 0; j < count; j++)
+        {
+            g = nestSlots[j].group;
+            if((g != s->group) && (all[g - 1] != 0))
+            {
+                s->ier |= 1U << (g - 1);
+            }
+        }
+        if(s->pieier != 0)
+        {
+            s->ier |= s->ierOwn;
+        }
+
+        if(s->ier != 0)
+        {
+            nestSlot[table[i].vector] = i;
+        }
+    }
+
+    nestCount = count;
+    nestOn = 1;
+    return 1;
+}
+
+//
+// Nest_Enable - Turn nesting on or off
+//
+void Nest_Enable(Uint16 on)
+{
+    nestOn = (on != 0);
+}
+
+//
+// Nest_Enabled - Nonzero while the interrupts nest
+//
+Uint16 Nest_Enabled(void)
+{
+    return nestOn;
+}
+
+//
+// Nest_Masks - The IER and own group PIEIER masks a vector runs with.
+//              Returns 0 if it does not nest.
+//
+Uint16 Nest_Masks(Uint16 vector, Uint16 *ier, Uint16 *pieier)
+{
+    Uint16 slot;
+
+    slot = (vector < NEST_VECTORS) ? nestSlot[vector] : NEST_NONE;
+    if(slot == NEST_NONE)
+    {
+        return 0;
+    }
+    *ier = nestSlots[slot].ier;
+    *pieier = nestSlots[slot].pieier;
+    return 1;
+}
+
+//
+// Nest_Enter - Let the vectors that outrank the running one preempt it.
+//              Returns what Nest_Exit() needs: the slot and the PIEIER
+//              it found, or NEST_NOT_NESTED.
+//
+HOT_FUNC(Nest_Enter)
+Uint32 Nest_Enter(void)
+{
+    const NEST_SLOT *s;
+    volatile Uint16 *pieier;
+    Uint16 vector;
+    Uint16 slot;
+    Uint16 saved;
+
+    if(nestOn == 0)
+    {
+        return NEST_NOT_NESTED;
+    }
+    vector = ((PieCtrlRegs.PIECTRL.all & 0xFFFE) - NEST_PIE_BASE) >> 1;
+    slot = nestSlot[vector];
+    if(slot == NEST_NONE)
+    {
+        return NEST_NOT_NESTED;
+    }
+
+    s = &nestSlots[slot];
+    saved = 0;
+    IER = (IER | s->ierOwn) & s->ier;
+    if(s->channel != 0)
+    {
+        pieier = &PieCtrlRegs.PIEIER1.all + 2 * (s->group - 1);
+        saved = *pieier;
+        *pieier = saved & s->pieier;
+        PieCtrlRegs.PIEACK.all = s->ierOwn;
+    }
+    asm(" NOP");
+    EINT;
+    return ((Uint32)slot << 16) | saved;
+}
+
+//
+// Nest_Exit - Hold the interrupts off again and put the PIEIER back
+//
+HOT_FUNC(Nest_Exit)
+void Nest_Exit(Uint32 saved)
+{
+    const NEST_SLOT *s;
+
+    if(saved == NEST_NOT_NESTED)
+    {
+        return;
+    }
+    DINT;
+    s = &nestSlots[(Uint16)(saved >> 16)];
+    if(s->channel != 0)
+    {
+        *(&PieCtrlRegs.PIEIER1.all + 2 * (s->group - 1)) = (Uint16)saved;
+    }
+}
+
+//
+// Nest_Decode - Group and channel of a vector ID. Returns 0 for a vector
+//               that cannot nest: the reserved and CPU vectors other than
+//               INT13 and INT14.
+//
+static Uint16 Nest_Decode(Uint16 vector, Uint16 *group, Uint16 *channel)
+{
+    if((vector == 13) || (vector == 14))
+    {
+        *group = vector;
+        *channel = 0;
+    }
+    else if((vector >= NEST_CPU_VECTORS) && (vector < NEST_HIGH_VECTORS))
+    {
+        *group = (vector - NEST_CPU_VECTORS) / 8 + 1;
+        *channel = (vector - NEST_CPU_VECTORS) % 8 + 1;
+    }
+    else if((vector >= NEST_HIGH_VECTORS) && (vector < NEST_VECTORS))
+    {
+        *group = (vector - NEST_HIGH_VECTORS) / 8 + 1;
+        *channel = (vector - NEST_HIGH_VECTORS) % 8 + 9;
+    }
+    else
+    {
+        return 0;
+    }
+    return 1;
+}
+
+//
+// End of file
+//
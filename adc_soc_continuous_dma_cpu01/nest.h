@@ -0,0 +1,79 @@
+//###########################################################################
+//
+// FILE:   nest.h
+//
+// TITLE:  Interrupt nesting by priority across and within the PIE groups.
+//
+//###########################################################################
+
+#ifndef NEST_H
+#define NEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fault.h"
+
+//
+// Defines
+//
+// A nesting interrupt opens and closes its body with
+//
+//   __interrupt void scibTxIsr(void)
+//   {
+//       ISRPROF_ENTER();
+//       NEST_ENTER();
+//       ...
+//       PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;
+//       NEST_EXIT();
+//       ISRPROF_EXIT(ISRPROF_SCIB_TX);
+//   }
+//
+// NEST_ENTER() is a declaration and goes with the others at the top. An
+// interrupt whose vector is not in the table, or that nothing outranks,
+// runs with the interrupts held off as before. The body must not change
+// the PIEIER of its own group: NEST_EXIT() puts back what it found.
+//
+#define NEST_ENTER()        Uint32 nestSaved = Nest_Enter()
+#define NEST_EXIT()         Nest_Exit(nestSaved)
+
+//
+// PIE vector IDs (see fault.h) of the table entries: channel 1..16 of
+// group 1..12, or the CPU interrupts INT13 and INT14
+//
+#define NEST_PIE(group, channel)    FAULT_PIE(group, channel)
+#define NEST_CPU(n)                 FAULT_CPU(n)
+
+#define NEST_VECTORS        224     // PIE vector table entries
+#define NEST_MAX            24      // Table entries
+#define NEST_PRIORITY_MAX   15      // 0 preempts everything else
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint16 vector;                  // NEST_PIE() or NEST_CPU()
+    Uint16 priority;
+} NEST_VECTOR;
+
+//
+// Function Prototypes
+//
+Uint16 Nest_Init(const NEST_VECTOR *table, Uint16 count);
+void Nest_Enable(Uint16 on);
+Uint16 Nest_Enabled(void);
+Uint16 Nest_Masks(Uint16 vector, Uint16 *ier, Uint16 *pieier);
+Uint32 Nest_Enter(void);
+void Nest_Exit(Uint32 saved);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NEST_H
+
+//
+// End of file
+//
@@ -0,0 +1,171 @@
+//###########################################################################
+//
+// FILE:   rice.c
+//
+// TITLE:  Lossless delta + adaptive Rice coding of ADC blocks.
+//
+// Each sample is predicted by the previous one (the first by mid-scale) and
+// the zig-zag mapped residual is Rice coded. The block is split into
+// partitions of RICE_PART_LEN samples, each with its own parameter:
+//
+//   k (RICE_K_BITS)    0..RICE_K_MAX: Rice codes follow, one per sample:
+//                      (u >> k) one bits, a zero bit, then the low k bits
+//                      of u
+//                      RICE_ESCAPE: the partition samples follow raw,
+//                      "bits" wide
+//
+// The encoder picks the cheapest parameter and falls back to the escape
+// whenever Rice coding would be larger than raw, which bounds the output
+// to RICE_MAX_BYTES(). Bits are packed MSB first, one byte per output word,
+// and the last byte is padded with zeros.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "rice.h"
+#include "hot.h"
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint16 *out;
+    Uint16 count;
+    Uint32 acc;
+    Uint16 nbits;
+} RICE_WRITER;
+
+//
+// Rice_Put - Append the n (at most 16) low bits of value
+//
+HOT_FUNC(Rice_Put)
+static void Rice_Put(RICE_WRITER *w, Uint32 value, Uint16 n)
+{
+    w->acc = (w->acc << n) | (value & ((1UL << n) - 1));
+    w->nbits += n;
+    while(w->nbits >= 8)
+    {
+        w->nbits -= 8;
+        w->out[w->count++] = (Uint16)(w->acc >> w->nbits) & 0xFF;
+    }
+}
+
+//
+// Rice_PutUnary - Append q one bits and the terminating zero bit
+//
+HOT_FUNC(Rice_PutUnary)
+static void Rice_PutUnary(RICE_WRITER *w, Uint32 q)
+{
+    while(q >= 16)
+    {
+        Rice_Put(w, 0xFFFF, 16);
+        q -= 16;
+    }
+    Rice_Put(w, (1UL << (q + 1)) - 2, (Uint16)q + 1);
+}
+
+//
+// Rice_Encode - Encode len samples of the given width (12 or 16 bits) into
+//               out. Returns the number of bytes written, at most
+//               RICE_MAX_BYTES(len, bits).
+//
+HOT_FUNC(Rice_Encode)
+Uint16 Rice_Encode(const Uint16 *data, Uint16 len, Uint16 bits, Uint16 *out)
+{
+    RICE_WRITER w;
+    Uint32 u[RICE_PART_LEN];
+    Uint32 sum, mean, cost, best;
+    int32 d;
+    Uint16 prev;
+    Uint16 p, n, i;
+    Uint16 k, kFirst, kLast, bestK;
+
+    w.out = out;
+    w.count = 0;
+    w.acc = 0;
+    w.nbits = 0;
+
+    prev = 1U << (bits - 1);
+
+    for(p = 0; p < len; p += n)
+    {
+        n = len - p;
+        if(n > RICE_PART_LEN)
+        {
+            n = RICE_PART_LEN;
+        }
+
+        //
+        // Zig-zag mapped first differences
+        //
+        sum = 0;
+        for(i = 0; i < n; i++)
+        {
+            d = (int32)data[p + i] - (int32)prev;
+            prev = data[p + i];
+            u[i] = (d >= 0) ? ((Uint32)d << 1) : (((Uint32)(-d) << 1) - 1);
+            sum += u[i];
+        }
+
+        //
+        // The optimum parameter is close to log2 of the mean residual, so
+        // only its neighbours are costed exactly
+        //
+        mean = sum / n;
+        k = 0;
+        while((mean >> k) > 1)
+        {
+            k++;
+        }
+        kFirst = (k > 0) ? (k - 1) : 0;
+        kLast = (k + 1 < RICE_K_MAX) ? (k + 1) : RICE_K_MAX;
+
+        best = (Uint32)n * bits;
+        bestK = RICE_ESCAPE;
+        for(k = kFirst; k <= kLast; k++)
+        {
+            cost = (Uint32)n * (k + 1);
+            for(i = 0; i < n; i++)
+            {
+                cost += u[i] >> k;
+            }
+            if(cost < best)
+            {
+                best = cost;
+                bestK = k;
+            }
+        }
+
+        Rice_Put(&w, bestK, RICE_K_BITS);
+        if(bestK == RICE_ESCAPE)
+        {
+            for(i = 0; i < n; i++)
+            {
+                Rice_Put(&w, data[p + i], bits);
+            }
+        }
+        else
+        {
+            for(i = 0; i < n; i++)
+            {
+                Rice_PutUnary(&w, u[i] >> bestK);
+                Rice_Put(&w, u[i], bestK);
+            }
+        }
+    }
+
+    if(w.nbits > 0)
+    {
+        Rice_Put(&w, 0, 8 - w.nbits);
+    }
+
+    return w.count;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,46 @@
+//###########################################################################
+//
+// FILE:   rice.h
+//
+// TITLE:  Lossless delta + adaptive Rice coding of ADC blocks.
+//
+//###########################################################################
+
+#ifndef RICE_H
+#define RICE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define RICE_PART_LEN   16      // Samples per Rice parameter
+#define RICE_K_BITS     4       // Width of the parameter field
+#define RICE_K_MAX      14      // Largest Rice parameter
+#define RICE_ESCAPE     15      // Parameter value of a raw partition
+
+//
+// Worst case size in bytes of an encoded block of n samples of the given
+// width: every partition escaped to raw samples plus its parameter field
+//
+#define RICE_MAX_BYTES(n, bits) \
+    ((((Uint32)(n) * (bits)) + \
+      ((((Uint32)(n) + RICE_PART_LEN - 1) / RICE_PART_LEN) * RICE_K_BITS) + \
+      7) / 8)
+
+//
+// Function Prototypes
+//
+Uint16 Rice_Encode(const Uint16 *data, Uint16 len, Uint16 bits, Uint16 *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RICE_H
+
+//
+// End of file
+//
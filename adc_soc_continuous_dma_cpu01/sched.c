@@ -0,0 +1,278 @@
+//###########################################################################
+//
+// FILE:   sched.c
+//
+// TITLE:  Telemetry frame scheduler: priorities and weighted shares.
+//
+// The streams sharing the telemetry frames (captures, the decimated
+// stream, logs, memory reads, status) each keep their own queue and are
+// asked for one frame at a time. Whenever a data port is free to take a
+// frame (Tlm_Busy(), tlm.c) Sched_Poll() picks the next stream:
+//
+//   - the ready streams of the lowest priority number go first; a higher
+//     number only gets the link while none of them is ready
+//   - within a priority, deficit round robin by frame bytes: a stream
+//     earns weight * SCHED_QUANTUM bytes of credit per round and sends
+//     while its credit lasts, so under saturation the streams share the
+//     link in the ratio of their weights whatever their frame sizes; each
+//     priority keeps its own place in the round, which the frames of a
+//     higher one in between do not move
+//
+// A stream that runs dry loses its credit, so idle time is not saved up
+// for a burst later. A frame in flight is always finished: a stream waits
+// at most one frame of another one at its own priority, plus the frames of
+// the higher ones.
+//
+// Command replies are not scheduled here: they go to the command port as
+// soon as no frame is being queued to it (Tlm_BusyOn()). That is why no
+// frame is long: payloads stay within TLM_MAX_PAYLOAD, captures are coded
+// in blocks of CAP_BLOCK_SIZE samples and memory reads in MEM_FRAME_WORDS,
+// so a reply waits at most about one such frame, 46 ms at 115200 baud.
+//
+// host/sched_sim runs this file and tlm.c on a model of the ports. With
+// CAP, DEC and MEM saturating one port at 115200 baud next to the logs,
+// they share the bytes 4:4:2 and a reply is queued after 46 ms at worst,
+// where whole 1024 sample capture frames and 1024 word memory frames kept
+// it waiting 178 ms.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <string.h>
+#include "sched.h"
+#include "tlm.h"
+#include "timebase.h"
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint16 priority;
+    Uint16 weight;
+    int32 deficit;                  // Bytes of credit left this round
+    Uint16 waiting;                 // Ready since waitStart
+    Uint32 waitStart;
+    SCHED_STATS stats;
+} SCHED_STATE;
+
+//
+// Globals
+//
+const SCHED_STREAM *schedTable;
+Uint16 schedCount;
+Uint16 schedNext[SCHED_PRIORITY_MAX + 1];  // Where the round robin of each
+                                    // priority goes on
+SCHED_STATE schedState[SCHED_STREAMS_MAX];
+
+//
+// Sched_Init - Take the streams of table, at most SCHED_STREAMS_MAX, with
+//              their initial priorities and weights
+//
+void Sched_Init(const SCHED_STREAM *table, Uint16 count)
+{
+    Uint16 i;
+
+    schedTable = table;
+    schedCount = (count > SCHED_STREAMS_MAX) ? SCHED_STREAMS_MAX : count;
+    memset(schedNext, 0, sizeof(schedNext));
+    memset(schedState, 0, sizeof(schedState));
+    for(i = 0; i < schedCount; i++)
+    {
+        schedState[i].priority = table[i].priority;
+        schedState[i].weight = table[i].weight;
+    }
+}
+
+//
+// Sched_Count - Number of streams
+//
+Uint16 Sched_Count(void)
+{
+    return schedCount;
+}
+
+//
+// Sched_Find - Stream of the given name, or SCHED_NONE
+//
+Uint16 Sched_Find(const char *name)
+{
+    Uint16 i;
+
+    for(i = 0; i < schedCount; i++)
+    {
+        if(strcmp(schedTable[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return SCHED_NONE;
+}
+
+//
+// Sched_Name - Name of a stream
+//
+const char *Sched_Name(Uint16 stream)
+{
+    return schedTable[stream].name;
+}
+
+//
+// Sched_Set - Change the priority and weight of a stream. Returns 0 and
+//             changes nothing if either is out of range.
+//
+Uint16 Sched_Set(Uint16 stream, Uint16 priority, Uint16 weight)
+{
+    if((stream >= schedCount) || (priority > SCHED_PRIORITY_MAX) ||
+       (weight == 0) || (weight > SCHED_WEIGHT_MAX))
+    {
+        return 0;
+    }
+    schedState[stream].priority = priority;
+    schedState[stream].weight = weight;
+    schedState[stream].deficit = 0;
+    return 1;
+}
+
+//
+// Sched_Get - Priority and weight of a stream
+//
+void Sched_Get(Uint16 stream, Uint16 *priority, Uint16 *weight)
+{
+    *priority = schedState[stream].priority;
+    *weight = schedState[stream].weight;
+}
+
+//
+// Sched_Stats - What a stream has sent since Sched_ClearStats()
+//
+void Sched_Stats(Uint16 stream, SCHED_STATS *stats)
+{
+    *stats = schedState[stream].stats;
+}
+
+//
+// Sched_ClearStats - Start the statistics of every stream again
+//
+void Sched_ClearStats(void)
+{
+    Uint16 i;
+
+    for(i = 0; i < schedCount; i++)
+    {
+        memset(&schedState[i].stats, 0, sizeof(SCHED_STATS));
+    }
+}
+
+//
+// Sched_Poll - Keep the frames in flight moving and, once a telemetry port
+//              is free, have the stream that is due frame its next
+//              one. Call from the background loop only when no text output
+//              is in progress on a data port. Returns nonzero if a stream
+//              could frame again at once, 0 if the scheduler waits for the
+//              ports or for a stream to become ready.
+//
+Uint16 Sched_Poll(void)
+{
+    SCHED_STATE *s;
+    Uint16 i;
+    Uint16 top;
+    Uint32 now;
+    Uint32 bytes;
+
+    //
+    // Note when each stream became ready, also while a frame is in
+    // flight, so the wait covers it
+    //
+    now = Timebase_Now();
+    top = SCHED_PRIORITY_MAX + 1;
+    for(i = 0; i < schedCount; i++)
+    {
+        s = &schedState[i];
+        if(schedTable[i].ready() != 0)
+        {
+            if(s->waiting == 0)
+            {
+                s->waiting = 1;
+                s->waitStart = now;
+            }
+            if(s->priority < top)
+            {
+                top = s->priority;
+            }
+        }
+        else
+        {
+            s->waiting = 0;
+            s->deficit = 0;
+        }
+    }
+
+    if(Tlm_Busy() != 0)
+    {
+        Tlm_SendStep();
+        return (top <= SCHED_PRIORITY_MAX) && (Tlm_Busy() == 0);
+    }
+    if(top > SCHED_PRIORITY_MAX)
+    {
+        Tlm_SendStep();             // Frames still going out on other ports
+        return 0;
+    }
+
+    //
+    // Deficit round robin over the ready streams of the top priority. Each
+    // visit adds credit, so the loop ends.
+    //
+    i = schedNext[top];
+    for(;;)
+    {
+        s = &schedState[i];
+        if((s->waiting != 0) && (s->priority == top))
+        {
+            if(s->deficit <= 0)
+            {
+                s->deficit += (int32)s->weight * SCHED_QUANTUM;
+            }
+            if(s->deficit > 0)
+            {
+                break;
+            }
+        }
+        i = (i + 1 == schedCount) ? 0 : i + 1;
+    }
+
+    bytes = Tlm_Bytes();
+    schedTable[i].send();
+    bytes = Tlm_Bytes() - bytes;
+
+    if(bytes != 0)
+    {
+        s->deficit -= (int32)bytes;
+        s->stats.frames++;
+        s->stats.bytes += bytes;
+        if(now - s->waitStart > s->stats.maxWait)
+        {
+            s->stats.maxWait = now - s->waitStart;
+        }
+        s->waiting = 0;
+    }
+    else
+    {
+        s->deficit = 0;             // Nothing after all, let the next go
+    }
+
+    //
+    // Stay with the stream while its credit lasts
+    //
+    schedNext[top] = (s->deficit > 0) ? i :
+                     ((i + 1 == schedCount) ? 0 : i + 1);
+    Tlm_SendStep();
+    return 1;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,71 @@
+//###########################################################################
+//
+// FILE:   sched.h
+//
+// TITLE:  Telemetry frame scheduler: priorities and weighted shares.
+//
+//###########################################################################
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define SCHED_STREAMS_MAX   8
+#define SCHED_PRIORITY_MAX  7       // 0 is served first
+#define SCHED_WEIGHT_MAX    64
+#define SCHED_QUANTUM       256     // Bytes per round and unit of weight
+#define SCHED_NONE          0xFFFF  // Sched_Find() of an unknown name
+
+//
+// Typedefs
+//
+// A stream frames from its own queue when the scheduler picks it:
+//
+//   ready - nonzero while it has a frame to send
+//   send  - frame it with Tlm_Begin() and Tlm_Commit() or Tlm_CommitRef();
+//           only called while Tlm_Busy() is 0
+//
+typedef struct
+{
+    const char *name;
+    Uint16 priority;                // At Sched_Init()
+    Uint16 weight;
+    Uint16 (*ready)(void);
+    void (*send)(void);
+} SCHED_STREAM;
+
+typedef struct
+{
+    Uint32 frames;
+    Uint32 bytes;                   // Frame bytes, header and CRC included
+    Uint32 maxWait;                 // Cycles from ready to framed, worst
+} SCHED_STATS;
+
+//
+// Function Prototypes
+//
+void Sched_Init(const SCHED_STREAM *table, Uint16 count);
+Uint16 Sched_Count(void);
+Uint16 Sched_Find(const char *name);
+const char *Sched_Name(Uint16 stream);
+Uint16 Sched_Set(Uint16 stream, Uint16 priority, Uint16 weight);
+void Sched_Get(Uint16 stream, Uint16 *priority, Uint16 *weight);
+void Sched_Stats(Uint16 stream, SCHED_STATS *stats);
+void Sched_ClearStats(void);
+Uint16 Sched_Poll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCHED_H
+
+//
+// End of file
+//
@@ -0,0 +1,997 @@
+//###########################################################################
+//
+// FILE:   sci.c
+//
+// TITLE:  Interrupt driven FIFO driver for SCI-A to SCI-D.
+//
+// Each port has a transmit and a receive ring served by its FIFO
+// interrupts:
+//
+//   TX - Sci_Put() copies into the ring and enables the TX FIFO interrupt,
+//        which refills the FIFO whenever it drains to SCI_TX_LEVEL and
+//        disables itself once the ring is empty.
+//   RX - the RX FIFO interrupt moves every received character into the
+//        ring; Sci_GetChar() takes them out. Characters that find the ring
+//        full are dropped.
+//
+// Receive errors are counted per port (Sci_Errors()): characters with a
+// framing or parity error, which are dropped, overruns, breaks and RX FIFO
+// overflows. An overrun or a break leaves the receiver stopped until a
+// software reset, so the RX interrupt, which the errors also raise, resets
+// the SCI at once. The reset leaves the FIFOs, the rings and the setup as
+// they are: only a character being shifted in or out is lost. A framing
+// or parity error does not stop the receiver and costs no reset; as its
+// flag only clears with one, the RX error interrupt is turned off until
+// the next reset, and an overrun meanwhile is caught by the next RX FIFO
+// or break interrupt. The counts
+// tell a noisy line (framing, parity, breaks) from a receiver that was
+// not served in time (overruns, FIFO overflows, ring drops).
+//
+// Sci_PutRef() queues a block of memory without copying it: the TX
+// interrupt reads the words in place, high byte first, at the point of
+// the ring where they were queued, and keeps the frame CRC over them (see
+// tlm.h) as it goes. The ring keeps taking characters meanwhile; they
+// follow the block. One block per port is queued at a time.
+//
+// Optional RTS/CTS flow control on free GPIOs (Sci_SetFlow()), both
+// active low:
+//
+//   RTS - driven high, asking the host to pause, once the receive ring
+//         holds SCI_RTS_STOP characters, and low again once Sci_GetChar()
+//         has brought it down to SCI_RTS_GO. What the host bridge still
+//         sends after that fits the rest of the ring and the FIFO.
+//   CTS - while it is high the TX interrupt leaves the FIFO alone and
+//         turns itself off; the falling edge, on the port's XINT (SCI-A
+//         XINT1 to SCI-D XINT4), turns it back on. Up to a FIFO full of
+//         characters already loaded still goes out.
+//
+// Each ring has one producer and one consumer, so the background loop may
+// use a port while its interrupts run without further locking. Only one
+// context may write to a given port.
+//
+// Pins (100-pin package):
+//
+//   SCI-A  TX GPIO84  RX GPIO85  (mux 5)
+//   SCI-B  TX GPIO86  RX GPIO87  (mux 5)
+//   SCI-C  TX GPIO89  RX GPIO90  (mux 6)
+//   SCI-D  TX GPIO93  RX GPIO94  (mux 6)
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <string.h>
+#include "sci.h"
+#include "tlm.h"
+#include "timebase.h"
+#include "isrprof.h"
+#include "nest.h"
+#include "hot.h"
+
+//
+// Defines
+//
+#define SCI_TX_LEVEL    2       // TX FIFO interrupt at this many words left
+#define SCI_RXBUF_FE    0x8000  // SCIRXBUF: framing error (SCIFFFE)
+#define SCI_RXBUF_PE    0x4000  // ... parity error (SCIFFPE)
+
+//
+// Typedefs
+//
+typedef struct
+{
+    volatile struct SCI_REGS *regs;
+    Uint16 *txBuf;
+    Uint16 *rxBuf;
+    volatile Uint16 txHead;     // Written by Sci_Put()
+    volatile Uint16 txTail;     // Written by the TX interrupt
+    volatile Uint16 rxHead;     // Written by the RX interrupt
+    volatile Uint16 rxTail;     // Written by Sci_GetChar()
+    Uint32 baud;
+    Uint32 txCount;
+    Uint32 rxCount;
+    Uint32 txCycles;            // CPU cycles in the TX interrupt
+    const Uint16 *ref;          // Block sent in place (Sci_PutRef())
+    volatile Uint16 refLeft;    // Bytes of it still to send
+    Uint16 refAt;               // Ring position it goes out at
+    Uint16 refCrc;              // CRC over the bytes of it sent
+    SCI_ERRORS err;
+    Uint16 rtsPin;              // SCI_NO_PIN without flow control
+    Uint16 ctsPin;
+    volatile Uint16 rtsHigh;    // RTS is asking the host to pause
+    volatile Uint16 ctsHeld;    // TX is waiting for CTS
+    Uint32 rtsStops;
+    Uint32 ctsStalls;
+    Uint16 open;
+} SCI_PORT;
+
+typedef struct
+{
+    Uint16 txPin;
+    Uint16 rxPin;
+    Uint16 mux;
+} SCI_PINS;
+
+//
+// Function Prototypes
+//
+static void Sci_SetCtsInt(Uint16 port, Uint16 pin);
+static void Sci_RxError(SCI_PORT *p);
+
+//
+// Globals
+//
+#pragma DATA_SECTION(sciTxBuf, "ramgs0");
+#pragma DATA_SECTION(sciRxBuf, "ramgs0");
+Uint16 sciTxBuf[SCI_PORTS][SCI_TX_LEN];
+Uint16 sciRxBuf[SCI_PORTS][SCI_RX_LEN];
+SCI_PORT sciPort[SCI_PORTS];
+
+const SCI_PINS sciPins[SCI_PORTS] =
+{
+    {84, 85, 5},
+    {86, 87, 5},
+    {89, 90, 6},
+    {93, 94, 6},
+};
+
+//
+// Sci_Init - Set up the pins, the FIFOs and the interrupts of a port and
+//            open it at the given baud rate. The handlers are in the
+//            vector map of Fault_Init().
+//
+void Sci_Init(Uint16 port, Uint32 baud)
+{
+    SCI_PORT *p;
+    volatile struct SCI_REGS *regs;
+
+    p = &sciPort[port];
+    switch(port)
+    {
+        case SCI_PORT_A: p->regs = &SciaRegs; break;
+        case SCI_PORT_B: p->regs = &ScibRegs; break;
+        case SCI_PORT_C: p->regs = &ScicRegs; break;
+        default:         p->regs = &ScidRegs; break;
+    }
+    regs = p->regs;
+    p->txBuf = sciTxBuf[port];
+    p->rxBuf = sciRxBuf[port];
+    p->txHead = 0;
+    p->txTail = 0;
+    p->rxHead = 0;
+    p->rxTail = 0;
+    p->txCount = 0;
+    p->rxCount = 0;
+    p->txCycles = 0;
+    p->refLeft = 0;
+    memset(&p->err, 0, sizeof(p->err));
+    p->rtsPin = SCI_NO_PIN;
+    p->ctsPin = SCI_NO_PIN;
+    p->rtsHigh = 0;
+    p->ctsHeld = 0;
+    p->rtsStops = 0;
+    p->ctsStalls = 0;
+
+    GPIO_SetupPinMux(sciPins[port].rxPin, GPIO_MUX_CPU1, sciPins[port].mux);
+    GPIO_SetupPinOptions(sciPins[port].rxPin, GPIO_INPUT, GPIO_PUSHPULL);
+    GPIO_SetupPinMux(sciPins[port].txPin, GPIO_MUX_CPU1, sciPins[port].mux);
+    GPIO_SetupPinOptions(sciPins[port].txPin, GPIO_OUTPUT, GPIO_ASYNC);
+
+    regs->SCICCR.all = 0x0007;      // 1 stop bit, no loopback, no parity,
+                                    // 8 char bits, async mode, idle-line
+    regs->SCICTL1.all = 0x0043;     // Enable TX, RX, RX ERR interrupt,
+                                    // internal SCICLK, disable SLEEP,
+                                    // TXWAKE
+    regs->SCICTL2.bit.TXINTENA = 1;
+    regs->SCICTL2.bit.RXBKINTENA = 1;
+    p->open = 1;
+    Sci_SetBaud(port, baud);
+
+    regs->SCIFFTX.all = 0xC000 | SCI_TX_LEVEL;  // TX interrupt off until
+                                                // there is data
+    regs->SCIFFRX.all = 0x0021;                 // RX interrupt at one char
+    regs->SCIFFCT.all = 0x00;
+
+    regs->SCICTL1.all = 0x0063;     // Relinquish SCI from reset
+    regs->SCIFFTX.bit.TXFIFORESET = 1;
+    regs->SCIFFRX.bit.RXFIFORESET = 1;
+
+    switch(port)
+    {
+        case SCI_PORT_A:
+            PieCtrlRegs.PIEIER9.bit.INTx1 = 1;
+            PieCtrlRegs.PIEIER9.bit.INTx2 = 1;
+            break;
+        case SCI_PORT_B:
+            PieCtrlRegs.PIEIER9.bit.INTx3 = 1;
+            PieCtrlRegs.PIEIER9.bit.INTx4 = 1;
+            break;
+        case SCI_PORT_C:
+            PieCtrlRegs.PIEIER8.bit.INTx5 = 1;
+            PieCtrlRegs.PIEIER8.bit.INTx6 = 1;
+            break;
+        default:
+            PieCtrlRegs.PIEIER8.bit.INTx7 = 1;
+            PieCtrlRegs.PIEIER8.bit.INTx8 = 1;
+            break;
+    }
+
+    IER |= (port <= SCI_PORT_B) ? M_INT9 : M_INT8;
+}
+
+//
+// Sci_IsOpen - Nonzero once Sci_Init() has set up the port
+//
+Uint16 Sci_IsOpen(Uint16 port)
+{
+    return (port < SCI_PORTS) && (sciPort[port].open != 0);
+}
+
+//
+// Sci_SetFlow - Use GPIO rtsPin and ctsPin for flow control of an open
+//               port, either of them SCI_NO_PIN for none; both SCI_NO_PIN
+//               turns flow control off. The pins must be free. Returns 0
+//               and changes nothing if a pin does not exist.
+//
+Uint16 Sci_SetFlow(Uint16 port, Uint16 rtsPin, Uint16 ctsPin)
+{
+    SCI_PORT *p;
+
+    if((Sci_IsOpen(port) == 0) ||
+       ((rtsPin != SCI_NO_PIN) && (rtsPin > SCI_GPIO_MAX)) ||
+       ((ctsPin != SCI_NO_PIN) && (ctsPin > SCI_GPIO_MAX)))
+    {
+        return 0;
+    }
+    p = &sciPort[port];
+
+    //
+    // Release the old pins: RTS back to an input, the XINT off
+    //
+    if(p->rtsPin != SCI_NO_PIN)
+    {
+        GPIO_SetupPinOptions(p->rtsPin, GPIO_INPUT, GPIO_PUSHPULL);
+    }
+    Sci_SetCtsInt(port, SCI_NO_PIN);
+    p->rtsPin = SCI_NO_PIN;
+    p->ctsPin = SCI_NO_PIN;
+    p->rtsHigh = 0;
+    p->ctsHeld = 0;
+
+    if(rtsPin != SCI_NO_PIN)
+    {
+        GPIO_SetupPinMux(rtsPin, GPIO_MUX_CPU1, 0);
+        GPIO_WritePin(rtsPin, 0);
+        GPIO_SetupPinOptions(rtsPin, GPIO_OUTPUT, GPIO_PUSHPULL);
+        p->rtsPin = rtsPin;
+    }
+    if(ctsPin != SCI_NO_PIN)
+    {
+        //
+        // An unconnected CTS reads high and holds the output
+        //
+        GPIO_SetupPinMux(ctsPin, GPIO_MUX_CPU1, 0);
+        GPIO_SetupPinOptions(ctsPin, GPIO_INPUT, GPIO_PULLUP);
+        p->ctsPin = ctsPin;
+        Sci_SetCtsInt(port, ctsPin);
+    }
+
+    //
+    // Let the TX interrupt look at CTS now
+    //
+    p->regs->SCIFFTX.bit.TXFFIENA = 1;
+    return 1;
+}
+
+//
+// Sci_Flow - The RTS and CTS pins of a port and how often each held the
+//            data back since Sci_Init()
+//
+void Sci_Flow(Uint16 port, Uint16 *rtsPin, Uint16 *ctsPin,
+              Uint32 *rtsStops, Uint32 *ctsStalls)
+{
+    SCI_PORT *p;
+
+    p = &sciPort[port];
+    *rtsPin = p->rtsPin;
+    *ctsPin = p->ctsPin;
+    *rtsStops = p->rtsStops;
+    *ctsStalls = p->ctsStalls;
+}
+
+//
+// Sci_SetCtsInt - Route a CTS pin to the port's XINT, falling edge, or
+//                 turn the XINT off for SCI_NO_PIN. GPIO_SetupXINTnGpio()
+//                 leaves EALLOW off, so it is set again after it.
+//
+static void Sci_SetCtsInt(Uint16 port, Uint16 pin)
+{
+    Uint16 on;
+
+    on = (pin != SCI_NO_PIN);
+    EALLOW;
+    switch(port)
+    {
+        case SCI_PORT_A:
+            if(on)
+            {
+                GPIO_SetupXINT1Gpio(pin);
+                EALLOW;
+            }
+            XintRegs.XINT1CR.bit.POLARITY = 0;
+            XintRegs.XINT1CR.bit.ENABLE = on;
+            PieCtrlRegs.PIEIER1.bit.INTx4 = on;
+            break;
+        case SCI_PORT_B:
+            if(on)
+            {
+                GPIO_SetupXINT2Gpio(pin);
+                EALLOW;
+            }
+            XintRegs.XINT2CR.bit.POLARITY = 0;
+            XintRegs.XINT2CR.bit.ENABLE = on;
+            PieCtrlRegs.PIEIER1.bit.INTx5 = on;
+            break;
+        case SCI_PORT_C:
+            if(on)
+            {
+                GPIO_SetupXINT3Gpio(pin);
+                EALLOW;
+            }
+            XintRegs.XINT3CR.bit.POLARITY = 0;
+            XintRegs.XINT3CR.bit.ENABLE = on;
+            PieCtrlRegs.PIEIER12.bit.INTx1 = on;
+            break;
+        default:
+            if(on)
+            {
+                GPIO_SetupXINT4Gpio(pin);
+                EALLOW;
+            }
+            XintRegs.XINT4CR.bit.POLARITY = 0;
+            XintRegs.XINT4CR.bit.ENABLE = on;
+            PieCtrlRegs.PIEIER12.bit.INTx2 = on;
+            break;
+    }
+    EDIS;
+
+    if(on)
+    {
+        IER |= (port <= SCI_PORT_B) ? M_INT1 : M_INT12;
+    }
+}
+
+//
+// Sci_SetBaud - Set the baud rate from the current LSPCLK. Returns the
+//               actual rate, or 0 and leaves the port unchanged if the
+//               rate is off by more than SCI_BAUD_TOLERANCE percent.
+//               Characters still being sent are corrupted; wait for
+//               Sci_TxIdle() first.
+//
+Uint32 Sci_SetBaud(Uint16 port, Uint32 baud)
+{
+    Uint32 lspclk;
+    Uint32 brr;
+    Uint32 actual;
+    Uint32 error;
+    Uint16 div;
+
+    if((Sci_IsOpen(port) == 0) || (baud == 0))
+    {
+        return 0;
+    }
+
+    div = ClkCfgRegs.LOSPCP.bit.LSPCLKDIV;
+    lspclk = (div == 0) ? SCI_SYSCLK_HZ : (SCI_SYSCLK_HZ / (2 * div));
+
+    //
+    // baud = LSPCLK / ((BRR + 1) * 8), rounded to the nearest divider
+    //
+    brr = (lspclk + 4 * baud) / (8 * baud);
+    if((brr < 2) || (brr > 0x10000UL))
+    {
+        return 0;
+    }
+    brr--;
+
+    actual = lspclk / ((brr + 1) * 8);
+    error = (actual > baud) ? (actual - baud) : (baud - actual);
+    if(error * 100 > baud * SCI_BAUD_TOLERANCE)
+    {
+        return 0;
+    }
+
+    sciPort[port].regs->SCIHBAUD.all = (Uint16)(brr >> 8);
+    sciPort[port].regs->SCILBAUD.all = (Uint16)(brr & 0xFF);
+    sciPort[port].baud = actual;
+    return actual;
+}
+
+//
+// Sci_Baud - Actual baud rate of a port, 0 if it is not open
+//
+Uint32 Sci_Baud(Uint16 port)
+{
+    return Sci_IsOpen(port) ? sciPort[port].baud : 0;
+}
+
+//
+// Sci_TxSpace - Characters Sci_Put() can take right now
+//
+Uint16 Sci_TxSpace(Uint16 port)
+{
+    SCI_PORT *p;
+
+    p = &sciPort[port];
+    return (p->txTail - p->txHead - 1) & (SCI_TX_LEN - 1);
+}
+
+//
+// Sci_Put - Copy len characters into the transmit ring of a port. Returns
+//           0 and copies nothing if the ring does not have room for all of
+//           them. Only the low 8 bits of each character are sent.
+//
+HOT_FUNC(Sci_Put)
+int Sci_Put(Uint16 port, const char *data, int len)
+{
+    SCI_PORT *p;
+    Uint16 head;
+    int i;
+
+    p = &sciPort[port];
+    if((p->open == 0) || (len > (int)Sci_TxSpace(port)))
+    {
+        return 0;
+    }
+
+    head = p->txHead;
+    for(i = 0; i < len; i++)
+    {
+        p->txBuf[head] = data[i];
+        head = (head + 1) & (SCI_TX_LEN - 1);
+    }
+    p->txHead = head;
+
+    //
+    // The TX interrupt takes it from here; it is pending at once if the
+    // FIFO is already below its level
+    //
+    p->regs->SCIFFTX.bit.TXFFIENA = 1;
+    return 1;
+}
+
+//
+// Sci_TxSpan - Length of the free part of a port's TX ring that follows
+//              its head without wrapping, and in *span where it starts, so
+//              text can be written into the ring in place, one char per
+//              word, and queued by Sci_TxCommit()
+//
+HOT_FUNC(Sci_TxSpan)
+Uint16 Sci_TxSpan(Uint16 port, char **span)
+{
+    SCI_PORT *p;
+    Uint16 space;
+    Uint16 toEnd;
+
+    p = &sciPort[port];
+    space = Sci_TxSpace(port);
+    toEnd = SCI_TX_LEN - p->txHead;
+    *span = (char *)&p->txBuf[p->txHead];
+    return (space < toEnd) ? space : toEnd;
+}
+
+//
+// Sci_TxCommit - Queue len characters written at the span of Sci_TxSpan()
+//
+HOT_FUNC(Sci_TxCommit)
+void Sci_TxCommit(Uint16 port, Uint16 len)
+{
+    SCI_PORT *p;
+
+    p = &sciPort[port];
+    if((p->open == 0) || (len == 0))
+    {
+        return;
+    }
+    p->txHead = (p->txHead + len) & (SCI_TX_LEN - 1);
+    p->regs->SCIFFTX.bit.TXFFIENA = 1;
+}
+
+//
+// Sci_PutRef - Queue words of memory to be sent in place, two bytes each,
+//              high byte first, after what the ring holds now. The CRC-16
+//              over them is continued from crc as they go out. Returns 0
+//              if the port has a block still being sent. The memory must
+//              stay valid until Sci_RefBusy() is 0; a change to it before
+//              then is sent as it is.
+//
+int Sci_PutRef(Uint16 port, const Uint16 *data, Uint16 words, Uint16 crc)
+{
+    SCI_PORT *p;
+
+    p = &sciPort[port];
+    if((p->open == 0) || (p->refLeft != 0) || (words == 0) ||
+       (words > SCI_REF_MAX))
+    {
+        return 0;
+    }
+
+    p->ref = data;
+    p->refAt = p->txHead;
+    p->refCrc = crc;
+    p->refLeft = 2 * words;
+    p->regs->SCIFFTX.bit.TXFFIENA = 1;
+    return 1;
+}
+
+//
+// Sci_RefBusy - Nonzero while part of the block is still to be sent
+//
+Uint16 Sci_RefBusy(Uint16 port)
+{
+    return sciPort[port].refLeft != 0;
+}
+
+//
+// Sci_RefCrc - The CRC continued over the last block, once it is sent
+//
+Uint16 Sci_RefCrc(Uint16 port)
+{
+    return sciPort[port].refCrc;
+}
+
+//
+// Sci_Write - Queue a string, waiting for room in the transmit ring
+//
+void Sci_Write(Uint16 port, const char *s)
+{
+    int len;
+    int chunk;
+
+    if(Sci_IsOpen(port) == 0)
+    {
+        return;
+    }
+
+    len = strlen(s);
+    while(len > 0)
+    {
+        chunk = (len > (SCI_TX_LEN / 2)) ? (SCI_TX_LEN / 2) : len;
+        if(Sci_Put(port, s, chunk) != 0)
+        {
+            s += chunk;
+            len -= chunk;
+        }
+    }
+}
+
+//
+// Sci_TxIdle - Nonzero once the ring, the FIFO and the shift register of a
+//              port are all empty
+//
+Uint16 Sci_TxIdle(Uint16 port)
+{
+    SCI_PORT *p;
+
+    p = &sciPort[port];
+    return (p->txHead == p->txTail) && (p->refLeft == 0) &&
+           (p->regs->SCIFFTX.bit.TXFFST == 0) &&
+           (p->regs->SCICTL2.bit.TXEMPTY != 0);
+}
+
+//
+// Sci_GetChar - Take one received character from a port. Returns -1 if
+//               there is none.
+//
+HOT_FUNC(Sci_GetChar)
+int Sci_GetChar(Uint16 port)
+{
+    SCI_PORT *p;
+    Uint16 intState;
+    int c;
+
+    p = &sciPort[port];
+    if(p->rxTail == p->rxHead)
+    {
+        return -1;
+    }
+
+    c = p->rxBuf[p->rxTail] & 0xFF;
+    p->rxTail = (p->rxTail + 1) & (SCI_RX_LEN - 1);
+
+    //
+    // The RX interrupt may fill the ring again meanwhile, so the level is
+    // looked at again with it held off
+    //
+    if((p->rtsHigh != 0) &&
+       (((p->rxHead - p->rxTail) & (SCI_RX_LEN - 1)) <= SCI_RTS_GO))
+    {
+        intState = __disable_interrupts();
+        if(((p->rxHead - p->rxTail) & (SCI_RX_LEN - 1)) <= SCI_RTS_GO)
+        {
+            GPIO_WritePin(p->rtsPin, 0);
+            p->rtsHigh = 0;
+        }
+        __restore_interrupts(intState);
+    }
+    return c;
+}
+
+//
+// Sci_Echo - Send back what a port has received, as far as its transmit
+//            ring takes it
+//
+void Sci_Echo(Uint16 port)
+{
+    SCI_PORT *p;
+    char c;
+
+    p = &sciPort[port];
+    while((p->rxTail != p->rxHead) && (Sci_TxSpace(port) != 0))
+    {
+        c = (char)Sci_GetChar(port);
+        Sci_Put(port, &c, 1);
+    }
+}
+
+//
+// Sci_TxCount - Characters a port has sent to its FIFO
+//
+Uint32 Sci_TxCount(Uint16 port)
+{
+    return sciPort[port].txCount;
+}
+
+//
+// Sci_RxCount - Characters a port has received into its ring
+//
+Uint32 Sci_RxCount(Uint16 port)
+{
+    return sciPort[port].rxCount;
+}
+
+//
+// Sci_TxCycles - CPU cycles a port has spent refilling its TX FIFO
+//
+Uint32 Sci_TxCycles(Uint16 port)
+{
+    return sciPort[port].txCycles;
+}
+
+//
+// Sci_Errors - Copy the receive error counts of a port since Sci_Init()
+//
+void Sci_Errors(Uint16 port, SCI_ERRORS *err)
+{
+    SCI_PORT *p;
+    Uint16 intState;
+
+    p = &sciPort[port];
+    intState = __disable_interrupts();
+    *err = p->err;
+    __restore_interrupts(intState);
+}
+
+//
+// Sci_TxService - Refill the TX FIFO from the ring and the block queued by
+//                 Sci_PutRef(), and stop the interrupt once both are empty
+//
+HOT_FUNC(Sci_TxService)
+static void Sci_TxService(SCI_PORT *p)
+{
+    volatile struct SCI_REGS *regs;
+    Uint16 tail;
+    Uint16 left;
+    Uint16 n;
+    Uint32 start;
+
+    start = Timebase_Now();
+    regs = p->regs;
+
+    //
+    // CTS high: stop until its falling edge turns the interrupt back on
+    //
+    if((p->ctsPin != SCI_NO_PIN) && (GPIO_ReadPin(p->ctsPin) != 0))
+    {
+        if(p->ctsHeld == 0)
+        {
+            p->ctsHeld = 1;
+            p->ctsStalls++;
+        }
+        regs->SCIFFTX.bit.TXFFIENA = 0;
+        regs->SCIFFTX.bit.TXFFINTCLR = 1;
+
+        //
+        // An edge just before the interrupt went off would be lost
+        //
+        if(GPIO_ReadPin(p->ctsPin) == 0)
+        {
+            regs->SCIFFTX.bit.TXFFIENA = 1;
+        }
+        p->txCycles += Timebase_Now() - start;
+        return;
+    }
+    p->ctsHeld = 0;
+
+    tail = p->txTail;
+    left = p->refLeft;
+    n = SCI_FIFO_LEN - regs->SCIFFTX.bit.TXFFST;
+    while(n > 0)
+    {
+        if((left != 0) && (tail == p->refAt))
+        {
+            //
+            // High byte on an even count left, then the low byte
+            //
+            if(left & 1)
+            {
+                regs->SCITXBUF.all = *p->ref & 0xFF;
+                p->refCrc = Tlm_Crc16Packed(p->refCrc, p->ref, 1);
+                p->ref++;
+            }
+            else
+            {
+                regs->SCITXBUF.all = *p->ref >> 8;
+            }
+            left--;
+        }
+        else if(tail != p->txHead)
+        {
+            regs->SCITXBUF.all = p->txBuf[tail];
+            tail = (tail + 1) & (SCI_TX_LEN - 1);
+        }
+        else
+        {
+            break;
+        }
+        p->txCount++;
+        n--;
+    }
+    p->txTail = tail;
+    p->refLeft = left;
+
+    if((tail == p->txHead) && (left == 0))
+    {
+        regs->SCIFFTX.bit.TXFFIENA = 0;
+    }
+    regs->SCIFFTX.bit.TXFFINTCLR = 1;   // Clear SCI Interrupt flag
+    p->txCycles += Timebase_Now() - start;
+}
+
+//
+// Sci_RxService - Empty the RX FIFO into the ring
+//
+HOT_FUNC(Sci_RxService)
+static void Sci_RxService(SCI_PORT *p)
+{
+    volatile struct SCI_REGS *regs;
+    Uint16 head;
+    Uint16 next;
+    Uint16 n;
+    Uint16 c;
+
+    regs = p->regs;
+    head = p->rxHead;
+    for(n = regs->SCIFFRX.bit.RXFFST; n > 0; n--)
+    {
+        c = regs->SCIRXBUF.all;
+        if((c & SCI_RXBUF_FE) != 0)
+        {
+            p->err.framing++;
+            continue;
+        }
+        if((c & SCI_RXBUF_PE) != 0)
+        {
+            p->err.parity++;
+            continue;
+        }
+        next = (head + 1) & (SCI_RX_LEN - 1);
+        if(next == p->rxTail)
+        {
+            p->err.ringDropped++;
+            continue;
+        }
+        p->rxBuf[head] = c;
+        head = next;
+        p->rxCount++;
+    }
+    p->rxHead = head;
+
+    if((p->rtsPin != SCI_NO_PIN) && (p->rtsHigh == 0) &&
+       (((head - p->rxTail) & (SCI_RX_LEN - 1)) >= SCI_RTS_STOP))
+    {
+        GPIO_WritePin(p->rtsPin, 1);
+        p->rtsHigh = 1;
+        p->rtsStops++;
+    }
+
+    if(regs->SCIFFRX.bit.RXFFOVF != 0)
+    {
+        p->err.fifoOverflow++;
+    }
+    if((regs->SCIRXST.bit.OE != 0) || (regs->SCIRXST.bit.BRKDT != 0))
+    {
+        Sci_RxError(p);
+    }
+    else if(regs->SCIRXST.bit.RXERROR != 0)
+    {
+        regs->SCICTL1.bit.RXERRINTENA = 0;  // FE or PE, sticky until reset
+    }
+
+    regs->SCIFFRX.bit.RXFFOVRCLR = 1;   // Clear Overflow flag
+    regs->SCIFFRX.bit.RXFFINTCLR = 1;   // Clear Interrupt flag
+}
+
+//
+// Sci_RxError - Count an overrun or a break and restart the receiver with
+//               a software reset, which also clears a framing or parity
+//               flag; those were counted with their characters.
+//
+static void Sci_RxError(SCI_PORT *p)
+{
+    volatile struct SCI_REGS *regs;
+
+    regs = p->regs;
+    if(regs->SCIRXST.bit.OE != 0)
+    {
+        p->err.overrun++;
+    }
+    if(regs->SCIRXST.bit.BRKDT != 0)
+    {
+        p->err.brk++;
+    }
+    regs->SCICTL1.bit.SWRESET = 0;      // Clears the error flags
+    regs->SCICTL1.bit.SWRESET = 1;
+    regs->SCICTL1.bit.RXERRINTENA = 1;
+    p->err.resets++;
+}
+
+//
+// SCI FIFO interrupts, PIE groups 9 (SCI-A/B) and 8 (SCI-C/D)
+//
+HOT_FUNC(sciaRxIsr)
+__interrupt void sciaRxIsr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    Sci_RxService(&sciPort[SCI_PORT_A]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_SCIA_RX);
+}
+
+HOT_FUNC(sciaTxIsr)
+__interrupt void sciaTxIsr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    Sci_TxService(&sciPort[SCI_PORT_A]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_SCIA_TX);
+}
+
+HOT_FUNC(scibRxIsr)
+__interrupt void scibRxIsr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    Sci_RxService(&sciPort[SCI_PORT_B]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_SCIB_RX);
+}
+
+HOT_FUNC(scibTxIsr)
+__interrupt void scibTxIsr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    Sci_TxService(&sciPort[SCI_PORT_B]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_SCIB_TX);
+}
+
+HOT_FUNC(scicRxIsr)
+__interrupt void scicRxIsr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    Sci_RxService(&sciPort[SCI_PORT_C]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP8;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_SCIC_RX);
+}
+
+HOT_FUNC(scicTxIsr)
+__interrupt void scicTxIsr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    Sci_TxService(&sciPort[SCI_PORT_C]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP8;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_SCIC_TX);
+}
+
+HOT_FUNC(scidRxIsr)
+__interrupt void scidRxIsr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    Sci_RxService(&sciPort[SCI_PORT_D]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP8;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_SCID_RX);
+}
+
+HOT_FUNC(scidTxIsr)
+__interrupt void scidTxIsr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    Sci_TxService(&sciPort[SCI_PORT_D]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP8;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_SCID_TX);
+}
+
+//
+// Sci_CtsService - CTS has fallen: let the TX interrupt go on if it has
+//                  something to send
+//
+HOT_FUNC(Sci_CtsService)
+static void Sci_CtsService(SCI_PORT *p)
+{
+    if((p->txTail != p->txHead) || (p->refLeft != 0))
+    {
+        p->regs->SCIFFTX.bit.TXFFIENA = 1;
+    }
+}
+
+//
+// CTS falling edge interrupts, XINT1/XINT2 in PIE group 1, XINT3/XINT4 in
+// group 12
+//
+HOT_FUNC(sciaCtsIsr)
+__interrupt void sciaCtsIsr(void)
+{
+    Sci_CtsService(&sciPort[SCI_PORT_A]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+}
+
+HOT_FUNC(scibCtsIsr)
+__interrupt void scibCtsIsr(void)
+{
+    Sci_CtsService(&sciPort[SCI_PORT_B]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+}
+
+HOT_FUNC(scicCtsIsr)
+__interrupt void scicCtsIsr(void)
+{
+    Sci_CtsService(&sciPort[SCI_PORT_C]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP12;
+}
+
+HOT_FUNC(scidCtsIsr)
+__interrupt void scidCtsIsr(void)
+{
+    Sci_CtsService(&sciPort[SCI_PORT_D]);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP12;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,98 @@
+//###########################################################################
+//
+// FILE:   sci.h
+//
+// TITLE:  Interrupt driven FIFO driver for SCI-A to SCI-D.
+//
+//###########################################################################
+
+#ifndef SCI_H
+#define SCI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define SCI_PORT_A      0
+#define SCI_PORT_B      1
+#define SCI_PORT_C      2
+#define SCI_PORT_D      3
+#define SCI_PORTS       4
+
+#define SCI_TX_LEN      256     // Transmit ring per port (power of two)
+#define SCI_RX_LEN      64      // Receive ring per port (power of two)
+#define SCI_FIFO_LEN    16
+#define SCI_REF_MAX     0x7FFF  // Words per Sci_PutRef() block
+#define SCI_NO_PIN      0xFFFF  // No flow control pin
+#define SCI_GPIO_MAX    168
+#define SCI_RTS_STOP    (SCI_RX_LEN / 2)    // Ring level that raises RTS
+#define SCI_RTS_GO      (SCI_RX_LEN / 4)    // ... and that lowers it again
+
+#define SCI_SYSCLK_HZ   200000000UL     // SYSCLK set up by InitSysCtrl()
+#define SCI_BAUD_DEFAULT 115200UL
+#define SCI_BAUD_TOLERANCE 3            // % error accepted by Sci_SetBaud()
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint32 overrun;             // Receiver overruns
+    Uint32 framing;             // Characters with a framing error
+    Uint32 parity;              // Characters with a parity error
+    Uint32 brk;                 // Break conditions
+    Uint32 fifoOverflow;        // RX FIFO overflows
+    Uint32 resets;              // Software resets after an overrun or break
+    Uint32 ringDropped;         // Characters that found the ring full
+} SCI_ERRORS;
+
+//
+// Function Prototypes
+//
+void Sci_Init(Uint16 port, Uint32 baud);
+Uint16 Sci_IsOpen(Uint16 port);
+Uint32 Sci_SetBaud(Uint16 port, Uint32 baud);
+Uint32 Sci_Baud(Uint16 port);
+Uint16 Sci_SetFlow(Uint16 port, Uint16 rtsPin, Uint16 ctsPin);
+void Sci_Flow(Uint16 port, Uint16 *rtsPin, Uint16 *ctsPin,
+              Uint32 *rtsStops, Uint32 *ctsStalls);
+int Sci_Put(Uint16 port, const char *data, int len);
+Uint16 Sci_TxSpan(Uint16 port, char **span);
+void Sci_TxCommit(Uint16 port, Uint16 len);
+int Sci_PutRef(Uint16 port, const Uint16 *data, Uint16 words, Uint16 crc);
+Uint16 Sci_RefBusy(Uint16 port);
+Uint16 Sci_RefCrc(Uint16 port);
+void Sci_Write(Uint16 port, const char *s);
+Uint16 Sci_TxSpace(Uint16 port);
+Uint16 Sci_TxIdle(Uint16 port);
+int Sci_GetChar(Uint16 port);
+void Sci_Echo(Uint16 port);
+Uint32 Sci_TxCount(Uint16 port);
+Uint32 Sci_RxCount(Uint16 port);
+Uint32 Sci_TxCycles(Uint16 port);
+void Sci_Errors(Uint16 port, SCI_ERRORS *err);
+__interrupt void sciaRxIsr(void);
+__interrupt void sciaTxIsr(void);
+__interrupt void scibRxIsr(void);
+__interrupt void scibTxIsr(void);
+__interrupt void scicRxIsr(void);
+__interrupt void scicTxIsr(void);
+__interrupt void scidRxIsr(void);
+__interrupt void scidTxIsr(void);
+__interrupt void sciaCtsIsr(void);
+__interrupt void scibCtsIsr(void);
+__interrupt void scicCtsIsr(void);
+__interrupt void scidCtsIsr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCI_H
+
+//
+// End of file
+//
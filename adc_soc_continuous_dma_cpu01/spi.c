@@ -0,0 +1,245 @@
+//###########################################################################
+//
+// FILE:   spi.c
+//
+// TITLE:  SPI-A slave streaming of ADC blocks by DMA.
+//
+// The bulk data link to the host. SPI-A runs as a slave with 16-bit
+// characters and its TX FIFO is fed by DMA CH5, so the CPU only works at
+// block boundaries:
+//
+//   Spi_SendBlock() - packs one block into spiBlock as a TLM_TYPE_RAW
+//                     frame, arms CH5 and raises the READY pin
+//   CH5 interrupt   - the last burst is in the FIFO: READY is lowered and
+//                     the buffer is free for the next block
+//
+// CH5 is triggered by the SPI TX FIFO event (TXFFST at or below
+// SPI_FIFO_LEN - SPI_BURST) and moves SPI_BURST words per event, which is
+// why frames are padded to a multiple of SPI_BURST words.
+//
+// The master (host/spi_stream.c) waits for READY before it starts a frame,
+// reads the three header words, and then clocks the rest of the padded
+// frame, SPI_FRAME_WORDS of the sample count in the header. It uses SPI
+// mode 0 (CLKPOLARITY 0, CLK_PHASE 1 here); STE may go high between
+// words. What the master sends is ignored; the RX FIFO is kept in reset.
+//
+// Pins (100-pin package):
+//
+//   SPISIMOA GPIO58  SPISOMIA GPIO59  (mux 15)
+//   SPICLKA  GPIO60  SPISTEA  GPIO61  (mux 15)
+//   READY    GPIO24  (SPI_READY_GPIO)
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "tlm.h"
+#include "spi.h"
+#include "timebase.h"
+#include "isrprof.h"
+#include "nest.h"
+#include "hot.h"
+
+//
+// Defines
+//
+#define SPI_TX_LEVEL    (SPI_FIFO_LEN - SPI_BURST)
+
+//
+// Globals
+//
+#pragma DATA_SECTION(spiBlock, "ramgs0");
+Uint16 spiBlock[SPI_FRAME_WORDS(SPI_BLOCK_SAMPLES)];
+volatile Uint16 spiBusy;
+Uint16 spiSeq;
+volatile Uint32 spiFrames;
+Uint32 spiBytes;
+volatile Uint32 spiCycles;      // CPU cycles packing and in the interrupt
+
+//
+// Spi_Init - Set up the pins and SPI-A as a slave, and the CH5 interrupt.
+//            The DMA must have been reset by DMAInitialize() before the
+//            first Spi_SendBlock().
+//
+void Spi_Init(void)
+{
+    GPIO_SetupPinMux(58, GPIO_MUX_CPU1, 15);
+    GPIO_SetupPinOptions(58, GPIO_INPUT, GPIO_ASYNC);
+    GPIO_SetupPinMux(59, GPIO_MUX_CPU1, 15);
+    GPIO_SetupPinOptions(59, GPIO_OUTPUT, GPIO_PUSHPULL);
+    GPIO_SetupPinMux(60, GPIO_MUX_CPU1, 15);
+    GPIO_SetupPinOptions(60, GPIO_INPUT, GPIO_ASYNC);
+    GPIO_SetupPinMux(61, GPIO_MUX_CPU1, 15);
+    GPIO_SetupPinOptions(61, GPIO_INPUT, GPIO_ASYNC);
+
+    GPIO_SetupPinMux(SPI_READY_GPIO, GPIO_MUX_CPU1, 0);
+    GPIO_SetupPinOptions(SPI_READY_GPIO, GPIO_OUTPUT, GPIO_PUSHPULL);
+    GPIO_WritePin(SPI_READY_GPIO, 0);
+
+    SpiaRegs.SPICCR.all = 0x000F;   // Reset, rising edge, 16-bit chars
+    SpiaRegs.SPICTL.all = 0x000A;   // Slave, TALK, CLK_PHASE 1 (mode 0),
+                                    // no SPI interrupts
+    SpiaRegs.SPIPRI.bit.FREE = 1;
+
+    SpiaRegs.SPIFFTX.all = 0xC000 | SPI_TX_LEVEL;   // FIFO mode, DMA event
+                                                    // at SPI_TX_LEVEL
+    SpiaRegs.SPIFFRX.all = 0x0000;  // RX FIFO held in reset
+    SpiaRegs.SPIFFCT.all = 0x00;
+
+    SpiaRegs.SPICCR.bit.SPISWRESET = 1;
+    SpiaRegs.SPIFFTX.bit.TXFIFO = 1;
+
+    //
+    // The DMA reaches the SPI registers on peripheral frame 2
+    //
+    EALLOW;
+    CpuSysRegs.SECMSEL.bit.PF2SEL = 1;
+    PieCtrlRegs.PIEIER7.bit.INTx5 = 1;
+    EDIS;
+
+    IER |= M_INT7;
+
+    spiBusy = 0;
+    spiSeq = 0;
+    Spi_ClearStats();
+}
+
+//
+// Spi_Busy - Nonzero while the DMA is still moving the last block
+//
+Uint16 Spi_Busy(void)
+{
+    return spiBusy;
+}
+
+//
+// Spi_SendBlock - Pack count (at most SPI_BLOCK_SAMPLES) samples of a
+//                 channel into a TLM_TYPE_RAW frame and start the DMA on
+//                 it. Returns 0 and sends nothing while the previous block
+//                 is still being moved.
+//
+Uint16 Spi_SendBlock(Uint16 ch, Uint16 bits, const Uint16 *data,
+                     Uint16 count)
+{
+    Uint16 words;
+    Uint16 i;
+    Uint32 start;
+
+    if(spiBusy != 0)
+    {
+        return 0;
+    }
+
+    start = Timebase_Now();
+    i = Tlm_PackRaw(spiBlock, spiSeq, ch, bits, data, count);
+    words = SPI_FRAME_WORDS(count);
+    for(; i < words; i++)
+    {
+        spiBlock[i] = 0;
+    }
+    spiSeq = (spiSeq + 1) & 0xFF;
+    spiBytes += 2UL * words;
+    spiBusy = 1;
+
+    EALLOW;
+    DMACH5AddrConfig(&SpiaRegs.SPITXBUF, spiBlock);
+    DMACH5BurstConfig(SPI_BURST - 1, 1, 0);
+    DMACH5TransferConfig(words / SPI_BURST - 1, 1, 0);
+    DMACH5ModeConfig(
+                        DMA_SPIATX,
+                        PERINT_ENABLE,
+                        ONESHOT_DISABLE,
+                        CONT_DISABLE,
+                        SYNC_DISABLE,
+                        SYNC_SRC,
+                        OVRFLOW_DISABLE,
+                        SIXTEEN_BIT,
+                        CHINT_END,
+                        CHINT_ENABLE
+                    );
+    EDIS;
+    StartDMACH5();
+
+    //
+    // The FIFO event is the level being reached. If the FIFO has already
+    // drained to it (an idle link), no event comes until data is added,
+    // so the first burst is forced. A burst already started by an event
+    // that arrived since the channel was armed is left alone.
+    //
+    EALLOW;
+    if((SpiaRegs.SPIFFTX.bit.TXFFST <= SPI_TX_LEVEL) &&
+       (DmaRegs.CH5.CONTROL.bit.PERINTFLG == 0) &&
+       (DmaRegs.CH5.CONTROL.bit.TRANSFERSTS == 0))
+    {
+        DmaRegs.CH5.CONTROL.bit.PERINTFRC = 1;
+    }
+    EDIS;
+
+    GPIO_WritePin(SPI_READY_GPIO, 1);
+    spiCycles += Timebase_Now() - start;
+    return 1;
+}
+
+//
+// Spi_Frames - Frames sent since the last Spi_ClearStats()
+//
+Uint32 Spi_Frames(void)
+{
+    return spiFrames;
+}
+
+//
+// Spi_Bytes - Bytes of the frames started since the last Spi_ClearStats(),
+//             padding included
+//
+Uint32 Spi_Bytes(void)
+{
+    return spiBytes;
+}
+
+//
+// Spi_Cycles - CPU cycles spent packing blocks and in the CH5 interrupt
+//
+Uint32 Spi_Cycles(void)
+{
+    return spiCycles;
+}
+
+//
+// Spi_ClearStats - Restart the counters
+//
+void Spi_ClearStats(void)
+{
+    spiFrames = 0;
+    spiBytes = 0;
+    spiCycles = 0;
+}
+
+//
+// spiDmaIsr - CH5 has put the last burst of the frame into the FIFO. The
+//             master already knows the frame length, so READY can drop
+//             while it clocks out the rest.
+//
+HOT_FUNC(spiDmaIsr)
+__interrupt void spiDmaIsr(void)
+{
+    Uint32 start;
+    ISRPROF_ENTER();
+    NEST_ENTER();
+
+    start = Timebase_Now();
+    GPIO_WritePin(SPI_READY_GPIO, 0);
+    spiFrames++;
+    spiBusy = 0;
+    spiCycles += Timebase_Now() - start;
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP7;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_DMA_CH5);
+}
+
+//
+// End of file
+//
@@ -0,0 +1,51 @@
+//###########################################################################
+//
+// FILE:   spi.h
+//
+// TITLE:  SPI-A slave streaming of ADC blocks by DMA.
+//
+//###########################################################################
+
+#ifndef SPI_H
+#define SPI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+// Blocks are sent as telemetry frames (tlm.h) of type TLM_TYPE_RAW with
+// the bytes packed two per 16-bit SPI word, high byte first, and zero
+// words appended up to a multiple of SPI_BURST words.
+//
+#define SPI_BLOCK_SAMPLES   512     // Largest block of one Spi_SendBlock()
+#define SPI_FIFO_LEN        16
+#define SPI_BURST           8       // Words the DMA moves per FIFO event
+#define SPI_FRAME_WORDS(n)  ((TLM_RAW_WORDS(n) + SPI_BURST - 1) & \
+                             ~(SPI_BURST - 1))
+#define SPI_READY_GPIO      24      // High while a frame waits for the master
+
+//
+// Function Prototypes
+//
+void Spi_Init(void);
+Uint16 Spi_Busy(void);
+Uint16 Spi_SendBlock(Uint16 ch, Uint16 bits, const Uint16 *data,
+                     Uint16 count);
+Uint32 Spi_Frames(void);
+Uint32 Spi_Bytes(void);
+Uint32 Spi_Cycles(void);
+void Spi_ClearStats(void);
+__interrupt void spiDmaIsr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPI_H
+
+//
+// End of file
+//
@@ -0,0 +1,82 @@
+//###########################################################################
+//
+// FILE:   timebase.c
+//
+// TITLE:  Free-running SYSCLK cycle counter on CPU Timer 1.
+//
+// The 32-bit count wraps every 21 s at 200 MHz. Timebase_Now64() extends
+// it to 64 bits, and Timebase_Us() is the monotonic microsecond clock for
+// timestamps that must not wrap. Both see every wrap as long as one of
+// them is called at least once per wrap period; the soft timer interrupt
+// (timer.c) calls it at least every TIMER_SLICE_US.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "timebase.h"
+#include "hot.h"
+
+//
+// Globals
+//
+Uint64 timebaseHigh;                // Wraps of the count, times 2^32
+Uint32 timebaseLast;                // Count at the last Timebase_Now64()
+
+//
+// Timebase_Init - Run CPU Timer 1 from SYSCLK over its full 32-bit period
+//                 with its interrupt disabled. Call after InitSysCtrl(),
+//                 which borrows the timer to check the PLL.
+//
+void Timebase_Init(void)
+{
+    CpuTimer1Regs.TCR.bit.TSS = 1;          // Stop the timer
+    CpuTimer1Regs.PRD.all = 0xFFFFFFFF;
+    CpuTimer1Regs.TPR.all = 0;              // Prescale by 1
+    CpuTimer1Regs.TPRH.all = 0;
+    CpuTimer1Regs.TCR.bit.TIE = 0;
+    CpuTimer1Regs.TCR.bit.FREE = 1;         // Keep counting on emulation halt
+    CpuTimer1Regs.TCR.bit.TRB = 1;          // Reload the counter
+    CpuTimer1Regs.TCR.bit.TSS = 0;          // Start the timer
+
+    timebaseHigh = 0;
+    timebaseLast = Timebase_Now();
+}
+
+//
+// Timebase_Now64 - Cycle count since Timebase_Init(), 64 bits wide. Call
+//                  after Hot_Init(), from anywhere.
+//
+HOT_FUNC(Timebase_Now64)
+Uint64 Timebase_Now64(void)
+{
+    Uint16 intState;
+    Uint32 now;
+    Uint64 count;
+
+    intState = __disable_interrupts();
+    now = Timebase_Now();
+    if(now < timebaseLast)
+    {
+        timebaseHigh += 0x100000000ULL;
+    }
+    timebaseLast = now;
+    count = timebaseHigh + now;
+    __restore_interrupts(intState);
+
+    return count;
+}
+
+//
+// Timebase_Us - Microseconds since Timebase_Init()
+//
+Uint64 Timebase_Us(void)
+{
+    return Timebase_Now64() / (TIMEBASE_HZ / 1000000);
+}
+
+//
+// End of file
+//
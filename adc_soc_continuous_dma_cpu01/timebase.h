@@ -0,0 +1,43 @@
+//###########################################################################
+//
+// FILE:   timebase.h
+//
+// TITLE:  Free-running SYSCLK cycle counter on CPU Timer 1.
+//
+//###########################################################################
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+#define TIMEBASE_HZ     200000000UL     // SYSCLK set up by InitSysCtrl()
+
+//
+// Timebase_Now - Current cycle count. CPU Timer 1 counts down, so the count
+//                is inverted to give an up-counter; differences of two
+//                readings are valid across the 32-bit wrap.
+//
+#define Timebase_Now()  (~CpuTimer1Regs.TIM.all)
+
+//
+// Function Prototypes
+//
+void Timebase_Init(void);
+Uint64 Timebase_Now64(void);
+Uint64 Timebase_Us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMEBASE_H
+
+//
+// End of file
+//
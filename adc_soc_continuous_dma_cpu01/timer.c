@@ -0,0 +1,228 @@
+//###########################################################################
+//
+// FILE:   timer.c
+//
+// TITLE:  One-shot and periodic soft timers on CPU Timer 0.
+//
+// A timer runs a handler, a WORK_FN, once after a time or every period.
+// Waiting on one instead of DELAY_US() leaves the CPU to the background
+// loop: an init step starts a timer and carries on, and what has to wait
+// for it tests Timer_Running() or is the handler.
+//
+// The deadlines are kept on the 64-bit timebase (Timebase_Now64()), so
+// they do not wrap. CPU Timer 0 is programmed, one-shot fashion, to
+// interrupt at the nearest one, or after TIMER_SLICE_US if that is later.
+// The slice keeps the 64-bit timebase seeing every wrap of the counter.
+// timerIsr passes the handlers of the timers that are due to the work
+// queue (WORK_TIMER, see work.c); they run in the background loop, not
+// in the interrupt. A periodic timer that falls behind by more than a
+// period skips the expiries it missed.
+//
+// Timer 0 shares PIE group 1 with ADCA1 and the CTS edges, so it has
+// their top nesting priority (nestTable, see nest.c) and runs with the
+// interrupts held off: timerIsr must stay as short as it is, a pass over
+// TIMER_COUNT slots and Timer_Arm().
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <string.h>
+#include "timer.h"
+#include "timebase.h"
+#include "isrprof.h"
+#include "nest.h"
+#include "hot.h"
+
+//
+// Defines
+//
+#define TIMER_CYCLES_PER_US (TIMEBASE_HZ / 1000000)
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint64 deadline;                // Timebase_Now64() of the next expiry
+    Uint64 period;                  // Cycles, 0 for a one-shot
+    WORK_FN fn;                     // 0 for none
+    Uint16 arg;
+    Uint16 active;
+    Uint32 fires;
+} TIMER_SLOT;
+
+//
+// Function Prototypes
+//
+static void Timer_Arm(Uint64 now);
+
+//
+// Globals
+//
+TIMER_SLOT timerSlot[TIMER_COUNT];
+
+//
+// Timer_Init - Stop all timers and start CPU Timer 0. Call after
+//              Hot_Init() and Boot_Sync(). Its interrupt, group 1
+//              channel 7, is enabled with the others in main().
+//
+void Timer_Init(void)
+{
+    memset(timerSlot, 0, sizeof(timerSlot));
+
+    CpuTimer0Regs.TCR.bit.TSS = 1;          // Stop the timer
+    CpuTimer0Regs.TPR.all = 0;              // Prescale by 1
+    CpuTimer0Regs.TPRH.all = 0;
+    CpuTimer0Regs.TCR.bit.FREE = 1;
+    CpuTimer0Regs.TCR.bit.TIF = 1;          // Clear a stale flag
+    CpuTimer0Regs.TCR.bit.TIE = 1;
+    Timer_Arm(Timebase_Now64());
+    CpuTimer0Regs.TCR.bit.TSS = 0;          // Start the timer
+}
+
+//
+// Timer_Start - Run fn(arg) in the background loop us microseconds from
+//               now, then every periodUs if that is not 0. fn may be 0 to
+//               only wait. Restarts the timer if it is running.
+//
+void Timer_Start(Uint16 id, Uint32 us, Uint32 periodUs, WORK_FN fn,
+                 Uint16 arg)
+{
+    TIMER_SLOT *t;
+    Uint16 intState;
+    Uint64 now;
+
+    t = &timerSlot[id];
+    intState = __disable_interrupts();
+    now = Timebase_Now64();
+    t->deadline = now + (Uint64)us * TIMER_CYCLES_PER_US;
+    t->period = (Uint64)periodUs * TIMER_CYCLES_PER_US;
+    t->fn = fn;
+    t->arg = arg;
+    t->active = 1;
+    Timer_Arm(now);
+    __restore_interrupts(intState);
+}
+
+//
+// Timer_Stop - Stop a timer. A handler already queued still runs.
+//
+void Timer_Stop(Uint16 id)
+{
+    timerSlot[id].active = 0;
+}
+
+//
+// Timer_Running - Nonzero until a one-shot timer expires, and for as long
+//                 as a periodic one runs
+//
+Uint16 Timer_Running(Uint16 id)
+{
+    return timerSlot[id].active;
+}
+
+//
+// Timer_State - Whether a timer runs, the time to its next expiry and how
+//               often it expired
+//
+void Timer_State(Uint16 id, TIMER_STATE *state)
+{
+    TIMER_SLOT *t;
+    Uint16 intState;
+    Uint64 now;
+
+    t = &timerSlot[id];
+    intState = __disable_interrupts();
+    now = Timebase_Now64();
+    state->active = t->active;
+    state->remainingUs = ((t->active != 0) && (t->deadline > now)) ?
+        (Uint32)((t->deadline - now) / TIMER_CYCLES_PER_US) : 0;
+    state->periodUs = (Uint32)(t->period / TIMER_CYCLES_PER_US);
+    state->fires = t->fires;
+    __restore_interrupts(intState);
+}
+
+//
+// Timer_Arm - Have Timer 0 interrupt at the nearest deadline, at most
+//             TIMER_SLICE_US from now. Call from timerIsr, or elsewhere
+//             with the interrupts held off.
+//
+HOT_FUNC(Timer_Arm)
+static void Timer_Arm(Uint64 now)
+{
+    Uint64 next;
+    Uint64 delta;
+    Uint16 id;
+
+    next = now + (Uint64)TIMER_SLICE_US * TIMER_CYCLES_PER_US;
+    for(id = 0; id < TIMER_COUNT; id++)
+    {
+        if((timerSlot[id].active != 0) && (timerSlot[id].deadline < next))
+        {
+            next = timerSlot[id].deadline;
+        }
+    }
+
+    delta = (next > now) ? next - now : 0;
+    if(delta < TIMER_MIN_CYCLES)
+    {
+        delta = TIMER_MIN_CYCLES;
+    }
+
+    CpuTimer0Regs.PRD.all = (Uint32)delta - 1;
+    CpuTimer0Regs.TCR.bit.TRB = 1;          // Reload the counter
+}
+
+//
+// timerIsr - Queue the handlers of the timers that are due and arm Timer 0
+//            for the next one
+//
+HOT_FUNC(timerIsr)
+__interrupt void timerIsr(void)
+{
+    ISRPROF_ENTER();
+    NEST_ENTER();
+    TIMER_SLOT *t;
+    Uint64 now;
+    Uint16 id;
+
+    CpuTimer0Regs.TCR.bit.TIF = 1;
+
+    now = Timebase_Now64();
+    for(id = 0; id < TIMER_COUNT; id++)
+    {
+        t = &timerSlot[id];
+        if((t->active == 0) || (t->deadline > now))
+        {
+            continue;
+        }
+
+        t->fires++;
+        if(t->fn != 0)
+        {
+            Work_Post(WORK_TIMER, t->fn, t->arg);
+        }
+        if(t->period == 0)
+        {
+            t->active = 0;
+            continue;
+        }
+        t->deadline += t->period;
+        if(t->deadline <= now)
+        {
+            t->deadline = now + t->period;
+        }
+    }
+    Timer_Arm(now);
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+    NEST_EXIT();
+    ISRPROF_EXIT(ISRPROF_TIMER0);
+}
+
+//
+// End of file
+//
@@ -0,0 +1,62 @@
+//###########################################################################
+//
+// FILE:   timer.h
+//
+// TITLE:  One-shot and periodic soft timers on CPU Timer 0.
+//
+//###########################################################################
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "work.h"
+
+//
+// Defines
+//
+// Timers, one user each. Every slot lengthens timerIsr, which holds off
+// the other interrupts (timer.c), so keep them few.
+//
+#define TIMER_ADC_POWER     0       // ADC power-up time (ConfigureADC())
+#define TIMER_SETTLE        1       // Wait before the first capture
+#define TIMER_BENCH         2       // Deadline of an ADC BENCH capture
+#define TIMER_COUNT         3
+
+#define TIMER_SLICE_US      1000000UL   // Longest Timer 0 period
+#define TIMER_MIN_CYCLES    200         // Shortest, against a missed zero
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint16 active;
+    Uint32 remainingUs;             // To the next expiry, 0 if due
+    Uint32 periodUs;                // 0 for a one-shot
+    Uint32 fires;                   // Expiries since Timer_Init()
+} TIMER_STATE;
+
+//
+// Function Prototypes
+//
+void Timer_Init(void);
+void Timer_Start(Uint16 id, Uint32 us, Uint32 periodUs, WORK_FN fn,
+                 Uint16 arg);
+void Timer_Stop(Uint16 id);
+Uint16 Timer_Running(Uint16 id);
+void Timer_State(Uint16 id, TIMER_STATE *state);
+__interrupt void timerIsr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMER_H
+
+//
+// End of file
+//
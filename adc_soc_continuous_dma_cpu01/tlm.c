@@ -0,0 +1,544 @@
+//###########################################################################
+//
+// FILE:   tlm.c
+//
+// TITLE:  Binary telemetry frames on the SCI transmit rings.
+//
+// A frame is built in place (Tlm_Begin/Tlm_Commit) and then handed to a
+// transmit ring TLM_CHUNK bytes at a time by Tlm_SendStep() as room
+// becomes available, so the background loop never blocks on the link.
+//
+// Frames are striped over the SCI ports of the data port mask, one frame
+// in flight per port: each port has its own frame buffer in tlmPort, and
+// Tlm_Begin() builds the next frame in that of the idle port with the most
+// room in its ring. The ports thus drain frames in parallel and the
+// throughput grows with their number; Tlm_Busy() only holds the streams
+// off while every data port has a frame to finish (host/sched_sim -p 1 to
+// 4 sends 1, 2, 3 and 4 times the bytes). The host merges the ports by
+// sequence number.
+//
+// A port carrying an ARQ session (arq.c) takes the frames into the ARQ
+// stream instead of its ring; its room is what Arq_Put() takes.
+//
+// Tlm_CommitRef() ends the payload with a block of memory that is not
+// copied: the port's buffer holds the header and the start of the
+// payload, the block goes to the port by Sci_PutRef() and the CRC is
+// queued once the TX interrupt has sent the block and with it finished the
+// CRC. The port stays busy until then. On an ARQ port the block is copied
+// into the segments, which must be kept for retransmission anyway.
+//
+// Tlm_CommitRaw() sends a TLM_TYPE_RAW frame in the packed form of the DMA
+// fed links (Tlm_PackRaw()), built in the port's buffer and handed over
+// the same way as such a block, as the whole frame with its own CRC.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "tlm.h"
+#include "sci.h"
+#include "arq.h"
+#include "hot.h"
+
+//
+// Defines
+//
+#define TLM_FRAME_LEN   (TLM_HEADER_LEN + TLM_MAX_PAYLOAD + TLM_CRC_LEN)
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint16 frame[TLM_FRAME_LEN];    // One byte per word, or packed
+    Uint16 len;                     // Words of frame to queue
+    Uint16 pos;                     // Words of it queued
+    const Uint16 *ref;              // Block ending the payload, 0 if none
+    Uint16 refLeft;                 // Words of it not yet handed over
+    Uint16 refCrc;
+    Uint16 refWhole;                // The block is a whole packed frame
+} TLM_PORT;
+
+//
+// Globals
+//
+#pragma DATA_SECTION(tlmPort, "ramgs1");
+#pragma DATA_SECTION(tlmCrcTable, "ramgs4");
+TLM_PORT tlmPort[SCI_PORTS];
+Uint16 tlmCrcTable[256];
+Uint16 tlmSeq;
+Uint16 tlmPorts;                    // Mask of data ports, bit n = port n
+Uint16 tlmNext;                     // Port whose buffer Tlm_Begin() gave
+Uint16 tlmDrop;                     // No data port is open, drop the frame
+Uint32 tlmBytes;                    // Frame bytes committed, all frames
+Uint16 tlmRefChunk[TLM_CHUNK];
+
+//
+// Function Prototypes
+//
+static Uint16 Tlm_PickPort(void);
+static Uint16 Tlm_Finish(TLM_PORT *p, Uint16 payloadLen, Uint16 inFrame);
+static void Tlm_PortStep(TLM_PORT *p, Uint16 port);
+static Uint16 Tlm_RefStep(TLM_PORT *p, Uint16 port);
+
+//
+// Tlm_Init - Build the CRC table and set the data ports
+//
+void Tlm_Init(Uint16 portMask)
+{
+    Uint16 i, j;
+    Uint16 crc;
+
+    for(i = 0; i < 256; i++)
+    {
+        crc = i << 8;
+        for(j = 0; j < 8; j++)
+        {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+        tlmCrcTable[i] = crc;
+    }
+
+    for(i = 0; i < SCI_PORTS; i++)
+    {
+        tlmPort[i].len = 0;
+        tlmPort[i].pos = 0;
+        tlmPort[i].ref = 0;
+        tlmPort[i].refWhole = 0;
+    }
+    tlmPorts = portMask;
+    tlmNext = 0;
+    tlmDrop = 0;
+    tlmSeq = 0;
+    tlmBytes = 0;
+}
+
+//
+// Tlm_Crc16 - Continue a CRC-16/CCITT over len bytes
+//
+HOT_FUNC(Tlm_Crc16)
+Uint16 Tlm_Crc16(Uint16 crc, const Uint16 *data, Uint16 len)
+{
+    Uint16 i;
+
+    for(i = 0; i < len; i++)
+    {
+        crc = (crc << 8) ^ tlmCrcTable[((crc >> 8) ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+//
+// Tlm_Crc16Packed - Continue a CRC-16/CCITT over len words of two bytes
+//                   each, high byte first
+//
+HOT_FUNC(Tlm_Crc16Packed)
+Uint16 Tlm_Crc16Packed(Uint16 crc, const Uint16 *data, Uint16 len)
+{
+    Uint16 i;
+
+    for(i = 0; i < len; i++)
+    {
+        crc = (crc << 8) ^ tlmCrcTable[((crc >> 8) ^ (data[i] >> 8)) & 0xFF];
+        crc = (crc << 8) ^ tlmCrcTable[((crc >> 8) ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+//
+// Tlm_PackRaw - Build a TLM_TYPE_RAW frame of count samples for the DMA fed
+//               links, the frame bytes packed two per word, high byte
+//               first. Returns the length, TLM_RAW_WORDS(count) words.
+//
+Uint16 Tlm_PackRaw(Uint16 *out, Uint16 seq, Uint16 ch, Uint16 bits,
+                   const Uint16 *data, Uint16 count)
+{
+    Uint16 payloadLen;
+    Uint16 i;
+
+    payloadLen = TLM_RAW_HEADER_LEN + 2 * count;
+    out[0] = (TLM_SYNC0 << 8) | TLM_SYNC1;
+    out[1] = (TLM_TYPE_RAW << 8) | (seq & 0xFF);
+    out[2] = ((payloadLen & 0xFF) << 8) | (payloadLen >> 8);
+    out[3] = ((ch & 0xFF) << 8) | (bits & 0xFF);
+    out[4] = ((count & 0xFF) << 8) | (count >> 8);
+    for(i = 0; i < count; i++)
+    {
+        out[5 + i] = data[i];
+    }
+    out[5 + count] = Tlm_Crc16Packed(0xFFFF, &out[1], 4 + count);
+    return TLM_RAW_WORDS(count);
+}
+
+//
+// Tlm_SetPorts - Change the data port mask. Takes effect with the next
+//                frame.
+//
+void Tlm_SetPorts(Uint16 portMask)
+{
+    tlmPorts = portMask;
+}
+
+//
+// Tlm_Ports - Current data port mask
+//
+Uint16 Tlm_Ports(void)
+{
+    return tlmPorts;
+}
+
+//
+// Tlm_Begin - Start a frame of the given type in the buffer of the port it
+//             will go to and return its payload area (TLM_MAX_PAYLOAD
+//             bytes). Only valid while Tlm_Busy() is 0.
+//
+Uint16 *Tlm_Begin(Uint16 type)
+{
+    Uint16 *frame;
+
+    tlmNext = Tlm_PickPort();
+    frame = tlmPort[tlmNext].frame;
+    frame[0] = TLM_SYNC0;
+    frame[1] = TLM_SYNC1;
+    frame[2] = type & 0xFF;
+    return &frame[TLM_HEADER_LEN];
+}
+
+//
+// Tlm_Commit - Close the frame started by Tlm_Begin and queue it
+//
+void Tlm_Commit(Uint16 payloadLen)
+{
+    TLM_PORT *p;
+    Uint16 crc;
+
+    p = &tlmPort[tlmNext];
+    crc = Tlm_Finish(p, payloadLen, payloadLen);
+    p->frame[TLM_HEADER_LEN + payloadLen] = crc >> 8;
+    p->frame[TLM_HEADER_LEN + payloadLen + 1] = crc & 0xFF;
+    p->len = TLM_HEADER_LEN + payloadLen + TLM_CRC_LEN;
+    if(tlmDrop != 0)
+    {
+        p->pos = p->len;            // No data port, the frame is dropped
+    }
+}
+
+//
+// Tlm_CommitRef - Close the frame started by Tlm_Begin with payloadLen
+//                 bytes in place followed by words of memory at ref, two
+//                 bytes each, high byte first, and queue it. The memory is
+//                 read as the frame goes out and must stay valid while
+//                 Tlm_Idle() is 0. The whole payload must not exceed 65535
+//                 bytes.
+//
+void Tlm_CommitRef(Uint16 payloadLen, const Uint16 *ref, Uint16 words)
+{
+    TLM_PORT *p;
+
+    p = &tlmPort[tlmNext];
+    p->refCrc = Tlm_Finish(p, payloadLen + 2 * words, payloadLen);
+    p->len = TLM_HEADER_LEN + payloadLen;
+    if(tlmDrop != 0)
+    {
+        p->pos = p->len;            // No data port, the frame is dropped
+        return;
+    }
+    p->ref = ref;
+    p->refLeft = words;
+}
+
+//
+// Tlm_CommitRaw - Pack a TLM_TYPE_RAW frame of count samples with
+//                 Tlm_PackRaw(), as the DMA fed links send it, and queue
+//                 it. count must not exceed TLM_RAW_MAX_SAMPLES. Only
+//                 valid while Tlm_Busy() is 0.
+//
+void Tlm_CommitRaw(Uint16 ch, Uint16 bits, const Uint16 *data, Uint16 count)
+{
+    TLM_PORT *p;
+    Uint16 words;
+
+    tlmNext = Tlm_PickPort();
+    p = &tlmPort[tlmNext];
+    words = Tlm_PackRaw(p->frame, tlmSeq, ch, bits, data, count);
+    tlmSeq = (tlmSeq + 1) & 0xFF;
+    tlmBytes += 2 * words;
+    p->pos = 0;
+    p->len = 0;
+    p->ref = 0;
+    if(tlmDrop != 0)
+    {
+        return;                     // No data port, the frame is dropped
+    }
+    p->ref = p->frame;
+    p->refLeft = words;
+    p->refCrc = 0xFFFF;
+    p->refWhole = 1;
+}
+
+//
+// Tlm_Finish - Fill in the header of a frame of payloadLen bytes and
+//              return the CRC over the header and the first inFrame bytes
+//              of the payload
+//
+static Uint16 Tlm_Finish(TLM_PORT *p, Uint16 payloadLen, Uint16 inFrame)
+{
+    p->frame[3] = tlmSeq;
+    p->frame[4] = payloadLen & 0xFF;
+    p->frame[5] = payloadLen >> 8;
+    tlmSeq = (tlmSeq + 1) & 0xFF;
+    tlmBytes += TLM_HEADER_LEN + payloadLen + TLM_CRC_LEN;
+    p->pos = 0;
+    p->ref = 0;
+    p->refWhole = 0;
+
+    return Tlm_Crc16(0xFFFF, &p->frame[2], inFrame + TLM_HEADER_LEN - 2);
+}
+
+//
+// Tlm_PickPort - Stripe: the idle open data port with the most room takes
+//                the next frame. SCI_PORTS if they are all busy. If no
+//                data port is open at all, the first idle port lends its
+//                buffer and tlmDrop is set.
+//
+static Uint16 Tlm_PickPort(void)
+{
+    Uint16 port;
+    Uint16 space;
+    Uint16 best;
+    Uint16 pick;
+    Uint16 open;
+
+    best = 0;
+    pick = SCI_PORTS;
+    open = 0;
+    for(port = 0; port < SCI_PORTS; port++)
+    {
+        if((tlmPorts & (1U << port)) && Sci_IsOpen(port))
+        {
+            open = 1;
+            if(Tlm_BusyOn(port) != 0)
+            {
+                continue;
+            }
+            space = (port == Arq_Port()) ? Arq_Space() : Sci_TxSpace(port);
+            if((pick == SCI_PORTS) || (space > best))
+            {
+                best = space;
+                pick = port;
+            }
+        }
+    }
+
+    tlmDrop = (open == 0);
+    if(tlmDrop != 0)
+    {
+        for(port = 0; (port < SCI_PORTS) && (pick == SCI_PORTS); port++)
+        {
+            if(Tlm_BusyOn(port) == 0)
+            {
+                pick = port;
+            }
+        }
+    }
+    return pick;
+}
+
+//
+// Tlm_Busy - Nonzero while no data port can take another frame
+//
+Uint16 Tlm_Busy(void)
+{
+    return Tlm_PickPort() == SCI_PORTS;
+}
+
+//
+// Tlm_BusyOn - Nonzero while part of a frame is still to be queued to the
+//              given port; other output may go to it once this is 0
+//
+Uint16 Tlm_BusyOn(Uint16 port)
+{
+    return (tlmPort[port].pos < tlmPort[port].len) ||
+           (tlmPort[port].ref != 0);
+}
+
+//
+// Tlm_Idle - Nonzero once every frame has been queued, on all ports
+//
+Uint16 Tlm_Idle(void)
+{
+    Uint16 port;
+
+    for(port = 0; port < SCI_PORTS; port++)
+    {
+        if(Tlm_BusyOn(port) != 0)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//
+// Tlm_Bytes - Bytes of all frames committed since Tlm_Init(), header and
+//             CRC included
+//
+Uint32 Tlm_Bytes(void)
+{
+    return tlmBytes;
+}
+
+//
+// Tlm_Pending - Bytes of the frames still to be queued, all ports
+//
+Uint16 Tlm_Pending(void)
+{
+    TLM_PORT *p;
+    Uint16 port;
+    Uint16 bytes;
+
+    bytes = 0;
+    for(port = 0; port < SCI_PORTS; port++)
+    {
+        p = &tlmPort[port];
+        bytes += p->len - p->pos;
+        if(p->ref != 0)
+        {
+            bytes += 2 * p->refLeft +
+                     ((p->refWhole != 0) ? 0 : TLM_CRC_LEN);
+        }
+    }
+    return bytes;
+}
+
+//
+// Tlm_SendStep - Queue as much of the frame of each port as its ring
+//                takes
+//
+void Tlm_SendStep(void)
+{
+    Uint16 port;
+
+    for(port = 0; port < SCI_PORTS; port++)
+    {
+        if(Tlm_BusyOn(port) != 0)
+        {
+            Tlm_PortStep(&tlmPort[port], port);
+        }
+    }
+
+    port = Arq_Port();
+    if((port != ARQ_NO_PORT) && (tlmPorts & (1U << port)))
+    {
+        Arq_Poll();
+    }
+}
+
+//
+// Tlm_PortStep - Queue as much of a port's frame as its ring takes. Bytes
+//                are one per word, which is also the width of char on the
+//                C28x.
+//
+static void Tlm_PortStep(TLM_PORT *p, Uint16 port)
+{
+    Uint16 chunk;
+    int queued;
+
+    for(;;)
+    {
+        while(p->pos < p->len)
+        {
+            chunk = p->len - p->pos;
+            if(chunk > TLM_CHUNK)
+            {
+                chunk = TLM_CHUNK;
+            }
+            if(port == Arq_Port())
+            {
+                queued = Arq_Put((const char *)&p->frame[p->pos], chunk);
+            }
+            else
+            {
+                queued = Sci_Put(port, (const char *)&p->frame[p->pos],
+                                 chunk);
+            }
+            if(queued == 0)
+            {
+                break;
+            }
+            p->pos += chunk;
+        }
+
+        //
+        // The block follows the bytes in place, then the CRC
+        //
+        if((p->pos < p->len) || (p->ref == 0) || (Tlm_RefStep(p, port) == 0))
+        {
+            break;
+        }
+    }
+}
+
+//
+// Tlm_RefStep - Hand over the block of a Tlm_CommitRef() frame. Once it is
+//               sent, put the CRC in the port's buffer to be queued and
+//               return 1. The frame of Tlm_CommitRaw() carries its CRC
+//               already.
+//
+static Uint16 Tlm_RefStep(TLM_PORT *p, Uint16 port)
+{
+    Uint16 n;
+    Uint16 i;
+    Uint16 crc;
+
+    if(port == Arq_Port())
+    {
+        while(p->refLeft > 0)
+        {
+            n = (p->refLeft > TLM_CHUNK / 2) ? (TLM_CHUNK / 2) : p->refLeft;
+            for(i = 0; i < n; i++)
+            {
+                tlmRefChunk[2 * i] = p->ref[i] >> 8;
+                tlmRefChunk[2 * i + 1] = p->ref[i] & 0xFF;
+            }
+            if(Arq_Put((const char *)tlmRefChunk, 2 * n) == 0)
+            {
+                return 0;
+            }
+            p->refCrc = Tlm_Crc16(p->refCrc, tlmRefChunk, 2 * n);
+            p->ref += n;
+            p->refLeft -= n;
+        }
+        crc = p->refCrc;
+    }
+    else
+    {
+        if((p->refLeft != 0) &&
+           (Sci_PutRef(port, p->ref, p->refLeft, p->refCrc) == 0))
+        {
+            return 0;
+        }
+        p->refLeft = 0;
+        if(Sci_RefBusy(port) != 0)
+        {
+            return 0;
+        }
+        crc = Sci_RefCrc(port);
+    }
+
+    if(p->refWhole != 0)
+    {
+        p->ref = 0;
+        return 1;
+    }
+    p->frame[p->len++] = crc >> 8;
+    p->frame[p->len++] = crc & 0xFF;
+    p->ref = 0;
+    return 1;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,90 @@
+//###########################################################################
+//
+// FILE:   tlm.h
+//
+// TITLE:  Binary telemetry frames on the SCI transmit rings.
+//
+//###########################################################################
+
+#ifndef TLM_H
+#define TLM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+// Frame layout, one byte per word:
+//
+//   0xA5 0x5A type seq lenL lenH payload[len] crcH crcL
+//
+// The CRC is CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) over
+// type, seq, len and the payload.
+//
+#define TLM_SYNC0           0xA5
+#define TLM_SYNC1           0x5A
+#define TLM_HEADER_LEN      6
+#define TLM_CRC_LEN         2
+#define TLM_MAX_PAYLOAD     524     // Rice block of 256 16-bit samples;
+                                    // short, so a command reply does not
+                                    // wait long behind a frame (sched.c)
+#define TLM_CHUNK           16      // Bytes handed to the ring at a time
+
+//
+// Frame types
+//
+#define TLM_TYPE_RICE       0x01    // ch, bits, countL, countH, Rice code
+#define TLM_RICE_HEADER_LEN 4
+#define TLM_TYPE_RAW        0x02    // ch, bits, countL, countH, samples as
+                                    // high, low byte pairs (spi.c)
+#define TLM_RAW_HEADER_LEN  4
+#define TLM_RAW_WORDS(n)    (5 + (n) + 1)   // Packed frame of n samples
+#define TLM_RAW_MAX_SAMPLES ((TLM_HEADER_LEN + TLM_MAX_PAYLOAD + \
+                              TLM_CRC_LEN) - 6)  // Tlm_CommitRaw() at most
+#define TLM_TYPE_LOG        0x03    // Log records as high, low byte pairs
+                                    // (log.h)
+#define TLM_TYPE_ARQ        0x04    // base, stream bytes (arq.h)
+#define TLM_TYPE_ARQ_ACK    0x05    // next, map0..mapN, from the host
+#define TLM_TYPE_MEM        0x06    // addr0..addr3, words as high, low
+                                    // byte pairs (mem.c)
+#define TLM_MEM_HEADER_LEN  4
+#define TLM_TYPE_SCI_STATUS 0x07    // ports, then per port: port and
+                                    // TLM_SCI_STATUS_COUNTS counts, low
+                                    // byte first: overrun, framing,
+                                    // parity, break, FIFO overflow, ring
+                                    // drops, resets, received
+#define TLM_SCI_STATUS_COUNTS 8
+#define TLM_SCI_STATUS_PORT_LEN (1 + 4 * TLM_SCI_STATUS_COUNTS)
+
+//
+// Function Prototypes
+//
+void Tlm_Init(Uint16 portMask);
+void Tlm_SetPorts(Uint16 portMask);
+Uint16 Tlm_Ports(void);
+Uint16 *Tlm_Begin(Uint16 type);
+void Tlm_Commit(Uint16 payloadLen);
+void Tlm_CommitRef(Uint16 payloadLen, const Uint16 *ref, Uint16 words);
+void Tlm_CommitRaw(Uint16 ch, Uint16 bits, const Uint16 *data, Uint16 count);
+Uint16 Tlm_Busy(void);
+Uint16 Tlm_BusyOn(Uint16 port);
+Uint16 Tlm_Idle(void);
+Uint32 Tlm_Bytes(void);
+Uint16 Tlm_Pending(void);
+void Tlm_SendStep(void);
+Uint16 Tlm_Crc16(Uint16 crc, const Uint16 *data, Uint16 len);
+Uint16 Tlm_Crc16Packed(Uint16 crc, const Uint16 *data, Uint16 len);
+Uint16 Tlm_PackRaw(Uint16 *out, Uint16 seq, Uint16 ch, Uint16 bits,
+                   const Uint16 *data, Uint16 count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TLM_H
+
+//
+// End of file
+//
@@ -0,0 +1,190 @@
+//###########################################################################
+//
+// FILE:   work.c
+//
+// TITLE:  Deferred work queue from the interrupts to the background loop.
+//
+// An interrupt that finishes an event hands what follows from it to the
+// background loop as a small item, a handler and an argument, instead of
+// doing it inline or setting a flag for the loop to test. Work_Dispatch()
+// runs the items from the background loop, each to its end, in the order
+// of the producers and, for one producer, of posting.
+//
+// Every producer has its own ring, written only by its interrupt and read
+// only by the background loop. The producer alone moves the head and the
+// loop alone the tail, so neither side has to hold the interrupts off:
+// the item is written before the head that publishes it, and run before
+// the tail that frees it. An interrupt does not interrupt itself (see
+// nest.c), so every ring has a single writer even with nesting on.
+//
+// A full ring drops the new item and counts it; the producer sees the
+// result of Work_Post() and can count an overrun of its own.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include <string.h>
+#include "work.h"
+#include "timebase.h"
+#include "hot.h"
+
+//
+// Defines
+//
+#define WORK_MASK           (WORK_RING_SIZE - 1)
+
+//
+// Typedefs
+//
+typedef struct
+{
+    WORK_FN fn;
+    Uint16 arg;
+} WORK_ITEM;
+
+typedef struct
+{
+    WORK_ITEM item[WORK_RING_SIZE];
+    volatile Uint16 head;           // Next item to write, producer only
+    volatile Uint16 tail;           // Next item to run, dispatcher only
+} WORK_RING;
+
+//
+// Globals
+//
+WORK_RING workRing[WORK_PRODUCERS];
+WORK_STATS workStats[WORK_PRODUCERS];
+
+//
+// Work_Init - Empty the rings and clear the statistics
+//
+void Work_Init(void)
+{
+    memset(workRing, 0, sizeof(workRing));
+    memset(workStats, 0, sizeof(workStats));
+}
+
+//
+// Work_Post - Queue fn(arg) for the dispatcher. Call from the interrupt
+//             of producer only. Returns 0 if its ring is full and the
+//             item was dropped.
+//
+HOT_FUNC(Work_Post)
+Uint16 Work_Post(Uint16 producer, WORK_FN fn, Uint16 arg)
+{
+    WORK_RING *r;
+    WORK_STATS *s;
+    Uint16 head;
+    Uint16 waiting;
+
+    r = &workRing[producer];
+    s = &workStats[producer];
+    head = r->head;
+    waiting = (head - r->tail) & (2 * WORK_RING_SIZE - 1);
+    if(waiting >= WORK_RING_SIZE)
+    {
+        s->drops++;
+        return 0;
+    }
+
+    r->item[head & WORK_MASK].fn = fn;
+    r->item[head & WORK_MASK].arg = arg;
+    r->head = (head + 1) & (2 * WORK_RING_SIZE - 1);
+
+    s->posts++;
+    if(waiting + 1 > s->peak)
+    {
+        s->peak = waiting + 1;
+    }
+    return 1;
+}
+
+//
+// Work_Pending - Items of producer not run to their end yet. From a
+//                handler of producer, the one running is among them.
+//
+Uint16 Work_Pending(Uint16 producer)
+{
+    return (workRing[producer].head - workRing[producer].tail) &
+           (2 * WORK_RING_SIZE - 1);
+}
+
+//
+// Work_Flush - Drop the items of producer not run yet. Call from the
+//              background loop only, outside the handlers.
+//
+void Work_Flush(Uint16 producer)
+{
+    workRing[producer].tail = workRing[producer].head;
+}
+
+//
+// Work_Dispatch - Run the items waiting when it is called, each to its
+//                 end. Call from the background loop only. Returns
+//                 nonzero if it ran any.
+//
+Uint16 Work_Dispatch(void)
+{
+    WORK_RING *r;
+    WORK_STATS *s;
+    WORK_ITEM item;
+    Uint16 p;
+    Uint16 n;
+    Uint16 ran;
+    Uint32 start;
+    Uint32 cycles;
+
+    ran = 0;
+    for(p = 0; p < WORK_PRODUCERS; p++)
+    {
+        r = &workRing[p];
+        s = &workStats[p];
+        for(n = Work_Pending(p); n != 0; n--)
+        {
+            item = r->item[r->tail & WORK_MASK];
+            start = Timebase_Now();
+            item.fn(item.arg);
+            cycles = Timebase_Now() - start;
+            r->tail = (r->tail + 1) & (2 * WORK_RING_SIZE - 1);
+
+            s->runs++;
+            if(cycles > s->runMax)
+            {
+                s->runMax = cycles;
+            }
+            ran = 1;
+        }
+    }
+    return ran;
+}
+
+//
+// Work_Stats - Copy the statistics of producer, consistent with each other
+//
+void Work_Stats(Uint16 producer, WORK_STATS *stats)
+{
+    Uint16 intState;
+
+    intState = __disable_interrupts();
+    *stats = workStats[producer];
+    __restore_interrupts(intState);
+}
+
+//
+// Work_Clear - Start the statistics again; the queued items stay
+//
+void Work_Clear(void)
+{
+    Uint16 intState;
+
+    intState = __disable_interrupts();
+    memset(workStats, 0, sizeof(workStats));
+    __restore_interrupts(intState);
+}
+
+//
+// End of file
+//
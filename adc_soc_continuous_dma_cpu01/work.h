@@ -0,0 +1,61 @@
+//###########################################################################
+//
+// FILE:   work.h
+//
+// TITLE:  Deferred work queue from the interrupts to the background loop.
+//
+//###########################################################################
+
+#ifndef WORK_H
+#define WORK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Defines
+//
+// Producers, one interrupt each, in the order Work_Dispatch() drains them
+//
+#define WORK_DMA_CH1        0       // Capture finished
+#define WORK_DMA_CH2        1       // Stream half finished
+#define WORK_TIMER          2       // Soft timer expired (timer.c)
+#define WORK_PRODUCERS      3
+
+#define WORK_RING_SIZE      4       // Items per producer, a power of 2
+
+//
+// Typedefs
+//
+typedef void (*WORK_FN)(Uint16 arg);
+
+typedef struct
+{
+    Uint32 posts;                   // Items queued
+    Uint32 drops;                   // Items lost to a full ring
+    Uint32 runs;                    // Items dispatched
+    Uint32 runMax;                  // Longest handler, cycles
+    Uint16 peak;                    // Most items waiting at a post
+} WORK_STATS;
+
+//
+// Function Prototypes
+//
+void Work_Init(void);
+Uint16 Work_Post(Uint16 producer, WORK_FN fn, Uint16 arg);
+Uint16 Work_Pending(Uint16 producer);
+void Work_Flush(Uint16 producer);
+Uint16 Work_Dispatch(void);
+void Work_Stats(Uint16 producer, WORK_STATS *stats);
+void Work_Clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WORK_H
+
+//
+// End of file
+//
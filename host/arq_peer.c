@@ -0,0 +1,646 @@
+//###########################################################################
+//
+// FILE:   arq_peer.c
+//
+// TITLE:  Host end of the target's reliable SCI transport (ARQ ON <port>).
+//
+// Receives the ARQ segments of one serial port (see
+// adc_soc_continuous_dma_cpu01/arq.c), acknowledges every one of them and
+// writes the byte stream they carry, complete and in order, to standard
+// output or a file. The stream is what the target would have sent on the
+// port without ARQ, so it can be piped into rice_decode or log_render, or
+// read as the CSV lines of MODE CSV.
+//
+// Run it on a data port other than the command port (SCI DATA C, ARQ ON
+// C); command replies on the ARQ port are not segments and are dropped.
+//
+// -l drops every byte received, and every byte of every ACK sent, with
+// the given probability, to test the transport over a lossy line. Once a
+// second the goodput, the bytes received and the segment counts are
+// printed to standard error.
+//
+// With -S the target and the line are simulated in the program: the
+// target's arq.c itself (arq_target.c) sends a saturated stream of
+// pseudo-random bytes, the line moves one byte per byte time in each
+// direction with -d ms of latency (USB adapter and host) and loses bytes
+// with probability -l. The delivered stream is checked against the one
+// sent. The report compares the goodput with the best any ARQ scheme gets
+// from segments of that size at that loss rate,
+//
+//   n / (n + 9) * (1 - p) ^ (n + 9)
+//
+// (n data bytes, 9 bytes framing, every lost byte costs its segment), and
+// shows the target's window and the share of time the line was busy. A
+// window that does not cover the loss recovery shows up as idle line time
+// or, as the target fills that time, as segments sent again.
+//
+// Build:  cc -O2 -Wno-unknown-pragmas -Ishim -o arq_peer arq_peer.c tlm.c
+//             arq_target.c ../adc_soc_continuous_dma_cpu01/arq.c
+//             ../adc_soc_continuous_dma_cpu01/tlm.c -lm
+// Usage:  arq_peer [-b baud] [-l loss] [-o out.bin] /dev/ttyUSB1
+//         arq_peer -S [-b baud] [-l loss] [-n bytes] [-d ms] [-r ms]
+//                     [-t seconds]
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "tlm.h"
+#include "arq_target.h"
+
+//
+// Defines
+//
+#define ARQ_WINDOW_MAX  128         // Largest sender window of arq.h
+#define ARQ_SEG_MAX     119         // ARQ_SEG_MAX of arq.h
+#define ARQ_OVERHEAD    9           // Framing and base byte per segment
+#define ARQ_MAP_BITS    ARQ_WINDOW_MAX
+#define ARQ_ACK_LEN     (1 + ARQ_MAP_BITS / 8)
+#define ARQ_ACK_FRAME   (TLM_HEADER_LEN + ARQ_ACK_LEN + TLM_CRC_LEN)
+#define RX_WINDOW       128         // Segments accepted ahead of the next
+                                    // one; with ARQ_WINDOW_MAX at most 256
+
+//
+// Simulated target
+//
+#define SIM_CHUNK       16          // TLM_CHUNK, bytes per Arq_Put()
+
+//
+// Typedefs
+//
+typedef struct
+{
+    int synced;
+    uint8_t next;                   // Next segment to hand on
+    uint8_t have[256];
+    uint8_t len[256];
+    uint8_t data[256][ARQ_SEG_MAX];
+    unsigned long segments;
+    unsigned long duplicates;
+    unsigned long resyncs;
+    unsigned long long delivered;
+} arq_receiver;
+
+typedef struct
+{
+    unsigned long at;               // Arrival, byte times
+    uint8_t byte;
+} sim_byte;
+
+typedef struct
+{
+    sim_byte *q;
+    size_t size;
+    size_t head;
+    size_t n;
+    unsigned long free_at;          // Next byte time the line is free
+} sim_line;
+
+//
+// next_byte - Byte sequence of the simulated stream (32-bit xorshift)
+//
+static uint8_t next_byte(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (uint8_t)x;
+}
+
+//
+// lost - Nonzero with probability p
+//
+static int lost(double p)
+{
+    return (p > 0.0) && (rand() < p * ((double)RAND_MAX + 1.0));
+}
+
+//
+// arq_receive - Take one segment and build the ACK for it into ack.
+//               Segments that complete the stream are written to out, or
+//               checked against the stream state check if out is NULL.
+//               The ACK is *ack_len bytes long, its map ending with the
+//               last byte that is not zero. Returns the number of bytes
+//               found wrong by the check.
+//
+static unsigned long arq_receive(arq_receiver *r, const tlm_frame *f,
+                                 FILE *out, uint32_t *check,
+                                 uint8_t ack[ARQ_ACK_FRAME],
+                                 size_t *ack_len)
+{
+    uint8_t base;
+    uint8_t seq;
+    unsigned ahead;
+    unsigned behind;
+    unsigned d;
+    unsigned i;
+    unsigned len;
+    uint16_t crc;
+    unsigned long errors = 0;
+
+    base = f->payload[0];
+    seq = f->seq;
+
+    //
+    // The sender's base can lag our next by at most its window (lost
+    // ACKs) and is never ahead of it. Anything else is a new session on
+    // the target, or a new peer on an old session: follow the sender.
+    //
+    ahead = (uint8_t)(base - r->next);
+    behind = (uint8_t)(r->next - base);
+    if(!r->synced || ((ahead != 0) && (ahead < 128)) ||
+       ((ahead >= 128) && (behind > ARQ_WINDOW_MAX)))
+    {
+        if(r->synced)
+        {
+            r->resyncs++;
+        }
+        memset(r->have, 0, sizeof(r->have));
+        r->next = base;
+        r->synced = 1;
+    }
+
+    d = (uint8_t)(seq - r->next);
+    if((d < RX_WINDOW) && !r->have[seq])
+    {
+        r->have[seq] = 1;
+        r->len[seq] = (uint8_t)(f->len - 1);
+        memcpy(r->data[seq], &f->payload[1], f->len - 1);
+        r->segments++;
+    }
+    else
+    {
+        r->duplicates++;
+    }
+
+    while(r->have[r->next])
+    {
+        if(out != NULL)
+        {
+            fwrite(r->data[r->next], 1, r->len[r->next], out);
+        }
+        else
+        {
+            for(i = 0; i < r->len[r->next]; i++)
+            {
+                if(r->data[r->next][i] != next_byte(check))
+                {
+                    errors++;
+                }
+            }
+        }
+        r->delivered += r->len[r->next];
+        r->have[r->next] = 0;
+        r->next++;
+    }
+
+    len = 1;
+    memset(&ack[7], 0, ARQ_MAP_BITS / 8);
+    for(i = 0; i < ARQ_MAP_BITS; i++)
+    {
+        if(r->have[(uint8_t)(r->next + 1 + i)])
+        {
+            ack[7 + i / 8] |= 1U << (i % 8);
+            len = 2 + i / 8;
+        }
+    }
+    ack[0] = TLM_SYNC0;
+    ack[1] = TLM_SYNC1;
+    ack[2] = TLM_TYPE_ARQ_ACK;
+    ack[3] = 0;
+    ack[4] = (uint8_t)len;
+    ack[5] = 0;
+    ack[6] = r->next;
+    crc = tlm_crc16(0xFFFF, &ack[2], TLM_HEADER_LEN - 2 + len);
+    ack[TLM_HEADER_LEN + len] = (uint8_t)(crc >> 8);
+    ack[TLM_HEADER_LEN + len + 1] = (uint8_t)crc;
+    *ack_len = TLM_HEADER_LEN + len + TLM_CRC_LEN;
+    return errors;
+}
+
+//
+// line_init - An empty line direction
+//
+static int line_init(sim_line *l, size_t size)
+{
+    memset(l, 0, sizeof(*l));
+    l->q = malloc(size * sizeof(l->q[0]));
+    l->size = size;
+    return (l->q != NULL) ? 0 : -1;
+}
+
+//
+// line_send - Put a byte on the line at time t; it arrives one byte time
+//             after the line is free plus the latency, unless it is lost
+//
+static void line_send(sim_line *l, unsigned long t, uint8_t byte,
+                      unsigned long latency, double loss)
+{
+    sim_byte *b;
+
+    if(l->free_at < t)
+    {
+        l->free_at = t;
+    }
+    l->free_at++;
+    if(lost(loss) || (l->n == l->size))
+    {
+        return;
+    }
+    b = &l->q[(l->head + l->n) % l->size];
+    b->at = l->free_at + latency;
+    b->byte = byte;
+    l->n++;
+}
+
+//
+// line_receive - Next byte that has arrived by time t, -1 if none
+//
+static int line_receive(sim_line *l, unsigned long t)
+{
+    int c;
+
+    if((l->n == 0) || (l->q[l->head].at > t))
+    {
+        return -1;
+    }
+    c = l->q[l->head].byte;
+    l->head = (l->head + 1) % l->size;
+    l->n--;
+    return c;
+}
+
+//
+// simulate - Run the simulated target and line for the given time and
+//            report. Returns 0 if the stream arrived intact.
+//
+static int simulate(long baud, double loss, unsigned seg_len,
+                    double latency_ms, unsigned rto_ms, double seconds)
+{
+    static arq_receiver r;
+    static tlm_reader reader;
+    static tlm_frame frame;
+    sim_line data;
+    sim_line acks;
+    arq_target_stats s;
+    uint8_t ack[ARQ_ACK_FRAME];
+    size_t ack_len;
+    uint8_t chunk[SIM_CHUNK];
+    double byte_time = 10.0 / (double)baud;
+    unsigned long end = (unsigned long)(seconds / byte_time);
+    unsigned long latency = (unsigned long)(latency_ms * 1e-3 / byte_time);
+    unsigned long t;
+    unsigned long busy = 0;
+    unsigned long errors = 0;
+    uint32_t source = 1;
+    uint32_t check = 1;
+    uint8_t byte;
+    int c;
+    unsigned i;
+    double link;
+    double goodput;
+    double best;
+
+    if(arq_target_init(seg_len, rto_ms) != 0)
+    {
+        fprintf(stderr, "arq.c takes no segment of %u bytes or timeout "
+                "of %u ms\n", seg_len, rto_ms);
+        return 1;
+    }
+    memset(&r, 0, sizeof(r));
+    tlm_reader_init(&reader);
+    reader.max_len = ARQ_SEG_MAX + 1;
+    if((line_init(&data, 1 << 16) != 0) || (line_init(&acks, 1 << 16) != 0))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    for(t = 0; t < end; t++)
+    {
+        while((c = line_receive(&acks, t)) >= 0)
+        {
+            arq_target_rx((uint8_t)c);
+        }
+        while(arq_target_space() >= SIM_CHUNK)
+        {
+            for(i = 0; i < SIM_CHUNK; i++)
+            {
+                chunk[i] = next_byte(&source);
+            }
+            arq_target_put(chunk, SIM_CHUNK);
+        }
+        arq_target_poll(t * byte_time);
+
+        if((c = arq_target_tx()) >= 0)
+        {
+            line_send(&data, t, (uint8_t)c, latency, loss);
+            busy++;
+        }
+
+        while((c = line_receive(&data, t)) >= 0)
+        {
+            byte = (uint8_t)c;
+            tlm_reader_push(&reader, &byte, 1);
+        }
+        while(tlm_reader_next(&reader, &frame))
+        {
+            if((frame.type != TLM_TYPE_ARQ) || (frame.len < 1))
+            {
+                continue;
+            }
+            errors += arq_receive(&r, &frame, NULL, &check, ack, &ack_len);
+            for(i = 0; i < ack_len; i++)
+            {
+                line_send(&acks, t, ack[i], latency, loss);
+            }
+        }
+    }
+
+    link = (double)baud / 10.0;
+    goodput = (double)r.delivered / seconds;
+    best = (double)seg_len / (seg_len + ARQ_OVERHEAD) *
+           pow(1.0 - loss, seg_len + ARQ_OVERHEAD);
+    arq_target_get_stats(&s);
+    printf("link %.0f bytes/s, window %u segments, busy %.1f%%, goodput "
+           "%.0f bytes/s (%.1f%% of the link, best %.1f%%, %.1f%% of best)\n",
+           link, s.window, 100.0 * busy / end, goodput, 100.0 * goodput / link,
+           100.0 * best, 100.0 * goodput / link / best);
+    printf("segments %lu new, %lu again (%lu timeouts), acks %lu "
+           "(%lu bad), crc errors %lu, delivered %llu bytes, %lu wrong\n",
+           s.segments, s.retransmits, s.timeouts, s.acks, s.bad_acks,
+           reader.crc_errors, r.delivered, errors);
+
+    free(data.q);
+    free(acks.q);
+    return (errors != 0);
+}
+
+//
+// baud_constant - termios speed of a baud rate, 0 if there is none
+//
+static speed_t baud_constant(long baud)
+{
+    switch(baud)
+    {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+#ifdef B1000000
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        case 3000000: return B3000000;
+#endif
+        default:      return 0;
+    }
+}
+
+//
+// open_port - Open a device raw, 8N1 at the given speed
+//
+static int open_port(const char *name, speed_t speed)
+{
+    struct termios tio;
+    int fd;
+
+    fd = open(name, O_RDWR | O_NOCTTY);
+    if(fd < 0)
+    {
+        perror(name);
+        return -1;
+    }
+
+    if(tcgetattr(fd, &tio) != 0)
+    {
+        perror(name);
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if(tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        perror(name);
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+//
+// now - Monotonic time in seconds
+//
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//
+// serve - Receive from the port until it fails, acknowledging every
+//         segment
+//
+static int serve(int fd, FILE *out, double loss)
+{
+    static arq_receiver r;
+    static tlm_reader reader;
+    static tlm_frame frame;
+    uint8_t chunk[4096];
+    uint8_t ack[ARQ_ACK_FRAME];
+    size_t ack_len;
+    uint8_t sent[ARQ_ACK_FRAME];
+    struct pollfd pfd;
+    unsigned long long received = 0;
+    unsigned long long lastDelivered = 0;
+    unsigned long long lastReceived = 0;
+    double last;
+    double t;
+    ssize_t got;
+    size_t take;
+    size_t n;
+    size_t i;
+    size_t k;
+
+    memset(&r, 0, sizeof(r));
+    tlm_reader_init(&reader);
+    reader.max_len = ARQ_SEG_MAX + 1;
+    last = now();
+
+    for(;;)
+    {
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        if((poll(&pfd, 1, 100) < 0) && (errno != EINTR))
+        {
+            perror("poll");
+            return 1;
+        }
+
+        take = tlm_reader_space(&reader);
+        if(take > sizeof(chunk))
+        {
+            take = sizeof(chunk);
+        }
+        got = read(fd, chunk, take);
+        if((got < 0) && (errno != EAGAIN) && (errno != EINTR))
+        {
+            perror("read");
+            return 1;
+        }
+        for(i = 0, n = 0; (got > 0) && (i < (size_t)got); i++)
+        {
+            if(!lost(loss))
+            {
+                chunk[n++] = chunk[i];
+            }
+        }
+        received += (got > 0) ? got : 0;
+        tlm_reader_push(&reader, chunk, n);
+
+        while(tlm_reader_next(&reader, &frame))
+        {
+            if((frame.type != TLM_TYPE_ARQ) || (frame.len < 1))
+            {
+                continue;
+            }
+            arq_receive(&r, &frame, out, NULL, ack, &ack_len);
+            for(i = 0, k = 0; i < ack_len; i++)
+            {
+                if(!lost(loss))
+                {
+                    sent[k++] = ack[i];
+                }
+            }
+            if(write(fd, sent, k) != (ssize_t)k)
+            {
+                perror("write");
+                return 1;
+            }
+        }
+        fflush(out);
+
+        t = now();
+        if(t - last >= 1.0)
+        {
+            fprintf(stderr, "goodput %.0f bytes/s, line %.0f bytes/s, "
+                    "segments %lu, again %lu, crc errors %lu, resyncs %lu\n",
+                    (double)(r.delivered - lastDelivered) / (t - last),
+                    (double)(received - lastReceived) / (t - last),
+                    r.segments, r.duplicates, reader.crc_errors, r.resyncs);
+            lastDelivered = r.delivered;
+            lastReceived = received;
+            last = t;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *device = NULL;
+    const char *outName = NULL;
+    long baud = 115200;
+    double loss = 0.0;
+    unsigned seg_len = 64;
+    double latency = 10.0;
+    unsigned rto = 100;
+    double seconds = 10.0;
+    int sim = 0;
+    int i;
+    int fd;
+    speed_t speed;
+    FILE *out = stdout;
+
+    for(i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "-S") == 0)
+        {
+            sim = 1;
+        }
+        else if((argv[i][0] == '-') && (i + 1 < argc))
+        {
+            switch(argv[i][1])
+            {
+                case 'b':  baud = atol(argv[++i]); break;
+                case 'l':  loss = atof(argv[++i]); break;
+                case 'n':  seg_len = (unsigned)atoi(argv[++i]); break;
+                case 'd':  latency = atof(argv[++i]); break;
+                case 'r':  rto = (unsigned)atoi(argv[++i]); break;
+                case 't':  seconds = atof(argv[++i]); break;
+                case 'o':  outName = argv[++i]; break;
+                default:
+                    fprintf(stderr, "unknown option %s\n", argv[i]);
+                    return 1;
+            }
+        }
+        else
+        {
+            device = argv[i];
+        }
+    }
+    if((baud <= 0) || (loss < 0.0) || (loss >= 1.0) || (seg_len < 8) ||
+       (seg_len > ARQ_SEG_MAX))
+    {
+        fprintf(stderr, "bad option value\n");
+        return 1;
+    }
+    srand(1);
+
+    if(sim)
+    {
+        return simulate(baud, loss, seg_len, latency, rto, seconds);
+    }
+
+    if(device == NULL)
+    {
+        fprintf(stderr, "usage: arq_peer [-b baud] [-l loss] [-o out.bin] "
+                "/dev/ttyUSB1\n");
+        return 1;
+    }
+    speed = baud_constant(baud);
+    if(speed == 0)
+    {
+        fprintf(stderr, "unsupported baud rate %ld\n", baud);
+        return 1;
+    }
+    if((outName != NULL) && ((out = fopen(outName, "wb")) == NULL))
+    {
+        perror(outName);
+        return 1;
+    }
+    fd = open_port(device, speed);
+    if(fd < 0)
+    {
+        return 1;
+    }
+    return serve(fd, out, loss);
+}
+
+//
+// End of file
+//
@@ -0,0 +1,204 @@
+//###########################################################################
+//
+// FILE:   arq_target.c
+//
+// TITLE:  The target's ARQ sender on a model of its SCI port.
+//
+// The simulated target of arq_peer -S. It runs the target's arq.c, and
+// the CRC of tlm.c, as they are, on a model of what they use:
+//
+//   SCI TX ring - SCI_TX_LEN bytes, Sci_TxSpace() as the driver reports
+//                 it; the line takes a byte per byte time (arq_target_tx())
+//   SCI RX ring - SCI_RX_LEN bytes of what the line delivered
+//                 (arq_target_rx()), dropped when full
+//   Timebase    - CPU Timer 1 counting down at TIMEBASE_HZ
+//
+// The session is opened on SCI-A (port 0).
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "../adc_soc_continuous_dma_cpu01/sci.h"
+#include "../adc_soc_continuous_dma_cpu01/tlm.h"
+#include "../adc_soc_continuous_dma_cpu01/arq.h"
+#include "../adc_soc_continuous_dma_cpu01/timebase.h"
+#include "arq_target.h"
+
+//
+// Defines
+//
+#define SIM_PORT        0
+
+//
+// Globals
+//
+volatile struct CPUTIMER_REGS CpuTimer1Regs;
+
+static Uint16 txRing[SCI_TX_LEN];
+static Uint16 txHead;
+static Uint16 txLevel;
+static Uint16 rxRing[SCI_RX_LEN];
+static Uint16 rxHead;
+static Uint16 rxLevel;
+
+//
+// The SCI driver, as arq.c and tlm.c see it
+//
+Uint16 Sci_IsOpen(Uint16 port)
+{
+    return port == SIM_PORT;
+}
+
+Uint16 Sci_TxSpace(Uint16 port)
+{
+    (void)port;
+    return SCI_TX_LEN - 1 - txLevel;
+}
+
+int Sci_Put(Uint16 port, const char *data, int len)
+{
+    const Uint16 *words = (const Uint16 *)data;     // One byte per word
+    int i;
+
+    if(len > (int)Sci_TxSpace(port))
+    {
+        return 0;
+    }
+    for(i = 0; i < len; i++)
+    {
+        txRing[(txHead + txLevel++) % SCI_TX_LEN] = words[i] & 0xFF;
+    }
+    return 1;
+}
+
+int Sci_GetChar(Uint16 port)
+{
+    int c;
+
+    (void)port;
+    if(rxLevel == 0)
+    {
+        return -1;
+    }
+    c = rxRing[rxHead];
+    rxHead = (rxHead + 1) % SCI_RX_LEN;
+    rxLevel--;
+    return c;
+}
+
+int Sci_PutRef(Uint16 port, const Uint16 *data, Uint16 words, Uint16 crc)
+{
+    (void)port;
+    (void)data;
+    (void)words;
+    (void)crc;
+    return 0;
+}
+
+Uint16 Sci_RefBusy(Uint16 port)
+{
+    (void)port;
+    return 0;
+}
+
+Uint16 Sci_RefCrc(Uint16 port)
+{
+    (void)port;
+    return 0;
+}
+
+//
+// arq_target_init - Open a session with segments of seg_len bytes and a
+//                   retransmission timeout of rto_ms. Returns -1 if arq.c
+//                   does not take them.
+//
+int arq_target_init(unsigned seg_len, unsigned rto_ms)
+{
+    Tlm_Init(0);                    // The CRC table of Tlm_Crc16()
+    Arq_Init();
+    if((seg_len > ARQ_SEG_MAX) || (rto_ms > ARQ_RTO_MS_MAX) ||
+       (Arq_SetSegment((Uint16)seg_len) == 0) ||
+       (Arq_SetTimeout((Uint16)rto_ms) == 0) ||
+       (Arq_Open(SIM_PORT) == 0))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+//
+// arq_target_space - Bytes arq_target_put() takes now
+//
+size_t arq_target_space(void)
+{
+    return Arq_Space();
+}
+
+//
+// arq_target_put - Arq_Put() of len bytes, 0 if there is no room
+//
+int arq_target_put(const uint8_t *data, size_t len)
+{
+    return Arq_Put((const char *)data, (int)len);
+}
+
+//
+// arq_target_poll - The background loop's Arq_Poll() at time t, seconds
+//
+void arq_target_poll(double t)
+{
+    CpuTimer1Regs.TIM.all = ~(Uint32)(uint64_t)(t * TIMEBASE_HZ);
+    Arq_Poll();
+}
+
+//
+// arq_target_tx - The next byte the SCI sends, -1 if its ring is empty
+//
+int arq_target_tx(void)
+{
+    int c;
+
+    if(txLevel == 0)
+    {
+        return -1;
+    }
+    c = txRing[txHead];
+    txHead = (txHead + 1) % SCI_TX_LEN;
+    txLevel--;
+    return c;
+}
+
+//
+// arq_target_rx - A byte the SCI received
+//
+void arq_target_rx(uint8_t byte)
+{
+    if(rxLevel == SCI_RX_LEN)
+    {
+        return;
+    }
+    rxRing[(rxHead + rxLevel++) % SCI_RX_LEN] = byte;
+}
+
+//
+// arq_target_get_stats - Arq_GetStats() and Arq_Window()
+//
+void arq_target_get_stats(arq_target_stats *stats)
+{
+    ARQ_STATS s;
+
+    Arq_GetStats(&s);
+    stats->segments = s.segments;
+    stats->retransmits = s.retransmits;
+    stats->timeouts = s.timeouts;
+    stats->acks = s.acks;
+    stats->bad_acks = s.badAcks;
+    stats->window = Arq_Window();
+}
+
+//
+// End of file
+//
@@ -0,0 +1,43 @@
+//###########################################################################
+//
+// FILE:   arq_target.h
+//
+// TITLE:  The target's ARQ sender on a model of its SCI port.
+//
+//###########################################################################
+
+#ifndef HOST_ARQ_TARGET_H
+#define HOST_ARQ_TARGET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Typedefs
+//
+typedef struct
+{
+    unsigned long segments;         // ARQ_STATS of the target
+    unsigned long retransmits;
+    unsigned long timeouts;
+    unsigned long acks;
+    unsigned long bad_acks;
+    unsigned window;                // Arq_Window(), segments
+} arq_target_stats;
+
+//
+// Function Prototypes
+//
+int arq_target_init(unsigned seg_len, unsigned rto_ms);
+size_t arq_target_space(void);
+int arq_target_put(const uint8_t *data, size_t len);
+void arq_target_poll(double t);
+int arq_target_tx(void);
+void arq_target_rx(uint8_t byte);
+void arq_target_get_stats(arq_target_stats *stats);
+
+#endif // HOST_ARQ_TARGET_H
+
+//
+// End of file
+//
@@ -0,0 +1,210 @@
+//###########################################################################
+//
+// FILE:   fmt_bench.c
+//
+// TITLE:  Host check and benchmark of the target's text formatter.
+//
+// Builds the target's fmt.c as it is and
+//
+//   - compares Fmt_Dec() for every width and Fmt_Hex() for every 16-bit
+//     value with snprintf(), and Fmt_CsvLines() with the capture's old
+//     sprintf("%04d,%04u\n") for every value at the low and high indexes,
+//     including lines cut short by the room given
+//   - times a 1024 sample capture both ways and prints the ratio
+//
+// The host ratio only shows the relative cost of the two; the target's own
+// is the time of a CSV capture drain, before and after.
+//
+// Build:  cc -O2 -DFMT_HOST_BENCH -I../adc_soc_continuous_dma_cpu01
+//             -o fmt_bench fmt_bench.c ../adc_soc_continuous_dma_cpu01/fmt.c
+// Usage:  fmt_bench [rounds]
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef uint16_t Uint16;
+typedef uint32_t Uint32;
+#include "fmt.h"
+
+//
+// Defines
+//
+#define SAMPLES         1024    // Samples per capture
+#define ROUNDS          2000    // Captures timed by default
+#define TEXT_LEN        (SAMPLES * FMT_CSV_LINE_MAX)
+
+//
+// Globals
+//
+static Uint16 samples[SAMPLES];
+static char textLib[TEXT_LEN + 1];
+static char textFmt[TEXT_LEN + 1];
+static volatile Uint32 sink;
+
+//
+// now - Monotonic time in seconds
+//
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//
+// csv_lib - The capture text the way the target formatted it before
+//
+static size_t csv_lib(char *out, const Uint16 *data, Uint16 count)
+{
+    size_t len;
+    Uint16 i;
+
+    len = 0;
+    for(i = 0; i < count; i++)
+    {
+        len += sprintf(out + len, "%04d,%04u\n", i, data[i]);
+    }
+    return len;
+}
+
+//
+// check - Compare every formatter with the C library. Returns the number
+//         of mismatches.
+//
+static long check(void)
+{
+    char ref[16];
+    char out[16];
+    Uint16 data[1];
+    Uint16 lines;
+    Uint16 len;
+    Uint16 room;
+    Uint16 width;
+    Uint16 index;
+    long bad;
+    Uint32 v;
+
+    bad = 0;
+    for(v = 0; v <= 0xFFFF; v++)
+    {
+        for(width = 1; width <= FMT_DEC_MAX; width++)
+        {
+            snprintf(ref, sizeof(ref), "%0*u", width, (unsigned)v);
+            len = Fmt_Dec(out, (Uint16)v, width);
+            if((len != strlen(ref)) || (memcmp(out, ref, len) != 0))
+            {
+                bad++;
+            }
+        }
+
+        snprintf(ref, sizeof(ref), "%04X", (unsigned)v);
+        len = Fmt_Hex(out, (Uint16)v);
+        if((len != 4) || (memcmp(out, ref, 4) != 0))
+        {
+            bad++;
+        }
+
+        data[0] = (Uint16)v;
+        for(index = 0; index < 2; index++)
+        {
+            snprintf(ref, sizeof(ref), "%04d,%04u\n",
+                     index ? SAMPLES - 1 : 0, (unsigned)v);
+            len = Fmt_CsvLines(out, sizeof(out), index ? SAMPLES - 1 : 0,
+                               data, 1, &lines);
+            if((lines != 1) || (len != strlen(ref)) ||
+               (memcmp(out, ref, len) != 0))
+            {
+                bad++;
+            }
+
+            //
+            // One character short of the line: nothing may be written
+            //
+            room = strlen(ref) - 1;
+            len = Fmt_CsvLines(out, room, index ? SAMPLES - 1 : 0,
+                               data, 1, &lines);
+            if((lines != 0) || (len != 0))
+            {
+                bad++;
+            }
+        }
+    }
+    return bad;
+}
+
+int main(int argc, char *argv[])
+{
+    long rounds;
+    long r;
+    long bad;
+    size_t lenLib;
+    Uint16 lenFmt;
+    Uint16 lines;
+    Uint16 i;
+    double t;
+    double tLib;
+    double tFmt;
+
+    rounds = (argc > 1) ? atol(argv[1]) : ROUNDS;
+    if(rounds <= 0)
+    {
+        fprintf(stderr, "usage: fmt_bench [rounds]\n");
+        return 2;
+    }
+
+    bad = check();
+    printf("check: %ld mismatches\n", bad);
+
+    //
+    // A capture of both 12-bit and 16-bit codes, so both widths of the
+    // value are timed
+    //
+    srand(1);
+    for(i = 0; i < SAMPLES; i++)
+    {
+        samples[i] = (i & 1) ? (Uint16)(rand() & 0xFFF) : (Uint16)rand();
+    }
+
+    lenLib = csv_lib(textLib, samples, SAMPLES);
+    lenFmt = Fmt_CsvLines(textFmt, TEXT_LEN, 0, samples, SAMPLES, &lines);
+    if((lines != SAMPLES) || (lenFmt != lenLib) ||
+       (memcmp(textLib, textFmt, lenLib) != 0))
+    {
+        printf("capture: text differs\n");
+        bad++;
+    }
+
+    t = now();
+    for(r = 0; r < rounds; r++)
+    {
+        sink += csv_lib(textLib, samples, SAMPLES);
+    }
+    tLib = now() - t;
+
+    t = now();
+    for(r = 0; r < rounds; r++)
+    {
+        samples[r & (SAMPLES - 1)] ^= 1;    // Keep the work in the loop
+        sink += Fmt_CsvLines(textFmt, TEXT_LEN, 0, samples, SAMPLES,
+                             &lines);
+    }
+    tFmt = now() - t;
+
+    printf("sprintf:      %8.1f ns/line\n", tLib * 1e9 / rounds / SAMPLES);
+    printf("Fmt_CsvLines: %8.1f ns/line\n", tFmt * 1e9 / rounds / SAMPLES);
+    printf("speedup:      %8.1fx\n", tLib / tFmt);
+    return (bad != 0);
+}
+
+//
+// End of file
+//
@@ -0,0 +1,386 @@
+//###########################################################################
+//
+// FILE:   log_render.c
+//
+// TITLE:  Renderer of the target's tokenized log (LOG ON).
+//
+// Reads the byte stream recorded from the target's SCI port (a file, or
+// standard input), takes the TLM_TYPE_LOG frames out of it and prints one
+// line per record:
+//
+//   seconds message
+//
+// The message is the format of the record's ID in log_strings.txt, the
+// table written by log_strings, filled in with the record's arguments.
+// Arguments are 32 bits on the target: %d and %i print them signed, %u,
+// %x, %X, %o and %c unsigned, %f, %e and %g as the bits of a float32. The
+// time is in seconds since the first record, from the SYSCLK cycle count
+// of the records; it is unwrapped assuming records are less than half a
+// wrap (about 10 s at 200 MHz) apart, which also lets the "records lost"
+// record, stamped with the last loss, come after later records. Other
+// frames are skipped.
+//
+// Records of an ID missing from the table mean the table does not belong
+// to the image; they are printed as "? id args...".
+//
+// Build:  cc -O2 -o log_render log_render.c tlm.c
+// Usage:  log_render [-t log_strings.txt] [-c sysclk_hz] [capture.bin]
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tlm.h"
+
+//
+// Defines
+//
+#define MAX_IDS         1024
+#define MAX_ARGS        3
+#define MAX_LINE        1024
+#define SYSCLK_HZ       200000000.0     // TIMEBASE_HZ of the target
+
+//
+// Typedefs
+//
+typedef struct
+{
+    int nargs;
+    char *format;
+} log_format;
+
+//
+// Globals
+//
+static log_format formats[MAX_IDS];
+
+//
+// unescape - Turn the C escapes of a format as written in the source into
+//            characters, in place
+//
+static void unescape(char *s)
+{
+    char *out = s;
+    char *end;
+
+    while(*s != '\0')
+    {
+        if((*s != '\\') || (s[1] == '\0'))
+        {
+            *out++ = *s++;
+            continue;
+        }
+        s++;
+        switch(*s)
+        {
+            case 'n':  *out++ = '\n'; s++; break;
+            case 't':  *out++ = '\t'; s++; break;
+            case 'r':  *out++ = '\r'; s++; break;
+            case 'x':
+                *out++ = (char)strtol(s + 1, &end, 16);
+                s = end;
+                break;
+            default:
+                if((*s >= '0') && (*s <= '7'))
+                {
+                    *out++ = (char)strtol(s, &end, 8);
+                    s = end;
+                }
+                else
+                {
+                    *out++ = *s++;  // \\ \" \' \?
+                }
+                break;
+        }
+    }
+    *out = '\0';
+}
+
+//
+// load_table - Read log_strings.txt. Returns the number of formats, or -1.
+//
+static int load_table(const char *path)
+{
+    FILE *f;
+    char line[MAX_LINE];
+    char *name;
+    char *nargs;
+    char *format;
+    long id;
+    int n = 0;
+    size_t len;
+
+    if((f = fopen(path, "r")) == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    while(fgets(line, sizeof(line), f) != NULL)
+    {
+        len = strlen(line);
+        if((len > 0) && (line[len - 1] == '\n'))
+        {
+            line[--len] = '\0';
+        }
+        if(((name = strchr(line, '\t')) == NULL) ||
+           ((nargs = strchr(name + 1, '\t')) == NULL) ||
+           ((format = strchr(nargs + 1, '\t')) == NULL))
+        {
+            continue;
+        }
+        *format++ = '\0';
+        id = strtol(line, NULL, 10);
+        if((id < 0) || (id >= MAX_IDS))
+        {
+            continue;
+        }
+
+        //
+        // A trailing newline of the format would give an empty line
+        //
+        unescape(format);
+        len = strlen(format);
+        if((len > 0) && (format[len - 1] == '\n'))
+        {
+            format[len - 1] = '\0';
+        }
+        free(formats[id].format);
+        formats[id].format = strdup(format);
+        formats[id].nargs = atoi(nargs + 1);
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+//
+// render - Print a format with the 32-bit arguments of a record. Each
+//          conversion is printed on its own with the length modifier
+//          replaced to fit the argument.
+//
+static void render(const char *format, const uint32_t *args, int nargs)
+{
+    char spec[32];
+    size_t n;
+    int arg = 0;
+    uint32_t v;
+    union
+    {
+        uint32_t u;
+        float f;
+    } bits;
+
+    while(*format != '\0')
+    {
+        if(*format != '%')
+        {
+            putchar(*format++);
+            continue;
+        }
+        if(format[1] == '%')
+        {
+            putchar('%');
+            format += 2;
+            continue;
+        }
+
+        //
+        // Copy flags, width and precision, drop h/l/L
+        //
+        n = 0;
+        spec[n++] = *format++;
+        while((*format != '\0') && strchr("-+ #0123456789.hlL", *format))
+        {
+            if(!strchr("hlL", *format) && (n < sizeof(spec) - 3))
+            {
+                spec[n++] = *format;
+            }
+            format++;
+        }
+        if(*format == '\0')
+        {
+            break;
+        }
+
+        v = (arg < nargs) ? args[arg] : 0;
+        arg++;
+        switch(*format)
+        {
+            case 'd':
+            case 'i':
+                spec[n++] = 'l';
+                spec[n++] = *format;
+                spec[n] = '\0';
+                printf(spec, (long)(int32_t)v);
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                spec[n++] = 'l';
+                spec[n++] = *format;
+                spec[n] = '\0';
+                printf(spec, (unsigned long)v);
+                break;
+            case 'c':
+                spec[n++] = 'c';
+                spec[n] = '\0';
+                printf(spec, (int)(v & 0xFF));
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+                bits.u = v;
+                spec[n++] = *format;
+                spec[n] = '\0';
+                printf(spec, (double)bits.f);
+                break;
+            default:
+                printf("?%c", *format);
+                break;
+        }
+        format++;
+    }
+}
+
+//
+// render_frame - Print the records of one TLM_TYPE_LOG frame. Returns the
+//                number of records.
+//
+static unsigned long render_frame(const tlm_frame *f, double sysclk,
+                                  int *haveTime, uint32_t *lastTime,
+                                  long long *clock,
+                                  unsigned long *unknown)
+{
+    const uint8_t *p = f->payload;
+    const uint8_t *end = f->payload + f->len;
+    uint32_t args[MAX_ARGS];
+    uint32_t t;
+    unsigned id;
+    unsigned nargs;
+    unsigned i;
+    unsigned long records = 0;
+
+    while(end - p >= 8)
+    {
+        id = (p[0] << 8) | p[1];
+        nargs = (p[2] << 8) | p[3];
+        t = ((uint32_t)p[6] << 24) | ((uint32_t)p[7] << 16) |
+            ((uint32_t)p[4] << 8) | p[5];
+        if((nargs > MAX_ARGS) || (end - p < 8 + 4 * (long)nargs))
+        {
+            fprintf(stderr, "frame %u: bad record\n", f->seq);
+            break;
+        }
+        p += 8;
+        for(i = 0; i < nargs; i++)
+        {
+            args[i] = ((uint32_t)p[2] << 24) | ((uint32_t)p[3] << 16) |
+                      ((uint32_t)p[0] << 8) | p[1];
+            p += 4;
+        }
+
+        if(*haveTime)
+        {
+            *clock += (int32_t)(t - *lastTime);
+        }
+        *haveTime = 1;
+        *lastTime = t;
+
+        printf("%12.6f ", (double)*clock / sysclk);
+        if((id < MAX_IDS) && (formats[id].format != NULL) &&
+           (formats[id].nargs == (int)nargs))
+        {
+            render(formats[id].format, args, (int)nargs);
+        }
+        else
+        {
+            printf("? %u", id);
+            for(i = 0; i < nargs; i++)
+            {
+                printf(" 0x%08lx", (unsigned long)args[i]);
+            }
+            (*unknown)++;
+        }
+        putchar('\n');
+        records++;
+    }
+    return records;
+}
+
+int main(int argc, char *argv[])
+{
+    static tlm_reader reader;
+    static tlm_frame frame;
+    uint8_t chunk[4096];
+    const char *table = "log_strings.txt";
+    double sysclk = SYSCLK_HZ;
+    FILE *in = stdin;
+    size_t got, take;
+    int i;
+    int haveTime = 0;
+    uint32_t lastTime = 0;
+    long long clock = 0;
+    unsigned long records = 0;
+    unsigned long unknown = 0;
+    unsigned long frames = 0;
+
+    for(i = 1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-t") == 0) && (i + 1 < argc))
+        {
+            table = argv[++i];
+        }
+        else if((strcmp(argv[i], "-c") == 0) && (i + 1 < argc))
+        {
+            sysclk = atof(argv[++i]);
+        }
+        else if((in = fopen(argv[i], "rb")) == NULL)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+    }
+    if((load_table(table) < 0) || (sysclk <= 0.0))
+    {
+        return 1;
+    }
+
+    tlm_reader_init(&reader);
+    do
+    {
+        take = tlm_reader_space(&reader);
+        if(take > sizeof(chunk))
+        {
+            take = sizeof(chunk);
+        }
+        got = fread(chunk, 1, take, in);
+        tlm_reader_push(&reader, chunk, got);
+
+        while(tlm_reader_next(&reader, &frame))
+        {
+            if(frame.type == TLM_TYPE_LOG)
+            {
+                frames++;
+                records += render_frame(&frame, sysclk, &haveTime,
+                                        &lastTime, &clock, &unknown);
+            }
+        }
+    } while(got > 0);
+
+    fprintf(stderr, "log frames %lu, records %lu, unknown %lu, crc errors "
+            "%lu, sequence gaps %lu\n", frames, records, unknown,
+            reader.crc_errors, reader.seq_gaps);
+    return 0;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,464 @@
+//###########################################################################
+//
+// FILE:   log_strings.c
+//
+// TITLE:  Build step collecting the format strings of the target's log.
+//
+// The target's LOGn(NAME, "format", ...) calls (adc_soc_continuous_dma_cpu01
+// /log.h) only compile the message ID and the arguments; the format stays
+// in the source. This tool finds every call in the given sources, checks
+// that the format takes as many arguments as the macro passes, numbers the
+// names in alphabetical order from 1 and writes
+//
+//   log_ids.h        - "#define NAME id" for the target build
+//   log_strings.txt  - "id<TAB>NAME<TAB>nargs<TAB>format" for log_render,
+//                      the format as written in the source
+//
+// into the output directory. ID 0 is the built in LOG_ID_LOST message. A
+// name may be used at several call sites if the format is the same.
+// Comments and string literals are skipped, so the example in log.h is not
+// taken for a call.
+//
+// Run it from the project directory after adding or changing a call:
+//
+//   ../host/log_strings *.c
+//
+// Build:  cc -O2 -o log_strings log_strings.c
+// Usage:  log_strings [-o dir] source.c ...
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Defines
+//
+#define MAX_MESSAGES    1024
+#define MAX_NAME        64
+#define MAX_FORMAT      256
+#define LOST_NAME       "LOG_ID_LOST"
+#define LOST_FORMAT     "%lu records lost"
+
+//
+// Typedefs
+//
+typedef struct
+{
+    char name[MAX_NAME];
+    char format[MAX_FORMAT];
+    int nargs;
+    const char *file;
+    int line;
+} log_message;
+
+//
+// Globals
+//
+static log_message messages[MAX_MESSAGES];
+static int messageCount;
+static int errors;
+
+//
+// read_file - The whole file as a string, or NULL
+//
+static char *read_file(const char *path)
+{
+    FILE *f;
+    long len;
+    char *text;
+
+    if((f = fopen(path, "rb")) == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    text = malloc((size_t)len + 1);
+    if((text == NULL) || (fread(text, 1, (size_t)len, f) != (size_t)len))
+    {
+        fprintf(stderr, "%s: read error\n", path);
+        free(text);
+        fclose(f);
+        return NULL;
+    }
+    text[len] = '\0';
+    fclose(f);
+    return text;
+}
+
+//
+// skip_space - Skip white space and comments, counting lines
+//
+static const char *skip_space(const char *p, int *line)
+{
+    for(;;)
+    {
+        if(*p == '\n')
+        {
+            (*line)++;
+            p++;
+        }
+        else if(isspace((unsigned char)*p))
+        {
+            p++;
+        }
+        else if((p[0] == '/') && (p[1] == '/'))
+        {
+            while((*p != '\0') && (*p != '\n'))
+            {
+                p++;
+            }
+        }
+        else if((p[0] == '/') && (p[1] == '*'))
+        {
+            for(p += 2; (*p != '\0') && !((p[0] == '*') && (p[1] == '/'));
+                p++)
+            {
+                if(*p == '\n')
+                {
+                    (*line)++;
+                }
+            }
+            if(*p != '\0')
+            {
+                p += 2;
+            }
+        }
+        else
+        {
+            return p;
+        }
+    }
+}
+
+//
+// skip_literal - Skip a string or character literal starting at p
+//
+static const char *skip_literal(const char *p, int *line)
+{
+    char quote = *p++;
+
+    while((*p != '\0') && (*p != quote))
+    {
+        if((*p == '\\') && (p[1] != '\0'))
+        {
+            p++;
+        }
+        if(*p == '\n')
+        {
+            (*line)++;
+        }
+        p++;
+    }
+    return (*p != '\0') ? p + 1 : p;
+}
+
+//
+// count_conversions - Arguments a printf format takes, -1 if it uses a
+//                     '*' width or precision, which the log can not pass
+//
+static int count_conversions(const char *format)
+{
+    int n = 0;
+
+    while((format = strchr(format, '%')) != NULL)
+    {
+        format++;
+        if(*format == '%')
+        {
+            format++;
+            continue;
+        }
+        while((*format != '\0') && (strchr("-+ #0123456789.hlL", *format)))
+        {
+            format++;
+        }
+        if(*format == '*')
+        {
+            return -1;
+        }
+        if(*format != '\0')
+        {
+            n++;
+        }
+    }
+    return n;
+}
+
+//
+// add_message - Record a call, or check it against an earlier call of the
+//               same name
+//
+static void add_message(const char *name, const char *format, int nargs,
+                        const char *file, int line)
+{
+    int i;
+    int conversions;
+
+    conversions = count_conversions(format);
+    if(conversions != nargs)
+    {
+        fprintf(stderr, "%s:%d: %s passes %d arguments, \"%s\" takes %d\n",
+                file, line, name, nargs, format, conversions);
+        errors++;
+        return;
+    }
+
+    for(i = 0; i < messageCount; i++)
+    {
+        if(strcmp(messages[i].name, name) == 0)
+        {
+            if(strcmp(messages[i].format, format) != 0)
+            {
+                fprintf(stderr, "%s:%d: %s differs from %s:%d\n", file, line,
+                        name, messages[i].file, messages[i].line);
+                errors++;
+            }
+            return;
+        }
+    }
+
+    if(messageCount == MAX_MESSAGES)
+    {
+        fprintf(stderr, "%s:%d: too many messages\n", file, line);
+        errors++;
+        return;
+    }
+    strcpy(messages[messageCount].name, name);
+    strcpy(messages[messageCount].format, format);
+    messages[messageCount].nargs = nargs;
+    messages[messageCount].file = file;
+    messages[messageCount].line = line;
+    messageCount++;
+}
+
+//
+// parse_call - Parse "(NAME, "format" ...," after LOGn. Returns 0 if the
+//              text is not a call (the macro definitions in log.h).
+//
+static int parse_call(const char *p, int nargs, const char *file, int *line)
+{
+    char name[MAX_NAME];
+    char format[MAX_FORMAT];
+    size_t n;
+    size_t len;
+    const char *start;
+    int callLine = *line;
+
+    p = skip_space(p, line);
+    if(*p != '(')
+    {
+        return 0;
+    }
+    p = skip_space(p + 1, line);
+
+    for(n = 0; isalnum((unsigned char)p[n]) || (p[n] == '_'); n++)
+    {
+    }
+    if((n == 0) || (n >= MAX_NAME))
+    {
+        return 0;
+    }
+    memcpy(name, p, n);
+    name[n] = '\0';
+
+    p = skip_space(p + n, line);
+    if(*p != ',')
+    {
+        return 0;
+    }
+    p = skip_space(p + 1, line);
+    if(*p != '"')
+    {
+        return 0;
+    }
+
+    //
+    // Adjacent literals are joined as the compiler would
+    //
+    len = 0;
+    while(*p == '"')
+    {
+        start = p + 1;
+        p = skip_literal(p, line);
+        n = (size_t)(p - 1 - start);
+        if(len + n >= MAX_FORMAT)
+        {
+            fprintf(stderr, "%s:%d: format too long\n", file, callLine);
+            errors++;
+            return 1;
+        }
+        memcpy(&format[len], start, n);
+        len += n;
+        p = skip_space(p, line);
+    }
+    format[len] = '\0';
+
+    if(strcmp(name, LOST_NAME) == 0)
+    {
+        fprintf(stderr, "%s:%d: %s is reserved\n", file, callLine, name);
+        errors++;
+        return 1;
+    }
+    add_message(name, format, nargs, file, callLine);
+    return 1;
+}
+
+//
+// scan_file - Find the LOGn( calls of one source file
+//
+static int scan_file(const char *path)
+{
+    char *text;
+    const char *p;
+    int line = 1;
+
+    if((text = read_file(path)) == NULL)
+    {
+        return -1;
+    }
+
+    p = text;
+    while(*p != '\0')
+    {
+        p = skip_space(p, &line);
+        if((*p == '"') || (*p == '\''))
+        {
+            p = skip_literal(p, &line);
+        }
+        else if((strncmp(p, "LOG", 3) == 0) && (p[3] >= '0') &&
+                (p[3] <= '3') && !isalnum((unsigned char)p[4]) &&
+                (p[4] != '_') &&
+                ((p == text) || (!isalnum((unsigned char)p[-1]) &&
+                                 (p[-1] != '_'))))
+        {
+            parse_call(p + 4, p[3] - '0', path, &line);
+            p += 4;
+        }
+        else if(*p != '\0')
+        {
+            p++;
+        }
+    }
+
+    free(text);
+    return 0;
+}
+
+//
+// compare_names - qsort order of the messages
+//
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(((const log_message *)a)->name,
+                  ((const log_message *)b)->name);
+}
+
+//
+// write_outputs - Write log_ids.h and log_strings.txt into dir
+//
+static int write_outputs(const char *dir)
+{
+    char path[1024];
+    FILE *f;
+    int i;
+
+    snprintf(path, sizeof(path), "%s/log_ids.h", dir);
+    if((f = fopen(path, "w")) == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    fprintf(f,
+        "//#############################################################"
+        "##############\n"
+        "//\n"
+        "// FILE:   log_ids.h\n"
+        "//\n"
+        "// TITLE:  Log message IDs, generated by host/log_strings from the"
+        "\n"
+        "//         LOGn() calls. Do not edit; the formats are in"
+        " log_strings.txt.\n"
+        "//\n"
+        "//#############################################################"
+        "##############\n"
+        "\n"
+        "#ifndef LOG_IDS_H\n"
+        "#define LOG_IDS_H\n"
+        "\n"
+        "//\n"
+        "// Defines\n"
+        "//\n");
+    for(i = 0; i < messageCount; i++)
+    {
+        fprintf(f, "#define %-31s %d\n", messages[i].name, i + 1);
+    }
+    fprintf(f,
+        "\n"
+        "#endif // LOG_IDS_H\n"
+        "\n"
+        "//\n"
+        "// End of file\n"
+        "//\n");
+    fclose(f);
+
+    snprintf(path, sizeof(path), "%s/log_strings.txt", dir);
+    if((f = fopen(path, "w")) == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "0\t%s\t1\t%s\n", LOST_NAME, LOST_FORMAT);
+    for(i = 0; i < messageCount; i++)
+    {
+        fprintf(f, "%d\t%s\t%d\t%s\n", i + 1, messages[i].name,
+                messages[i].nargs, messages[i].format);
+    }
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *dir = ".";
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))
+        {
+            dir = argv[++i];
+        }
+        else if(scan_file(argv[i]) != 0)
+        {
+            return 1;
+        }
+    }
+
+    if(errors != 0)
+    {
+        fprintf(stderr, "%d errors, nothing written\n", errors);
+        return 1;
+    }
+
+    qsort(messages, (size_t)messageCount, sizeof(messages[0]),
+          compare_names);
+    if(write_outputs(dir) != 0)
+    {
+        return 1;
+    }
+    fprintf(stderr, "%d messages\n", messageCount);
+    return 0;
+}
+
+//
+// End of file
+//
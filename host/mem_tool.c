@@ -0,0 +1,694 @@
+//###########################################################################
+//
+// FILE:   mem_tool.c
+//
+// TITLE:  Host end of the target's MEM commands: dump, load and check
+//         target memory over the serial links.
+//
+//   read ADDR WORDS FILE    MEM RD, the TLM_TYPE_MEM frames into FILE,
+//                           checked against MEM CRC
+//   write ADDR FILE         MEM WR of FILE in MEM_WRITE_MAX word pieces,
+//                           checked against MEM CRC
+//   crc ADDR WORDS          print the target's MEM CRC
+//   stream ADDR WORDS MS FILE PASSES
+//                           MEM STREAM, PASSES passes one after the
+//                           other into FILE
+//
+// Addresses are hexadecimal. Files hold the words high byte first.
+//
+// The commands go to the command port (SCI-B); the frames are read from
+// the data port given with -d, by default the command port itself (the
+// target's SCI DATA setting must match). Frames lost to line errors are
+// asked for again with MEM RD of their range, so a read completes on a
+// noisy line too. The rate of a read is reported against the line rate.
+//
+// Build:  cc -O2 -o mem_tool mem_tool.c tlm.c
+// Usage:  mem_tool [-b baud] [-d /dev/ttyUSB1] /dev/ttyUSB0 read C000 65536
+//             gs.bin
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "tlm.h"
+
+//
+// Defines
+//
+#define MEM_FRAME_WORDS     256     // Words per frame (mem.h)
+#define MEM_WRITE_MAX       256     // Words per MEM WR (mem.h)
+#define REPLY_TIMEOUT       2.0     // Seconds to wait for a reply
+#define FRAME_TIMEOUT       1.0     // Seconds without a frame before the
+                                    // missing ones are asked for again
+#define RETRIES             5
+
+//
+// Typedefs
+//
+typedef struct
+{
+    int cmd;                        // Command port
+    int data;                       // Data port, may be cmd
+    tlm_reader reader;
+    tlm_frame frame;
+} mem_link;
+
+//
+// baud_constant - termios speed of a baud rate, 0 if there is none
+//
+static speed_t baud_constant(long baud)
+{
+    switch(baud)
+    {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+#ifdef B1000000
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        case 3000000: return B3000000;
+#endif
+        default:      return 0;
+    }
+}
+
+//
+// open_port - Open a device raw, non-blocking, 8N1 at the given speed
+//
+static int open_port(const char *name, speed_t speed)
+{
+    struct termios tio;
+    int fd;
+
+    fd = open(name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(fd < 0)
+    {
+        perror(name);
+        return -1;
+    }
+
+    if(tcgetattr(fd, &tio) != 0)
+    {
+        perror(name);
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if(tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        perror(name);
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+//
+// now - Monotonic time in seconds
+//
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//
+// wait_in - Wait up to seconds for input on fd, nonzero if there is some
+//
+static int wait_in(int fd, double seconds)
+{
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    return (poll(&pfd, 1, (int)(seconds * 1000.0)) > 0) &&
+           (pfd.revents & POLLIN);
+}
+
+//
+// send_all - Write all of a buffer to a non-blocking port
+//
+static int send_all(int fd, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    struct pollfd pfd;
+    ssize_t n;
+
+    while(len > 0)
+    {
+        n = write(fd, p, len);
+        if(n > 0)
+        {
+            p += n;
+            len -= n;
+            continue;
+        }
+        if((n < 0) && (errno != EAGAIN) && (errno != EINTR))
+        {
+            perror("write");
+            return -1;
+        }
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        poll(&pfd, 1, 100);
+    }
+    return 0;
+}
+
+//
+// command - Send a command line and read the reply line into reply. The
+//           reply is read a byte at a time, so frames that follow it on
+//           the same port are left for read_frame(). Returns 0 on a
+//           reply, -1 on a timeout.
+//
+static int command(mem_link *l, const char *line, char *reply, size_t size)
+{
+    double end;
+    size_t n = 0;
+    char c;
+
+    if(send_all(l->cmd, line, strlen(line)) != 0)
+    {
+        return -1;
+    }
+    end = now() + REPLY_TIMEOUT;
+    while(now() < end)
+    {
+        if(!wait_in(l->cmd, 0.05))
+        {
+            continue;
+        }
+        while(read(l->cmd, &c, 1) == 1)
+        {
+            if(c == '\n')
+            {
+                reply[n] = '\0';
+                if(n > 0)
+                {
+                    return 0;
+                }
+                continue;
+            }
+            if((c != '\r') && (n + 1 < size))
+            {
+                reply[n++] = c;
+            }
+        }
+    }
+    fprintf(stderr, "no reply to %s", line);
+    return -1;
+}
+
+//
+// read_frame - Wait up to seconds for the next TLM_TYPE_MEM frame on the
+//              data port. Returns 1 with its address and words, 0 on a
+//              timeout, -1 on an error.
+//
+static int read_frame(mem_link *l, double seconds, uint32_t *addr,
+                      const uint8_t **words, size_t *count)
+{
+    uint8_t buf[4096];
+    double end = now() + seconds;
+    size_t room;
+    ssize_t n;
+    const uint8_t *p;
+
+    for(;;)
+    {
+        while(tlm_reader_next(&l->reader, &l->frame))
+        {
+            if((l->frame.type != TLM_TYPE_MEM) ||
+               (l->frame.len < TLM_MEM_HEADER_LEN) ||
+               ((l->frame.len - TLM_MEM_HEADER_LEN) & 1))
+            {
+                continue;
+            }
+            p = l->frame.payload;
+            *addr = p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) |
+                    ((uint32_t)p[3] << 24);
+            *words = p + TLM_MEM_HEADER_LEN;
+            *count = (l->frame.len - TLM_MEM_HEADER_LEN) / 2;
+            return 1;
+        }
+        if(now() >= end)
+        {
+            return 0;
+        }
+        if(!wait_in(l->data, end - now()))
+        {
+            continue;
+        }
+        room = tlm_reader_space(&l->reader);
+        if(room > sizeof(buf))
+        {
+            room = sizeof(buf);
+        }
+        n = read(l->data, buf, room);
+        if((n < 0) && (errno != EAGAIN) && (errno != EINTR))
+        {
+            perror("read");
+            return -1;
+        }
+        if(n > 0)
+        {
+            tlm_reader_push(&l->reader, buf, n);
+        }
+    }
+}
+
+//
+// target_crc - The target's MEM CRC of a range, -1 if it is refused
+//
+static long target_crc(mem_link *l, uint32_t addr, uint32_t words)
+{
+    char line[64];
+    char reply[64];
+    unsigned crc;
+
+    snprintf(line, sizeof(line), "MEM CRC %lX %lu\n", (unsigned long)addr,
+             (unsigned long)words);
+    if((command(l, line, reply, sizeof(reply)) != 0) ||
+       (sscanf(reply, "MEM CRC %x", &crc) != 1))
+    {
+        fprintf(stderr, "MEM CRC: %s\n", reply);
+        return -1;
+    }
+    return crc;
+}
+
+//
+// request - MEM RD of a range, 0 once the target took it
+//
+static int request(mem_link *l, uint32_t addr, uint32_t words)
+{
+    char line[64];
+    char reply[64];
+
+    snprintf(line, sizeof(line), "MEM RD %lX %lu\n", (unsigned long)addr,
+             (unsigned long)words);
+    if((command(l, line, reply, sizeof(reply)) != 0) ||
+       (strcmp(reply, "OK") != 0))
+    {
+        fprintf(stderr, "MEM RD: %s\n", reply);
+        return -1;
+    }
+    return 0;
+}
+
+//
+// read_range - Read words from addr on into data (two bytes a word, high
+//              first), asking again for the frames that do not arrive
+//
+static int read_range(mem_link *l, uint32_t addr, uint32_t words,
+                      uint8_t *data)
+{
+    size_t frames = (words + MEM_FRAME_WORDS - 1) / MEM_FRAME_WORDS;
+    uint8_t *have = calloc(frames, 1);
+    size_t missing = frames;
+    size_t first;
+    size_t last;
+    size_t count;
+    size_t i;
+    uint32_t at;
+    const uint8_t *w;
+    int tries = 0;
+    int r;
+
+    if((have == NULL) || (request(l, addr, words) != 0))
+    {
+        free(have);
+        return -1;
+    }
+
+    while(missing > 0)
+    {
+        r = read_frame(l, FRAME_TIMEOUT, &at, &w, &count);
+        if(r < 0)
+        {
+            break;
+        }
+        if((r > 0) && (at >= addr) && ((at - addr) % MEM_FRAME_WORDS == 0) &&
+           (at - addr + count <= words))
+        {
+            i = (at - addr) / MEM_FRAME_WORDS;
+            memcpy(&data[2 * (size_t)(at - addr)], w, 2 * count);
+            missing -= !have[i];
+            have[i] = 1;
+            tries = 0;
+            continue;
+        }
+        if(r > 0)
+        {
+            continue;
+        }
+
+        //
+        // Quiet: ask again for each run of missing frames
+        //
+        if(++tries > RETRIES)
+        {
+            break;
+        }
+        fprintf(stderr, "%zu frames missing, asking again\n", missing);
+        for(first = 0; first < frames; first = last)
+        {
+            for(; (first < frames) && have[first]; first++)
+            {
+            }
+            for(last = first; (last < frames) && !have[last]; last++)
+            {
+            }
+            if(first < frames)
+            {
+                at = first * MEM_FRAME_WORDS;
+                count = last * MEM_FRAME_WORDS;
+                count = ((count > words) ? words : count) - at;
+                if(request(l, addr + at, count) != 0)
+                {
+                    free(have);
+                    return -1;
+                }
+
+                //
+                // One run at a time; the next ones are asked for once
+                // this one is in
+                //
+                break;
+            }
+        }
+    }
+
+    free(have);
+    if(missing > 0)
+    {
+        fprintf(stderr, "%zu frames missing\n", missing);
+        return -1;
+    }
+    return 0;
+}
+
+//
+// do_read - read ADDR WORDS FILE
+//
+static int do_read(mem_link *l, long baud, uint32_t addr, uint32_t words,
+                   const char *name)
+{
+    uint8_t *data = malloc(2 * (size_t)words);
+    FILE *out;
+    double start;
+    double elapsed;
+    long crc;
+
+    if(data == NULL)
+    {
+        return 1;
+    }
+    start = now();
+    if(read_range(l, addr, words, data) != 0)
+    {
+        free(data);
+        return 1;
+    }
+    elapsed = now() - start;
+
+    crc = target_crc(l, addr, words);
+    if(crc != tlm_crc16(0xFFFF, data, 2 * (size_t)words))
+    {
+        fprintf(stderr, "CRC mismatch: the memory changed during the read\n");
+    }
+
+    out = fopen(name, "wb");
+    if((out == NULL) || (fwrite(data, 2, words, out) != words))
+    {
+        perror(name);
+        free(data);
+        return 1;
+    }
+    fclose(out);
+    free(data);
+
+    printf("%lu words in %.2f s, %.0f bytes/s, %.1f%% of the line, "
+           "%lu crc errors\n", (unsigned long)words, elapsed,
+           2.0 * words / elapsed, 100.0 * 2.0 * words * 10.0 / baud / elapsed,
+           l->reader.crc_errors);
+    return crc < 0;
+}
+
+//
+// do_write - write ADDR FILE
+//
+static int do_write(mem_link *l, uint32_t addr, const char *name)
+{
+    uint8_t piece[2 * MEM_WRITE_MAX + 2];
+    char line[64];
+    char reply[64];
+    FILE *in;
+    size_t n;
+    uint32_t at = addr;
+    uint32_t words = 0;
+    uint16_t crc;
+    uint16_t all = 0xFFFF;
+    int tries;
+
+    in = fopen(name, "rb");
+    if(in == NULL)
+    {
+        perror(name);
+        return 1;
+    }
+
+    while((n = fread(piece, 2, MEM_WRITE_MAX, in)) > 0)
+    {
+        crc = tlm_crc16(0xFFFF, piece, 2 * n);
+        piece[2 * n] = crc >> 8;
+        piece[2 * n + 1] = crc & 0xFF;
+        all = tlm_crc16(all, piece, 2 * n);
+
+        for(tries = 0; tries < RETRIES; tries++)
+        {
+            snprintf(line, sizeof(line), "MEM WR %lX %zu\n",
+                     (unsigned long)at, n);
+            if((command(l, line, reply, sizeof(reply)) != 0) ||
+               (strcmp(reply, "OK") != 0))
+            {
+                fprintf(stderr, "MEM WR: %s\n", reply);
+                fclose(in);
+                return 1;
+            }
+            if(send_all(l->cmd, piece, 2 * n + 2) != 0)
+            {
+                fclose(in);
+                return 1;
+            }
+
+            //
+            // The result comes as a reply to no command
+            //
+            if((command(l, "", reply, sizeof(reply)) == 0) &&
+               (strcmp(reply, "MEM WR OK") == 0))
+            {
+                break;
+            }
+            fprintf(stderr, "%s at %lX, again\n", reply, (unsigned long)at);
+        }
+        if(tries == RETRIES)
+        {
+            fclose(in);
+            return 1;
+        }
+        at += n;
+        words += n;
+    }
+    fclose(in);
+
+    if(target_crc(l, addr, words) != all)
+    {
+        fprintf(stderr, "CRC mismatch after the write\n");
+        return 1;
+    }
+    printf("%lu words written\n", (unsigned long)words);
+    return 0;
+}
+
+//
+// do_stream - stream ADDR WORDS MS FILE PASSES
+//
+static int do_stream(mem_link *l, uint32_t addr, uint32_t words,
+                     unsigned ms, const char *name, unsigned long passes)
+{
+    uint8_t *data = malloc(2 * (size_t)words);
+    char line[64];
+    char reply[64];
+    FILE *out;
+    unsigned long done = 0;
+    uint32_t filled = 0;
+    uint32_t at;
+    const uint8_t *w;
+    size_t count;
+    double start;
+    int r;
+
+    out = fopen(name, "wb");
+    if((data == NULL) || (out == NULL))
+    {
+        perror(name);
+        return 1;
+    }
+    snprintf(line, sizeof(line), "MEM STREAM %lX %lu %u\n",
+             (unsigned long)addr, (unsigned long)words, ms);
+    if((command(l, line, reply, sizeof(reply)) != 0) ||
+       (strcmp(reply, "OK") != 0))
+    {
+        fprintf(stderr, "MEM STREAM: %s\n", reply);
+        return 1;
+    }
+
+    //
+    // A pass is written once its last frame is in; a pass with a frame
+    // lost is dropped
+    //
+    start = now();
+    while(done < passes)
+    {
+        r = read_frame(l, FRAME_TIMEOUT + ms / 1000.0, &at, &w, &count);
+        if(r <= 0)
+        {
+            fprintf(stderr, "stream stopped\n");
+            break;
+        }
+        if((at < addr) || (at - addr + count > words))
+        {
+            continue;
+        }
+        if(at - addr != filled)
+        {
+            filled = 0;
+            if(at != addr)
+            {
+                continue;
+            }
+        }
+        memcpy(&data[2 * (size_t)filled], w, 2 * count);
+        filled += count;
+        if(filled == words)
+        {
+            fwrite(data, 2, words, out);
+            filled = 0;
+            done++;
+        }
+    }
+
+    command(l, "MEM STOP\n", reply, sizeof(reply));
+    fclose(out);
+    free(data);
+    printf("%lu passes in %.2f s, %lu crc errors\n", done, now() - start,
+           l->reader.crc_errors);
+    return done < passes;
+}
+
+int main(int argc, char *argv[])
+{
+    static mem_link link;
+    const char *dataName = NULL;
+    long baud = 115200;
+    speed_t speed;
+    uint32_t addr;
+    int opt;
+    int n;
+
+    while((opt = getopt(argc, argv, "b:d:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'b': baud = atol(optarg); break;
+            case 'd': dataName = optarg; break;
+            default:  return 2;
+        }
+    }
+    n = argc - optind;
+    if((n < 3) ||
+       ((strcmp(argv[optind + 1], "read") == 0) && (n != 5)) ||
+       ((strcmp(argv[optind + 1], "write") == 0) && (n != 4)) ||
+       ((strcmp(argv[optind + 1], "crc") == 0) && (n != 4)) ||
+       ((strcmp(argv[optind + 1], "stream") == 0) && (n != 7)))
+    {
+        fprintf(stderr, "usage: mem_tool [-b baud] [-d data_tty] cmd_tty\n"
+                "         read ADDR WORDS FILE | write ADDR FILE |\n"
+                "         crc ADDR WORDS | stream ADDR WORDS MS FILE "
+                "PASSES\n");
+        return 2;
+    }
+    speed = baud_constant(baud);
+    if(speed == 0)
+    {
+        fprintf(stderr, "unsupported baud rate %ld\n", baud);
+        return 2;
+    }
+
+    link.cmd = open_port(argv[optind], speed);
+    link.data = (dataName != NULL) ? open_port(dataName, speed) : link.cmd;
+    if((link.cmd < 0) || (link.data < 0))
+    {
+        return 1;
+    }
+    tlm_reader_init(&link.reader);
+    addr = (uint32_t)strtoul(argv[optind + 2], NULL, 16);
+
+    if(strcmp(argv[optind + 1], "read") == 0)
+    {
+        return do_read(&link, baud, addr,
+                       (uint32_t)strtoul(argv[optind + 3], NULL, 10),
+                       argv[optind + 4]);
+    }
+    if(strcmp(argv[optind + 1], "write") == 0)
+    {
+        return do_write(&link, addr, argv[optind + 3]);
+    }
+    if(strcmp(argv[optind + 1], "crc") == 0)
+    {
+        long crc = target_crc(&link, addr,
+                              (uint32_t)strtoul(argv[optind + 3], NULL, 10));
+        if(crc < 0)
+        {
+            return 1;
+        }
+        printf("%04lX\n", crc);
+        return 0;
+    }
+    if(strcmp(argv[optind + 1], "stream") == 0)
+    {
+        return do_stream(&link, addr,
+                         (uint32_t)strtoul(argv[optind + 3], NULL, 10),
+                         (unsigned)atoi(argv[optind + 4]), argv[optind + 5],
+                         strtoul(argv[optind + 6], NULL, 10));
+    }
+    fprintf(stderr, "unknown operation %s\n", argv[optind + 1]);
+    return 2;
+}
+
+//
+// End of file
+//
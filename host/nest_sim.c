@@ -0,0 +1,640 @@
+//###########################################################################
+//
+// FILE:   nest_sim.c
+//
+// TITLE:  Host model of the interrupt latencies with and without nesting.
+//
+// Builds the target's nest.c as it is and runs its Nest_Enter() and
+// Nest_Exit() on a model of the C28x interrupt path:
+//
+//   PIE  - a flag per channel, PIEIER per group, and a group sends one
+//          interrupt to the CPU until it is acknowledged (PIEACK)
+//   CPU  - takes the highest of IFR & IER while INTM is clear: clears the
+//          IER bit, sets INTM, saves context (ENTRY_CYCLES) and fetches
+//          the highest enabled channel; IRET puts IER and INTM back
+//   ISRs - ISRPROF_ENTER() and NEST_ENTER() (PRO_CYCLES), the body, then
+//          NEST_EXIT(), ISRPROF_EXIT() and the context restore
+//          (EPI_CYCLES); only a nesting body runs with INTM clear
+//
+// The load is that of the SCI test rigs: every port sends a stream that
+// never runs dry and receives one at the same baud rate, with the RX FIFO
+// interrupt at one character and the TX one at SCI_TX_LEVEL. The ADC
+// stream's DMA halves, the Timer 2 tick and Timer 0 run at their rates.
+// ADCA1 comes at random, to sample every point of the SCI interrupts.
+//
+// The ISR bodies take the cycles of simVectors, which are estimates read
+// off the code, not measurements. -r takes them from the target's ISR
+// report instead (the exec max of each "ISR <name> ..." line, which
+// includes the profiler bias), so the model replays a measured load:
+//
+//   ISR ON, ISR CLEAR, a minute of the load, ISR > report.txt
+//
+// The priorities are those of nestTable in adc_soc_continuous_dma_cpu01.c.
+// Prints, for NEST OFF and NEST ON, the latency of each vector from its
+// PIE flag to its body, and the RX FIFO overflows. On the target the
+// ADCA1 latency of the ISR report also counts the conversion.
+//
+// Build:  cc -O2 -Wno-unknown-pragmas -Ishim -o nest_sim nest_sim.c
+//             ../adc_soc_continuous_dma_cpu01/nest.c
+// Usage:  nest_sim [-b baud] [-p ports] [-s seconds] [-r report.txt]
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "F28x_Project.h"
+#include "../adc_soc_continuous_dma_cpu01/nest.h"
+#include "../adc_soc_continuous_dma_cpu01/sci.h"
+#include "../adc_soc_continuous_dma_cpu01/load.h"
+#include "../adc_soc_continuous_dma_cpu01/timebase.h"
+
+//
+// Defines
+//
+#define SIM_PIE_BASE    0x0D00      // NEST_PIE_BASE of nest.c
+#define SIM_TX_LEVEL    2           // SCI_TX_LEVEL of sci.c
+#define ENTRY_CYCLES    30          // Flag to first instruction, context
+#define PRO_CYCLES      30          // ISRPROF_ENTER(), Nest_Enter() to EINT
+#define EPI_CYCLES      45          // Nest_Exit(), ISRPROF_EXIT(), IRET
+#define SAMPLE_CYCLES   8002        // ePWM2 SOC period
+#define STREAM_HALF     512         // STREAM_BLOCK_SIZE
+#define TIMER0_US       1000        // A periodic soft timer
+#define ADC_MEAN_US     100         // Mean gap between ADCA1 events
+#define SIM_GROUPS      14
+#define SIM_NEVER       (~(Uint64)0)
+
+#define KIND_ADC        0
+#define KIND_RX         1
+#define KIND_TX         2
+#define KIND_PERIODIC   3
+
+#define PHASE_ENTRY     0
+#define PHASE_PRO       1
+#define PHASE_BODY      2
+#define PHASE_EPI       3
+
+//
+// Typedefs
+//
+typedef struct
+{
+    const char *name;               // As in the ISR report
+    Uint16 vector;                  // PIE vector ID
+    Uint16 kind;
+    Uint16 port;                    // KIND_RX, KIND_TX
+    Uint32 base;                    // Body cycles
+    Uint32 perChar;                 // ... and per character moved
+    Uint32 period;                  // KIND_PERIODIC, cycles
+} SIM_VECTOR;
+
+typedef struct
+{
+    Uint64 next;                    // Next event, SIM_NEVER for none
+    Uint64 flagged;                 // PIE flag set at
+    Uint16 level;                   // FIFO words
+    Uint16 intFlag;                 // Peripheral interrupt flag
+    Uint64 count;
+    Uint64 latSum;
+    Uint64 latMax;
+    Uint64 overflows;
+} SIM_STATE;
+
+typedef struct
+{
+    Uint16 v;
+    Uint16 phase;
+    Uint64 left;                    // Cycles left in the phase
+    Uint16 ier;                     // IER before entry, back on IRET
+    Uint32 nestSaved;
+    Uint64 flagged;                 // PIE flag of this entry set at
+} SIM_FRAME;
+
+//
+// Globals
+//
+volatile Uint16 IER;
+volatile Uint16 INTM;
+volatile struct PIE_CTRL_REGS PieCtrlRegs;
+
+//
+// nestTable of adc_soc_continuous_dma_cpu01.c
+//
+static const NEST_VECTOR simNestTable[] =
+{
+    {NEST_PIE(1, 1),  0},           // ADCA1
+    {NEST_PIE(1, 4),  0},           // XINT1, XINT2: CTS of SCI-A and B
+    {NEST_PIE(1, 5),  0},
+    {NEST_PIE(12, 1), 0},           // XINT3, XINT4: CTS of SCI-C and D
+    {NEST_PIE(12, 2), 0},
+    {NEST_PIE(7, 1),  0},           // DMA CH1, CH2: ADC data
+    {NEST_PIE(7, 2),  0},
+    {NEST_PIE(7, 3),  1},           // DMA CH3: McBSP link
+    {NEST_PIE(7, 5),  1},           // DMA CH5: SPI link
+    {NEST_PIE(9, 1),  2},           // SCI-A, SCI-B RX
+    {NEST_PIE(9, 3),  2},
+    {NEST_PIE(8, 5),  2},           // SCI-C, SCI-D RX
+    {NEST_PIE(8, 7),  2},
+    {NEST_PIE(9, 2),  3},           // SCI-A, SCI-B TX
+    {NEST_PIE(9, 4),  3},
+    {NEST_PIE(8, 6),  3},           // SCI-C, SCI-D TX
+    {NEST_PIE(8, 8),  3},
+    {NEST_PIE(1, 7),  0},           // Timer 0: soft timers, see timer.c
+    {NEST_CPU(14),    4},           // Timer 2: load.c wake-up tick
+};
+
+//
+// The profiled interrupts of isrprof.c. Body cycles estimated from the
+// code: a TX refill copies up to 14 characters from the ring, an RX pass
+// moves what the FIFO holds into the ring.
+//
+static SIM_VECTOR simVectors[] =
+{
+    {"ADCA1",   32, KIND_ADC,      0,  40,  0, 0},
+    {"DMA_CH1", 80, KIND_PERIODIC, 0,  60,  0,
+        SAMPLE_CYCLES * STREAM_HALF},
+    {"DMA_CH2", 81, KIND_PERIODIC, 0,  90,  0,
+        SAMPLE_CYCLES * STREAM_HALF},
+    {"SCIA_RX", 96, KIND_RX,       0,  40, 20, 0},
+    {"SCIA_TX", 97, KIND_TX,       0,  50, 15, 0},
+    {"SCIB_RX", 98, KIND_RX,       1,  40, 20, 0},
+    {"SCIB_TX", 99, KIND_TX,       1,  50, 15, 0},
+    {"SCIC_RX", 92, KIND_RX,       2,  40, 20, 0},
+    {"SCIC_TX", 93, KIND_TX,       2,  50, 15, 0},
+    {"SCID_RX", 94, KIND_RX,       3,  40, 20, 0},
+    {"SCID_TX", 95, KIND_TX,       3,  50, 15, 0},
+    {"TIMER2",  14, KIND_PERIODIC, 0,  60,  0, TIMEBASE_HZ / LOAD_TICK_HZ},
+    {"TIMER0",  38, KIND_PERIODIC, 0, 150,  0,
+        TIMER0_US * (TIMEBASE_HZ / 1000000)},
+};
+
+#define SIM_VECTORS     (sizeof(simVectors) / sizeof(simVectors[0]))
+
+static SIM_STATE simState[SIM_VECTORS];
+static SIM_FRAME simStack[SIM_VECTORS + 1];
+static Uint16 simDepth;
+static Uint16 simIfr;
+static Uint16 simPieAck;
+static Uint16 simPorts = SCI_PORTS;
+static Uint64 simNow;
+static Uint64 simChar;              // Cycles per character
+
+//
+// Vector helpers
+//
+static Uint16 Group(Uint16 vector)
+{
+    return (vector < 32) ? vector : (vector - 32) / 8 + 1;
+}
+
+static Uint16 Channel(Uint16 vector)
+{
+    return (vector < 32) ? 0 : (vector - 32) % 8 + 1;
+}
+
+static volatile Uint16 *PieIer(Uint16 group)
+{
+    return &PieCtrlRegs.PIEIER1.all + 2 * (group - 1);
+}
+
+static volatile Uint16 *PieIfr(Uint16 group)
+{
+    return &PieCtrlRegs.PIEIFR1.all + 2 * (group - 1);
+}
+
+//
+// Raise - The peripheral flag of a vector goes up: the PIE latches it, or
+//         for INT14 the CPU does
+//
+static void Raise(Uint16 v)
+{
+    Uint16 g = Group(simVectors[v].vector);
+
+    if(g > 12)
+    {
+        simIfr |= 1U << (g - 1);
+    }
+    else
+    {
+        *PieIfr(g) |= 1U << (Channel(simVectors[v].vector) - 1);
+    }
+    if(simState[v].flagged == SIM_NEVER)
+    {
+        simState[v].flagged = simNow;
+    }
+}
+
+//
+// Acknowledge - PIEACK writes, ours and those of nest.c
+//
+static void Acknowledge(Uint16 groups)
+{
+    simPieAck &= ~(groups | PieCtrlRegs.PIEACK.all);
+    PieCtrlRegs.PIEACK.all = 0;
+}
+
+//
+// FifoCheck - The level condition of an SCI FIFO interrupt; its flag is
+//             raised on the edge, or again after the ISR clears it
+//
+static void FifoCheck(Uint16 v)
+{
+    SIM_STATE *s = &simState[v];
+    Uint16 cond;
+
+    cond = (simVectors[v].kind == KIND_RX) ? (s->level >= 1) :
+                                             (s->level <= SIM_TX_LEVEL);
+    if(cond && (s->intFlag == 0))
+    {
+        s->intFlag = 1;
+        Raise(v);
+    }
+}
+
+//
+// Event - The source of a vector does what is due at simNow
+//
+static void Event(Uint16 v)
+{
+    const SIM_VECTOR *d = &simVectors[v];
+    SIM_STATE *s = &simState[v];
+
+    switch(d->kind)
+    {
+        case KIND_ADC:
+            Raise(v);
+            s->next = simNow + 1 +
+                (Uint64)(rand() % (2 * ADC_MEAN_US)) * (TIMEBASE_HZ / 1000000);
+            break;
+        case KIND_RX:
+            if(s->level == SCI_FIFO_LEN)
+            {
+                s->overflows++;
+            }
+            else
+            {
+                s->level++;
+            }
+            FifoCheck(v);
+            s->next += simChar;
+            break;
+        case KIND_TX:
+            if(s->level > 0)
+            {
+                s->level--;
+            }
+            FifoCheck(v);
+            s->next += simChar;
+            break;
+        default:
+            Raise(v);
+            s->next += d->period;
+            break;
+    }
+}
+
+//
+// Take - The CPU takes the highest interrupt it may
+//
+static void Take(void)
+{
+    SIM_FRAME *f;
+    Uint16 pending;
+    Uint16 bit;
+    Uint16 g;
+    Uint16 ch;
+    Uint16 v;
+    Uint16 vector;
+
+    //
+    // Groups with an enabled flag and no interrupt out send one
+    //
+    for(g = 1; g <= 12; g++)
+    {
+        bit = 1U << (g - 1);
+        if(((simPieAck & bit) == 0) && ((*PieIfr(g) & *PieIer(g)) != 0))
+        {
+            simIfr |= bit;
+            simPieAck |= bit;
+        }
+    }
+
+    pending = simIfr & IER;
+    if((INTM != 0) || (pending == 0))
+    {
+        return;
+    }
+    for(g = 1; (pending & (1U << (g - 1))) == 0; g++)
+    {
+    }
+    bit = 1U << (g - 1);
+    simIfr &= ~bit;
+
+    if(g > 12)
+    {
+        vector = g;
+    }
+    else
+    {
+        pending = *PieIfr(g) & *PieIer(g);
+        if(pending == 0)
+        {
+            return;                 // Flag masked since it was sent
+        }
+        for(ch = 1; (pending & (1U << (ch - 1))) == 0; ch++)
+        {
+        }
+        *PieIfr(g) &= ~(1U << (ch - 1));
+        vector = 32 + (g - 1) * 8 + (ch - 1);
+    }
+    for(v = 0; simVectors[v].vector != vector; v++)
+    {
+    }
+
+    f = &simStack[simDepth++];
+    f->v = v;
+    f->phase = PHASE_ENTRY;
+    f->left = ENTRY_CYCLES;
+    f->ier = IER;
+    f->flagged = simState[v].flagged;
+    simState[v].flagged = SIM_NEVER;    // A new flag is a new entry
+    IER &= ~bit;
+    INTM = 1;
+}
+
+//
+// Step - The running ISR finishes its phase
+//
+static void Step(SIM_FRAME *f)
+{
+    const SIM_VECTOR *d = &simVectors[f->v];
+    SIM_STATE *s = &simState[f->v];
+    Uint64 lat;
+    Uint16 n;
+
+    switch(f->phase)
+    {
+        case PHASE_ENTRY:
+            f->phase = PHASE_PRO;
+            f->left = PRO_CYCLES;
+            break;
+
+        case PHASE_PRO:
+            lat = simNow - f->flagged;
+            s->count++;
+            s->latSum += lat;
+            if(lat > s->latMax)
+            {
+                s->latMax = lat;
+            }
+
+            n = 0;
+            if(d->kind == KIND_RX)
+            {
+                n = s->level;
+                s->level = 0;
+            }
+            else if(d->kind == KIND_TX)
+            {
+                n = SCI_FIFO_LEN - s->level;
+                s->level = SCI_FIFO_LEN;
+            }
+            f->phase = PHASE_BODY;
+            f->left = d->base + (Uint64)d->perChar * n;
+
+            f->nestSaved = 0xFFFFFFFFUL;
+            if(d->kind != KIND_ADC)
+            {
+                PieCtrlRegs.PIECTRL.all = SIM_PIE_BASE + 2 * d->vector + 1;
+                f->nestSaved = Nest_Enter();
+                Acknowledge(0);
+            }
+            break;
+
+        case PHASE_BODY:
+            if(Group(d->vector) <= 12)
+            {
+                Acknowledge(1U << (Group(d->vector) - 1));
+            }
+            if((d->kind == KIND_RX) || (d->kind == KIND_TX))
+            {
+                s->intFlag = 0;     // INTCLR
+                FifoCheck(f->v);
+            }
+            if(d->kind != KIND_ADC)
+            {
+                Nest_Exit(f->nestSaved);
+            }
+            INTM = 1;
+            f->phase = PHASE_EPI;
+            f->left = EPI_CYCLES;
+            break;
+
+        default:
+            IER = f->ier;
+            INTM = 0;
+            simDepth--;
+            break;
+    }
+}
+
+//
+// Run - Simulate for the given cycles with nesting on or off
+//
+static void Run(Uint16 nest, Uint64 cycles)
+{
+    SIM_FRAME *f;
+    Uint64 next;
+    Uint16 v;
+    Uint16 g;
+
+    srand(1);
+    memset(simState, 0, sizeof(simState));
+    memset((void *)&PieCtrlRegs, 0, sizeof(PieCtrlRegs));
+    simDepth = 0;
+    simIfr = 0;
+    simPieAck = 0;
+    simNow = 0;
+    IER = 0;
+    INTM = 0;
+
+    Nest_Init(simNestTable, sizeof(simNestTable) / sizeof(simNestTable[0]));
+    Nest_Enable(nest);
+
+    for(v = 0; v < SIM_VECTORS; v++)
+    {
+        g = Group(simVectors[v].vector);
+        simState[v].flagged = SIM_NEVER;
+        simState[v].next = (Uint64)(rand() % 4096);
+        if(((simVectors[v].kind == KIND_RX) ||
+            (simVectors[v].kind == KIND_TX)) &&
+           (simVectors[v].port >= simPorts))
+        {
+            simState[v].next = SIM_NEVER;
+            continue;
+        }
+        if(simVectors[v].kind == KIND_TX)
+        {
+            simState[v].level = SCI_FIFO_LEN;
+        }
+        IER |= 1U << (g - 1);
+        if(g <= 12)
+        {
+            *PieIer(g) |= 1U << (Channel(simVectors[v].vector) - 1);
+        }
+    }
+
+    while(simNow < cycles)
+    {
+        for(v = 0; v < SIM_VECTORS; v++)
+        {
+            while(simState[v].next == simNow)
+            {
+                Event(v);
+            }
+        }
+        Take();
+
+        next = SIM_NEVER;
+        for(v = 0; v < SIM_VECTORS; v++)
+        {
+            if(simState[v].next < next)
+            {
+                next = simState[v].next;
+            }
+        }
+        f = (simDepth != 0) ? &simStack[simDepth - 1] : 0;
+        if((f != 0) && (simNow + f->left <= next))
+        {
+            next = simNow + f->left;
+        }
+
+        if(f != 0)
+        {
+            f->left -= next - simNow;
+        }
+        simNow = next;
+        if((f != 0) && (f->left == 0))
+        {
+            Step(f);
+        }
+    }
+}
+
+//
+// LoadReport - Take the body cycles from the exec max of the target's ISR
+//              report. Returns the number of vectors found.
+//
+static int LoadReport(const char *name)
+{
+    char line[256];
+    char isr[32];
+    unsigned vector;
+    unsigned long count, execMin, execMean, execMax;
+    int found = 0;
+    Uint16 v;
+    FILE *in;
+
+    in = fopen(name, "r");
+    if(in == NULL)
+    {
+        perror(name);
+        return -1;
+    }
+    while(fgets(line, sizeof(line), in) != NULL)
+    {
+        if(sscanf(line, "ISR %31s %u %lu %lu %lu %lu", isr, &vector, &count,
+                  &execMin, &execMean, &execMax) != 6)
+        {
+            continue;
+        }
+        for(v = 0; v < SIM_VECTORS; v++)
+        {
+            if(strcmp(simVectors[v].name, isr) == 0)
+            {
+                simVectors[v].base = execMax;
+                simVectors[v].perChar = 0;
+                found++;
+            }
+        }
+    }
+    fclose(in);
+    return found;
+}
+
+int main(int argc, char *argv[])
+{
+    static SIM_STATE off[SIM_VECTORS];
+    const char *report = 0;
+    double baud = 921600;
+    double seconds = 1.0;
+    double us = TIMEBASE_HZ / 1e6;
+    Uint64 offOver, onOver;
+    Uint16 v;
+    int opt;
+
+    for(opt = 1; opt + 1 < argc; opt += 2)
+    {
+        switch(argv[opt][1])
+        {
+        case 'b': baud = atof(argv[opt + 1]); break;
+        case 'p': simPorts = atoi(argv[opt + 1]); break;
+        case 's': seconds = atof(argv[opt + 1]); break;
+        case 'r': report = argv[opt + 1]; break;
+        default:  opt = argc; break;
+        }
+    }
+    if((opt != argc) || (simPorts > SCI_PORTS) || (baud <= 0) ||
+       (seconds <= 0))
+    {
+        fprintf(stderr, "usage: nest_sim [-b baud] [-p ports] [-s seconds] "
+                "[-r report.txt]\n");
+        return 2;
+    }
+    if((report != 0) && (LoadReport(report) <= 0))
+    {
+        fprintf(stderr, "no ISR lines in %s\n", report);
+        return 1;
+    }
+    simChar = (Uint64)(10.0 * TIMEBASE_HZ / baud);
+
+    Run(0, (Uint64)(seconds * TIMEBASE_HZ));
+    memcpy(off, simState, sizeof(off));
+    Run(1, (Uint64)(seconds * TIMEBASE_HZ));
+
+    printf("%u ports at %.0f baud, ISR cycles %s\n", simPorts, baud,
+           (report != 0) ? report : "estimated");
+    printf("%-8s %9s %19s %19s\n", "", "", "NEST OFF", "NEST ON");
+    printf("%-8s %9s %9s %9s %9s %9s\n", "vector", "count",
+           "mean", "max", "mean", "max");
+    offOver = 0;
+    onOver = 0;
+    for(v = 0; v < SIM_VECTORS; v++)
+    {
+        offOver += off[v].overflows;
+        onOver += simState[v].overflows;
+        if((off[v].count == 0) || (simState[v].count == 0))
+        {
+            continue;
+        }
+        printf("%-8s %9llu %9.0f %9llu %9.0f %9llu\n", simVectors[v].name,
+               (unsigned long long)simState[v].count,
+               (double)off[v].latSum / off[v].count,
+               (unsigned long long)off[v].latMax,
+               (double)simState[v].latSum / simState[v].count,
+               (unsigned long long)simState[v].latMax);
+    }
+    printf("ADCA1 worst latency: %.2f us NEST OFF, %.2f us NEST ON "
+           "(cycles at %u MHz, flag to body)\n", off[0].latMax / us,
+           simState[0].latMax / us, (unsigned)(TIMEBASE_HZ / 1000000));
+    printf("RX FIFO overflows: %llu NEST OFF, %llu NEST ON\n",
+           (unsigned long long)offOver, (unsigned long long)onOver);
+    return 0;
+}
+
+//
+// End of file
+//
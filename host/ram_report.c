@@ -0,0 +1,549 @@
+//###########################################################################
+//
+// FILE:   ram_report.c
+//
+// TITLE:  Build report of the code the target runs from RAM.
+//
+// Reads the link information a CCS build writes next to the .out
+// (CPU1_FLASH/adc_soc_continuous_dma_cpu01_linkInfo.xml) and prints, for
+// the hotfuncs and .TI.ramfunc sections or those given:
+//
+//   - where the section is loaded and where it runs, and its size
+//   - every global function in it: run address, size, RAM block, object
+//   - the words copied from flash to RAM at boot, over all of them
+//   - the use of every RAM block, code and data
+//
+// A section that is copied runs from a single RAM block, which the linker
+// cannot split: hotfuncs of the FLASH build must fit one LS or D block of
+// RAM_BLOCK_WORDS. The report checks it against that, whichever block it
+// landed in, and exits with 3 if it does not fit or is too close to full
+// (RAM_BLOCK_SPARE), before a few more HOT_FUNC()s break the link.
+//
+// The size of a function runs to the next symbol of its object's part of
+// the section, so a static function is counted in the one before it.
+//
+// Build:  cc -O2 -o ram_report ram_report.c
+// Usage:  ram_report linkInfo.xml [section ...]
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Defines
+//
+#define NAME_LEN        64
+#define MAX_FILES       256
+#define MAX_COMPONENTS  4096
+#define MAX_GROUPS      512
+#define MAX_SYMBOLS     8192
+#define MAX_AREAS       256         // Memory ranges, registers included
+#define MAX_REFS        256         // Object components per section
+#define LINE_LEN        1024
+#define RAM_BLOCK_WORDS 0x800       // RAMLS0..5, RAMD0/1
+#define RAM_BLOCK_SPARE 128         // Room asked of a copied section
+
+//
+// Typedefs
+//
+typedef struct
+{
+    char id[NAME_LEN];
+    char name[NAME_LEN];
+} rr_file;
+
+typedef struct
+{
+    char id[NAME_LEN];
+    char name[NAME_LEN];
+    char file[NAME_LEN];            // id of the input file
+    unsigned long load;
+    unsigned long run;
+    unsigned long size;
+    int hasLoad;
+} rr_component;
+
+typedef struct
+{
+    char name[NAME_LEN];
+    unsigned long load;
+    unsigned long run;
+    unsigned long size;
+    int hasLoad;
+    int refs;
+    char ref[MAX_REFS][NAME_LEN];   // ids of its object components
+} rr_group;
+
+typedef struct
+{
+    char name[NAME_LEN];
+    unsigned long value;
+    char component[NAME_LEN];
+} rr_symbol;
+
+typedef struct
+{
+    char name[NAME_LEN];
+    unsigned long origin;
+    unsigned long length;
+    unsigned long used;
+} rr_area;
+
+typedef struct
+{
+    const rr_symbol *symbol;
+    const rr_component *component;
+} rr_function;
+
+//
+// Globals
+//
+static rr_file files[MAX_FILES];
+static int fileCount;
+static rr_component components[MAX_COMPONENTS];
+static int componentCount;
+static rr_group groups[MAX_GROUPS];
+static int groupCount;
+static rr_symbol symbols[MAX_SYMBOLS];
+static int symbolCount;
+static rr_area areas[MAX_AREAS];
+static int areaCount;
+
+static const char *defaultSections[] = {"hotfuncs", ".TI.ramfunc"};
+
+//
+// tag_text - Copy the text of <tag>...</tag> on line to out. Returns 0 if
+//            the line has no such element.
+//
+static int tag_text(const char *line, const char *tag, char *out)
+{
+    char open[NAME_LEN + 2];
+    const char *start;
+    const char *end;
+    size_t len;
+
+    snprintf(open, sizeof(open), "<%s>", tag);
+    start = strstr(line, open);
+    if(start == NULL)
+    {
+        return 0;
+    }
+    start += strlen(open);
+    end = strchr(start, '<');
+    if(end == NULL)
+    {
+        return 0;
+    }
+    len = (size_t)(end - start);
+    if(len >= NAME_LEN)
+    {
+        len = NAME_LEN - 1;
+    }
+    memcpy(out, start, len);
+    out[len] = '\0';
+    return 1;
+}
+
+//
+// tag_number - The number in <tag>...</tag> on line into *value. Returns 0
+//              if the line has no such element.
+//
+static int tag_number(const char *line, const char *tag,
+                      unsigned long *value)
+{
+    char text[NAME_LEN];
+
+    if(tag_text(line, tag, text) == 0)
+    {
+        return 0;
+    }
+    *value = strtoul(text, NULL, 0);
+    return 1;
+}
+
+//
+// attr_text - Copy the value of attribute attr on line to out. Returns 0
+//             if there is none.
+//
+static int attr_text(const char *line, const char *attr, char *out)
+{
+    char key[NAME_LEN + 3];
+    const char *start;
+    const char *end;
+    size_t len;
+
+    snprintf(key, sizeof(key), "%s=\"", attr);
+    start = strstr(line, key);
+    if(start == NULL)
+    {
+        return 0;
+    }
+    start += strlen(key);
+    end = strchr(start, '"');
+    if(end == NULL)
+    {
+        return 0;
+    }
+    len = (size_t)(end - start);
+    if(len >= NAME_LEN)
+    {
+        len = NAME_LEN - 1;
+    }
+    memcpy(out, start, len);
+    out[len] = '\0';
+    return 1;
+}
+
+//
+// load_info - Read the parts of the link information the report needs.
+//             Returns 0 if the file cannot be read.
+//
+static int load_info(const char *path)
+{
+    FILE *f;
+    char line[LINE_LEN];
+    rr_file *file = NULL;
+    rr_component *component = NULL;
+    rr_group *group = NULL;
+    rr_symbol *symbol = NULL;
+    rr_area *area = NULL;
+    char ref[NAME_LEN];
+
+    f = fopen(path, "r");
+    if(f == NULL)
+    {
+        return 0;
+    }
+
+    while(fgets(line, sizeof(line), f) != NULL)
+    {
+        if(strstr(line, "<input_file ") && (fileCount < MAX_FILES))
+        {
+            file = &files[fileCount++];
+            attr_text(line, "id", file->id);
+        }
+        else if(strstr(line, "</input_file>"))
+        {
+            file = NULL;
+        }
+        else if(strstr(line, "<object_component ") &&
+                (componentCount < MAX_COMPONENTS))
+        {
+            component = &components[componentCount++];
+            attr_text(line, "id", component->id);
+        }
+        else if(strstr(line, "</object_component>"))
+        {
+            component = NULL;
+        }
+        else if(strstr(line, "<logical_group ") &&
+                (groupCount < MAX_GROUPS))
+        {
+            group = &groups[groupCount++];
+        }
+        else if(strstr(line, "</logical_group>"))
+        {
+            group = NULL;           // Nested groups are not expected
+        }
+        else if(strstr(line, "<symbol ") && (symbolCount < MAX_SYMBOLS))
+        {
+            symbol = &symbols[symbolCount++];
+        }
+        else if(strstr(line, "</symbol>"))
+        {
+            symbol = NULL;
+        }
+        else if(strstr(line, "<memory_area ") && (areaCount < MAX_AREAS))
+        {
+            area = &areas[areaCount++];
+        }
+        else if(strstr(line, "</memory_area>"))
+        {
+            area = NULL;
+        }
+        else if(file != NULL)
+        {
+            tag_text(line, "name", file->name);
+        }
+        else if(component != NULL)
+        {
+            tag_text(line, "name", component->name);
+            if(tag_number(line, "load_address", &component->load))
+            {
+                component->hasLoad = 1;
+            }
+            tag_number(line, "run_address", &component->run);
+            tag_number(line, "size", &component->size);
+            if(strstr(line, "<input_file_ref "))
+            {
+                attr_text(line, "idref", component->file);
+            }
+        }
+        else if(group != NULL)
+        {
+            if(strstr(line, "<object_component_ref "))
+            {
+                if((group->refs < MAX_REFS) &&
+                   attr_text(line, "idref", ref))
+                {
+                    strcpy(group->ref[group->refs++], ref);
+                }
+            }
+            else if(group->name[0] == '\0')
+            {
+                tag_text(line, "name", group->name);
+            }
+            if(tag_number(line, "load_address", &group->load))
+            {
+                group->hasLoad = 1;
+            }
+            tag_number(line, "run_address", &group->run);
+            tag_number(line, "size", &group->size);
+        }
+        else if(symbol != NULL)
+        {
+            tag_text(line, "name", symbol->name);
+            tag_number(line, "value", &symbol->value);
+            if(strstr(line, "<object_component_ref "))
+            {
+                attr_text(line, "idref", symbol->component);
+            }
+        }
+        else if(area != NULL)
+        {
+            tag_text(line, "name", area->name);
+            tag_number(line, "origin", &area->origin);
+            tag_number(line, "length", &area->length);
+            tag_number(line, "used_space", &area->used);
+        }
+    }
+
+    fclose(f);
+    return 1;
+}
+
+//
+// find_component - The object component with the given id, or NULL
+//
+static const rr_component *find_component(const char *id)
+{
+    int i;
+
+    for(i = 0; i < componentCount; i++)
+    {
+        if(strcmp(components[i].id, id) == 0)
+        {
+            return &components[i];
+        }
+    }
+    return NULL;
+}
+
+//
+// file_name - Name of the input file with the given id
+//
+static const char *file_name(const char *id)
+{
+    int i;
+
+    for(i = 0; i < fileCount; i++)
+    {
+        if(strcmp(files[i].id, id) == 0)
+        {
+            return files[i].name;
+        }
+    }
+    return "?";
+}
+
+//
+// area_name - RAM or flash block an address is in
+//
+static const char *area_name(unsigned long address)
+{
+    int i;
+
+    for(i = 0; i < areaCount; i++)
+    {
+        if((address >= areas[i].origin) &&
+           (address < areas[i].origin + areas[i].length))
+        {
+            return areas[i].name;
+        }
+    }
+    return "?";
+}
+
+//
+// by_address - qsort() order of the functions
+//
+static int by_address(const void *a, const void *b)
+{
+    unsigned long x = ((const rr_function *)a)->symbol->value;
+    unsigned long y = ((const rr_function *)b)->symbol->value;
+
+    return (x > y) - (x < y);
+}
+
+//
+// report_group - Print a section and its functions. Returns the words
+//                copied from flash at boot for it.
+//
+static unsigned long report_group(const rr_group *g)
+{
+    rr_function *fn;
+    const rr_component *c;
+    unsigned long end;
+    int count = 0;
+    int i;
+    int j;
+
+    printf("%s: run 0x%05lx in %s", g->name, g->run, area_name(g->run));
+    if(g->hasLoad && (g->load != g->run))
+    {
+        printf(", load 0x%05lx in %s", g->load, area_name(g->load));
+    }
+    printf(", 0x%lx words\n", g->size);
+
+    fn = calloc(symbolCount + 1, sizeof(*fn));
+    if(fn == NULL)
+    {
+        return 0;
+    }
+    for(i = 0; i < g->refs; i++)
+    {
+        c = find_component(g->ref[i]);
+        for(j = 0; (c != NULL) && (j < symbolCount); j++)
+        {
+            if(strcmp(symbols[j].component, c->id) == 0)
+            {
+                fn[count].symbol = &symbols[j];
+                fn[count].component = c;
+                count++;
+            }
+        }
+    }
+    qsort(fn, count, sizeof(*fn), by_address);
+
+    printf("  %-7s %6s  %-7s %-28s %s\n", "run", "words", "block",
+           "function", "object");
+    for(i = 0; i < count; i++)
+    {
+        c = fn[i].component;
+        end = c->run + c->size;
+        if((i + 1 < count) && (fn[i + 1].component == c))
+        {
+            end = fn[i + 1].symbol->value;
+        }
+        printf("  0x%05lx %6lu  %-7s %-28s %s\n", fn[i].symbol->value,
+               end - fn[i].symbol->value, area_name(fn[i].symbol->value),
+               fn[i].symbol->name, file_name(c->file));
+    }
+    free(fn);
+    printf("\n");
+
+    return (g->hasLoad && (g->load != g->run)) ? g->size : 0;
+}
+
+//
+// check_block - Check that a copied section fits one RAM block with room
+//               to spare. Returns 0 if it does, or is not copied.
+//
+static int check_block(const rr_group *g)
+{
+    long left;
+
+    if(!g->hasLoad || (g->load == g->run))
+    {
+        return 0;
+    }
+    left = (long)RAM_BLOCK_WORDS - (long)g->size;
+    printf("%s: %lu of the %u words of one RAM block, %ld left", g->name,
+           g->size, RAM_BLOCK_WORDS, left);
+    if(left < 0)
+    {
+        printf(": DOES NOT FIT\n\n");
+        return 1;
+    }
+    if(left < RAM_BLOCK_SPARE)
+    {
+        printf(": under %u, move some HOT_FUNC()s back\n\n",
+               RAM_BLOCK_SPARE);
+        return 1;
+    }
+    printf("\n\n");
+    return 0;
+}
+
+//
+// main
+//
+int main(int argc, char *argv[])
+{
+    const char **names;
+    unsigned long copied = 0;
+    int nameCount;
+    int found;
+    int full = 0;
+    int i;
+    int j;
+
+    if(argc < 2)
+    {
+        fprintf(stderr, "usage: %s linkInfo.xml [section ...]\n", argv[0]);
+        return 2;
+    }
+    if(load_info(argv[1]) == 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    names = (argc > 2) ? (const char **)&argv[2] : defaultSections;
+    nameCount = (argc > 2) ? argc - 2 :
+        (int)(sizeof(defaultSections) / sizeof(defaultSections[0]));
+
+    for(i = 0; i < nameCount; i++)
+    {
+        found = 0;
+        for(j = 0; j < groupCount; j++)
+        {
+            if(strcmp(groups[j].name, names[i]) == 0)
+            {
+                copied += report_group(&groups[j]);
+                full |= check_block(&groups[j]);
+                found = 1;
+            }
+        }
+        if(found == 0)
+        {
+            printf("%s: not in this build\n\n", names[i]);
+        }
+    }
+
+    printf("copied at boot: %lu words (%lu bytes)\n\n", copied, copied * 2);
+
+    printf("  %-7s %-7s %7s %7s %5s\n", "block", "origin", "length", "used",
+           "use");
+    for(i = 0; i < areaCount; i++)
+    {
+        if(strncmp(areas[i].name, "RAM", 3) != 0)
+        {
+            continue;
+        }
+        printf("  %-7s 0x%05lx %7lu %7lu %4lu%%\n", areas[i].name,
+               areas[i].origin, areas[i].length, areas[i].used,
+               (areas[i].length != 0) ?
+                   areas[i].used * 100 / areas[i].length : 0);
+    }
+    return full ? 3 : 0;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,263 @@
+//###########################################################################
+//
+// FILE:   rice_decode.c
+//
+// TITLE:  Decoder of the Rice coded ADC frames sent in MODE RICE.
+//
+// Reads the byte stream recorded from the target's SCI port (a file, or
+// standard input), decodes every Rice frame and writes one line per sample:
+//
+//   frame,channel,index,value
+//
+// A summary with the compression ratio of the stream is printed to
+// standard error. The coding is described in
+// adc_soc_continuous_dma_cpu01/rice.c.
+//
+// Uncoded frames (TLM_TYPE_RAW) are written the same way, so recordings of
+// the SPI and McBSP links (MODE SPI, MODE MCB) and of LINK SCI decode too;
+// the zero padding between SPI frames is skipped as noise.
+//
+// Build:  cc -O2 -o rice_decode rice_decode.c tlm.c
+// Usage:  rice_decode [-q] [capture.bin]    (-q: summary only)
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tlm.h"
+
+//
+// Defines
+//
+#define RICE_PART_LEN   16
+#define RICE_K_BITS     4
+#define RICE_K_MAX      14
+#define RICE_ESCAPE     15
+#define RICE_MAX_UNARY  (1UL << 18)     // Longer runs only in corrupt data
+
+//
+// Typedefs
+//
+typedef struct
+{
+    const uint8_t *data;
+    size_t len;
+    size_t pos;                 // Bit position
+} bit_reader;
+
+//
+// get_bits - Read n (at most 16) bits MSB first. Returns -1 past the end.
+//
+static long get_bits(bit_reader *br, unsigned n)
+{
+    unsigned long v = 0;
+    unsigned i;
+
+    if(br->pos + n > br->len * 8)
+    {
+        return -1;
+    }
+    for(i = 0; i < n; i++)
+    {
+        v = (v << 1) | ((br->data[br->pos >> 3] >> (7 - (br->pos & 7))) & 1);
+        br->pos++;
+    }
+    return (long)v;
+}
+
+//
+// rice_decode - Decode count samples of the given width. Returns 0 on
+//               success and -1 if the code is truncated or invalid.
+//
+static int rice_decode(const uint8_t *in, size_t inLen, unsigned bits,
+                       uint16_t *out, unsigned count)
+{
+    bit_reader br = { in, inLen, 0 };
+    long prev = 1L << (bits - 1);
+    long k, b, x;
+    unsigned long q, u;
+    unsigned p, n, i;
+
+    for(p = 0; p < count; p += n)
+    {
+        n = count - p;
+        if(n > RICE_PART_LEN)
+        {
+            n = RICE_PART_LEN;
+        }
+
+        k = get_bits(&br, RICE_K_BITS);
+        if(k < 0)
+        {
+            return -1;
+        }
+
+        for(i = 0; i < n; i++)
+        {
+            if(k == RICE_ESCAPE)
+            {
+                x = get_bits(&br, bits);
+                if(x < 0)
+                {
+                    return -1;
+                }
+            }
+            else if(k <= RICE_K_MAX)
+            {
+                q = 0;
+                while((b = get_bits(&br, 1)) == 1)
+                {
+                    if(++q > RICE_MAX_UNARY)
+                    {
+                        return -1;
+                    }
+                }
+                if(b < 0)
+                {
+                    return -1;
+                }
+                b = get_bits(&br, (unsigned)k);
+                if(b < 0)
+                {
+                    return -1;
+                }
+                u = (q << k) | (unsigned long)b;
+                x = prev + ((u & 1) ? -(long)((u + 1) >> 1) : (long)(u >> 1));
+                if((x < 0) || (x >= (1L << bits)))
+                {
+                    return -1;
+                }
+            }
+            else
+            {
+                return -1;
+            }
+            out[p + i] = (uint16_t)x;
+            prev = x;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    static tlm_reader reader;
+    static tlm_frame frame;
+    static uint16_t samples[65536];
+    uint8_t chunk[4096];
+    FILE *in = stdin;
+    int quiet = 0;
+    int i;
+    size_t got, take;
+    unsigned long riceFrames = 0, rawFrames = 0, badFrames = 0;
+    unsigned long long totalSamples = 0, rawBits = 0, codedBytes = 0;
+    unsigned long long wireBytes = 0;
+    unsigned ch, bits, count, idx;
+
+    for(i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "-q") == 0)
+        {
+            quiet = 1;
+        }
+        else if((in = fopen(argv[i], "rb")) == NULL)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+    }
+
+    tlm_reader_init(&reader);
+    do
+    {
+        take = tlm_reader_space(&reader);
+        if(take > sizeof(chunk))
+        {
+            take = sizeof(chunk);
+        }
+        got = fread(chunk, 1, take, in);
+        wireBytes += got;
+        tlm_reader_push(&reader, chunk, got);
+
+        while(tlm_reader_next(&reader, &frame))
+        {
+            if((frame.type == TLM_TYPE_RAW) &&
+               (frame.len >= TLM_RAW_HEADER_LEN))
+            {
+                ch = frame.payload[0];
+                count = frame.payload[2] | ((unsigned)frame.payload[3] << 8);
+                if(TLM_RAW_HEADER_LEN + 2 * count > frame.len)
+                {
+                    badFrames++;
+                    continue;
+                }
+                if(!quiet)
+                {
+                    for(idx = 0; idx < count; idx++)
+                    {
+                        printf("%lu,%u,%u,%u\n", riceFrames + rawFrames, ch,
+                               idx,
+                               (frame.payload[4 + 2 * idx] << 8) |
+                               frame.payload[5 + 2 * idx]);
+                    }
+                }
+                rawFrames++;
+                continue;
+            }
+
+            if((frame.type != TLM_TYPE_RICE) ||
+               (frame.len < TLM_RICE_HEADER_LEN))
+            {
+                continue;
+            }
+
+            ch = frame.payload[0];
+            bits = frame.payload[1];
+            count = frame.payload[2] | ((unsigned)frame.payload[3] << 8);
+            if((bits < 1) || (bits > 16) ||
+               (rice_decode(&frame.payload[TLM_RICE_HEADER_LEN],
+                            frame.len - TLM_RICE_HEADER_LEN, bits,
+                            samples, count) != 0))
+            {
+                badFrames++;
+                continue;
+            }
+
+            if(!quiet)
+            {
+                for(idx = 0; idx < count; idx++)
+                {
+                    printf("%lu,%u,%u,%u\n", riceFrames + rawFrames, ch,
+                           idx, samples[idx]);
+                }
+            }
+
+            riceFrames++;
+            totalSamples += count;
+            rawBits += (unsigned long long)count * bits;
+            codedBytes += frame.len - TLM_RICE_HEADER_LEN;
+        }
+    } while(got > 0);
+
+    fprintf(stderr, "frames %lu (raw %lu), undecodable %lu, crc errors %lu, "
+            "sequence gaps %lu, bytes skipped %lu\n",
+            riceFrames + rawFrames, rawFrames, badFrames, reader.crc_errors,
+            reader.seq_gaps, reader.skipped);
+    if(codedBytes > 0)
+    {
+        fprintf(stderr, "samples %llu, raw %llu bytes, coded %llu bytes, "
+                "ratio %.3f (%.3f including framing)\n",
+                totalSamples, rawBits / 8, codedBytes,
+                (double)rawBits / 8.0 / (double)codedBytes,
+                (double)rawBits / 8.0 / (double)wireBytes);
+    }
+    return 0;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,378 @@
+//###########################################################################
+//
+// FILE:   sched_sim.c
+//
+// TITLE:  Host simulation of the telemetry scheduler and command replies.
+//
+// Builds the target's sched.c and tlm.c as they are and runs them on a
+// model of the SCI ports: each data port sends its SCI_TX_LEN byte ring at
+// the baud rate, one pass of the background loop takes LOOP_US, and the
+// loop serves the command port before the scheduler, as main() does. The
+// streams are those of the target's schedTable:
+//
+//   STATUS  a status frame every second
+//   LOG     a log frame every LOG_PERIOD_MS
+//   CAP     Rice frames of -c samples, CAP_CODED_BITS per sample coded
+//   DEC     Rice frames of the decimated stream
+//   MEM     memory read frames of -m words
+//
+// CAP, DEC and MEM always have a frame ready, so they share what the link
+// leaves them. A command arrives on the command port (SCI-B, which also
+// carries data) every CMD_PERIOD_MS and is answered as soon as no frame is
+// being queued to it.
+//
+// Prints what each stream sent, its share of the bytes and its worst wait,
+// and the reply latency: from the command to the reply queued, and to its
+// last byte on the wire.
+//
+// Build:  cc -O2 -Wno-unknown-pragmas -Ishim -o sched_sim sched_sim.c
+//             ../adc_soc_continuous_dma_cpu01/sched.c
+//             ../adc_soc_continuous_dma_cpu01/tlm.c
+// Usage:  sched_sim [-c capSamples] [-m memWords] [-p ports] [-b baud]
+//                   [-s seconds]
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "F28x_Project.h"
+#include "../adc_soc_continuous_dma_cpu01/tlm.h"
+#include "../adc_soc_continuous_dma_cpu01/sci.h"
+#include "../adc_soc_continuous_dma_cpu01/arq.h"
+#include "../adc_soc_continuous_dma_cpu01/sched.h"
+#include "../adc_soc_continuous_dma_cpu01/mem.h"
+#include "../adc_soc_continuous_dma_cpu01/log.h"
+#include "../adc_soc_continuous_dma_cpu01/timebase.h"
+
+//
+// Defines
+//
+#define CYCLES_PER_MS   (TIMEBASE_HZ / 1000)
+#define LOOP_US         10      // One background loop pass
+#define LOOP_CYCLES     (LOOP_US * (TIMEBASE_HZ / 1000000))
+#define CAP_SAMPLES     256     // CAP_BLOCK_SIZE of the target
+#define CAP_CODED_BITS  9       // Rice code of a 12-bit capture
+#define DEC_SAMPLES     128     // STREAM_OUT_LEN of the target
+#define DEC_CODED_BITS  12      // Rice code of the 16-bit decimated stream
+#define LOG_PERIOD_MS   50
+#define LOG_BYTES       120
+#define STATUS_PERIOD_MS 1000
+#define CMD_PERIOD_MS   37      // Not a multiple of any frame time
+#define CMD_PORT        SCI_PORT_B
+#define REPLY_LEN       3       // "OK\n"
+#define SECONDS         60
+
+//
+// Typedefs
+//
+typedef struct
+{
+    Uint16 ring;                    // Bytes in the TX ring
+    Uint32 ref;                     // Bytes of a Sci_PutRef() block left
+    double credit;                  // Bytes the line may send
+} SIM_PORT;
+
+//
+// Function Prototypes
+//
+static Uint16 StatusReady(void);
+static void StatusSend(void);
+static Uint16 LogReady(void);
+static void LogSend(void);
+static Uint16 AlwaysReady(void);
+static void CapSend(void);
+static void DecSend(void);
+static void MemSend(void);
+
+//
+// Globals
+//
+volatile struct CPUTIMER_REGS CpuTimer1Regs;
+
+static SIM_PORT simPort[SCI_PORTS];
+static Uint16 simPorts = 1;
+static Uint32 simNow;
+static Uint32 statusNext;
+static Uint32 logNext;
+static unsigned capSamples = CAP_SAMPLES;
+static unsigned memWords = MEM_FRAME_WORDS;
+static Uint16 simData[32768];
+
+static const SCHED_STREAM simTable[] =
+{
+    {"STATUS", 0, 1, StatusReady, StatusSend},
+    {"LOG",    1, 1, LogReady,    LogSend},
+    {"CAP",    2, 4, AlwaysReady, CapSend},
+    {"DEC",    2, 4, AlwaysReady, DecSend},
+    {"MEM",    2, 2, AlwaysReady, MemSend},
+};
+
+//
+// The SCI driver and the ARQ transport, as tlm.c sees them. Sci_Put()
+// takes all or nothing, like the target's.
+//
+Uint16 Sci_IsOpen(Uint16 port)
+{
+    return (port < SCI_PORTS) && ((Tlm_Ports() & (1U << port)) != 0);
+}
+
+Uint16 Sci_TxSpace(Uint16 port)
+{
+    return SCI_TX_LEN - simPort[port].ring;
+}
+
+int Sci_Put(Uint16 port, const char *data, int len)
+{
+    (void)data;
+    if(len > SCI_TX_LEN - simPort[port].ring)
+    {
+        return 0;
+    }
+    simPort[port].ring += len;
+    return len;
+}
+
+int Sci_PutRef(Uint16 port, const Uint16 *data, Uint16 words, Uint16 crc)
+{
+    (void)data;
+    (void)crc;
+    if(simPort[port].ref != 0)
+    {
+        return 0;
+    }
+    simPort[port].ref = 2UL * words;
+    return 1;
+}
+
+Uint16 Sci_RefBusy(Uint16 port)
+{
+    return simPort[port].ref != 0;
+}
+
+Uint16 Sci_RefCrc(Uint16 port)
+{
+    (void)port;
+    return 0;
+}
+
+Uint16 Arq_Port(void)
+{
+    return ARQ_NO_PORT;
+}
+
+Uint16 Arq_Space(void)
+{
+    return 0;
+}
+
+int Arq_Put(const char *data, int len)
+{
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+void Arq_Poll(void)
+{
+}
+
+//
+// SimFrame - Frame bytes of payload of the given type, the way the MEM
+//            stream does, so that frames longer than tlmFrame can be
+//            simulated too
+//
+static void SimFrame(Uint16 type, unsigned bytes)
+{
+    Tlm_Begin(type);
+    Tlm_CommitRef(0, simData, (Uint16)((bytes + 1) / 2));
+}
+
+//
+// The streams
+//
+static Uint16 StatusReady(void)
+{
+    return (int32)(simNow - statusNext) >= 0;
+}
+
+static void StatusSend(void)
+{
+    SimFrame(TLM_TYPE_SCI_STATUS, 1 + simPorts * TLM_SCI_STATUS_PORT_LEN);
+    statusNext += STATUS_PERIOD_MS * CYCLES_PER_MS;
+}
+
+static Uint16 LogReady(void)
+{
+    return (int32)(simNow - logNext) >= 0;
+}
+
+static void LogSend(void)
+{
+    SimFrame(TLM_TYPE_LOG, LOG_BYTES);
+    logNext += LOG_PERIOD_MS * CYCLES_PER_MS;
+}
+
+static Uint16 AlwaysReady(void)
+{
+    return 1;
+}
+
+static void CapSend(void)
+{
+    SimFrame(TLM_TYPE_RICE,
+             TLM_RICE_HEADER_LEN + (capSamples * CAP_CODED_BITS + 7) / 8);
+}
+
+static void DecSend(void)
+{
+    SimFrame(TLM_TYPE_RICE,
+             TLM_RICE_HEADER_LEN + (DEC_SAMPLES * DEC_CODED_BITS + 7) / 8);
+}
+
+static void MemSend(void)
+{
+    SimFrame(TLM_TYPE_MEM, TLM_MEM_HEADER_LEN + 2 * memWords);
+}
+
+//
+// Drain - Send what the lines of the ports manage in one loop pass: the
+//         ring first, then the block after it
+//
+static void Drain(double bytesPerPass)
+{
+    SIM_PORT *p;
+    Uint16 port;
+    Uint32 n;
+
+    for(port = 0; port < SCI_PORTS; port++)
+    {
+        p = &simPort[port];
+        if((p->ring == 0) && (p->ref == 0))
+        {
+            p->credit = 0;          // An idle line saves nothing up
+            continue;
+        }
+        p->credit += bytesPerPass;
+        n = (Uint32)p->credit;
+        p->credit -= n;
+        if(n <= p->ring)
+        {
+            p->ring -= n;
+            continue;
+        }
+        n -= p->ring;
+        p->ring = 0;
+        p->ref = (n < p->ref) ? p->ref - n : 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    SCHED_STATS stats;
+    double baud = SCI_BAUD_DEFAULT;
+    double seconds = SECONDS;
+    double bytesPerMs;
+    double wait, wire;
+    double waitSum = 0, waitMax = 0, wireMax = 0;
+    Uint32 total = 0;
+    Uint32 passes, pass;
+    Uint32 cmdNext, cmdTime = 0;
+    Uint16 cmdPending = 0;
+    unsigned long replies = 0;
+    unsigned i;
+    int opt;
+
+    for(opt = 1; opt + 1 < argc; opt += 2)
+    {
+        switch(argv[opt][1])
+        {
+        case 'c': capSamples = atoi(argv[opt + 1]); break;
+        case 'm': memWords = atoi(argv[opt + 1]); break;
+        case 'p': simPorts = atoi(argv[opt + 1]); break;
+        case 'b': baud = atof(argv[opt + 1]); break;
+        case 's': seconds = atof(argv[opt + 1]); break;
+        default:  opt = argc; break;
+        }
+    }
+    if((opt != argc) || (simPorts < 1) || (simPorts > SCI_PORTS) ||
+       (capSamples < 1) || (capSamples > 16384) || (memWords < 1) ||
+       (memWords > 16384) || (baud <= 0) || (seconds <= 0))
+    {
+        fprintf(stderr, "usage: sched_sim [-c capSamples] [-m memWords] "
+                "[-p ports] [-b baud] [-s seconds]\n");
+        return 2;
+    }
+
+    //
+    // The data ports are SCI-B and, with more, the ports from SCI-A on
+    //
+    Tlm_Init((simPorts == 1) ? (1U << CMD_PORT) : ((1U << simPorts) - 1));
+    Sched_Init(simTable, sizeof(simTable) / sizeof(simTable[0]));
+
+    bytesPerMs = baud / 10.0 / 1000.0;
+    passes = (Uint32)(seconds * 1000000.0 / LOOP_US);
+    simNow = 0;
+    statusNext = 0;
+    logNext = 0;
+    cmdNext = CMD_PERIOD_MS * CYCLES_PER_MS;
+
+    for(pass = 0; pass < passes; pass++)
+    {
+        CpuTimer1Regs.TIM.all = ~simNow;
+
+        if((cmdPending == 0) && ((int32)(simNow - cmdNext) >= 0))
+        {
+            cmdPending = 1;
+            cmdTime = simNow;
+            cmdNext += CMD_PERIOD_MS * CYCLES_PER_MS;
+        }
+        if((cmdPending != 0) && (Tlm_BusyOn(CMD_PORT) == 0) &&
+           (Sci_TxSpace(CMD_PORT) >= REPLY_LEN))
+        {
+            wait = (double)(simNow - cmdTime) / CYCLES_PER_MS;
+            wire = wait + (simPort[CMD_PORT].ring + simPort[CMD_PORT].ref +
+                           REPLY_LEN) / bytesPerMs;
+            Sci_Put(CMD_PORT, "OK\n", REPLY_LEN);
+            cmdPending = 0;
+            replies++;
+            waitSum += wait;
+            waitMax = (wait > waitMax) ? wait : waitMax;
+            wireMax = (wire > wireMax) ? wire : wireMax;
+        }
+
+        Sched_Poll();
+
+        Drain(bytesPerMs * LOOP_US / 1000.0);
+        simNow += LOOP_CYCLES;
+    }
+
+    printf("%u port(s) at %.0f baud, %.0f s, CAP frames of %u samples, "
+           "MEM frames of %u words\n", simPorts, baud, seconds, capSamples,
+           memWords);
+    for(i = 0; i < Sched_Count(); i++)
+    {
+        Sched_Stats(i, &stats);
+        total += stats.bytes;
+    }
+    printf("stream    frames     bytes  share  max wait\n");
+    for(i = 0; i < Sched_Count(); i++)
+    {
+        Sched_Stats(i, &stats);
+        printf("%-6s  %8lu  %8lu  %4.1f%%  %6.1f ms\n", Sched_Name(i),
+               (unsigned long)stats.frames, (unsigned long)stats.bytes,
+               (total != 0) ? 100.0 * stats.bytes / total : 0.0,
+               (double)stats.maxWait / CYCLES_PER_MS);
+    }
+    printf("replies %lu, queued after %.1f ms mean, %.1f ms worst, "
+           "last byte out after %.1f ms worst\n", replies,
+           (replies != 0) ? waitSum / replies : 0.0, waitMax, wireMax);
+    return 0;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,283 @@
+//###########################################################################
+//
+// FILE:   sci_loop.c
+//
+// TITLE:  Host loopback rig for the target's SCI ports.
+//
+// Streams a pseudo-random byte sequence into every given serial device at
+// once, reads back what the target echoes (SCI LOOP <ports> on the
+// command port), checks it and reports the throughput per port and in
+// total. Running it with one, two, three and four ports shows how the
+// aggregate bandwidth scales with the port count.
+//
+// Build:  cc -O2 -o sci_loop sci_loop.c
+// Usage:  sci_loop [-b baud] [-t seconds] /dev/ttyUSB1 [/dev/ttyUSB2 ...]
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+//
+// Defines
+//
+#define MAX_PORTS       4
+#define WINDOW          192     // Bytes in flight per port. The target
+                                // moves them from its 64 byte receive
+                                // ring (SCI_RX_LEN) to its 256 byte
+                                // transmit ring at once, and the window
+                                // fits the transmit ring, so the receive
+                                // ring only holds what arrives during one
+                                // background loop pass: 64 bytes, plus 16
+                                // in the FIFO, is 7 ms at 115200 baud
+
+//
+// Typedefs
+//
+typedef struct
+{
+    const char *name;
+    int fd;
+    uint32_t tx_state;          // Sequence generators of both directions
+    uint32_t rx_state;
+    unsigned long long sent;
+    unsigned long long received;
+    unsigned long errors;
+} loop_port;
+
+//
+// next_byte - Byte sequence of a port (32-bit xorshift)
+//
+static uint8_t next_byte(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (uint8_t)x;
+}
+
+//
+// baud_constant - termios speed of a baud rate, 0 if there is none
+//
+static speed_t baud_constant(long baud)
+{
+    switch(baud)
+    {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+#ifdef B1000000
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        case 3000000: return B3000000;
+#endif
+        default:      return 0;
+    }
+}
+
+//
+// open_port - Open a device raw, non-blocking, 8N1 at the given speed
+//
+static int open_port(const char *name, speed_t speed)
+{
+    struct termios tio;
+    int fd;
+
+    fd = open(name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(fd < 0)
+    {
+        perror(name);
+        return -1;
+    }
+
+    if(tcgetattr(fd, &tio) != 0)
+    {
+        perror(name);
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if(tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        perror(name);
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+//
+// now - Monotonic time in seconds
+//
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+    loop_port port[MAX_PORTS];
+    struct pollfd pfd[MAX_PORTS];
+    uint8_t buf[256];
+    long baud = 115200;
+    double seconds = 10.0;
+    double start, elapsed = 0.0;
+    unsigned long long total = 0;
+    unsigned long errors = 0;
+    int nports = 0;
+    int opt, i, j;
+    ssize_t n;
+    size_t room;
+    speed_t speed;
+    uint32_t state;
+
+    while((opt = getopt(argc, argv, "b:t:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'b': baud = atol(optarg); break;
+            case 't': seconds = atof(optarg); break;
+            default:  return 2;
+        }
+    }
+    if((optind >= argc) || (argc - optind > MAX_PORTS))
+    {
+        fprintf(stderr, "usage: sci_loop [-b baud] [-t seconds] tty...\n");
+        return 2;
+    }
+    speed = baud_constant(baud);
+    if(speed == 0)
+    {
+        fprintf(stderr, "unsupported baud rate %ld\n", baud);
+        return 2;
+    }
+
+    for(i = optind; i < argc; i++, nports++)
+    {
+        memset(&port[nports], 0, sizeof(port[nports]));
+        port[nports].name = argv[i];
+        port[nports].fd = open_port(argv[i], speed);
+        port[nports].tx_state = 0x9E3779B9u + nports;
+        port[nports].rx_state = port[nports].tx_state;
+        if(port[nports].fd < 0)
+        {
+            return 1;
+        }
+        pfd[nports].fd = port[nports].fd;
+    }
+
+    start = now();
+    do
+    {
+        for(i = 0; i < nports; i++)
+        {
+            pfd[i].events = POLLIN;
+            if(port[i].sent - port[i].received < WINDOW)
+            {
+                pfd[i].events |= POLLOUT;
+            }
+        }
+        if(poll(pfd, nports, 100) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            perror("poll");
+            return 1;
+        }
+
+        for(i = 0; i < nports; i++)
+        {
+            if(pfd[i].revents & POLLOUT)
+            {
+                room = WINDOW - (size_t)(port[i].sent - port[i].received);
+                if(room > sizeof(buf))
+                {
+                    room = sizeof(buf);
+                }
+                state = port[i].tx_state;
+                for(j = 0; j < (int)room; j++)
+                {
+                    buf[j] = next_byte(&state);
+                }
+
+                //
+                // Advance the sequence only by what the driver took
+                //
+                n = write(port[i].fd, buf, room);
+                for(j = 0; j < n; j++)
+                {
+                    next_byte(&port[i].tx_state);
+                }
+                if(n > 0)
+                {
+                    port[i].sent += n;
+                }
+            }
+            if(pfd[i].revents & POLLIN)
+            {
+                n = read(port[i].fd, buf, sizeof(buf));
+                for(j = 0; j < n; j++)
+                {
+                    if(buf[j] != next_byte(&port[i].rx_state))
+                    {
+                        port[i].errors++;
+                    }
+                }
+                if(n > 0)
+                {
+                    port[i].received += n;
+                }
+            }
+        }
+        elapsed = now() - start;
+    } while(elapsed < seconds);
+
+    printf("%-20s %12s %12s %10s %8s\n", "port", "bytes", "bytes/s",
+           "errors", "% line");
+    for(i = 0; i < nports; i++)
+    {
+        printf("%-20s %12llu %12.0f %10lu %8.1f\n", port[i].name,
+               port[i].received, port[i].received / elapsed, port[i].errors,
+               100.0 * port[i].received * 10.0 / baud / elapsed);
+        total += port[i].received;
+        errors += port[i].errors;
+        close(port[i].fd);
+    }
+    printf("%-20s %12llu %12.0f %10lu %8.1f\n", "total", total,
+           total / elapsed, errors,
+           100.0 * total * 10.0 / baud / elapsed / nports);
+    return errors != 0;
+}
+
+//
+// End of file
+//
@@ -0,0 +1,304 @@
+//###########################################################################
+//
+// FILE:   F28x_Project.h
+//
+// TITLE:  Host stand-in for the device support headers.
+//
+// Lets the host tools build target modules as they are, so they check the
+// code that runs on the target and not a copy of it. Only what those
+// modules use is here: the C28x types, the intrinsics and keywords of the
+// TI compiler, and the registers they touch. The tool that builds a module
+// defines the register globals and models the hardware behind them.
+//
+// The host char is 8 bits where the C28x one is 16: the modules hand bytes
+// around one per Uint16 word, so a tool must read such a buffer back as
+// Uint16, whatever the cast at the call.
+//
+//###########################################################################
+
+#ifndef F28X_PROJECT_H
+#define F28X_PROJECT_H
+
+#include <stdint.h>
+
+//
+// Types
+//
+typedef int16_t     int16;
+typedef int32_t     int32;
+typedef int64_t     int64;
+typedef uint16_t    Uint16;
+typedef uint32_t    Uint32;
+typedef uint64_t    Uint64;
+typedef float       float32;
+typedef double      float64;
+
+//
+// Compiler keywords and intrinsics
+//
+#define __interrupt
+#define EALLOW
+#define EDIS
+#define EINT            (INTM = 0)
+#define DINT            (INTM = 1)
+#define asm(s)
+
+typedef void (*PINT)(void);
+
+extern volatile Uint16 IER;
+extern volatile Uint16 INTM;        // ST1 bit, set while held off
+
+//
+// Interrupts
+//
+#define M_INT7          0x0040
+#define PIEACK_GROUP7   0x0040
+
+struct PIEIER_BITS
+{
+    Uint16 INTx1:1;
+    Uint16 INTx2:1;
+    Uint16 INTx3:1;
+    Uint16 INTx4:1;
+    Uint16 INTx5:1;
+    Uint16 INTx6:1;
+    Uint16 INTx7:1;
+    Uint16 INTx8:1;
+    Uint16 rsvd:8;
+};
+
+union PIEIER_REG
+{
+    Uint16 all;
+    struct PIEIER_BITS bit;
+};
+
+union PIEACK_REG
+{
+    Uint16 all;
+};
+
+union PIECTRL_REG
+{
+    Uint16 all;                     // PIEVECT, the vector being fetched
+};
+
+struct PIE_CTRL_REGS
+{
+    union PIECTRL_REG PIECTRL;
+    union PIEACK_REG PIEACK;
+    union PIEIER_REG PIEIER1;
+    union PIEIER_REG PIEIFR1;
+    union PIEIER_REG PIEIER2;
+    union PIEIER_REG PIEIFR2;
+    union PIEIER_REG PIEIER3;
+    union PIEIER_REG PIEIFR3;
+    union PIEIER_REG PIEIER4;
+    union PIEIER_REG PIEIFR4;
+    union PIEIER_REG PIEIER5;
+    union PIEIER_REG PIEIFR5;
+    union PIEIER_REG PIEIER6;
+    union PIEIER_REG PIEIFR6;
+    union PIEIER_REG PIEIER7;
+    union PIEIER_REG PIEIFR7;
+    union PIEIER_REG PIEIER8;
+    union PIEIER_REG PIEIFR8;
+    union PIEIER_REG PIEIER9;
+    union PIEIER_REG PIEIFR9;
+    union PIEIER_REG PIEIER10;
+    union PIEIER_REG PIEIFR10;
+    union PIEIER_REG PIEIER11;
+    union PIEIER_REG PIEIFR11;
+    union PIEIER_REG PIEIER12;
+    union PIEIER_REG PIEIFR12;
+};
+
+extern volatile struct PIE_CTRL_REGS PieCtrlRegs;
+
+//
+// CPU timers
+//
+union TIM_REG
+{
+    Uint32 all;
+};
+
+struct CPUTIMER_REGS
+{
+    union TIM_REG TIM;
+};
+
+extern volatile struct CPUTIMER_REGS CpuTimer1Regs;
+
+//
+// System control
+//
+struct SECMSEL_BITS
+{
+    Uint16 PF1SEL:2;
+    Uint16 PF2SEL:2;
+    Uint16 rsvd:12;
+};
+
+union SECMSEL_REG
+{
+    Uint16 all;
+    struct SECMSEL_BITS bit;
+};
+
+struct CPU_SYS_REGS
+{
+    union SECMSEL_REG SECMSEL;
+};
+
+extern volatile struct CPU_SYS_REGS CpuSysRegs;
+
+//
+// GPIO (F2837xS_Gpio.c)
+//
+#define GPIO_MUX_CPU1   0
+#define GPIO_INPUT      0
+#define GPIO_OUTPUT     1
+#define GPIO_PUSHPULL   0
+#define GPIO_ASYNC      0x30
+
+void GPIO_SetupPinMux(Uint16 pin, Uint16 cpu, Uint16 peripheral);
+void GPIO_SetupPinOptions(Uint16 pin, Uint16 output, Uint16 flags);
+void GPIO_WritePin(Uint16 pin, Uint16 outVal);
+
+//
+// SPI
+//
+struct SPICCR_BITS
+{
+    Uint16 SPICHAR:4;
+    Uint16 SPILBK:1;
+    Uint16 HS_MODE:1;
+    Uint16 CLKPOLARITY:1;
+    Uint16 SPISWRESET:1;
+    Uint16 rsvd:8;
+};
+
+union SPICCR_REG
+{
+    Uint16 all;
+    struct SPICCR_BITS bit;
+};
+
+struct SPIPRI_BITS
+{
+    Uint16 TRIWIRE:1;
+    Uint16 STEINV:1;
+    Uint16 rsvd1:2;
+    Uint16 FREE:1;
+    Uint16 SOFT:1;
+    Uint16 rsvd2:10;
+};
+
+union SPIPRI_REG
+{
+    Uint16 all;
+    struct SPIPRI_BITS bit;
+};
+
+struct SPIFFTX_BITS
+{
+    Uint16 TXFFIL:5;
+    Uint16 TXFFIENA:1;
+    Uint16 TXFFINTCLR:1;
+    Uint16 TXFFINT:1;
+    Uint16 TXFFST:5;
+    Uint16 TXFIFO:1;
+    Uint16 SPIFFENA:1;
+    Uint16 SPIRST:1;
+};
+
+union SPIFFTX_REG
+{
+    Uint16 all;
+    struct SPIFFTX_BITS bit;
+};
+
+union SPI_REG
+{
+    Uint16 all;
+};
+
+struct SPI_REGS
+{
+    union SPICCR_REG SPICCR;
+    union SPI_REG SPICTL;
+    union SPIPRI_REG SPIPRI;
+    union SPIFFTX_REG SPIFFTX;
+    union SPI_REG SPIFFRX;
+    union SPI_REG SPIFFCT;
+    Uint16 SPITXBUF;
+};
+
+extern volatile struct SPI_REGS SpiaRegs;
+
+//
+// DMA (F2837xS_Dma.c)
+//
+#define DMA_SPIATX      109
+#define PERINT_ENABLE   1
+#define ONESHOT_DISABLE 0
+#define CONT_DISABLE    0
+#define SYNC_DISABLE    0
+#define SYNC_SRC        1
+#define OVRFLOW_DISABLE 0
+#define SIXTEEN_BIT     0
+#define CHINT_END       1
+#define CHINT_ENABLE    1
+
+struct DMA_CONTROL_BITS
+{
+    Uint16 RUN:1;
+    Uint16 HALT:1;
+    Uint16 SOFTRESET:1;
+    Uint16 PERINTFRC:1;
+    Uint16 PERINTCLR:1;
+    Uint16 rsvd1:2;
+    Uint16 ERRCLR:1;
+    Uint16 PERINTFLG:1;
+    Uint16 SYNCFLG:1;
+    Uint16 SYNCERR:1;
+    Uint16 TRANSFERSTS:1;
+    Uint16 BURSTSTS:1;
+    Uint16 RUNSTS:1;
+    Uint16 OVRFLG:1;
+    Uint16 rsvd2:1;
+};
+
+union DMA_CONTROL_REG
+{
+    Uint16 all;
+    struct DMA_CONTROL_BITS bit;
+};
+
+struct CH_REGS
+{
+    union DMA_CONTROL_REG CONTROL;
+};
+
+struct DMA_REGS
+{
+    struct CH_REGS CH5;
+};
+
+extern volatile struct DMA_REGS DmaRegs;
+
+void DMACH5AddrConfig(volatile Uint16 *DMA_Dest, volatile Uint16 *DMA_Source);
+void DMACH5BurstConfig(Uint16 bsize, int16 srcbstep, int16 desbstep);
+void DMACH5TransferConfig(Uint16 tsize, int16 srctstep, int16 deststep);
+void DMACH5ModeConfig(Uint16 persel, Uint16 perinte, Uint16 oneshot,
+                      Uint16 cont, Uint16 synce, Uint16 syncsel,
+                      Uint16 ovrinte, Uint16 datasize, Uint16 chintmode,
+                      Uint16 chinte);
+void StartDMACH5(void);
+
+#endif // F28X_PROJECT_H
+
+//
+// End of file
+//
@@ -0,0 +1,358 @@
+//###########################################################################
+//
+// FILE:   spi_stream.c
+//
+// TITLE:  SPI master for the target's SPI-A slave streaming link.
+//
+// Clocks the raw ADC frames out of the target (MODE SPI on the command
+// port, see adc_soc_continuous_dma_cpu01/spi.c) through a Linux spidev
+// master, decodes them and reports the sustained throughput against the
+// 11520 bytes/s of a 115200 baud SCI port. For every frame it waits for
+// the target's READY pin, reads the 6 header bytes and then the rest of
+// the frame padded to a multiple of 8 words (16 bytes). Decoded samples
+// are written as
+//
+//   frame,channel,index,value
+//
+// and a summary is printed to standard error.
+//
+// With -S the target is simulated in the program: the target's spi.c
+// runs on a model of SPI-A, DMA CH5 and the READY pin (spi_target.c) and
+// sends blocks of a ramp. Each block is handed to Spi_SendBlock() -p
+// microseconds (block preparation on the target) after the DMA has taken
+// the previous one, and every transfer costs -g microseconds of master
+// overhead plus its bits at -s Hz. This checks the target's framing and
+// the decoder against each other and gives the expected bandwidth of a
+// clock rate before the hardware is wired up.
+//
+// Build:  cc -O2 -Wno-unknown-pragmas -Ishim -o spi_stream spi_stream.c
+//             tlm.c spi_target.c ../adc_soc_continuous_dma_cpu01/spi.c
+//             ../adc_soc_continuous_dma_cpu01/tlm.c
+// Usage:  spi_stream [-q] [-s hz] [-t seconds] -d /dev/spidev0.0
+//                    -r /sys/class/gpio/gpio25/value
+//         spi_stream -S [-q] [-s hz] [-t seconds] [-n samples] [-b bits]
+//                    [-p us] [-g us]
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include "tlm.h"
+#include "spi_target.h"
+
+//
+// Defines
+//
+#define SPI_BURST       8           // Frame padding in words (spi.h)
+#define SPI_BLOCK_MAX   512         // SPI_BLOCK_SAMPLES of spi.h
+#define SCI_BYTES_PER_S 11520.0     // 115200 baud, 10 bits per byte
+#define FRAME_MAX       (2 * (5 + SPI_BLOCK_MAX + 1 + SPI_BURST))
+
+//
+// Typedefs
+//
+typedef struct
+{
+    // spidev back end
+    int fd;
+    int ready_fd;
+    uint32_t hz;
+
+    // Simulated target
+    int simulate;
+    unsigned samples;
+    unsigned bits;
+    double prep;                    // Block preparation, seconds
+    double gap;                     // Master overhead per transfer, seconds
+    double clock;                   // Simulated time, seconds
+    double ready_at;                // When the next block is handed over
+} spi_link;
+
+//
+// now - Monotonic time in seconds
+//
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//
+// frame_bytes - Bytes on the wire of a frame with a payload of len bytes
+//
+static size_t frame_bytes(size_t len)
+{
+    size_t words;
+
+    words = (TLM_HEADER_LEN + len + TLM_CRC_LEN + 1) / 2;
+    words = (words + SPI_BURST - 1) & ~(size_t)(SPI_BURST - 1);
+    return 2 * words;
+}
+
+//
+// link_ready - Nonzero if the target has a frame armed. The simulated
+//              target arms the next one once the clock has run to it.
+//
+static int link_ready(spi_link *l)
+{
+    char c = '0';
+
+    if(l->simulate)
+    {
+        if(!spi_target_ready())
+        {
+            if(l->clock < l->ready_at)
+            {
+                l->clock = l->ready_at;
+            }
+            spi_target_arm();
+        }
+        return spi_target_ready();
+    }
+
+    if(pread(l->ready_fd, &c, 1, 0) != 1)
+    {
+        return 0;
+    }
+    return c == '1';
+}
+
+//
+// link_xfer - Clock n bytes out of the target. Returns 0 on success.
+//
+static int link_xfer(spi_link *l, uint8_t *buf, size_t n)
+{
+    struct spi_ioc_transfer tr;
+    long after;
+
+    if(l->simulate)
+    {
+        l->clock += l->gap + n * 8.0 / l->hz;
+        after = spi_target_clock(buf, n);
+
+        //
+        // The next block is handed over a preparation time after the DMA
+        // finished this one, while the FIFO was still being clocked
+        //
+        if(after >= 0)
+        {
+            l->ready_at = l->clock - after * 8.0 / l->hz + l->prep;
+        }
+        return 0;
+    }
+
+    memset(&tr, 0, sizeof(tr));
+    tr.rx_buf = (unsigned long)buf;
+    tr.len = (uint32_t)n;
+    tr.speed_hz = l->hz;
+    tr.bits_per_word = 8;
+    return (ioctl(l->fd, SPI_IOC_MESSAGE(1), &tr) < 0) ? -1 : 0;
+}
+
+//
+// link_open - Open the spidev device in mode 0 and the READY value file
+//
+static int link_open(spi_link *l, const char *dev, const char *ready)
+{
+    uint8_t mode = SPI_MODE_0;
+    uint8_t bits = 8;
+
+    l->fd = open(dev, O_RDWR);
+    if(l->fd < 0)
+    {
+        perror(dev);
+        return -1;
+    }
+    if((ioctl(l->fd, SPI_IOC_WR_MODE, &mode) < 0) ||
+       (ioctl(l->fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) ||
+       (ioctl(l->fd, SPI_IOC_WR_MAX_SPEED_HZ, &l->hz) < 0))
+    {
+        perror(dev);
+        return -1;
+    }
+    l->ready_fd = open(ready, O_RDONLY);
+    if(l->ready_fd < 0)
+    {
+        perror(ready);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    static spi_link link;
+    static tlm_reader reader;
+    static tlm_frame frame;
+    uint8_t buf[FRAME_MAX];
+    const char *dev = NULL;
+    const char *ready = NULL;
+    double seconds = 10.0;
+    double start, elapsed = 0.0;
+    unsigned long long wireBytes = 0, sampleBytes = 0;
+    unsigned long rawFrames = 0, mismatches = 0, lostSync = 0;
+    unsigned long block[2] = { 0, 0 };
+    unsigned ch, bits, count, idx;
+    uint16_t v;
+    size_t len, total;
+    int quiet = 0;
+    int opt;
+
+    link.hz = 1000000;
+    link.samples = SPI_BLOCK_MAX;
+    link.bits = 12;
+    link.prep = 60e-6;
+    link.gap = 10e-6;
+
+    while((opt = getopt(argc, argv, "d:r:s:t:Sn:b:p:g:q")) != -1)
+    {
+        switch(opt)
+        {
+            case 'd': dev = optarg; break;
+            case 'r': ready = optarg; break;
+            case 's': link.hz = (uint32_t)atol(optarg); break;
+            case 't': seconds = atof(optarg); break;
+            case 'S': link.simulate = 1; break;
+            case 'n': link.samples = (unsigned)atoi(optarg); break;
+            case 'b': link.bits = (unsigned)atoi(optarg); break;
+            case 'p': link.prep = atof(optarg) * 1e-6; break;
+            case 'g': link.gap = atof(optarg) * 1e-6; break;
+            case 'q': quiet = 1; break;
+            default:  return 2;
+        }
+    }
+    if((link.hz == 0) || (link.samples < 1) ||
+       (link.samples > SPI_BLOCK_MAX) || (link.bits < 1) ||
+       (link.bits > 16) ||
+       (!link.simulate && ((dev == NULL) || (ready == NULL))))
+    {
+        fprintf(stderr, "usage: spi_stream [-q] [-s hz] [-t seconds] "
+                "-d spidev -r ready-gpio-value\n"
+                "       spi_stream -S [-q] [-s hz] [-t seconds] "
+                "[-n samples] [-b bits] [-p us] [-g us]\n");
+        return 2;
+    }
+    if(!link.simulate && (link_open(&link, dev, ready) != 0))
+    {
+        return 1;
+    }
+    if(link.simulate)
+    {
+        spi_target_init(link.samples, link.bits);
+    }
+
+    tlm_reader_init(&reader);
+    start = link.simulate ? 0.0 : now();
+    do
+    {
+        if(!link_ready(&link))
+        {
+            usleep(20);
+        }
+        else
+        {
+            //
+            // Header first, it holds the length of the rest of the frame.
+            // Out of sync the master moves on by one padding unit.
+            //
+            if(link_xfer(&link, buf, TLM_HEADER_LEN) != 0)
+            {
+                perror("spi");
+                return 1;
+            }
+            total = 2 * SPI_BURST;
+            if((buf[0] == TLM_SYNC0) && (buf[1] == TLM_SYNC1))
+            {
+                len = buf[4] | ((size_t)buf[5] << 8);
+                if(frame_bytes(len) <= sizeof(buf))
+                {
+                    total = frame_bytes(len);
+                }
+            }
+            else
+            {
+                lostSync++;
+            }
+            if(link_xfer(&link, &buf[TLM_HEADER_LEN],
+                         total - TLM_HEADER_LEN) != 0)
+            {
+                perror("spi");
+                return 1;
+            }
+            wireBytes += total;
+            tlm_reader_push(&reader, buf, total);
+
+            while(tlm_reader_next(&reader, &frame))
+            {
+                if((frame.type != TLM_TYPE_RAW) ||
+                   (frame.len < TLM_RAW_HEADER_LEN))
+                {
+                    continue;
+                }
+                ch = frame.payload[0];
+                bits = frame.payload[1];
+                count = frame.payload[2] | ((unsigned)frame.payload[3] << 8);
+                if(TLM_RAW_HEADER_LEN + 2 * count > frame.len)
+                {
+                    continue;
+                }
+
+                for(idx = 0; idx < count; idx++)
+                {
+                    v = (uint16_t)((frame.payload[4 + 2 * idx] << 8) |
+                                   frame.payload[5 + 2 * idx]);
+                    if(!quiet)
+                    {
+                        printf("%lu,%u,%u,%u\n", rawFrames, ch, idx, v);
+                    }
+                    if(link.simulate && (ch < 2) &&
+                       (v != spi_target_ramp(block[ch], ch, idx, bits)))
+                    {
+                        mismatches++;
+                    }
+                }
+                if(ch < 2)
+                {
+                    block[ch]++;
+                }
+                rawFrames++;
+                sampleBytes += 2ULL * count;
+            }
+        }
+        elapsed = (link.simulate ? link.clock : now()) - start;
+    } while(elapsed < seconds);
+
+    fprintf(stderr, "frames %lu, crc errors %lu, sequence gaps %lu, "
+            "out of sync %lu%s\n", rawFrames, reader.crc_errors,
+            reader.seq_gaps, lostSync,
+            link.simulate ? "" : " (real link)");
+    if(link.simulate)
+    {
+        fprintf(stderr, "sample mismatches %lu, FIFO underruns %lu\n",
+                mismatches, spi_target_underruns());
+    }
+    if(elapsed > 0.0)
+    {
+        fprintf(stderr, "%.0f Hz: wire %.0f bytes/s, samples %.0f bytes/s, "
+                "%.1fx a 115200 baud SCI port\n", (double)link.hz,
+                wireBytes / elapsed, sampleBytes / elapsed,
+                sampleBytes / elapsed / SCI_BYTES_PER_S);
+    }
+    return (reader.crc_errors != 0) || (mismatches != 0) ||
+           (link.simulate && (spi_target_underruns() != 0));
+}
+
+//
+// End of file
+//
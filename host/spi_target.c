@@ -0,0 +1,362 @@
+//###########################################################################
+//
+// FILE:   spi_target.c
+//
+// TITLE:  The target's SPI-A slave link on a model of its hardware.
+//
+// The simulated target of spi_stream -S. It runs the target's spi.c and
+// the packing of tlm.c as they are, on a model of what they drive:
+//
+//   SPI-A TX FIFO - SPI_FIFO_LEN words; the master clocking a word out
+//                   takes it off, an empty FIFO sends zeros (underruns)
+//   DMA CH5       - moves a burst into the FIFO on each FIFO event, the
+//                   level dropping to TXFFIL, or when forced (PERINTFRC),
+//                   and calls spiDmaIsr() once the last burst is in
+//   READY pin     - what spi.c writes to SPI_READY_GPIO
+//
+// The blocks handed to Spi_SendBlock() are ramps of both channels in
+// turn (spi_target_ramp()), for the master to check.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include "F28x_Project.h"
+#include "../adc_soc_continuous_dma_cpu01/tlm.h"
+#include "../adc_soc_continuous_dma_cpu01/spi.h"
+#include "../adc_soc_continuous_dma_cpu01/sci.h"
+#include "../adc_soc_continuous_dma_cpu01/arq.h"
+#include "../adc_soc_continuous_dma_cpu01/isrprof.h"
+#include "../adc_soc_continuous_dma_cpu01/nest.h"
+#include "spi_target.h"
+
+//
+// Globals
+//
+volatile Uint16 IER;
+volatile struct PIE_CTRL_REGS PieCtrlRegs;
+volatile struct CPUTIMER_REGS CpuTimer1Regs;
+volatile struct CPU_SYS_REGS CpuSysRegs;
+volatile struct SPI_REGS SpiaRegs;
+volatile struct DMA_REGS DmaRegs;
+volatile Uint32 isrProfCycles;
+
+static volatile Uint16 *dmaSrc;
+static Uint16 dmaBurst;             // Words per burst
+static Uint16 dmaBursts;            // Bursts per transfer
+static Uint16 dmaMoved;             // Bursts moved
+static int dmaRun;
+static int dmaEnded;                // spiDmaIsr() has run
+static Uint16 fifo[SPI_FIFO_LEN];
+static Uint16 fifoHead;
+static Uint16 fifoLevel;
+static Uint16 shiftWord;
+static int shiftLow;                // Low byte of shiftWord comes next
+static int readyPin;
+static unsigned simSamples;
+static unsigned simBits;
+static unsigned simCh;
+static unsigned long simBlock;
+static unsigned long underruns;
+static Uint16 simData[SPI_BLOCK_SAMPLES];
+
+//
+// GPIO
+//
+void GPIO_SetupPinMux(Uint16 pin, Uint16 cpu, Uint16 peripheral)
+{
+    (void)pin;
+    (void)cpu;
+    (void)peripheral;
+}
+
+void GPIO_SetupPinOptions(Uint16 pin, Uint16 output, Uint16 flags)
+{
+    (void)pin;
+    (void)output;
+    (void)flags;
+}
+
+void GPIO_WritePin(Uint16 pin, Uint16 outVal)
+{
+    if(pin == SPI_READY_GPIO)
+    {
+        readyPin = outVal;
+    }
+}
+
+//
+// DMA CH5
+//
+void DMACH5AddrConfig(volatile Uint16 *DMA_Dest, volatile Uint16 *DMA_Source)
+{
+    (void)DMA_Dest;
+    dmaSrc = DMA_Source;
+}
+
+void DMACH5BurstConfig(Uint16 bsize, int16 srcbstep, int16 desbstep)
+{
+    (void)srcbstep;
+    (void)desbstep;
+    dmaBurst = bsize + 1;
+}
+
+void DMACH5TransferConfig(Uint16 tsize, int16 srctstep, int16 deststep)
+{
+    (void)srctstep;
+    (void)deststep;
+    dmaBursts = tsize + 1;
+}
+
+void DMACH5ModeConfig(Uint16 persel, Uint16 perinte, Uint16 oneshot,
+                      Uint16 cont, Uint16 synce, Uint16 syncsel,
+                      Uint16 ovrinte, Uint16 datasize, Uint16 chintmode,
+                      Uint16 chinte)
+{
+    (void)persel;
+    (void)perinte;
+    (void)oneshot;
+    (void)cont;
+    (void)synce;
+    (void)syncsel;
+    (void)ovrinte;
+    (void)datasize;
+    (void)chintmode;
+    (void)chinte;
+}
+
+void StartDMACH5(void)
+{
+    dmaMoved = 0;
+    dmaRun = 1;
+}
+
+//
+// The profiler and nesting, which the interrupt calls
+//
+void IsrProf_Exit(Uint16 id, Uint32 start, Uint32 base, Uint32 age)
+{
+    (void)id;
+    (void)start;
+    (void)base;
+    (void)age;
+}
+
+Uint32 Nest_Enter(void)
+{
+    return 0;
+}
+
+void Nest_Exit(Uint32 saved)
+{
+    (void)saved;
+}
+
+//
+// The SCI driver and the ARQ transport, which tlm.c links against; only
+// its packing is used here
+//
+Uint16 Sci_IsOpen(Uint16 port)
+{
+    (void)port;
+    return 0;
+}
+
+Uint16 Sci_TxSpace(Uint16 port)
+{
+    (void)port;
+    return 0;
+}
+
+int Sci_Put(Uint16 port, const char *data, int len)
+{
+    (void)port;
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+int Sci_PutRef(Uint16 port, const Uint16 *data, Uint16 words, Uint16 crc)
+{
+    (void)port;
+    (void)data;
+    (void)words;
+    (void)crc;
+    return 0;
+}
+
+Uint16 Sci_RefBusy(Uint16 port)
+{
+    (void)port;
+    return 0;
+}
+
+Uint16 Sci_RefCrc(Uint16 port)
+{
+    (void)port;
+    return 0;
+}
+
+Uint16 Arq_Port(void)
+{
+    return ARQ_NO_PORT;
+}
+
+Uint16 Arq_Space(void)
+{
+    return 0;
+}
+
+int Arq_Put(const char *data, int len)
+{
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+void Arq_Poll(void)
+{
+}
+
+//
+// dma_burst - CH5 moves a burst into the FIFO; after the last one of the
+//             transfer its interrupt runs
+//
+static void dma_burst(void)
+{
+    Uint16 i;
+
+    for(i = 0; (i < dmaBurst) && (fifoLevel < SPI_FIFO_LEN); i++)
+    {
+        fifo[(fifoHead + fifoLevel) % SPI_FIFO_LEN] = *dmaSrc++;
+        fifoLevel++;
+    }
+    SpiaRegs.SPIFFTX.bit.TXFFST = fifoLevel;
+    if(++dmaMoved == dmaBursts)
+    {
+        dmaRun = 0;
+        dmaEnded = 1;
+        spiDmaIsr();
+    }
+}
+
+//
+// spi_target_init - Set up the target's link for blocks of samples of the
+//                   given width
+//
+void spi_target_init(unsigned samples, unsigned bits)
+{
+    simSamples = samples;
+    simBits = bits;
+    Tlm_Init(0);                    // The CRC table of Tlm_PackRaw()
+    Spi_Init();
+}
+
+//
+// spi_target_ready - The READY pin
+//
+int spi_target_ready(void)
+{
+    return readyPin;
+}
+
+//
+// spi_target_ramp - Sample at index i of a block of a channel
+//
+uint16_t spi_target_ramp(unsigned long block, unsigned ch, unsigned i,
+                         unsigned bits)
+{
+    return (uint16_t)((block * 7 + ch * 1000 + i) & ((1UL << bits) - 1));
+}
+
+//
+// spi_target_arm - The target's background loop hands the next block to
+//                  Spi_SendBlock(). Returns 0 while it is still busy.
+//
+int spi_target_arm(void)
+{
+    unsigned i;
+
+    for(i = 0; i < simSamples; i++)
+    {
+        simData[i] = spi_target_ramp(simBlock, simCh, i, simBits);
+    }
+    if(Spi_SendBlock(simCh, simBits, simData, simSamples) == 0)
+    {
+        return 0;
+    }
+    if(DmaRegs.CH5.CONTROL.bit.PERINTFRC != 0)
+    {
+        DmaRegs.CH5.CONTROL.bit.PERINTFRC = 0;
+        dma_burst();
+    }
+
+    simCh ^= 1;
+    if(simCh == 0)
+    {
+        simBlock++;
+    }
+    return 1;
+}
+
+//
+// spi_target_clock - The master clocks n bytes out of the slave, high byte
+//                    of each word first. Returns how many of them came
+//                    after the DMA finished the frame, or -1 if it did not
+//                    in this transfer.
+//
+long spi_target_clock(uint8_t *buf, size_t n)
+{
+    long after;
+    size_t i;
+
+    after = dmaEnded ? (long)n : -1;    // All in the FIFO when armed
+    dmaEnded = 0;
+    for(i = 0; i < n; i++)
+    {
+        if(shiftLow)
+        {
+            buf[i] = (uint8_t)shiftWord;
+            shiftLow = 0;
+            continue;
+        }
+
+        if(fifoLevel == 0)
+        {
+            shiftWord = 0;
+            underruns++;
+        }
+        else
+        {
+            shiftWord = fifo[fifoHead];
+            fifoHead = (fifoHead + 1) % SPI_FIFO_LEN;
+            fifoLevel--;
+            SpiaRegs.SPIFFTX.bit.TXFFST = fifoLevel;
+            if(dmaRun && (fifoLevel <= SpiaRegs.SPIFFTX.bit.TXFFIL))
+            {
+                dma_burst();
+                if(dmaEnded && (after < 0))
+                {
+                    after = (long)(n - i - 1);
+                }
+            }
+        }
+        buf[i] = (uint8_t)(shiftWord >> 8);
+        shiftLow = 1;
+    }
+    dmaEnded = 0;
+    return after;
+}
+
+//
+// spi_target_underruns - Words clocked out of an empty FIFO
+//
+unsigned long spi_target_underruns(void)
+{
+    return underruns;
+}
+
+//
+// End of file
+//
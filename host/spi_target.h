@@ -0,0 +1,30 @@
+//###########################################################################
+//
+// FILE:   spi_target.h
+//
+// TITLE:  The target's SPI-A slave link on a model of its hardware.
+//
+//###########################################################################
+
+#ifndef HOST_SPI_TARGET_H
+#define HOST_SPI_TARGET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Function Prototypes
+//
+void spi_target_init(unsigned samples, unsigned bits);
+int spi_target_ready(void);
+int spi_target_arm(void);
+long spi_target_clock(uint8_t *buf, size_t n);
+uint16_t spi_target_ramp(unsigned long block, unsigned ch, unsigned i,
+                         unsigned bits);
+unsigned long spi_target_underruns(void);
+
+#endif // HOST_SPI_TARGET_H
+
+//
+// End of file
+//
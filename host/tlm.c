@@ -0,0 +1,155 @@
+//###########################################################################
+//
+// FILE:   tlm.c
+//
+// TITLE:  Host side reader of the target's binary telemetry frames.
+//
+//###########################################################################
+
+//
+// Included Files
+//
+#include <string.h>
+#include "tlm.h"
+
+//
+// tlm_crc16 - Continue a CRC-16/CCITT over len bytes
+//
+uint16_t tlm_crc16(uint16_t crc, const uint8_t *data, size_t len)
+{
+    size_t i;
+    int j;
+
+    for(i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for(j = 0; j < 8; j++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) :
+                                   (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+//
+// tlm_reader_init - Start with an empty buffer and no sequence history,
+//                   accepting frames up to TLM_MAX_PAYLOAD
+//
+void tlm_reader_init(tlm_reader *r)
+{
+    memset(r, 0, sizeof(*r));
+    r->max_len = TLM_MAX_PAYLOAD;
+}
+
+//
+// tlm_reader_space - Bytes that can be pushed before the next frame must
+//                    be taken out with tlm_reader_next()
+//
+size_t tlm_reader_space(const tlm_reader *r)
+{
+    return sizeof(r->buf) - r->n;
+}
+
+//
+// tlm_reader_push - Append received bytes, at most tlm_reader_space()
+//
+void tlm_reader_push(tlm_reader *r, const uint8_t *data, size_t len)
+{
+    memcpy(&r->buf[r->n], data, len);
+    r->n += len;
+}
+
+//
+// tlm_reader_drop - Discard the first count buffered bytes
+//
+static void tlm_reader_drop(tlm_reader *r, size_t count)
+{
+    memmove(r->buf, &r->buf[count], r->n - count);
+    r->n -= count;
+}
+
+//
+// tlm_reader_next - Take the next valid frame out of the buffer. Returns 1
+//                   with the frame in f, or 0 if more bytes are needed.
+//                   A frame failing its CRC is resynchronized one byte
+//                   after its sync pattern.
+//
+int tlm_reader_next(tlm_reader *r, tlm_frame *f)
+{
+    size_t i;
+    size_t len;
+    size_t total;
+    uint16_t crc;
+
+    for(;;)
+    {
+        i = 0;
+        while((i + 1 < r->n) &&
+              !((r->buf[i] == TLM_SYNC0) && (r->buf[i + 1] == TLM_SYNC1)))
+        {
+            i++;
+        }
+        if((i + 1 >= r->n) && (r->n > 0) && (r->buf[r->n - 1] != TLM_SYNC0))
+        {
+            i = r->n;
+        }
+        if(i > 0)
+        {
+            r->skipped += i;
+            tlm_reader_drop(r, i);
+        }
+
+        if(r->n < TLM_HEADER_LEN)
+        {
+            return 0;
+        }
+
+        //
+        // A length beyond max_len is a broken header; waiting for that
+        // many bytes would only hold up the frames behind it
+        //
+        len = r->buf[4] | ((size_t)r->buf[5] << 8);
+        if(len > r->max_len)
+        {
+            r->crc_errors++;
+            r->skipped++;
+            tlm_reader_drop(r, 1);
+            continue;
+        }
+        total = TLM_HEADER_LEN + len + TLM_CRC_LEN;
+        if(r->n < total)
+        {
+            return 0;
+        }
+
+        crc = tlm_crc16(0xFFFF, &r->buf[2], TLM_HEADER_LEN - 2 + len);
+        if(crc != (((uint16_t)r->buf[TLM_HEADER_LEN + len] << 8) |
+                   r->buf[TLM_HEADER_LEN + len + 1]))
+        {
+            r->crc_errors++;
+            r->skipped++;
+            tlm_reader_drop(r, 1);
+            continue;
+        }
+
+        f->type = r->buf[2];
+        f->seq = r->buf[3];
+        f->len = (uint16_t)len;
+        memcpy(f->payload, &r->buf[TLM_HEADER_LEN], len);
+        tlm_reader_drop(r, total);
+
+        if(r->have_seq && (f->seq != r->next_seq))
+        {
+            r->seq_gaps++;
+        }
+        r->have_seq = 1;
+        r->next_seq = (uint8_t)(f->seq + 1);
+        r->frames++;
+        return 1;
+    }
+}
+
+//
+// End of file
+//
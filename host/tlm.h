@@ -0,0 +1,88 @@
+//###########################################################################
+//
+// FILE:   tlm.h
+//
+// TITLE:  Host side reader of the target's binary telemetry frames.
+//
+// Frame layout (see adc_soc_continuous_dma_cpu01/tlm.h):
+//
+//   0xA5 0x5A type seq lenL lenH payload[len] crcH crcL
+//
+// with a CRC-16/CCITT (polynomial 0x1021, initial 0xFFFF) over type, seq,
+// len and payload. Bytes outside frames (command replies) are skipped.
+//
+//###########################################################################
+
+#ifndef HOST_TLM_H
+#define HOST_TLM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Defines
+//
+#define TLM_SYNC0           0xA5
+#define TLM_SYNC1           0x5A
+#define TLM_HEADER_LEN      6
+#define TLM_CRC_LEN         2
+#define TLM_MAX_PAYLOAD     65535
+#define TLM_BUF_LEN         (2 * (TLM_HEADER_LEN + TLM_MAX_PAYLOAD + TLM_CRC_LEN))
+
+#define TLM_TYPE_RICE       0x01    // ch, bits, countL, countH, Rice code
+#define TLM_RICE_HEADER_LEN 4
+#define TLM_TYPE_RAW        0x02    // ch, bits, countL, countH, samples as
+                                    // high, low byte pairs
+#define TLM_RAW_HEADER_LEN  4
+#define TLM_TYPE_LOG        0x03    // Log records, see log_render.c
+#define TLM_TYPE_ARQ        0x04    // base, stream bytes, see arq_peer.c
+#define TLM_TYPE_ARQ_ACK    0x05    // next, map0..mapN, to the target
+#define TLM_TYPE_MEM        0x06    // addr0..addr3, words as high, low
+                                    // byte pairs, see mem_tool.c
+#define TLM_MEM_HEADER_LEN  4
+#define TLM_TYPE_SCI_STATUS 0x07    // ports, then per port: port and
+                                    // TLM_SCI_STATUS_COUNTS counts, low
+                                    // byte first: overrun, framing,
+                                    // parity, break, FIFO overflow, ring
+                                    // drops, resets, received
+#define TLM_SCI_STATUS_COUNTS 8
+#define TLM_SCI_STATUS_PORT_LEN (1 + 4 * TLM_SCI_STATUS_COUNTS)
+
+//
+// Typedefs
+//
+typedef struct
+{
+    uint8_t  type;
+    uint8_t  seq;
+    uint16_t len;
+    uint8_t  payload[TLM_MAX_PAYLOAD];
+} tlm_frame;
+
+typedef struct
+{
+    uint8_t       buf[TLM_BUF_LEN];
+    size_t        n;
+    int           have_seq;
+    uint8_t       next_seq;
+    size_t        max_len;      // Longer frames are taken as broken
+    unsigned long frames;
+    unsigned long crc_errors;
+    unsigned long seq_gaps;
+    unsigned long skipped;
+} tlm_reader;
+
+//
+// Function Prototypes
+//
+uint16_t tlm_crc16(uint16_t crc, const uint8_t *data, size_t len);
+void tlm_reader_init(tlm_reader *r);
+size_t tlm_reader_space(const tlm_reader *r);
+void tlm_reader_push(tlm_reader *r, const uint8_t *data, size_t len);
+int tlm_reader_next(tlm_reader *r, tlm_frame *f);
+
+#endif // HOST_TLM_H
+
+//
+// End of file
+//